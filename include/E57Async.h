@@ -0,0 +1,237 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+
+/// @file
+/// @brief Optional C++20 coroutine API for reading and writing a CompressedVectorNode
+/// asynchronously.
+/// @details This header only needs C++20 in the code which includes it - the library itself is
+/// still built as C++14. If coroutines are not available, the header is empty and
+/// E57_HAS_COROUTINES is not defined.
+///
+/// The reading and decoding (or encoding and writing) is run as a task on an executor provided by
+/// the caller. The awaiting coroutine is resumed on the thread which ran the task, so thousands of
+/// reads can be multiplexed on a few executor threads.
+///
+/// @note An ImageFile is not thread safe. Reads of the same ImageFile must not overlap.
+
+#include "E57Format.h"
+
+// Check __has_include separately since older compilers may not support it.
+#if defined( __cpp_impl_coroutine ) && ( __cpp_impl_coroutine >= 201902L )
+#if __has_include( <coroutine> )
+
+#define E57_HAS_COROUTINES 1
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <utility>
+
+namespace e57
+{
+   /// @brief Schedules a task. The task must be run exactly once, on any thread.
+   /// @details For example, to run the tasks on an asio::thread_pool:
+   /// @code
+   /// e57::AsyncExecutor executor = [&pool]( std::function<void()> task ) {
+   ///    asio::post( pool, std::move( task ) );
+   /// };
+   /// @endcode
+   using AsyncExecutor = std::function<void( std::function<void()> task )>;
+
+   /// @brief Awaitable returned by readAsync() and AsyncChunkReader::next()
+   /// @details co_await gives the number of records read (see CompressedVectorReader::read()).
+   /// Exceptions thrown by the read are rethrown in the awaiting coroutine.
+   class ReadAwaitable
+   {
+   public:
+      ReadAwaitable( CompressedVectorReader reader, std::vector<SourceDestBuffer> *dbufs,
+                     AsyncExecutor executor, bool closeAtEnd = false ) :
+         reader_( std::move( reader ) ), dbufs_( dbufs ), executor_( std::move( executor ) ),
+         closeAtEnd_( closeAtEnd )
+      {
+      }
+
+      bool await_ready() const noexcept
+      {
+         return false;
+      }
+
+      void await_suspend( std::coroutine_handle<> handle )
+      {
+         // The task may resume the coroutine, which destroys this awaitable, before the executor
+         // returns, so the executor must not be a member while it is called.
+         const AsyncExecutor executor = executor_;
+
+         executor( [this, handle]() {
+            try
+            {
+               count_ = ( dbufs_ != nullptr ) ? reader_.read( *dbufs_ ) : reader_.read();
+
+               if ( closeAtEnd_ && ( count_ == 0 ) )
+               {
+                  reader_.close();
+               }
+            }
+            catch ( ... )
+            {
+               error_ = std::current_exception();
+            }
+
+            handle.resume();
+         } );
+      }
+
+      unsigned await_resume()
+      {
+         if ( error_ )
+         {
+            std::rethrow_exception( error_ );
+         }
+
+         return count_;
+      }
+
+   private:
+      CompressedVectorReader reader_;
+      std::vector<SourceDestBuffer> *dbufs_;
+      AsyncExecutor executor_;
+      bool closeAtEnd_;
+
+      unsigned count_ = 0;
+      std::exception_ptr error_;
+   };
+
+   /// @brief Awaitable returned by writeAsync()
+   /// @details Exceptions thrown by the write are rethrown in the awaiting coroutine.
+   class WriteAwaitable
+   {
+   public:
+      WriteAwaitable( CompressedVectorWriter writer, size_t recordCount,
+                      std::vector<SourceDestBuffer> *sbufs, AsyncExecutor executor ) :
+         writer_( std::move( writer ) ), recordCount_( recordCount ), sbufs_( sbufs ),
+         executor_( std::move( executor ) )
+      {
+      }
+
+      bool await_ready() const noexcept
+      {
+         return false;
+      }
+
+      void await_suspend( std::coroutine_handle<> handle )
+      {
+         // See ReadAwaitable::await_suspend()
+         const AsyncExecutor executor = executor_;
+
+         executor( [this, handle]() {
+            try
+            {
+               if ( sbufs_ != nullptr )
+               {
+                  writer_.write( *sbufs_, recordCount_ );
+               }
+               else
+               {
+                  writer_.write( recordCount_ );
+               }
+            }
+            catch ( ... )
+            {
+               error_ = std::current_exception();
+            }
+
+            handle.resume();
+         } );
+      }
+
+      void await_resume()
+      {
+         if ( error_ )
+         {
+            std::rethrow_exception( error_ );
+         }
+      }
+
+   private:
+      CompressedVectorWriter writer_;
+      size_t recordCount_;
+      std::vector<SourceDestBuffer> *sbufs_;
+      AsyncExecutor executor_;
+
+      std::exception_ptr error_;
+   };
+
+   /// @brief Reads the next block of records into the reader's current buffers on the executor
+   /// @param [in] reader Reader to read from
+   /// @param [in] executor Executor which runs the read
+   inline ReadAwaitable readAsync( const CompressedVectorReader &reader, AsyncExecutor executor )
+   {
+      return { reader, nullptr, std::move( executor ) };
+   }
+
+   /// @brief Reads the next block of records into new buffers on the executor
+   /// @param [in] reader Reader to read from
+   /// @param [in] dbufs Buffers to read into. Must stay valid until the read completes.
+   /// @param [in] executor Executor which runs the read
+   inline ReadAwaitable readAsync( const CompressedVectorReader &reader,
+                                   std::vector<SourceDestBuffer> &dbufs, AsyncExecutor executor )
+   {
+      return { reader, &dbufs, std::move( executor ) };
+   }
+
+   /// @brief Writes records from the writer's current buffers on the executor
+   /// @param [in] writer Writer to write with
+   /// @param [in] recordCount Number of records to write (see CompressedVectorWriter::write())
+   /// @param [in] executor Executor which runs the write
+   inline WriteAwaitable writeAsync( const CompressedVectorWriter &writer, size_t recordCount,
+                                     AsyncExecutor executor )
+   {
+      return { writer, recordCount, nullptr, std::move( executor ) };
+   }
+
+   /// @brief Writes records from new buffers on the executor
+   /// @param [in] writer Writer to write with
+   /// @param [in] sbufs Buffers to write from. Must stay valid until the write completes.
+   /// @param [in] recordCount Number of records to write (see CompressedVectorWriter::write())
+   /// @param [in] executor Executor which runs the write
+   inline WriteAwaitable writeAsync( const CompressedVectorWriter &writer,
+                                     std::vector<SourceDestBuffer> &sbufs, size_t recordCount,
+                                     AsyncExecutor executor )
+   {
+      return { writer, recordCount, &sbufs, std::move( executor ) };
+   }
+
+   /// @brief Asynchronous stream of chunks of records
+   /// @details Each call to next() reads the next chunk into the reader's buffers. The reader is
+   /// closed when all the records have been read.
+   /// @code
+   /// e57::AsyncChunkReader chunks( vectorReader, executor );
+   ///
+   /// while ( const unsigned count = co_await chunks.next() )
+   /// {
+   ///    // process count records in the buffers
+   /// }
+   /// @endcode
+   class AsyncChunkReader
+   {
+   public:
+      AsyncChunkReader( CompressedVectorReader reader, AsyncExecutor executor ) :
+         reader_( std::move( reader ) ), executor_( std::move( executor ) )
+      {
+      }
+
+      /// @brief Reads the next chunk. co_await gives the number of records read, 0 at the end.
+      ReadAwaitable next()
+      {
+         return { reader_, nullptr, executor_, true };
+      }
+
+   private:
+      CompressedVectorReader reader_;
+      AsyncExecutor executor_;
+   };
+} // end namespace e57
+
+#endif
+#endif
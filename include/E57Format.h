@@ -33,6 +33,7 @@
 
 #include <cfloat>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -100,6 +101,27 @@ namespace e57
          PrecisionDouble
    };
 
+   /// @brief Identifies how the values of a field of a CompressedVectorNode are stored
+   /// @details The codecs other than CodecBitPack are part of the libE57Format codecs extension
+   /// (see e57::CODECS_EXTENSION_URI) and can only be read by software supporting it.
+   /// @see CompressedVectorNode::appendCodec()
+   enum Codec
+   {
+      CodecBitPack = 0,  ///< Standard E57 bitPackCodec (the default)
+      CodecFloatXor = 1, ///< XOR of consecutive values of Float fields (lossless)
+
+      /// Runs of repeated values of Integer and ScaledInteger fields, with a dictionary of the
+      /// values (lossless). Best for fields with a few values in long runs, like
+      /// cartesianInvalidState or returnIndex.
+      CodecRunLength = 2,
+
+      /// rANS entropy coding of Integer and ScaledInteger fields (lossless). The values are coded
+      /// relative to the minimum or as differences between consecutive values, whichever is
+      /// smaller. Best for fields with a skewed distribution of values, like intensity or a
+      /// smoothly varying coordinate.
+      CodecRans = 3
+   };
+
    /// @brief Identifies the representations of memory elements API can transfer data to/from
    enum MemoryRepresentation
    {
@@ -190,6 +212,111 @@ namespace e57
    [[deprecated( "Will be removed in 4.0. Use e57::VERSION_1_0_URI." )]] // TODO Remove in 4.0
    constexpr auto E57_V1_0_URI = VERSION_1_0_URI;
 
+   /// @brief The URI of the libE57Format codecs extension XML namespace
+   /// @see e57::Codec
+   constexpr char CODECS_EXTENSION_URI[] =
+      "https://github.com/asmaloney/libE57Format/E57_EXT_codecs";
+
+   /// @brief The URI of the libE57Format time index extension XML namespace
+   /// @details A Data3D using it has a CompressedVector "<prefix>:chunks" whose records have the
+   /// range of points of a chunk ("startPointIndex" and "pointCount") and the range of their valid
+   /// time stamps ("timeMinimum" and "timeMaximum").
+   /// @see WriterOptions::timeIndexChunkSize, Reader::ReadTimeWindow()
+   constexpr char TIME_INDEX_EXTENSION_URI[] =
+      "https://github.com/asmaloney/libE57Format/E57_EXT_time_index";
+
+   /// @brief The URI of the libE57Format point order extension XML namespace
+   /// @details A Data3D using it has a String "<prefix>:order" naming the order its points were
+   /// written in. "bitReversedIndex" means that, with B the number of bits needed for the point
+   /// count, the points were written in the order of reverse(k) (k with its B low bits reversed)
+   /// for k = 0, 1, ... skipping the values not less than the point count. Any prefix of the
+   /// points is then a subsample spread evenly over the original order.
+   /// @see WriterOptions::progressivePointOrder
+   constexpr char POINT_ORDER_EXTENSION_URI[] =
+      "https://github.com/asmaloney/libE57Format/E57_EXT_point_order";
+
+   /// @brief Source of the memory used for the nodes and the large internal buffers
+   /// @details This is used for the nodes of the tree (with their names, string values and lists
+   /// of children), the packet caches of readers, the buffers of the encoders and decoders of each
+   /// field, and the point buffers of Data3DPointsData_t. It has the same
+   /// interface as std::pmr::memory_resource, so one can easily be wrapped in a MemoryResource.
+   /// @see MonotonicMemoryResource, ImageFile::setMemoryResource()
+   class E57_DLL MemoryResource
+   {
+   public:
+      virtual ~MemoryResource() = default;
+
+      /// @brief Allocates bytes with the given alignment. Throws if it fails.
+      virtual void *allocate( size_t bytes, size_t alignment ) = 0;
+
+      /// @brief Releases memory returned by allocate() with the same bytes and alignment
+      virtual void deallocate( void *p, size_t bytes, size_t alignment ) = 0;
+   };
+
+   /// @brief MemoryResource which allocates from large blocks and only frees them all at once
+   /// @details deallocate() does nothing. The memory is freed by release() or when the resource
+   /// is destroyed, so everything using it must have been destroyed by then. It is not thread safe.
+   class E57_DLL MonotonicMemoryResource : public MemoryResource
+   {
+   public:
+      /// @param [in] blockSize Size of the blocks allocated from the heap. Larger allocations get
+      /// a block of their own.
+      explicit MonotonicMemoryResource( size_t blockSize = 1024 * 1024 );
+      ~MonotonicMemoryResource() override;
+
+      MonotonicMemoryResource( const MonotonicMemoryResource & ) = delete;
+      MonotonicMemoryResource &operator=( const MonotonicMemoryResource & ) = delete;
+
+      void *allocate( size_t bytes, size_t alignment ) override;
+      void deallocate( void *p, size_t bytes, size_t alignment ) override;
+
+      /// @brief Frees all the memory allocated so far
+      void release();
+
+      /// @brief Returns the number of bytes allocated from the heap
+      size_t heapBytes() const;
+
+   private:
+      size_t blockSize_;
+      std::vector<std::unique_ptr<char[]>> blocks_;
+      size_t heapBytes_ = 0;
+      char *next_ = nullptr;
+      size_t available_ = 0;
+   };
+
+   /// @brief Reads byteCount bytes of a file starting at offset into dest
+   /// @details Returns false if the bytes can't be read. The range is always inside the file.
+   /// @see RangeSource
+   using ReadRangeFunction = std::function<bool( uint64_t offset, size_t byteCount, char *dest )>;
+
+   /// @brief A file which is read by byte ranges, such as an object in an object store or a
+   /// member of an archive.
+   /// @details The ranges are read in blocks which are kept in a least recently used cache.
+   /// Blocks missing from a read are fetched together with one call, and blocks are read ahead
+   /// when they are read in order.
+   /// @see ImageFile::ImageFile( const RangeSource &, ReadChecksumPolicy )
+   struct E57_DLL RangeSource
+   {
+      /// Reads the bytes of the file
+      ReadRangeFunction read;
+
+      /// Length of the file in bytes
+      uint64_t size = 0;
+
+      /// Name of the file used in error messages and returned by ImageFile::fileName()
+      ustring name = "<RangeSource>";
+
+      /// Size in bytes of the blocks which are read & cached. It is rounded up to a multiple of
+      /// the 1 KiB page size.
+      size_t blockSize = 64 * 1024;
+
+      /// Number of blocks in the cache
+      size_t cacheBlockCount = 64;
+
+      /// Number of blocks read ahead when the blocks are read in order
+      size_t prefetchBlockCount = 4;
+   };
+
    /// @cond documentNonPublic   The following aren't documented
    // Minimum and maximum values for integers
    constexpr uint8_t UINT8_MIN = 0U;
@@ -235,6 +362,7 @@ public:
    class IntegerNodeImpl;
    class Node;
    class NodeImpl;
+   class NodeVisitor;
    class ScaledIntegerNode;
    class ScaledIntegerNodeImpl;
    class SourceDestBuffer;
@@ -246,6 +374,103 @@ public:
    class VectorNode;
    class VectorNodeImpl;
 
+   /// @brief Read-only view of a node given to a NodeVisitor
+   /// @details A view reads the node directly: making one allocates nothing and changes no
+   /// reference counts. Only the strings returned by elementName() and stringValue() are copies.
+   /// It is only valid during the call it is given to. The accessors for the values of another
+   /// type of node throw ::ErrorBadNodeDowncast.
+   /// @see Node::visit()
+   class E57_DLL NodeView
+   {
+   public:
+      NodeView() = delete;
+
+      /// @brief Returns the type of the node
+      NodeType type() const;
+
+      /// @brief Returns the element name of the node ("" for the node the visit started from if
+      /// it is a root). The prototype and codecs of a CompressedVectorNode are named "prototype"
+      /// and "codecs".
+      ustring elementName() const;
+
+      /// @brief Returns the depth of the node below the node the visit started from
+      unsigned depth() const;
+
+      /// @brief Returns the number of children of a StructureNode or VectorNode, 2 for a
+      /// CompressedVectorNode (its prototype and codecs), and 0 for the other types.
+      int64_t childCount() const;
+
+      /// @brief Returns the value of an IntegerNode, or the raw value of a ScaledIntegerNode
+      int64_t integerValue() const;
+      /// @brief Returns the minimum of an IntegerNode, or the raw minimum of a ScaledIntegerNode
+      int64_t integerMinimum() const;
+      /// @brief Returns the maximum of an IntegerNode, or the raw maximum of a ScaledIntegerNode
+      int64_t integerMaximum() const;
+
+      /// @brief Returns the scaled value of a ScaledIntegerNode
+      double scaledValue() const;
+      /// @brief Returns the scale of a ScaledIntegerNode
+      double scale() const;
+      /// @brief Returns the offset of a ScaledIntegerNode
+      double offset() const;
+
+      /// @brief Returns the value of a FloatNode
+      double floatValue() const;
+      /// @brief Returns the minimum of a FloatNode
+      double floatMinimum() const;
+      /// @brief Returns the maximum of a FloatNode
+      double floatMaximum() const;
+      /// @brief Returns the precision of a FloatNode
+      FloatPrecision precision() const;
+
+      /// @brief Returns the value of a StringNode
+      ustring stringValue() const;
+
+      /// @brief Returns the length in bytes of a BlobNode
+      int64_t blobLength() const;
+
+      /// @brief Returns the number of records of a CompressedVectorNode
+      int64_t recordCount() const;
+
+      /// @brief Returns whether a VectorNode allows children of different types
+      bool allowHeteroChildren() const;
+
+      /// @brief Returns a handle on the node, to keep it or use the rest of the API
+      Node node() const;
+
+      /// @cond documentNonPublic The following isn't part of the API, and isn't documented.
+   private:
+      friend class Node;
+
+      NodeView( const NodeImpl *impl, const char *elementName, unsigned depth );
+
+      static void visit( const NodeImpl *impl, const char *elementName, unsigned depth,
+                         NodeVisitor &visitor );
+
+      template <typename ImplT> const ImplT *implAs( NodeType type ) const;
+
+      const NodeImpl *impl_;
+      const char *elementName_;
+      unsigned depth_;
+      /// @endcond
+   };
+
+   /// @brief Receives the nodes of a tree walked by Node::visit()
+   class E57_DLL NodeVisitor
+   {
+   public:
+      virtual ~NodeVisitor() = default;
+
+      /// @brief Called for each node, before its children
+      /// @return Returns false to skip the children of the node
+      virtual bool enter( const NodeView &node ) = 0;
+
+      /// @brief Called after the children of a node (if any) when enter() returned true for it
+      virtual void leave( const NodeView & /*node*/ )
+      {
+      }
+   };
+
    class E57_DLL Node
    {
    public:
@@ -258,6 +483,7 @@ public:
       ustring elementName() const;
       ImageFile destImageFile() const;
       bool isAttached() const;
+      void visit( NodeVisitor &visitor ) const;
       void dump( int indent = 0, std::ostream &os = std::cout ) const;
       void checkInvariant( bool doRecurse = true, bool doDowncast = true );
       bool operator==( const Node &n2 ) const;
@@ -301,6 +527,7 @@ public:
       ustring elementName() const;
       ImageFile destImageFile() const;
       bool isAttached() const;
+      void visit( NodeVisitor &visitor ) const;
 
       // Diagnostic functions:
       void dump( int indent = 0, std::ostream &os = std::cout ) const;
@@ -333,6 +560,8 @@ public:
       Node get( int64_t index ) const;
       Node get( const ustring &pathName ) const;
       void append( const Node &n );
+      void appendMany( const std::vector<Node> &nodes );
+      void reserve( int64_t count );
 
       // Up/Down cast conversion
       operator Node() const;
@@ -419,6 +648,66 @@ public:
       /// @endcond
    };
 
+   /// @brief Comparison used by a RecordCondition
+   enum FilterComparison
+   {
+      FilterEqual = 0,         ///< Field value == value
+      FilterNotEqual = 1,      ///< Field value != value
+      FilterLess = 2,          ///< Field value < value
+      FilterLessOrEqual = 3,   ///< Field value <= value
+      FilterGreater = 4,       ///< Field value > value
+      FilterGreaterOrEqual = 5 ///< Field value >= value
+   };
+
+   /// @brief Condition on a field of the records read by a CompressedVectorReader
+   /// @details The value of the field is compared as it is in the destination buffer (i.e. after
+   /// conversion and scaling), converted to double.
+   /// @see CompressedVectorReader::setFilter()
+   struct E57_DLL RecordCondition
+   {
+      ustring pathName;                          ///< Path of the field in the prototype
+      FilterComparison comparison = FilterEqual; ///< How the field value is compared with value
+      double value = 0.0;                        ///< Value the field value is compared with
+   };
+
+   /// @brief Conditions which a record must all meet to be kept
+   using RecordFilter = std::vector<RecordCondition>;
+
+   /// @brief Field of the records read by a CompressedVectorReader to gather statistics on
+   /// @see CompressedVectorReader::setStatistics()
+   struct E57_DLL StatisticsField
+   {
+      ustring pathName;               ///< Path of the field in the prototype
+      unsigned histogramBinCount = 0; ///< Number of bins of the histogram (0 for no histogram)
+      double histogramMinimum = 0.0;  ///< Start of the first bin of the histogram
+      double histogramMaximum = 0.0;  ///< End of the last bin of the histogram
+   };
+
+   /// @brief Statistics of the values of a field read by a CompressedVectorReader
+   /// @details Values are taken as they are in the destination buffer (i.e. after conversion and
+   /// scaling), converted to double. NaN values are not counted.
+   /// @see CompressedVectorReader::statistics()
+   struct E57_DLL FieldStatistics
+   {
+      ustring pathName;              ///< Path of the field in the prototype
+      uint64_t count = 0;            ///< Number of values
+      double minimum = 0.0;          ///< Smallest value (only meaningful if count > 0)
+      double maximum = 0.0;          ///< Largest value (only meaningful if count > 0)
+      double sum = 0.0;              ///< Sum of the values
+      double histogramMinimum = 0.0; ///< Start of the first bin of the histogram
+      double histogramMaximum = 0.0; ///< End of the last bin of the histogram
+
+      /// Number of values in each bin, which evenly split [histogramMinimum, histogramMaximum).
+      /// Values outside of it are counted in the first or last bin.
+      std::vector<uint64_t> histogram;
+
+      /// Mean of the values (0 if there are none)
+      double mean() const
+      {
+         return ( count > 0 ) ? ( sum / static_cast<double>( count ) ) : 0.0;
+      }
+   };
+
    class E57_DLL CompressedVectorReader
    {
    public:
@@ -426,7 +715,12 @@ public:
 
       unsigned read();
       unsigned read( std::vector<SourceDestBuffer> &dbufs );
-      void seek( int64_t recordNumber ); // !!! not implemented yet
+      void seek( int64_t recordNumber );
+      void rebind( const CompressedVectorNode &cv );
+      void setFilter( const RecordFilter &filter );
+      void setStatistics( const std::vector<StatisticsField> &fields );
+      std::vector<FieldStatistics> statistics() const;
+      std::vector<FieldStatistics> lastReadStatistics() const;
       void close();
       bool isOpen();
       CompressedVectorNode compressedVectorNode() const;
@@ -447,6 +741,25 @@ public:
       /// @endcond
    };
 
+   /// @brief Codec selected automatically for a field of a CompressedVectorNode
+   /// @see WriterOptions::codecSelectionSampleSize, CompressedVectorWriter::codecSelections()
+   struct E57_DLL CodecSelection
+   {
+      /// Result of encoding the sample with one codec
+      struct Trial
+      {
+         Codec codec = CodecBitPack; ///< Codec tried
+         uint64_t byteCount = 0;     ///< Size of the encoded sample
+      };
+
+      ustring pathName;               ///< Path of the field in the prototype
+      Codec codec = CodecBitPack;     ///< Codec used to store the field
+      uint64_t sampleRecordCount = 0; ///< Number of records in the sample
+
+      /// Trials, fastest decoding codec first. Empty if only one codec supports the field's type.
+      std::vector<Trial> trials;
+   };
+
    class E57_DLL CompressedVectorWriter
    {
    public:
@@ -457,6 +770,7 @@ public:
       void close();
       bool isOpen();
       CompressedVectorNode compressedVectorNode() const;
+      std::vector<CodecSelection> codecSelections() const;
 
       void dump( int indent = 0, std::ostream &os = std::cout ) const;
       void checkInvariant( bool doRecurse = true );
@@ -485,6 +799,9 @@ public:
       Node prototype() const;
       VectorNode codecs() const;
 
+      static void appendCodec( VectorNode &codecs, Codec codec,
+                               const std::vector<ustring> &fieldPaths );
+
       // Iterators
       CompressedVectorWriter writer( std::vector<SourceDestBuffer> &sbufs );
       CompressedVectorReader reader( const std::vector<SourceDestBuffer> &dbufs );
@@ -735,6 +1052,8 @@ public:
                  ReadChecksumPolicy checksumPolicy = ChecksumAll );
       ImageFile( const char *input, uint64_t size,
                  ReadChecksumPolicy checksumPolicy = ChecksumAll );
+      explicit ImageFile( const RangeSource &source,
+                          ReadChecksumPolicy checksumPolicy = ChecksumAll );
 
       StructureNode root() const;
       void close();
@@ -745,6 +1064,9 @@ public:
       int writerCount() const;
       int readerCount() const;
 
+      // Memory used by the readers and writers created afterwards
+      void setMemoryResource( MemoryResource *memory );
+
       // Manipulate registered extensions in the file
       void extensionsAdd( const ustring &prefix, const ustring &uri );
       bool extensionsLookupPrefix( const ustring &prefix ) const;
@@ -778,6 +1100,9 @@ public:
       friend class FloatNode;
       friend class StringNode;
       friend class BlobNode;
+      friend class CompressedVectorWriterImpl;
+      friend class ReaderImpl;
+      friend class WriterImpl;
 
       explicit ImageFile( std::shared_ptr<ImageFileImpl> imfi );
 
@@ -160,6 +160,17 @@ namespace e57
       {
          return !operator==( rhs );
       }
+
+      /// @brief Checks the bounds against the statistics gathered while reading the points
+      /// @details Compares the minimum and maximum of the cartesianX, cartesianY and cartesianZ
+      /// statistics with the bounds. Coordinates without statistics (or without values) aren't
+      /// checked.
+      /// @param [in] statistics Statistics from CompressedVectorReader::statistics()
+      /// @param [in] tolerance Allowed difference between the bounds and the values
+      /// @return Returns true if each minimum and maximum is within tolerance of the bounds
+      /// @see CompressedVectorReader::setStatistics()
+      bool matches( const std::vector<FieldStatistics> &statistics,
+                    double tolerance = 0.0 ) const;
    };
 
    /// @brief Stores the bounds of some data in spherical coordinates.
@@ -373,9 +384,11 @@ namespace e57
       ustring idElementName;
 
       /// @brief Size of the groups compressedVector of LineGroupRecord structures.
+      /// @details When writing, 0 means use the rowIndexMaximum or columnIndexMaximum (+1).
       int64_t groupsSize = 0;
 
       /// @brief The size value for the LineGroupRecord::pointCount.
+      /// @details When writing, 0 means use the Data3D pointCount.
       int64_t pointCountSize = 0;
    };
 
@@ -639,8 +652,37 @@ namespace e57
       */
       explicit Data3DPointsData_t( e57::Data3D &data3D );
 
-      /// @brief Destructor will delete any memory allocated using the Data3DPointsData_t( const
-      /// e57::Data3D & ) constructor
+      /*!
+      @brief Constructor which allocates buffers of pointCount elements for all valid fields in
+      the given Data3D header.
+
+      @details
+      Use this to read or write a Data3D in chunks (e.g. using MemoryEstimate::chunkPointCount)
+      instead of allocating buffers for all the points.
+
+      @param [in] data3D Completed header which indicates the fields we are using
+      @param [in] pointCount Number of elements to allocate for each buffer
+
+      @throw ::ErrorValueOutOfBounds
+      @throw ::ErrorInvalidNodeType
+      */
+      Data3DPointsData_t( e57::Data3D &data3D, size_t pointCount );
+
+      /*!
+      @brief Constructor which allocates buffers of pointCount elements for all valid fields in
+      the given Data3D header from a MemoryResource.
+
+      @param [in] data3D Completed header which indicates the fields we are using
+      @param [in] pointCount Number of elements to allocate for each buffer
+      @param [in] memory MemoryResource to allocate the buffers from (the heap if nullptr). It must
+      outlive this object.
+
+      @throw ::ErrorValueOutOfBounds
+      @throw ::ErrorInvalidNodeType
+      */
+      Data3DPointsData_t( e57::Data3D &data3D, size_t pointCount, MemoryResource *memory );
+
+      /// @brief Destructor will delete any memory allocated by the constructors taking a Data3D
       ~Data3DPointsData_t();
 
       /// @brief Pointer to a buffer with the X coordinate (in meters) of the point in Cartesian
@@ -732,6 +774,12 @@ namespace e57
       /// @brief Keeps track of whether we used the Data3D constructor or not so we can free our
       /// memory.
       bool _selfAllocated = false;
+
+      /// @brief Where the buffers were allocated from (nullptr for the heap)
+      MemoryResource *_memory = nullptr;
+
+      /// @brief Number of elements allocated for each buffer
+      size_t _pointCount = 0;
    };
 
    using Data3DPointsFloat = Data3DPointsData_t<float>;
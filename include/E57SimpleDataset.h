@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+
+/// @file
+/// @brief E57 Simple API for reading a dataset made of several E57 files.
+
+#include <functional>
+
+#include "E57SimpleReader.h"
+
+namespace e57
+{
+   /// Options to the Dataset constructor
+   struct E57_DLL DatasetOptions
+   {
+      /// Options used to open each file. Its memoryBudget is ignored - use memoryBudget below. Its
+      /// memoryResource is used by all the threads at the same time, so it must be thread safe.
+      ReaderOptions readerOptions;
+
+      /// Maximum number of files which are open at the same time.
+      size_t maxOpenFiles = 8;
+
+      /// Number of threads used by Dataset::ReadPoints(). 0 (the default) uses the number of
+      /// hardware threads. It is never more than maxOpenFiles.
+      unsigned threadCount = 0;
+
+      /// Approximate limit (in bytes) on the memory used to read point data, shared by all the
+      /// threads. 0 (the default) means no limit.
+      size_t memoryBudget = 0;
+
+      /// @brief Optional path of a file used to cache the catalog.
+      /// @details If the file exists and matches the dataset files (same paths and sizes), the
+      /// catalog is loaded from it instead of opening every file. Otherwise the catalog is built
+      /// and saved to it.
+      ustring catalogCachePath;
+   };
+
+   /// @brief Describes one Data3D in a Dataset
+   struct E57_DLL DatasetScan
+   {
+      /// Index of the file in the list given to the Dataset
+      size_t fileIndex = 0;
+
+      /// Path of the file containing the Data3D
+      ustring filePath;
+
+      /// Index of the Data3D in the file's data3D vector
+      int64_t dataIndex = 0;
+
+      /// Data3D guid
+      ustring guid;
+
+      /// Data3D pose
+      RigidBodyTransform pose;
+
+      /// Data3D cartesian bounds
+      CartesianBounds cartesianBounds;
+
+      /// Number of points in the Data3D
+      int64_t pointCount = 0;
+   };
+
+   /// @brief Called by Dataset::ReadPoints() for each chunk of points which is read.
+   /// @details This may be called from several threads at the same time, but never at the same
+   /// time for the same scan. Chunks of a scan are delivered in order.
+   /// @param [in] scan The scan the points belong to
+   /// @param [in] buffers Buffers holding the points. Only valid during the call.
+   /// @param [in] count Number of points in the buffers
+   using DatasetPointsCallback = std::function<void(
+      const DatasetScan &scan, const Data3DPointsDouble &buffers, size_t count )>;
+
+   class DatasetImpl;
+
+   /// @brief Used for reading many E57 files as one dataset using the E57 Simple API.
+   ///
+   /// Files are opened lazily and at most DatasetOptions::maxOpenFiles are open at once. The
+   /// catalog of all the Data3D in all the files is built when the Dataset is created (or loaded
+   /// from DatasetOptions::catalogCachePath).
+   class E57_DLL Dataset
+   {
+   public:
+      /// @brief Dataset constructor
+      /// @param [in] filePaths Paths to the E57 files
+      /// @param [in] options Options to be used for the dataset
+      Dataset( const std::vector<ustring> &filePaths, const DatasetOptions &options );
+
+      /// @brief Returns the number of files in the dataset
+      size_t GetFileCount() const;
+
+      /// @brief Returns the number of Data3D in all the files
+      int64_t GetScanCount() const;
+
+      /// @brief Returns the catalog entry of a Data3D
+      /// @param [in] scanIndex Index into the catalog. Must be less than GetScanCount().
+      /// @param [out] scan The catalog entry
+      /// @return Returns true if successful
+      bool GetScan( int64_t scanIndex, DatasetScan &scan ) const;
+
+      /// @brief Writes the catalog to a file which can be used as DatasetOptions::catalogCachePath
+      /// @param [in] catalogPath Path of the catalog file
+      /// @return Returns true if successful
+      bool SaveCatalog( const ustring &catalogPath ) const;
+
+      /// @brief Reads the points of several Data3D, in parallel across files
+      /// @details Scans in the same file are read one after the other. Returns when all the scans
+      /// have been read. If reading fails, the first exception is rethrown after all the threads
+      /// have stopped.
+      /// @param [in] scanIndices Indices into the catalog of the Data3D to read
+      /// @param [in] callback Called for each chunk of points
+      void ReadPoints( const std::vector<int64_t> &scanIndices,
+                       const DatasetPointsCallback &callback ) const;
+
+      /// @cond documentNonPublic The following isn't part of the API, and isn't documented.
+   protected:
+      E57_INTERNAL_ACCESS( Dataset )
+
+   protected:
+      std::shared_ptr<DatasetImpl> impl_;
+      /// @endcond
+   };
+} // end namespace e57
@@ -44,6 +44,113 @@ namespace e57
    {
       /// Set how frequently to verify the checksums (see ReadChecksumPolicy).
       ReadChecksumPolicy checksumPolicy = ChecksumAll;
+
+      /// Approximate limit (in bytes) on the memory used to read point data. When set, the packet
+      /// cache is sized to fit in the budget and Reader::EstimateMemory() returns a chunk size for
+      /// the point buffers. 0 (the default) means no limit.
+      size_t memoryBudget = 0;
+
+      /// @brief Optional MemoryResource for the nodes read from the XML section, the packet cache
+      /// and the buffers used to decode the point data.
+      /// @details It must outlive the Reader and the handles on its nodes (e.g. from
+      /// Reader::GetRawIMF()). nullptr (the default) uses the heap.
+      /// @see ImageFile::setMemoryResource()
+      MemoryResource *memoryResource = nullptr;
+
+      /// @brief Time (in milliseconds) to wait for data which hasn't arrived yet.
+      /// @details Allows reading a file while it is still being copied or downloaded in order.
+      /// Reads past the current end of the file wait for it to grow, and fail if it doesn't grow
+      /// for this long. The file header must already be complete, so this doesn't work with
+      /// files which are still being written by a Writer. Works best with files written with
+      /// WriterOptions::xmlAtFront. 0 (the default) disables waiting.
+      unsigned progressiveReadTimeout = 0;
+
+      /// @brief Optional directory holding the column cache used by Reader::MapData3DPoints().
+      /// @details Each field is decoded once into a file of raw values, named after the file guid,
+      /// the Data3D guid and the field, which later calls map directly into memory. The directory
+      /// must exist. Empty (the default) disables the cache.
+      ustring columnCachePath;
+   };
+
+   /// @brief Estimate of the memory needed to read the points of a Data3D
+   /// @see Reader::EstimateMemory()
+   struct E57_DLL MemoryEstimate
+   {
+      /// Bytes used by the packet cache
+      size_t packetCacheBytes = 0;
+
+      /// Bytes used by the decoders (one per field)
+      size_t decoderBytes = 0;
+
+      /// Bytes of user buffers needed per point
+      size_t bytesPerPoint = 0;
+
+      /// Number of points each user buffer should hold so the total stays within
+      /// ReaderOptions::memoryBudget. If there is no budget, this is the number of points in the
+      /// Data3D. It is never less than 1 (unless the Data3D is empty), so compare totalBytes with
+      /// the budget to see if it can be met at all.
+      size_t chunkPointCount = 0;
+
+      /// packetCacheBytes + decoderBytes + ( bytesPerPoint * chunkPointCount )
+      size_t totalBytes = 0;
+   };
+
+   /// @brief Called by Reader::ReadTimeWindow() for each chunk of points which is read.
+   /// @param [in] startPointIndex Index in the Data3D of the first point in the buffers
+   /// @param [in] count Number of points in the buffers
+   using TimeWindowCallback = std::function<void( int64_t startPointIndex, size_t count )>;
+
+   /// @brief Point kept for each voxel by Reader::ReadData3DDownsampled()
+   enum class VoxelPoint
+   {
+      First,   ///< The first point read in the voxel
+      Centroid ///< The average of the points in the voxel
+   };
+
+   /// @brief Options to Reader::ReadData3DDownsampled()
+   struct E57_DLL DownsampleOptions
+   {
+      /// Edge length of the voxels, in the units of the cartesian coordinates (i.e. meters). Must
+      /// be greater than 0.
+      double voxelSize = 0.0;
+
+      /// @brief Point kept for each voxel
+      /// @details With VoxelPoint::Centroid, the coordinates, intensity, color and normal are
+      /// averaged (the normal is normalized again) and the other fields are those of the first
+      /// point.
+      VoxelPoint voxelPoint = VoxelPoint::Centroid;
+   };
+
+   /// @brief Called by Reader::ReadData3DDownsampled() for each chunk of downsampled points
+   /// @param [in] startPointIndex Index in the downsampled points of the first point in the
+   /// buffers
+   /// @param [in] count Number of points in the buffers
+   using DownsampleCallback = std::function<void( int64_t startPointIndex, size_t count )>;
+
+   class MappedData3DPointsImpl;
+
+   /// @brief Decoded fields of a Data3D, mapped from the column cache or held in memory
+   /// @details Copies share the same columns, which are released when the last copy is destroyed.
+   /// @see Reader::MapData3DPoints()
+   class E57_DLL MappedData3DPoints
+   {
+   public:
+      /// @brief Returns the number of points in each buffer
+      int64_t GetPointCount() const;
+
+      /// @brief Returns the buffers of the fields which were mapped (the others are nullptr)
+      /// @details The buffers may be modified, but the changes are only seen through this object
+      /// (and its copies) and are never written back to the cache.
+      const Data3DPointsDouble &GetPoints() const;
+
+      /// @cond documentNonPublic The following isn't part of the API, and isn't documented.
+   protected:
+      friend class ReaderImpl;
+
+      explicit MappedData3DPoints( std::shared_ptr<MappedData3DPointsImpl> impl );
+
+      std::shared_ptr<MappedData3DPointsImpl> impl_;
+      /// @endcond
    };
 
    /// @brief Used for reading an E57 file using E57 Simple API.
@@ -58,6 +165,12 @@ namespace e57
       /// @param [in] options Options to be used for the file
       Reader( const ustring &filePath, const ReaderOptions &options );
 
+      /// @brief Reader constructor for a file read by byte ranges
+      /// @details ReaderOptions::progressiveReadTimeout is ignored.
+      /// @param [in] source Describes the file, how to read it and how to cache it
+      /// @param [in] options Options to be used for the file
+      Reader( const RangeSource &source, const ReaderOptions &options );
+
       /// @brief Reader constructor (deprecated)
       /// @param [in] filePath Path to E57 file
       /// @deprecated Will be removed in 4.0. Use Reader( const ustring &, const ReaderOptions & )
@@ -181,6 +294,107 @@ namespace e57
       CompressedVectorReader SetUpData3DPointsData( int64_t dataIndex, size_t pointCount,
                                                     const Data3DPointsDouble &buffers ) const;
 
+      /// @brief Use this to read the 3D data, only keeping the points which meet a filter
+      /// @details Same as SetUpData3DPointsData() above, but CompressedVectorReader::read() drops
+      /// the points which fail any condition of @p filter and compacts all the buffers, so they
+      /// only hold the points kept. It returns the number of points kept, and 0 at the end. For
+      /// example, to only keep the valid first returns:
+      /// @code
+      /// e57::RecordFilter filter{ { "cartesianInvalidState", e57::FilterEqual, 0 },
+      ///                           { "returnIndex", e57::FilterEqual, 0 } };
+      /// @endcode
+      /// @param [in] dataIndex data block index
+      /// @param [in] pointCount size of each element buffer.
+      /// @param [in] buffers pointers to user-provided buffers
+      /// @param [in] filter Conditions on the point fields (e.g. "intensity"). Each field must be
+      /// in the Data3D and have a buffer.
+      /// @return vector reader setup to read the selected data into the provided buffers
+      /// @throw ::ErrorPathUndefined if a field of the filter isn't being read
+      /// @see CompressedVectorReader::setFilter()
+      CompressedVectorReader SetUpData3DPointsData( int64_t dataIndex, size_t pointCount,
+                                                    const Data3DPointsFloat &buffers,
+                                                    const RecordFilter &filter ) const;
+
+      /// @overload
+      CompressedVectorReader SetUpData3DPointsData( int64_t dataIndex, size_t pointCount,
+                                                    const Data3DPointsDouble &buffers,
+                                                    const RecordFilter &filter ) const;
+
+      /// @brief Estimates the memory needed to read the 3D data
+      /// @details Use MemoryEstimate::chunkPointCount as the pointCount for
+      /// Data3DPointsData_t( Data3D &, size_t ) and SetUpData3DPointsData(), then call
+      /// CompressedVectorReader::read() until it returns 0. The same buffers are reused for each
+      /// chunk.
+      /// @param [in] dataIndex This in the index into the data3D vector. Must be less than
+      /// GetData3DCount().
+      /// @param [in] fields Names of the prototype fields which will be read (e.g. "cartesianX").
+      /// If empty, all the fields in the prototype are used.
+      /// @return The estimate, or all zeros if the file is not open or dataIndex is out of range
+      /// @throw ::ErrorPathUndefined if one of the fields is not in the prototype
+      MemoryEstimate EstimateMemory( int64_t dataIndex,
+                                     const std::vector<ustring> &fields = {} ) const;
+
+      /// @brief Reads the points of a Data3D which have a time stamp in a time window.
+      /// @details Uses the time index of the Data3D (see WriterOptions::timeIndexChunkSize) to
+      /// only decode the chunks of points whose range of time stamps overlaps the window. If the
+      /// file doesn't have an index, one is built the first time by reading only the timeStamp
+      /// field. Points are read by whole chunks, so the buffers can also hold points just outside
+      /// the window - check their timeStamp if that matters. Fields stored with codecs other than
+      /// bitPackCodec can't be sought, so chunks are then found by decoding from the start, and
+      /// the first buffer of a chunk can also start before it.
+      /// @param [in] dataIndex This in the index into the data3D vector. Must be less than
+      /// GetData3DCount().
+      /// @param [in] startTime Start of the window (inclusive)
+      /// @param [in] endTime End of the window (inclusive)
+      /// @param [in] pointCount Size of each element buffer
+      /// @param [in] buffers Pointers to user-provided buffers, as for SetUpData3DPointsData()
+      /// @param [in] callback Called each time the buffers have been filled
+      /// @return The number of points passed to the callback (the sum of its counts), or 0 if the
+      /// file is not open or dataIndex is out of range
+      /// @throw ::ErrorPathUndefined if the Data3D doesn't have a timeStamp field
+      int64_t ReadTimeWindow( int64_t dataIndex, double startTime, double endTime,
+                              size_t pointCount, const Data3DPointsDouble &buffers,
+                              const TimeWindowCallback &callback ) const;
+
+      /// @brief Reads the points of a Data3D downsampled on a voxel grid
+      /// @details The points are decoded in chunks of pointCount points and each one is added to
+      /// the voxel of a regular grid which holds it, so only one point per voxel is kept in memory
+      /// instead of the whole Data3D. Points with a non-zero cartesianInvalidState are skipped when
+      /// that buffer is provided. Once all the points have been read, the downsampled points are
+      /// passed back through the same buffers, in the order their voxels were first hit.
+      /// @param [in] dataIndex This in the index into the data3D vector. Must be less than
+      /// GetData3DCount().
+      /// @param [in] options Voxel size and point kept for each voxel
+      /// @param [in] pointCount Size of each element buffer
+      /// @param [in] buffers Pointers to user-provided buffers, as for SetUpData3DPointsData().
+      /// The cartesian coordinates are required.
+      /// @param [in] callback Called each time the buffers have been filled with downsampled
+      /// points
+      /// @return The number of downsampled points (i.e. of voxels holding points), or 0 if the file
+      /// is not open or dataIndex is out of range
+      /// @throw ::ErrorBadAPIArgument if options.voxelSize isn't greater than 0 or pointCount is 0
+      /// @throw ::ErrorPathUndefined if the Data3D or buffers don't have cartesian coordinates
+      int64_t ReadData3DDownsampled( int64_t dataIndex, const DownsampleOptions &options,
+                                     size_t pointCount, const Data3DPointsDouble &buffers,
+                                     const DownsampleCallback &callback ) const;
+
+      /// @brief Returns fields of a Data3D decoded in full, without decoding them again each time
+      /// @details When ReaderOptions::columnCachePath is set, each field is decoded once into a
+      /// file in the cache and mapped into memory, so later calls (from any Reader of the same
+      /// file) don't decode anything and the OS pages the values in and out as they are used.
+      /// This allows working on Data3D larger than the memory. Without a cache, or if the file or
+      /// Data3D has no guid, the fields are decoded into memory.
+      /// @param [in] dataIndex This in the index into the data3D vector. Must be less than
+      /// GetData3DCount().
+      /// @param [in] fields Names of the fields to map (e.g. "cartesianX"), which must have a
+      /// buffer in Data3DPointsDouble. If empty, all such fields in the prototype are mapped.
+      /// @return The mapped fields, or no fields if the file is not open or dataIndex is out of
+      /// range
+      /// @throw ::ErrorPathUndefined if one of the fields is not in the prototype or has no buffer
+      /// in Data3DPointsDouble
+      MappedData3DPoints MapData3DPoints( int64_t dataIndex,
+                                          const std::vector<ustring> &fields = {} ) const;
+
       ///@}
 
       /// @name File information
@@ -35,6 +35,8 @@
 /// @details This includes support for the
 /// [E57_EXT_surface_normals](http://www.libe57.org/E57_EXT_surface_normals.txt) extension.
 
+#include <map>
+
 #include "E57SimpleData.h"
 
 namespace e57
@@ -47,6 +49,69 @@ namespace e57
 
       /// Information describing the Coordinate Reference System to be used for the file
       ustring coordinateMetadata;
+
+      /// @brief Write the file bypassing the OS file cache where possible.
+      /// @details Data is written in large aligned blocks using O_DIRECT (Linux) or F_NOCACHE
+      /// (macOS) so writing very large files doesn't evict everything else from the cache. The
+      /// unaligned parts (e.g. the end of the file) are written normally. This has no effect on
+      /// other platforms or if the file system doesn't support it.
+      bool directIO = false;
+
+      /// @brief Write each data packet of the point data with the values of a single field.
+      /// @details Runs of packets then hold one field at a time, so readers which only read some
+      /// of the fields read much less of the file. The files are still standard E57 files.
+      bool columnGroupedPackets = false;
+
+      /// @brief Codecs used to store point fields, keyed by field name (e.g. "timeStamp").
+      /// @details Fields which aren't listed use the standard bitPackCodec. Codecs other than
+      /// CodecBitPack are stored using the libE57Format codecs extension, so files using them can
+      /// only be read by software supporting it.
+      /// @see e57::Codec
+      std::map<ustring, Codec> fieldCodecs;
+
+      /// @brief Number of records used to select the codec of each point field automatically.
+      /// @details The first codecSelectionSampleSize records of each field which isn't in
+      /// fieldCodecs are encoded with each codec supporting the field's type, and the field is
+      /// stored with the one giving the smallest result. 0 (the default) disables the selection.
+      /// The choices are reported by CompressedVectorWriter::codecSelections().
+      size_t codecSelectionSampleSize = 0;
+
+      /// @brief Fraction of the smallest size a codec which decodes faster may exceed it by and
+      /// still be selected (e.g. 0.05 for 5%).
+      double codecSelectionTolerance = 0.0;
+
+      /// @brief Optional MemoryResource for the nodes and the buffers used to encode the point
+      /// data.
+      /// @details It must outlive the Writer and the handles on its nodes (e.g. from
+      /// Writer::GetRawIMF()). nullptr (the default) uses the heap.
+      /// @see ImageFile::setMemoryResource()
+      MemoryResource *memoryResource = nullptr;
+
+      /// @brief Put the XML section at the front of the file instead of the end.
+      /// @details When the file is closed, the point data is moved up by whole pages to make room
+      /// for the XML right after the file header. Readers which get the file progressively (see
+      /// ReaderOptions::progressiveReadTimeout) or by byte ranges can then parse the metadata
+      /// before the points have arrived. Closing the file takes longer since the data is copied.
+      bool xmlAtFront = false;
+
+      /// @brief Number of points in each chunk of the time index written for each Data3D with a
+      /// timeStamp field.
+      /// @details The index holds the range of time stamps of each chunk of points, so
+      /// Reader::ReadTimeWindow() can read the points of a time window without decoding the whole
+      /// Data3D. It is stored using the libE57Format time index extension (see
+      /// e57::TIME_INDEX_EXTENSION_URI), which other software ignores. 0 (the default) doesn't
+      /// write an index.
+      size_t timeIndexChunkSize = 0;
+
+      /// @brief Write the points of Writer::WriteData3DData() in a progressive order.
+      /// @details The points are reordered so any prefix of them (e.g. the first 1% of the data
+      /// packets) is a subsample spread evenly over the whole scan, which a viewer can show while
+      /// the rest is still being read. The order is stored using the libE57Format point order
+      /// extension (see e57::POINT_ORDER_EXTENSION_URI). The points are reordered in chunks
+      /// while they are written, so little memory is needed besides the user's buffers. Line
+      /// groups aren't derived from the points of such a Data3D. Points written using
+      /// Writer::SetUpData3DPointsData() keep their order.
+      bool progressivePointOrder = false;
    };
 
    /// @brief Used for writing an E57 file using the E57 Simple API.
@@ -124,6 +189,7 @@ namespace e57
       /// @param [in,out] data3DHeader metadata about what is included in the buffers
       /// @param [in] buffers pointers to user-provided buffers containing the actual data
       /// @return Returns the index of the new scan's data3D block.
+      /// @see WriterOptions::progressivePointOrder
       int64_t WriteData3DData( Data3D &data3DHeader, const Data3DPointsFloat &buffers );
 
       /// @overload
@@ -150,6 +216,9 @@ namespace e57
                                                     const Data3DPointsDouble &buffers );
 
       /// @brief Writes out the group data
+      /// @details If the Data3D header has a pointGroupingSchemes.groupingByLine.idElementName,
+      /// the line groups are derived from the rowIndex or columnIndex of the points as they are
+      /// written, and are written when the file is closed. Calling this replaces those groups.
       /// @param [in] dataIndex data block index given by the NewData3D
       /// @param [in] groupCount size of each of the buffers given
       /// @param [in] idElementValue buffer with idElementValue indices for this group
@@ -134,7 +134,7 @@ must be true).
 @see Node, BlobNode::read, BlobNode::write
 */
 BlobNode::BlobNode( const ImageFile &destImageFile, int64_t byteCount ) :
-   impl_( new BlobNodeImpl( destImageFile.impl(), byteCount ) )
+   impl_( makeNode<BlobNodeImpl>( destImageFile.impl(), byteCount ) )
 {
 }
 
@@ -357,7 +357,7 @@ BlobNode::BlobNode( const Node &n )
 
 /// @cond documentNonPublic The following isn't part of the API, and isn't documented.
 BlobNode::BlobNode( const ImageFile &destImageFile, int64_t fileOffset, int64_t length ) :
-   impl_( new BlobNodeImpl( destImageFile.impl(), fileOffset, length ) )
+   impl_( makeNode<BlobNodeImpl>( destImageFile.impl(), fileOffset, length ) )
 {
 }
 
@@ -194,7 +194,7 @@ namespace e57
       }
       else
       {
-         fieldName = elementName_;
+         fieldName = toUstring( elementName_ );
       }
 
       //??? need to implement
@@ -49,6 +49,16 @@ namespace e57
       void read( uint8_t *buf, int64_t start, size_t count );
       void write( uint8_t *buf, int64_t start, size_t count );
 
+      uint64_t getBinarySectionLogicalStart() const
+      {
+         return ( binarySectionLogicalStart_ );
+      }
+
+      void setBinarySectionLogicalStart( uint64_t binarySectionLogicalStart )
+      {
+         binarySectionLogicalStart_ = binarySectionLogicalStart;
+      }
+
       void checkLeavesInSet( const StringSet &pathNames, NodeImplSharedPtr origin ) override;
 
       void writeXml( ImageFileImplSharedPtr imf, CheckedFile &cf, int indent,
@@ -59,6 +69,8 @@ namespace e57
 #endif
 
    private:
+      friend class NodeView;
+
       uint64_t blobLogicalLength_;
       uint64_t binarySectionLogicalStart_;
       uint64_t binarySectionLogicalLength_;
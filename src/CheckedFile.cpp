@@ -60,10 +60,16 @@
 #error "no supported OS platform defined"
 #endif
 
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
+#include <exception>
 #include <fcntl.h>
+#include <limits>
+#include <mutex>
+#include <thread>
 
 // This is fixed in a newer version of CRCpp.
 //    https://github.com/d-bahr/CRCpp/issues/17
@@ -79,6 +85,7 @@
 #endif
 
 #include "CheckedFile.h"
+#include "RangeFile.h"
 #include "StringFunctions.h"
 
 // #define E57_CHECK_FILE_DEBUG
@@ -94,6 +101,9 @@ constexpr size_t CheckedFile::physicalPageSizeLog2;
 constexpr size_t CheckedFile::physicalPageSize;
 constexpr uint64_t CheckedFile::physicalPageSizeMask;
 constexpr size_t CheckedFile::logicalPageSize;
+constexpr size_t CheckedFile::maxPendingPages;
+constexpr size_t CheckedFile::directIOAlignment;
+constexpr size_t CheckedFile::directIOPages;
 
 namespace
 {
@@ -119,8 +129,132 @@ namespace
 
       return crc;
    }
+
+   /// Calc and store the checksums of consecutive physical pages
+   void checksumPages( char *pages, size_t pageCount )
+   {
+      for ( size_t i = 0; i < pageCount; ++i )
+      {
+         char *page_buffer = pages + i * CheckedFile::physicalPageSize;
+
+         const uint32_t check_sum = checksum( page_buffer, CheckedFile::logicalPageSize );
+         *reinterpret_cast<uint32_t *>( &page_buffer[CheckedFile::logicalPageSize] ) =
+            check_sum; //??? little endian dependency
+      }
+   }
 }
 
+/// Threads calculating the checksums of batches of pages, kept for all the flushes of a file so
+/// threads aren't started for every flush. The calling thread does the first batch.
+class e57::ChecksumWorkers
+{
+public:
+   explicit ChecksumWorkers( size_t workerCount )
+   {
+      for ( size_t i = 0; i < workerCount; ++i )
+      {
+         threads_.emplace_back( &ChecksumWorkers::run, this, i + 1 );
+      }
+   }
+
+   ~ChecksumWorkers()
+   {
+      {
+         std::lock_guard<std::mutex> lock( mutex_ );
+         stop_ = true;
+      }
+
+      start_.notify_all();
+
+      for ( auto &thread : threads_ )
+      {
+         thread.join();
+      }
+   }
+
+   ChecksumWorkers( const ChecksumWorkers & ) = delete;
+   ChecksumWorkers &operator=( const ChecksumWorkers & ) = delete;
+
+   size_t workerCount() const
+   {
+      return threads_.size();
+   }
+
+   /// Calc and store the checksums of pageCount consecutive pages split into batchCount batches
+   /// (at most workerCount() + 1)
+   void checksum( char *pages, size_t pageCount, size_t batchCount )
+   {
+      {
+         std::lock_guard<std::mutex> lock( mutex_ );
+
+         pages_ = pages;
+         pageCount_ = pageCount;
+         pagesPerBatch_ = ( pageCount + batchCount - 1 ) / batchCount;
+         remaining_ = threads_.size();
+         ++generation_;
+      }
+
+      start_.notify_all();
+
+      checksumPages( pages, std::min( pagesPerBatch_, pageCount ) );
+
+      std::unique_lock<std::mutex> lock( mutex_ );
+      done_.wait( lock, [this] { return remaining_ == 0; } );
+   }
+
+private:
+   void run( size_t batch )
+   {
+      uint64_t generation = 0;
+
+      while ( true )
+      {
+         std::unique_lock<std::mutex> lock( mutex_ );
+         start_.wait( lock, [&] { return stop_ || ( generation_ != generation ); } );
+
+         if ( stop_ )
+         {
+            return;
+         }
+
+         generation = generation_;
+
+         // There may be fewer batches than workers
+         const size_t first = batch * pagesPerBatch_;
+
+         if ( first < pageCount_ )
+         {
+            char *pages = pages_ + first * CheckedFile::physicalPageSize;
+            const size_t count = std::min( pagesPerBatch_, pageCount_ - first );
+
+            lock.unlock();
+
+            checksumPages( pages, count );
+
+            lock.lock();
+         }
+
+         if ( --remaining_ == 0 )
+         {
+            done_.notify_one();
+         }
+      }
+   }
+
+   std::vector<std::thread> threads_;
+
+   std::mutex mutex_;
+   std::condition_variable start_;
+   std::condition_variable done_;
+
+   char *pages_ = nullptr;
+   size_t pageCount_ = 0;
+   size_t pagesPerBatch_ = 0;
+   size_t remaining_ = 0;
+   uint64_t generation_ = 0;
+   bool stop_ = false;
+};
+
 /// Tool class to read buffer efficiently without multiplying copy operations.
 ///
 /// @warning Pointer input is handled by user!
@@ -233,6 +367,17 @@ CheckedFile::CheckedFile( const char *input, uint64_t size, ReadChecksumPolicy p
    logicalLength_ = physicalToLogical( physicalLength_ );
 }
 
+CheckedFile::CheckedFile( const RangeSource &source, ReadChecksumPolicy policy ) :
+   fileName_( source.name ), checkSumPolicy_( policy )
+{
+   rangeFile_ = new RangeFile( source );
+
+   readOnly_ = true;
+
+   physicalLength_ = source.size;
+   logicalLength_ = physicalToLogical( physicalLength_ );
+}
+
 int CheckedFile::open64( const ustring &fileName, int flags, int mode )
 {
 #if defined( _MSC_VER )
@@ -291,6 +436,9 @@ void CheckedFile::read( char *buf, size_t nRead, size_t /*bufSize*/ )
    //??? need to keep track of logical length?
    //??? check bufSize OK
 
+   // Pages waiting to be written don't have checksums yet.
+   flushPendingPages();
+
    const uint64_t end = position( Logical ) + nRead;
    const uint64_t logicalLength = length( Logical );
 
@@ -307,6 +455,14 @@ void CheckedFile::read( char *buf, size_t nRead, size_t /*bufSize*/ )
 
    size_t n = std::min( nRead, logicalPageSize - pageOffset );
 
+   // Fetch all the pages at once when reading by ranges
+   if ( ( rangeFile_ != nullptr ) && ( nRead > 0 ) )
+   {
+      const uint64_t endPage = ( end + logicalPageSize - 1 ) / logicalPageSize;
+
+      rangeFile_->willRead( page * physicalPageSize, ( endPage - page ) * physicalPageSize );
+   }
+
    // Allocate temp page buffer
    std::vector<char> page_buffer_v( physicalPageSize );
    char *page_buffer = page_buffer_v.data();
@@ -352,9 +508,16 @@ void CheckedFile::read( char *buf, size_t nRead, size_t /*bufSize*/ )
 }
 
 void CheckedFile::write( const char *buf, size_t nWrite )
+{
+   const WriteBuffer buffer{ buf, nWrite };
+
+   write( &buffer, 1 );
+}
+
+void CheckedFile::write( const WriteBuffer *buffers, size_t bufferCount )
 {
 #ifdef E57_VERBOSE
-   // cout << "write nWrite=" << nWrite << " position()="<< position() << std::endl;
+   // cout << "write bufferCount=" << bufferCount << " position()="<< position() << std::endl;
    // //???
 #endif
    if ( readOnly_ )
@@ -362,6 +525,13 @@ void CheckedFile::write( const char *buf, size_t nWrite )
       throw E57_EXCEPTION2( ErrorFileReadOnly, "fileName=" + fileName_ );
    }
 
+   size_t nWrite = 0;
+
+   for ( size_t i = 0; i < bufferCount; ++i )
+   {
+      nWrite += buffers[i].size;
+   }
+
    uint64_t end = position( Logical ) + nWrite;
 
    uint64_t page = 0;
@@ -371,32 +541,51 @@ void CheckedFile::write( const char *buf, size_t nWrite )
 
    size_t n = std::min( nWrite, logicalPageSize - pageOffset );
 
-   // Allocate temp page buffer
-   std::vector<char> page_buffer_v( physicalPageSize );
-   char *page_buffer = page_buffer_v.data();
+   // Zero the page buffer like the buffer each call used to allocate: the unwritten tail of a new
+   // page is zero, or holds the bytes of the page before it in the same call.
+   pageBuffer_.assign( physicalPageSize, 0 );
+
+   char *page_buffer = pageBuffer_.data();
+
+   // Position in the buffers of the next byte to write
+   const char *buf = ( bufferCount > 0 ) ? buffers[0].data : nullptr;
+   size_t bufRemaining = ( bufferCount > 0 ) ? buffers[0].size : 0;
 
    while ( nWrite > 0 )
    {
       const uint64_t physicalLength = length( Physical );
 
-      if ( page * physicalPageSize < physicalLength )
+      // A page which is completely overwritten doesn't need to be read (its checksum is
+      // calculated when it is written to the file).
+      if ( ( n < logicalPageSize ) && ( page * physicalPageSize < physicalLength ) )
       {
          readPhysicalPage( page_buffer, page );
       }
 
-#ifdef E57_VERBOSE
-      // cout << "  page_buffer[0] read: '" << page_buffer[0] << "'" << std::endl;
-      // cout << "copy " << n << "bytes to page=" << page << " pageOffset=" <<
-      // pageOffset << " buf='"; //??? for (size_t i=0; i < n; i++) cout <<
-      // buf[i]; cout << "'" << std::endl;
-#endif
-      memcpy( page_buffer + pageOffset, buf, n );
+      // Fill the page from as many buffers as needed
+      for ( size_t copied = 0; copied < n; )
+      {
+         while ( bufRemaining == 0 )
+         {
+            ++buffers;
+            buf = buffers->data;
+            bufRemaining = buffers->size;
+         }
+
+         const size_t count = std::min( n - copied, bufRemaining );
+
+         memcpy( page_buffer + pageOffset + copied, buf, count );
+
+         buf += count;
+         bufRemaining -= count;
+         copied += count;
+      }
+
       writePhysicalPage( page_buffer, page );
 #ifdef E57_VERBOSE
       // cout << "  page_buffer[0] after write: '" << page_buffer[0] << "'" <<
       // std::endl; //???
 #endif
-      buf += n;
       nWrite -= n;
       pageOffset = 0;
       page++;
@@ -408,7 +597,7 @@ void CheckedFile::write( const char *buf, size_t nWrite )
       logicalLength_ = end;
    }
 
-   // When done, leave cursor just past end of buf
+   // When done, leave cursor just past end of buffers
    seek( end, Logical );
 }
 
@@ -485,6 +674,20 @@ uint64_t CheckedFile::lseek64( int64_t offset, int whence )
                                                 " whence=" + toString( whence ) );
    }
 
+   if ( ( fd_ < 0 ) && ( rangeFile_ != nullptr ) )
+   {
+      const auto uoffset = static_cast<uint64_t>( offset );
+
+      if ( rangeFile_->seek( uoffset, whence ) )
+      {
+         return rangeFile_->pos();
+      }
+
+      throw E57_EXCEPTION2( ErrorSeekFailed, "fileName=" + fileName_ +
+                                                " offset=" + toString( offset ) +
+                                                " whence=" + toString( whence ) );
+   }
+
 #if defined( _WIN32 )
    __int64 result = _lseeki64( fd_, offset, whence );
 #elif defined( __linux__ ) || defined( __EMSCRIPTEN__ )
@@ -522,21 +725,8 @@ uint64_t CheckedFile::length( OffsetMode omode )
 {
    if ( omode == Physical )
    {
-      if ( readOnly_ )
-      {
-         return physicalLength_;
-      }
-
-      // Current file position
-      uint64_t original_pos = lseek64( 0LL, SEEK_CUR );
-
-      // End file position
-      uint64_t end_pos = lseek64( 0LL, SEEK_END );
-
-      // Restore original position
-      lseek64( original_pos, SEEK_SET );
-
-      return end_pos;
+      // When writing, this includes pages which haven't been written to the file yet.
+      return physicalLength_;
    }
 
    return logicalLength_;
@@ -644,6 +834,21 @@ void CheckedFile::close()
 {
    if ( fd_ >= 0 )
    {
+      // The file is closed even if the last pages can't be written
+      std::exception_ptr flushError;
+
+      try
+      {
+         flushPendingPages();
+      }
+      catch ( ... )
+      {
+         flushError = std::current_exception();
+         pendingPageCount_ = 0;
+      }
+
+      checksumWorkers_.reset();
+
 #if defined( _MSC_VER )
       int result = ::_close( fd_ );
 #elif defined( __GNUC__ )
@@ -651,13 +856,18 @@ void CheckedFile::close()
 #else
 #error "no supported compiler defined"
 #endif
+      fd_ = -1;
+
+      if ( flushError )
+      {
+         std::rethrow_exception( flushError );
+      }
+
       if ( result < 0 )
       {
          throw E57_EXCEPTION2( ErrorCloseFailed,
                                "fileName=" + fileName_ + " result=" + toString( result ) );
       }
-
-      fd_ = -1;
    }
 
    if ( bufView_ != nullptr )
@@ -668,10 +878,16 @@ void CheckedFile::close()
       // WARNING: do NOT delete buffer of bufView_ because
       // pointer is handled by user !!
    }
+
+   delete rangeFile_;
+   rangeFile_ = nullptr;
 }
 
 void CheckedFile::unlink()
 {
+   // No point in writing pages to a file we are removing
+   pendingPageCount_ = 0;
+
    close();
 
    // Try to remove the file, don't report a failure
@@ -731,6 +947,20 @@ void CheckedFile::readPhysicalPage( char *page_buffer, uint64_t page )
    assert( page * physicalPageSize < physicalLength );
 #endif
 
+   // Pages waiting to be written are more recent than the file contents
+   if ( ( page >= pendingFirstPage_ ) && ( page < pendingFirstPage_ + pendingPageCount_ ) )
+   {
+      const auto index = static_cast<size_t>( page - pendingFirstPage_ );
+
+      memcpy( page_buffer, pendingData_ + index * physicalPageSize, physicalPageSize );
+      return;
+   }
+
+   if ( ( waitTimeoutMs_ > 0 ) && ( ( page + 1 ) * physicalPageSize > availableLength_ ) )
+   {
+      waitForData( ( page + 1 ) * physicalPageSize );
+   }
+
    // Seek to start of physical page
    seek( page * physicalPageSize, Physical );
 
@@ -740,6 +970,12 @@ void CheckedFile::readPhysicalPage( char *page_buffer, uint64_t page )
       return;
    }
 
+   if ( ( fd_ < 0 ) && ( rangeFile_ != nullptr ) )
+   {
+      rangeFile_->read( page_buffer, physicalPageSize );
+      return;
+   }
+
 #if defined( _MSC_VER )
    int result = ::_read( fd_, page_buffer, physicalPageSize );
 #elif defined( __GNUC__ )
@@ -755,31 +991,329 @@ void CheckedFile::readPhysicalPage( char *page_buffer, uint64_t page )
    }
 }
 
+void CheckedFile::readPages( char *pages, uint64_t firstPage, size_t pageCount )
+{
+   // Seek to start of first physical page
+   seek( firstPage * physicalPageSize, Physical );
+
+   size_t nRead = pageCount * physicalPageSize;
+
+   while ( nRead > 0 )
+   {
+#if defined( _MSC_VER )
+      int result = ::_read( fd_, pages, static_cast<unsigned int>( nRead ) );
+#elif defined( __GNUC__ )
+      ssize_t result = ::read( fd_, pages, nRead );
+#else
+#error "no supported compiler defined"
+#endif
+
+      if ( result <= 0 )
+      {
+         throw E57_EXCEPTION2( ErrorReadFailed,
+                               "fileName=" + fileName_ + " result=" + toString( result ) );
+      }
+
+      pages += result;
+      nRead -= static_cast<size_t>( result );
+   }
+}
+
+void CheckedFile::waitForData( uint64_t physicalEnd )
+{
+   using Clock = std::chrono::steady_clock;
+
+   constexpr auto cPollInterval = std::chrono::milliseconds( 10 );
+
+   const auto timeout = std::chrono::milliseconds( waitTimeoutMs_ );
+
+   auto lastGrowth = Clock::now();
+
+   // The caller seeks before reading, so the cursor doesn't need to be restored.
+   for ( ;; )
+   {
+      const uint64_t available = lseek64( 0, SEEK_END );
+
+      if ( available >= physicalEnd )
+      {
+         availableLength_ = available;
+         return;
+      }
+
+      if ( available > availableLength_ )
+      {
+         availableLength_ = available;
+         lastGrowth = Clock::now();
+      }
+      else if ( Clock::now() - lastGrowth >= timeout )
+      {
+         throw E57_EXCEPTION2( ErrorReadFailed,
+                               "fileName=" + fileName_ + " timedOutWaitingFor=" +
+                                  toString( physicalEnd ) + " available=" + toString( available ) );
+      }
+
+      std::this_thread::sleep_for( cPollInterval );
+   }
+}
+
 void CheckedFile::writePhysicalPage( char *page_buffer, uint64_t page )
 {
 #ifdef E57_VERBOSE
    // cout << "writePhysicalPage, page:" << page << std::endl;
 #endif
 
-   // Append checksum
-   uint32_t check_sum = checksum( page_buffer, logicalPageSize );
-   *reinterpret_cast<uint32_t *>( &page_buffer[logicalPageSize] ) =
-      check_sum; //??? little endian dependency
+   // Pages are buffered as a run of consecutive pages. Write the run out if this page isn't in it
+   // and can't extend it.
+   const uint64_t pendingEndPage = pendingFirstPage_ + pendingPageCount_;
 
-   // Seek to start of physical page
-   seek( page * physicalPageSize, Physical );
+   const bool isPending = ( page >= pendingFirstPage_ ) && ( page < pendingEndPage );
+   const bool extendsPending = ( page == pendingEndPage ) && ( pendingPageCount_ > 0 ) &&
+                               ( pendingPageCount_ < maxPendingPages );
+
+   if ( !isPending && !extendsPending )
+   {
+      flushPendingPages();
+
+      if ( pendingPages_.empty() )
+      {
+         // Room for a full run starting anywhere in an aligned block, plus the alignment itself
+         pendingPages_.resize( ( maxPendingPages + directIOPages ) * physicalPageSize +
+                               directIOAlignment );
+      }
+
+      // Place the run so pages which start an aligned block in the file are also aligned in
+      // memory, as direct I/O needs.
+      const auto base = reinterpret_cast<uintptr_t>( pendingPages_.data() );
+      const size_t alignOffset =
+         ( directIOAlignment - base % directIOAlignment ) % directIOAlignment;
+      const size_t blockOffset = static_cast<size_t>( page % directIOPages ) * physicalPageSize;
+
+      pendingData_ = pendingPages_.data() + alignOffset + blockOffset;
+      pendingFirstPage_ = page;
+   }
+
+   if ( !isPending )
+   {
+      ++pendingPageCount_;
+   }
+
+   const auto index = static_cast<size_t>( page - pendingFirstPage_ );
+
+   // The checksum is calculated when the page is written to the file.
+   memcpy( pendingData_ + index * physicalPageSize, page_buffer, logicalPageSize );
+
+   physicalLength_ = std::max( physicalLength_, ( page + 1 ) * physicalPageSize );
+}
+
+void CheckedFile::flushPendingPages()
+{
+   if ( pendingPageCount_ == 0 )
+   {
+      return;
+   }
+
+   checksumPendingPages();
+
+   // Leave the cursor where it was when done
+   const uint64_t originalPos = position( Physical );
+
+   size_t headCount = pendingPageCount_;
+   size_t alignedCount = 0;
+
+   if ( directIO_ )
+   {
+      // Split the run into pages before the first aligned block, whole aligned blocks, and
+      // the unaligned tail. Only the aligned blocks bypass the OS cache.
+      const auto firstInBlock = static_cast<size_t>( pendingFirstPage_ % directIOPages );
+
+      headCount = std::min( pendingPageCount_, ( directIOPages - firstInBlock ) % directIOPages );
+      alignedCount = ( pendingPageCount_ - headCount ) / directIOPages * directIOPages;
+
+      if ( ( alignedCount > 0 ) && setDirectIOFlag( true ) )
+      {
+         try
+         {
+            writePages( pendingData_ + headCount * physicalPageSize,
+                        pendingFirstPage_ + headCount, alignedCount );
+         }
+         catch ( ... )
+         {
+            setDirectIOFlag( false );
+            throw;
+         }
+
+         setDirectIOFlag( false );
+      }
+      else
+      {
+         // Direct I/O isn't available (e.g. not supported by the file system)
+         headCount = pendingPageCount_;
+         alignedCount = 0;
+      }
+   }
+
+   writePages( pendingData_, pendingFirstPage_, headCount );
+
+   const size_t tailStart = headCount + alignedCount;
+
+   writePages( pendingData_ + tailStart * physicalPageSize, pendingFirstPage_ + tailStart,
+               pendingPageCount_ - tailStart );
+
+   pendingPageCount_ = 0;
+
+   seek( originalPos, Physical );
+}
+
+/// Calc the checksums of the pending pages, using the worker threads if there are enough pages
+/// to make it worthwhile.
+void CheckedFile::checksumPendingPages()
+{
+   constexpr size_t cMinPagesPerThread = 256;
+
+   const size_t threadCount = ( checksumThreadCount_ > 0 ) ? checksumThreadCount_
+                                                           : std::thread::hardware_concurrency();
+   const size_t batchCount = std::min( threadCount, pendingPageCount_ / cMinPagesPerThread );
+
+   if ( batchCount < 2 )
+   {
+      checksumPages( pendingData_, pendingPageCount_ );
+      return;
+   }
 
+   if ( checksumWorkers_ == nullptr )
+   {
+      checksumWorkers_.reset( new ChecksumWorkers( threadCount - 1 ) );
+   }
+
+   checksumWorkers_->checksum( pendingData_, pendingPageCount_, batchCount );
+}
+
+void CheckedFile::setChecksumThreadCount( unsigned threadCount )
+{
+   flushPendingPages();
+
+   checksumThreadCount_ = threadCount;
+   checksumWorkers_.reset();
+}
+
+void CheckedFile::writePages( const char *pages, uint64_t firstPage, size_t pageCount )
+{
+   if ( pageCount == 0 )
+   {
+      return;
+   }
+
+   // Seek to start of first physical page
+   seek( firstPage * physicalPageSize, Physical );
+
+   size_t nWrite = pageCount * physicalPageSize;
+
+   while ( nWrite > 0 )
+   {
 #if defined( _MSC_VER )
-   int result = ::_write( fd_, page_buffer, physicalPageSize );
+      int result = ::_write( fd_, pages, static_cast<unsigned int>( nWrite ) );
 #elif defined( __GNUC__ )
-   ssize_t result = ::write( fd_, page_buffer, physicalPageSize );
+      ssize_t result = ::write( fd_, pages, nWrite );
 #else
 #error "no supported compiler defined"
 #endif
 
-   if ( result < 0 )
+      if ( result <= 0 )
+      {
+         throw E57_EXCEPTION2( ErrorWriteFailed,
+                               "fileName=" + fileName_ + " result=" + toString( result ) );
+      }
+
+      pages += result;
+      nWrite -= static_cast<size_t>( result );
+   }
+}
+
+void CheckedFile::setDirectIO( bool enable )
+{
+   if ( readOnly_ )
    {
-      throw E57_EXCEPTION2( ErrorWriteFailed,
-                            "fileName=" + fileName_ + " result=" + toString( result ) );
+      throw E57_EXCEPTION2( ErrorFileReadOnly, "fileName=" + fileName_ );
+   }
+
+   directIO_ = enable;
+}
+
+void CheckedFile::movePages( uint64_t firstPage, uint64_t endPage, uint64_t pageShift )
+{
+   if ( readOnly_ )
+   {
+      throw E57_EXCEPTION2( ErrorFileReadOnly, "fileName=" + fileName_ );
    }
+
+   if ( ( endPage <= firstPage ) || ( pageShift == 0 ) )
+   {
+      return;
+   }
+
+   // Pages waiting to be written don't have checksums yet.
+   flushPendingPages();
+
+   constexpr size_t cChunkPages = 256;
+
+   std::vector<char> buffer( cChunkPages * physicalPageSize );
+
+   // Move from the end so no page is overwritten before it has been moved
+   for ( uint64_t end = endPage; end > firstPage; )
+   {
+      const auto count = static_cast<size_t>( std::min<uint64_t>( cChunkPages, end - firstPage ) );
+      const uint64_t start = end - count;
+
+      readPages( buffer.data(), start, count );
+      writePages( buffer.data(), start + pageShift, count );
+
+      end = start;
+   }
+
+   physicalLength_ = std::max( physicalLength_, ( endPage + pageShift ) * physicalPageSize );
+   logicalLength_ = std::max( logicalLength_, ( endPage + pageShift ) * logicalPageSize );
+}
+
+void CheckedFile::setWaitForData( unsigned timeoutMs )
+{
+   // Buffers are complete, so there is nothing to wait for.
+   if ( !readOnly_ || ( fd_ < 0 ) || ( timeoutMs == 0 ) )
+   {
+      return;
+   }
+
+   waitTimeoutMs_ = timeoutMs;
+   availableLength_ = physicalLength_;
+
+   // Allow reads anywhere until the real length is known
+   physicalLength_ = std::numeric_limits<int64_t>::max();
+   logicalLength_ = physicalToLogical( physicalLength_ );
+}
+
+void CheckedFile::setExpectedLength( uint64_t physicalLength )
+{
+   physicalLength_ = physicalLength;
+   logicalLength_ = physicalToLogical( physicalLength_ );
+}
+
+bool CheckedFile::setDirectIOFlag( bool enable )
+{
+#if defined( __linux__ ) && defined( O_DIRECT )
+   int flags = ::fcntl( fd_, F_GETFL );
+
+   if ( flags < 0 )
+   {
+      return false;
+   }
+
+   flags = enable ? ( flags | O_DIRECT ) : ( flags & ~O_DIRECT );
+
+   return ::fcntl( fd_, F_SETFL, flags ) == 0;
+#elif defined( __APPLE__ )
+   return ::fcntl( fd_, F_NOCACHE, enable ? 1 : 0 ) != -1;
+#else
+   E57_UNUSED( enable );
+
+   return false;
+#endif
 }
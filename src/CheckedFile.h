@@ -39,6 +39,9 @@ namespace e57
    // WARNING: pointer input is handled by user!
    class BufferView;
 
+   class ChecksumWorkers;
+   class RangeFile;
+
    class CheckedFile
    {
    public:
@@ -48,6 +51,13 @@ namespace e57
       static constexpr uint64_t physicalPageSizeMask = physicalPageSize - 1;
       static constexpr size_t logicalPageSize = physicalPageSize - 4;
 
+      // maximum number of physical pages buffered before they are written to the file
+      static constexpr size_t maxPendingPages = 4096;
+
+      // alignment of the file offsets, sizes & buffers used for direct I/O
+      static constexpr size_t directIOAlignment = 4096;
+      static constexpr size_t directIOPages = directIOAlignment / physicalPageSize;
+
    public:
       enum Mode
       {
@@ -63,10 +73,21 @@ namespace e57
 
       CheckedFile( const e57::ustring &fileName, Mode mode, ReadChecksumPolicy policy );
       CheckedFile( const char *input, uint64_t size, ReadChecksumPolicy policy );
+      CheckedFile( const RangeSource &source, ReadChecksumPolicy policy );
       ~CheckedFile();
 
       void read( char *buf, size_t nRead, size_t bufSize = 0 );
       void write( const char *buf, size_t nWrite );
+
+      // One of the buffers written one after the other by write( buffers, bufferCount )
+      struct WriteBuffer
+      {
+         const char *data;
+         size_t size;
+      };
+
+      // Write several buffers as one contiguous write without gathering them in memory first
+      void write( const WriteBuffer *buffers, size_t bufferCount );
       CheckedFile &operator<<( const e57::ustring &s );
       CheckedFile &operator<<( int64_t i );
       CheckedFile &operator<<( uint64_t i );
@@ -82,6 +103,29 @@ namespace e57
          return fileName_;
       }
 
+      // Write large aligned runs of pages bypassing the OS cache where it is supported (O_DIRECT
+      // on Linux, F_NOCACHE on macOS). Other writes go through the cache as usual.
+      void setDirectIO( bool enable );
+
+      // Number of threads (including the calling one) calculating the checksums of the pages
+      // written. 0 (the default) uses the number of hardware threads.
+      void setChecksumThreadCount( unsigned threadCount );
+
+      // Move the physical pages [firstPage, endPage) pageShift pages towards the end of the file.
+      // The pages keep their checksums since those only cover the page contents.
+      void movePages( uint64_t firstPage, uint64_t endPage, uint64_t pageShift );
+
+      // When reading a file which is still being copied or downloaded, wait up to timeoutMs for
+      // it to grow instead of failing on reads past its current end. Its length is unknown until
+      // setExpectedLength() is called.
+      void setWaitForData( unsigned timeoutMs );
+      void setExpectedLength( uint64_t physicalLength );
+
+      bool waitsForData() const
+      {
+         return waitTimeoutMs_ > 0;
+      }
+
       void close();
       void unlink();
 
@@ -96,7 +140,13 @@ namespace e57
       void getCurrentPageAndOffset( uint64_t &page, size_t &pageOffset,
                                     OffsetMode omode = Logical );
       void readPhysicalPage( char *page_buffer, uint64_t page );
+      void readPages( char *pages, uint64_t firstPage, size_t pageCount );
+      void waitForData( uint64_t physicalEnd );
       void writePhysicalPage( char *page_buffer, uint64_t page );
+      void checksumPendingPages();
+      void flushPendingPages();
+      void writePages( const char *pages, uint64_t firstPage, size_t pageCount );
+      bool setDirectIOFlag( bool enable );
       int open64( const e57::ustring &fileName, int flags, int mode );
       uint64_t lseek64( int64_t offset, int whence );
 
@@ -108,7 +158,29 @@ namespace e57
 
       int fd_ = -1;
       BufferView *bufView_ = nullptr;
+      RangeFile *rangeFile_ = nullptr;
       bool readOnly_ = false;
+
+      // When writing, consecutive physical pages are buffered here. Their checksums are only
+      // calculated (in parallel) when they are written to the file, so pages which are rewritten
+      // many times (partial page writes) are only checksummed once.
+      std::vector<char> pendingPages_;
+      char *pendingData_ = nullptr;
+      uint64_t pendingFirstPage_ = 0;
+      size_t pendingPageCount_ = 0;
+
+      // Page being filled by write(), kept so writes don't allocate
+      std::vector<char> pageBuffer_;
+
+      // Threads calculating the checksums, started by the first flush large enough to use them
+      unsigned checksumThreadCount_ = 0;
+      std::unique_ptr<ChecksumWorkers> checksumWorkers_;
+
+      bool directIO_ = false;
+
+      // When waiting for data: the timeout, and how much of the file was there when last checked
+      unsigned waitTimeoutMs_ = 0;
+      uint64_t availableLength_ = 0;
    };
 
    inline uint64_t CheckedFile::logicalToPhysical( uint64_t logicalOffset )
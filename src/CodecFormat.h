@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace e57
+{
+   // Stream formats shared by the encoders and decoders of the codecs extension.
+
+   // runLengthCodec: each run is a tag byte, then the value minus the minimum as a varint (only if
+   // the tag is RUN_LENGTH_LITERAL_TAG), then the run length minus one as a varint. Other tags are
+   // indices into the dictionary of the literal values, in the order they appear in the stream. A
+   // literal is added to the dictionary until it has RUN_LENGTH_DICTIONARY_SIZE values.
+   constexpr uint8_t RUN_LENGTH_LITERAL_TAG = 255;
+   constexpr size_t RUN_LENGTH_DICTIONARY_SIZE = 255;
+
+   // Maximum size of a varint (LEB128) of a 64 bit value
+   constexpr size_t VARINT_MAX_BYTES = 10;
+
+   // Maximum size of a run of the runLengthCodec
+   constexpr size_t RUN_LENGTH_MAX_BYTES = 1 + 2 * VARINT_MAX_BYTES;
+
+   // ransCodec: the records are coded in independent blocks of at most RANS_BLOCK_RECORDS records.
+   // A block is its size in bytes as a varint (not counting the size itself), the record count as
+   // a varint, a mode byte, the number of bytes W of the residuals, then W byte planes of the
+   // residuals, least significant first. With RANS_MODE_MINIMUM the residuals are the values minus
+   // the minimum. With RANS_MODE_DELTA they are the zigzag coded differences between consecutive
+   // values, the first value being relative to the minimum. A plane is a type byte, then:
+   //    RANS_PLANE_CONSTANT: the byte shared by all the records
+   //    RANS_PLANE_RAW: one byte per record
+   //    RANS_PLANE_RANS: the symbol count, (symbol byte, frequency varint) for each symbol, the
+   //    payload size as a varint, then the payload. The frequencies add up to RANS_PROB_SCALE.
+   //    The payload starts with the RANS_STATE_COUNT initial states (32 bit little endian), then
+   //    the renormalization bytes. Record i is decoded with state i % RANS_STATE_COUNT.
+   constexpr size_t RANS_BLOCK_RECORDS = 4096;
+
+   constexpr uint8_t RANS_MODE_MINIMUM = 0;
+   constexpr uint8_t RANS_MODE_DELTA = 1;
+
+   constexpr uint8_t RANS_PLANE_CONSTANT = 0;
+   constexpr uint8_t RANS_PLANE_RAW = 1;
+   constexpr uint8_t RANS_PLANE_RANS = 2;
+
+   constexpr unsigned RANS_PROB_BITS = 12;
+   constexpr uint32_t RANS_PROB_SCALE = 1U << RANS_PROB_BITS;
+   constexpr size_t RANS_STATE_COUNT = 4;
+
+   // Lower bound of the normalized rANS states (byte-wise renormalization)
+   constexpr uint32_t RANS_STATE_LOWER = 1U << 23;
+
+   // Maximum size of a block of the ransCodec, including its size. A rANS plane is only written if
+   // it is smaller than the raw plane.
+   constexpr size_t RANS_BLOCK_MAX_BYTES =
+      2 * VARINT_MAX_BYTES + 2 + 8 * ( 1 + RANS_BLOCK_RECORDS );
+
+   // Write value as a varint. Returns the number of bytes written.
+   inline size_t varintPut( char *out, uint64_t value )
+   {
+      size_t count = 0;
+
+      for ( ; value >= 0x80; value >>= 7 )
+      {
+         out[count++] = static_cast<char>( ( value & 0x7F ) | 0x80 );
+      }
+
+      out[count++] = static_cast<char>( value );
+
+      return count;
+   }
+
+   // Size of value as a varint
+   inline size_t varintSize( uint64_t value )
+   {
+      size_t count = 1;
+
+      for ( ; value >= 0x80; value >>= 7 )
+      {
+         ++count;
+      }
+
+      return count;
+   }
+
+   // Read a varint of at most byteCount bytes. Returns the number of bytes read, or 0 if the
+   // varint doesn't end within byteCount bytes.
+   inline size_t varintGet( const char *in, size_t byteCount, uint64_t &value )
+   {
+      value = 0;
+
+      const size_t maxCount = ( byteCount < VARINT_MAX_BYTES ) ? byteCount : VARINT_MAX_BYTES;
+
+      for ( size_t i = 0; i < maxCount; ++i )
+      {
+         const auto byte = static_cast<uint8_t>( in[i] );
+
+         value |= static_cast<uint64_t>( byte & 0x7F ) << ( 7 * i );
+
+         if ( ( byte & 0x80 ) == 0 )
+         {
+            return i + 1;
+         }
+      }
+
+      return 0;
+   }
+}
@@ -0,0 +1,295 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#if defined( _WIN32 )
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "ColumnCache.h"
+#include "StringFunctions.h"
+
+namespace e57
+{
+   namespace
+   {
+      constexpr char COLUMN_MAGIC[8] = { 'E', '5', '7', 'C', 'O', 'L', '0', '1' };
+      constexpr size_t COLUMN_FIXED_HEADER_SIZE = 32;
+
+      uint64_t _valuesOffset( size_t keySize )
+      {
+         const uint64_t headerSize = COLUMN_FIXED_HEADER_SIZE + keySize;
+         const uint64_t alignment = ColumnCache::COLUMN_ALIGNMENT;
+
+         return ( ( headerSize + alignment - 1 ) / alignment ) * alignment;
+      }
+
+      // FNV-1a, used to make short file names from the keys
+      uint64_t _hash( const ustring &text )
+      {
+         uint64_t hash = 14695981039346656037ULL;
+
+         for ( const char c : text )
+         {
+            hash ^= static_cast<uint8_t>( c );
+            hash *= 1099511628211ULL;
+         }
+
+         return hash;
+      }
+   }
+
+   MappedFile::MappedFile( char *data, uint64_t size ) : data_( data ), size_( size )
+   {
+   }
+
+   std::shared_ptr<MappedFile> MappedFile::map( const ustring &path )
+   {
+#if defined( _WIN32 )
+      HANDLE file = ::CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                   OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+
+      if ( file == INVALID_HANDLE_VALUE )
+      {
+         return nullptr;
+      }
+
+      LARGE_INTEGER fileSize;
+
+      if ( !::GetFileSizeEx( file, &fileSize ) || ( fileSize.QuadPart <= 0 ) )
+      {
+         ::CloseHandle( file );
+         return nullptr;
+      }
+
+      HANDLE mapping = ::CreateFileMappingA( file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr );
+
+      ::CloseHandle( file );
+
+      if ( mapping == nullptr )
+      {
+         return nullptr;
+      }
+
+      // The view keeps the mapping alive
+      void *view = ::MapViewOfFile( mapping, FILE_MAP_COPY, 0, 0, 0 );
+
+      ::CloseHandle( mapping );
+
+      if ( view == nullptr )
+      {
+         return nullptr;
+      }
+
+      const auto size = static_cast<uint64_t>( fileSize.QuadPart );
+
+      return std::shared_ptr<MappedFile>( new MappedFile( static_cast<char *>( view ), size ) );
+#else
+      const int fd = ::open( path.c_str(), O_RDONLY );
+
+      if ( fd < 0 )
+      {
+         return nullptr;
+      }
+
+      struct stat fileStat;
+
+      if ( ( ::fstat( fd, &fileStat ) != 0 ) || ( fileStat.st_size <= 0 ) )
+      {
+         ::close( fd );
+         return nullptr;
+      }
+
+      const auto size = static_cast<size_t>( fileStat.st_size );
+
+      // The mapping stays valid once the file is closed
+      void *data = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+
+      ::close( fd );
+
+      if ( data == MAP_FAILED )
+      {
+         return nullptr;
+      }
+
+      return std::shared_ptr<MappedFile>( new MappedFile( static_cast<char *>( data ), size ) );
+#endif
+   }
+
+   MappedFile::~MappedFile()
+   {
+#if defined( _WIN32 )
+      ::UnmapViewOfFile( data_ );
+#else
+      ::munmap( data_, static_cast<size_t>( size_ ) );
+#endif
+   }
+
+   ustring ColumnCache::columnKey( const ustring &fileGuid, const ustring &scanGuid,
+                                  const ustring &fieldName )
+   {
+      return fileGuid + '\n' + scanGuid + '\n' + fieldName;
+   }
+
+   ustring ColumnCache::columnPath( const ustring &cacheDirectory, const ustring &key,
+                                    const ustring &fieldName )
+   {
+      // The field name only makes the names readable - the key is checked when mapping
+      ustring name;
+
+      for ( const char c : fieldName )
+      {
+         const bool keep = ( ( c >= 'a' ) && ( c <= 'z' ) ) || ( ( c >= 'A' ) && ( c <= 'Z' ) ) ||
+                           ( ( c >= '0' ) && ( c <= '9' ) );
+
+         name += keep ? c : '_';
+      }
+
+      char hash[17];
+      std::snprintf( hash, sizeof( hash ), "%016llx",
+                     static_cast<unsigned long long>( _hash( key ) ) );
+
+      ustring path = cacheDirectory;
+
+      if ( !path.empty() && ( path.back() != '/' ) && ( path.back() != '\\' ) )
+      {
+         path += '/';
+      }
+
+      return path + hash + "_" + name + ".e57col";
+   }
+
+   std::shared_ptr<MappedFile> ColumnCache::mapColumn( const ustring &path, const ustring &key,
+                                                       size_t elementSize, uint64_t pointCount,
+                                                       char *&values )
+   {
+      std::shared_ptr<MappedFile> file = MappedFile::map( path );
+
+      if ( ( file == nullptr ) || ( file->size() < COLUMN_FIXED_HEADER_SIZE ) )
+      {
+         return nullptr;
+      }
+
+      const char *header = file->data();
+
+      uint32_t fileElementSize = 0;
+      uint32_t fileKeySize = 0;
+      uint64_t filePointCount = 0;
+      uint64_t fileValuesOffset = 0;
+
+      std::memcpy( &fileElementSize, header + 8, sizeof( fileElementSize ) );
+      std::memcpy( &fileKeySize, header + 12, sizeof( fileKeySize ) );
+      std::memcpy( &filePointCount, header + 16, sizeof( filePointCount ) );
+      std::memcpy( &fileValuesOffset, header + 24, sizeof( fileValuesOffset ) );
+
+      const bool match =
+         ( std::memcmp( header, COLUMN_MAGIC, sizeof( COLUMN_MAGIC ) ) == 0 ) &&
+         ( fileElementSize == elementSize ) && ( filePointCount == pointCount ) &&
+         ( fileKeySize == key.size() ) && ( fileValuesOffset == _valuesOffset( key.size() ) ) &&
+         ( file->size() == fileValuesOffset + ( pointCount * elementSize ) ) &&
+         ( std::memcmp( header + COLUMN_FIXED_HEADER_SIZE, key.data(), key.size() ) == 0 );
+
+      if ( !match )
+      {
+         return nullptr;
+      }
+
+      values = file->data() + fileValuesOffset;
+
+      return file;
+   }
+
+   ColumnCacheWriter::ColumnCacheWriter( const ustring &path, const ustring &key,
+                                         size_t elementSize, uint64_t pointCount ) :
+      path_( path ),
+      temporaryPath_( path + "." +
+                      toString( std::chrono::steady_clock::now().time_since_epoch().count() ) +
+                      ".tmp" ),
+      elementSize_( elementSize ), pointCount_( pointCount ),
+      file_( temporaryPath_, std::ios::binary | std::ios::trunc )
+   {
+      if ( !file_.is_open() )
+      {
+         return;
+      }
+
+      const auto elementSize32 = static_cast<uint32_t>( elementSize );
+      const auto keySize = static_cast<uint32_t>( key.size() );
+      const uint64_t valuesOffset = _valuesOffset( key.size() );
+
+      std::vector<char> header( valuesOffset, 0 );
+
+      std::memcpy( &header[0], COLUMN_MAGIC, sizeof( COLUMN_MAGIC ) );
+      std::memcpy( &header[8], &elementSize32, sizeof( elementSize32 ) );
+      std::memcpy( &header[12], &keySize, sizeof( keySize ) );
+      std::memcpy( &header[16], &pointCount, sizeof( pointCount ) );
+      std::memcpy( &header[24], &valuesOffset, sizeof( valuesOffset ) );
+      std::memcpy( &header[COLUMN_FIXED_HEADER_SIZE], key.data(), key.size() );
+
+      file_.write( header.data(), static_cast<std::streamsize>( header.size() ) );
+   }
+
+   ColumnCacheWriter::~ColumnCacheWriter()
+   {
+      if ( !committed_ )
+      {
+         if ( file_.is_open() )
+         {
+            file_.close();
+         }
+
+         std::remove( temporaryPath_.c_str() );
+      }
+   }
+
+   bool ColumnCacheWriter::isOpen() const
+   {
+      return file_.is_open();
+   }
+
+   void ColumnCacheWriter::append( const void *values, size_t count )
+   {
+      file_.write( static_cast<const char *>( values ),
+                   static_cast<std::streamsize>( count * elementSize_ ) );
+
+      writtenCount_ += count;
+   }
+
+   bool ColumnCacheWriter::commit()
+   {
+      file_.close();
+
+      if ( file_.fail() || ( writtenCount_ != pointCount_ ) )
+      {
+         return false;
+      }
+
+      // Another reader may have written the same column in the meantime
+      if ( std::rename( temporaryPath_.c_str(), path_.c_str() ) != 0 )
+      {
+         std::remove( path_.c_str() );
+
+         if ( std::rename( temporaryPath_.c_str(), path_.c_str() ) != 0 )
+         {
+            return false;
+         }
+      }
+
+      committed_ = true;
+
+      return true;
+   }
+}
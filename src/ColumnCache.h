@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+
+#include <fstream>
+
+#include "Common.h"
+#include "E57SimpleData.h"
+
+namespace e57
+{
+   /// A whole file mapped into memory copy-on-write: the pages may be modified, but the changes
+   /// are private and never written back to the file.
+   class MappedFile
+   {
+   public:
+      /// Returns nullptr if the file can't be opened or mapped
+      static std::shared_ptr<MappedFile> map( const ustring &path );
+
+      ~MappedFile();
+
+      MappedFile( const MappedFile & ) = delete;
+      MappedFile &operator=( const MappedFile & ) = delete;
+
+      char *data() const
+      {
+         return data_;
+      }
+
+      uint64_t size() const
+      {
+         return size_;
+      }
+
+   private:
+      MappedFile( char *data, uint64_t size );
+
+      char *data_;
+      uint64_t size_;
+   };
+
+   /// Files of the column cache. Each one holds the decoded values of one field of a Data3D, in
+   /// native byte order, after a header identifying the field:
+   ///
+   ///    0  "E57COL01"
+   ///    8  uint32 size of an element
+   ///   12  uint32 size of the key
+   ///   16  uint64 number of points
+   ///   24  uint64 offset of the values (a multiple of COLUMN_ALIGNMENT)
+   ///   32  key: file guid, Data3D guid and field name separated by '\n'
+   class ColumnCache
+   {
+   public:
+      /// Alignment of the values in the files
+      static constexpr size_t COLUMN_ALIGNMENT = 64;
+
+      static ustring columnKey( const ustring &fileGuid, const ustring &scanGuid,
+                                const ustring &fieldName );
+
+      static ustring columnPath( const ustring &cacheDirectory, const ustring &key,
+                                 const ustring &fieldName );
+
+      /// Returns the values of the column mapped, or nullptr if the file doesn't exist or doesn't
+      /// match the key, element size and number of points
+      static std::shared_ptr<MappedFile> mapColumn( const ustring &path, const ustring &key,
+                                                    size_t elementSize, uint64_t pointCount,
+                                                    char *&values );
+   };
+
+   /// Writes a column file to a temporary file, which replaces the real one when it is complete.
+   class ColumnCacheWriter
+   {
+   public:
+      /// Check isOpen() before writing
+      ColumnCacheWriter( const ustring &path, const ustring &key, size_t elementSize,
+                         uint64_t pointCount );
+
+      /// Removes the temporary file if commit() wasn't called
+      ~ColumnCacheWriter();
+
+      ColumnCacheWriter( const ColumnCacheWriter & ) = delete;
+      ColumnCacheWriter &operator=( const ColumnCacheWriter & ) = delete;
+
+      bool isOpen() const;
+
+      void append( const void *values, size_t count );
+
+      /// Returns false if the file couldn't be written
+      bool commit();
+
+   private:
+      ustring path_;
+      ustring temporaryPath_;
+      size_t elementSize_;
+      uint64_t pointCount_;
+      uint64_t writtenCount_ = 0;
+
+      std::ofstream file_;
+      bool committed_ = false;
+   };
+
+   class MappedData3DPointsImpl
+   {
+   public:
+      int64_t pointCount = 0;
+
+      /// Point to the mapped columns, or to memoryColumns
+      Data3DPointsDouble points;
+
+      std::vector<std::shared_ptr<MappedFile>> mappedColumns;
+
+      /// Columns decoded into memory when they can't be cached
+      std::vector<std::vector<char>> memoryColumns;
+   };
+}
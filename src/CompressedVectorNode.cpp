@@ -32,6 +32,7 @@
 
 #include "CompressedVectorNodeImpl.h"
 #include "StringFunctions.h"
+#include "VectorNodeImpl.h"
 
 using namespace e57;
 
@@ -141,6 +142,9 @@ parameters to tune. In the ASTM standard, if no codec is specified, the bitPackC
 specifying the @c codecs as an empty VectorNode is equivalent to requesting at all fields in the
 record be encoded with the bitPackCodec.
 
+libE57Format also supports the codecs of its codecs extension (see e57::Codec), which can be added
+to the @c codecs using CompressedVectorNode::appendCodec().
+
 Other than the @c prototype and @c codecs attributes, the only other state directly accessible is
 the number of children (records) in the CompressedVectorNode. The read/write access to the contents
 of the CompressedVectorNode is coordinated by two other Foundation API objects:
@@ -186,6 +190,7 @@ argument.
 The @a codecs must be a heterogeneous VectorNode with children as specified in the ASTM E57 data
 format standard. Since currently only one codec is supported (bitPackCodec), and it is the default,
 passing an empty VectorNode will specify that all record fields will be encoded with bitPackCodec.
+Fields which aren't listed in any of the @a codecs children are encoded with bitPackCodec.
 
 @pre The @a destImageFile must be open (i.e. destImageFile.isOpen() must be true).
 @pre The @a destImageFile must have been opened in write mode (i.e. destImageFile.isWritable() must
@@ -209,7 +214,7 @@ prototype.isRoot())
 */
 CompressedVectorNode::CompressedVectorNode( const ImageFile &destImageFile, const Node &prototype,
                                             const VectorNode &codecs ) :
-   impl_( new CompressedVectorNodeImpl( destImageFile.impl() ) )
+   impl_( makeNode<CompressedVectorNodeImpl>( destImageFile.impl() ) )
 {
    // Because of shared_ptr quirks, can't set prototype,codecs in CompressedVectorNodeImpl(), so set
    // it afterwards
@@ -324,6 +329,50 @@ VectorNode CompressedVectorNode::codecs() const
    return VectorNode( impl_->getCodecs() );
 }
 
+/*!
+@brief Append a codec description to a codecs tree.
+
+@details Adds a record to @a codecs which selects @a codec for the fields of the prototype named
+in @a fieldPaths. Fields which are not named in any record of the codecs tree use the
+bitPackCodec. If @a codec is part of the libE57Format codecs extension, the extension is declared
+in the ImageFile (with the prefix "codec") if it hasn't been declared already.
+
+@param [in] codecs The codecs tree which will be used to construct a CompressedVectorNode.
+@param [in] codec The codec to use for the fields.
+@param [in] fieldPaths The path names of the fields, relative to the prototype.
+
+@pre The destination ImageFile must be open (i.e. destImageFile().isOpen()).
+@pre The destination ImageFile must have been opened in write mode (i.e.
+destImageFile().isWritable()).
+@pre @a codecs must not be attached (i.e. !codecs.isAttached())
+@post The codecs tree has one more child.
+
+@throw ::ErrorBadAPIArgument
+@throw ::ErrorImageFileNotOpen
+@throw ::ErrorFileReadOnly
+@throw ::ErrorAlreadyHasParent
+@throw ::ErrorInternal All objects in undocumented state
+
+@see e57::Codec, CompressedVectorNode::CompressedVectorNode
+*/
+void CompressedVectorNode::appendCodec( VectorNode &codecs, Codec codec,
+                                        const std::vector<ustring> &fieldPaths )
+{
+   if ( codecs.isAttached() )
+   {
+      throw E57_EXCEPTION2( ErrorAlreadyHasParent, "codecs->pathName=" + codecs.pathName() );
+   }
+
+   if ( fieldPaths.empty() )
+   {
+      throw E57_EXCEPTION2( ErrorBadAPIArgument, "fieldPathsSize=0" );
+   }
+
+   ImageFileImplSharedPtr imf( codecs.impl()->destImageFile() );
+
+   codecs.impl()->append( CompressedVectorNodeImpl::codecRecord( imf, codec, fieldPaths ) );
+}
+
 /*!
 @brief Diagnostic function to print internal state of object to output stream in an indented format.
 @copydetails Node::dump()
@@ -31,6 +31,7 @@
 #include "CompressedVectorWriterImpl.h"
 #include "ImageFileImpl.h"
 #include "StringFunctions.h"
+#include "StringNodeImpl.h"
 #include "VectorNodeImpl.h"
 
 namespace e57
@@ -129,6 +130,220 @@ namespace e57
       return ( codecs_ ); //??? check defined
    }
 
+   NodeImplSharedPtr CompressedVectorNodeImpl::codecNodeFor( const ustring &pathName ) const
+   {
+      // Returns the codec child of the codecs record listing pathName in its inputs, or nullptr.
+      if ( !codecs_ )
+      {
+         return nullptr;
+      }
+
+      NodeImplSharedPtr field = prototype_->get( pathName );
+
+      for ( int64_t i = 0; i < codecs_->childCount(); ++i )
+      {
+         NodeImplSharedPtr record = codecs_->get( i );
+
+         if ( record->type() != TypeStructure )
+         {
+            throw E57_EXCEPTION2( ErrorBadCodecs, "recordPathName=" + record->pathName() );
+         }
+
+         auto structure = std::static_pointer_cast<StructureNodeImpl>( record );
+
+         if ( !structure->isDefined( "inputs" ) || ( structure->childCount() != 2 ) )
+         {
+            throw E57_EXCEPTION2( ErrorBadCodecs, "recordPathName=" + record->pathName() );
+         }
+
+         NodeImplSharedPtr inputs = structure->get( "inputs" );
+
+         if ( inputs->type() != TypeVector )
+         {
+            throw E57_EXCEPTION2( ErrorBadCodecs, "inputsPathName=" + inputs->pathName() );
+         }
+
+         auto inputsVector = std::static_pointer_cast<VectorNodeImpl>( inputs );
+
+         bool found = false;
+
+         for ( int64_t j = 0; !found && ( j < inputsVector->childCount() ); ++j )
+         {
+            NodeImplSharedPtr input = inputsVector->get( j );
+
+            if ( input->type() != TypeString )
+            {
+               throw E57_EXCEPTION2( ErrorBadCodecs, "inputPathName=" + input->pathName() );
+            }
+
+            const ustring inputPath = std::static_pointer_cast<StringNodeImpl>( input )->value();
+
+            found = ( prototype_->get( inputPath ) == field );
+         }
+
+         if ( !found )
+         {
+            continue;
+         }
+
+         // The codec is the child which isn't "inputs"
+         NodeImplSharedPtr codecNode = structure->get( 0 );
+         if ( codecNode == inputs )
+         {
+            codecNode = structure->get( 1 );
+         }
+
+         return codecNode;
+      }
+
+      return nullptr;
+   }
+
+   bool CompressedVectorNodeImpl::hasCodec( const ustring &pathName ) const
+   {
+      return ( codecNodeFor( pathName ) != nullptr );
+   }
+
+   Codec CompressedVectorNodeImpl::codecFor( const ustring &pathName ) const
+   {
+      NodeImplSharedPtr codecNode = codecNodeFor( pathName );
+
+      // A field which isn't in the codecs (or an empty or missing codecs tree) uses the
+      // bitPackCodec.
+      if ( codecNode == nullptr )
+      {
+         return CodecBitPack;
+      }
+
+      const ustring codecName = codecNode->elementName();
+
+      if ( codecName == codecElementName( CodecBitPack ) )
+      {
+         return CodecBitPack;
+      }
+
+      ImageFileImplSharedPtr imf( destImageFile_ );
+
+      if ( imf->isElementNameExtended( codecName ) )
+      {
+         ustring prefix;
+         ustring localPart;
+         ustring uri;
+
+         ImageFileImpl::elementNameParse( codecName, prefix, localPart );
+
+         if ( imf->extensionsLookupPrefix( prefix, uri ) && ( uri == CODECS_EXTENSION_URI ) )
+         {
+            for ( const Codec codec : { CodecFloatXor, CodecRunLength, CodecRans } )
+            {
+               if ( localPart != codecElementName( codec ) )
+               {
+                  continue;
+               }
+
+               const NodeType fieldType = prototype_->get( pathName )->type();
+
+               if ( !codecSupportsType( codec, fieldType ) )
+               {
+                  throw E57_EXCEPTION2( ErrorBadCodecs, "codec=" + codecName +
+                                                           " pathName=" + pathName +
+                                                           " nodeType=" + toString( fieldType ) );
+               }
+
+               return codec;
+            }
+         }
+      }
+
+      throw E57_EXCEPTION2( ErrorBadCodecs,
+                            "unsupported codec=" + codecName + " pathName=" + pathName );
+   }
+
+   NodeImplSharedPtr CompressedVectorNodeImpl::codecRecord( const ImageFileImplSharedPtr &imf,
+                                                            Codec codec,
+                                                            const std::vector<ustring> &fieldPaths )
+   {
+      auto inputs = makeNode<VectorNodeImpl>( imf, false );
+
+      for ( const auto &fieldPath : fieldPaths )
+      {
+         inputs->append( makeNode<StringNodeImpl>( imf, fieldPath ) );
+      }
+
+      auto record = makeNode<StructureNodeImpl>( imf );
+
+      record->set( "inputs", inputs );
+
+      ustring codecName = codecElementName( codec );
+
+      if ( codec != CodecBitPack )
+      {
+         ustring prefix;
+
+         if ( !imf->extensionsLookupUri( CODECS_EXTENSION_URI, prefix ) )
+         {
+            prefix = "codec";
+            imf->extensionsAdd( prefix, CODECS_EXTENSION_URI );
+         }
+
+         codecName = prefix + ":" + codecName;
+      }
+
+      record->set( codecName, makeNode<StructureNodeImpl>( imf ) );
+
+      return record;
+   }
+
+   void CompressedVectorNodeImpl::appendCodec( Codec codec, const std::vector<ustring> &fieldPaths )
+   {
+      ImageFileImplSharedPtr imf( destImageFile_ );
+
+      NodeImplSharedPtr record = codecRecord( imf, codec, fieldPaths );
+
+      // The codecs of an attached CompressedVector are type constrained, so
+      // StructureNodeImpl::set() would refuse the record. Only the writer adds one, before the
+      // binary section is written.
+      codecs_->appendChild( record, toString( codecs_->childCount() ) );
+   }
+
+   bool CompressedVectorNodeImpl::codecSupportsType( Codec codec, NodeType type )
+   {
+      switch ( codec )
+      {
+         case CodecBitPack:
+            return true;
+
+         case CodecFloatXor:
+            return ( type == TypeFloat );
+
+         case CodecRunLength:
+         case CodecRans:
+            return ( type == TypeInteger ) || ( type == TypeScaledInteger );
+      }
+
+      return false;
+   }
+
+   ustring CompressedVectorNodeImpl::codecElementName( Codec codec )
+   {
+      switch ( codec )
+      {
+         case CodecBitPack:
+            return "bitPackCodec";
+
+         case CodecFloatXor:
+            return "floatXorCodec";
+
+         case CodecRunLength:
+            return "runLengthCodec";
+
+         case CodecRans:
+            return "ransCodec";
+      }
+
+      throw E57_EXCEPTION2( ErrorInternal, "codec=" + toString( codec ) );
+   }
+
    bool CompressedVectorNodeImpl::isTypeEquivalent( NodeImplSharedPtr ni )
    {
       // don't checkImageFileOpen
@@ -215,7 +430,7 @@ namespace e57
       }
       else
       {
-         fieldName = elementName_;
+         fieldName = toUstring( elementName_ );
       }
 
       uint64_t physicalStart = cf.logicalToPhysical( binarySectionLogicalStart_ );
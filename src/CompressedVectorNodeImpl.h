@@ -50,6 +50,14 @@ namespace e57
       void setCodecs( const std::shared_ptr<VectorNodeImpl> &codecs );
       std::shared_ptr<VectorNodeImpl> getCodecs() const;
 
+      Codec codecFor( const ustring &pathName ) const;
+      bool hasCodec( const ustring &pathName ) const;
+      void appendCodec( Codec codec, const std::vector<ustring> &fieldPaths );
+      static NodeImplSharedPtr codecRecord( const ImageFileImplSharedPtr &imf, Codec codec,
+                                            const std::vector<ustring> &fieldPaths );
+      static ustring codecElementName( Codec codec );
+      static bool codecSupportsType( Codec codec, NodeType type );
+
       int64_t childCount() const;
 
       void checkLeavesInSet( const StringSet &pathNames, NodeImplSharedPtr origin ) override;
@@ -87,6 +95,9 @@ namespace e57
 
    private:
       friend class CompressedVectorReaderImpl;
+      friend class NodeView;
+
+      NodeImplSharedPtr codecNodeFor( const ustring &pathName ) const;
 
       NodeImplSharedPtr prototype_;
       std::shared_ptr<VectorNodeImpl> codecs_;
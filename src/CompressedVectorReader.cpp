@@ -265,6 +265,10 @@ This function may be called at any time (as long as ImageFile and CompressedVect
 The next read will start at the given recordNumber. It is not an error to seek to recordNumber =
 childCount() (i.e. to one record past end of CompressedVectorNode).
 
+Only the data packet headers are read to find the record, so seeking doesn't decode the records
+before it. This needs every field being read to have records of a fixed size in the file, which is
+the case for the fields stored with the bitPackCodec other than strings.
+
 @pre @a recordNumber <= childCount() of CompressedVectorNode.
 @pre The associated ImageFile must be open.
 @pre This CompressedVectorReader must be open (i.e isOpen())
@@ -276,6 +280,7 @@ childCount() (i.e. to one record past end of CompressedVectorNode).
 @throw ::ErrorSeekFailed
 @throw ::ErrorReadFailed
 @throw ::ErrorBadChecksum
+@throw ::ErrorNotImplemented if one of the fields being read uses another codec, or is a string
 @throw ::ErrorInternal All objects in undocumented state
 
 @see CompressedVectorNode::reader
@@ -285,6 +290,162 @@ void CompressedVectorReader::seek( int64_t recordNumber )
    impl_->seek( recordNumber );
 }
 
+/*!
+@brief Start reading another CompressedVectorNode with the same reader.
+
+@param [in] cv The CompressedVectorNode to read next.
+
+@details
+Setting up a reader creates a decoder for each buffer, finds the bytestream of each field in the
+prototype and allocates a packet cache. When many CompressedVectorNodes have the same prototype
+(e.g. the points of thousands of small scans), this can take longer than decoding them.
+
+This reuses all of that: the decoders are reset, and the next read starts at the first record of
+@a cv, using the same buffers. Any record of the previous CompressedVectorNode which hasn't been
+read is skipped. The prototype of @a cv must be identical to the one being read (including the
+minimum, maximum, scale and offset of the fields), and the fields being read must use the same
+codecs. If they aren't, an exception is thrown and the reader is unchanged, so it can go on reading
+the previous CompressedVectorNode.
+@code
+e57::CompressedVectorReader reader = firstPoints.reader( buffers );
+// read firstPoints...
+
+reader.rebind( secondPoints );
+// read secondPoints...
+@endcode
+
+@pre The associated ImageFile must be open.
+@pre This CompressedVectorReader must be open (i.e isOpen())
+@pre @a cv must be in the same ImageFile.
+@post The reader is closed if the section of @a cv in the file is bad.
+
+@throw ::ErrorImageFileNotOpen
+@throw ::ErrorReaderNotOpen
+@throw ::ErrorDifferentDestImageFile
+@throw ::ErrorBadPrototype      The prototype of @a cv is different.
+@throw ::ErrorBadCodecs         A field being read uses a different codec in @a cv.
+@throw ::ErrorBadCVHeader
+@throw ::ErrorBadCVPacket
+@throw ::ErrorSeekFailed
+@throw ::ErrorReadFailed
+@throw ::ErrorBadChecksum
+@throw ::ErrorInternal           All objects in undocumented state
+
+@see CompressedVectorNode::reader
+*/
+void CompressedVectorReader::rebind( const CompressedVectorNode &cv )
+{
+   impl_->rebind( cv.impl() );
+}
+
+/*!
+@brief Only read the records which meet all the conditions of a filter.
+
+@param [in] filter Conditions on the fields being read. An empty filter keeps all the records.
+
+@details
+Each block of decoded records is tested against the conditions, and the records which fail are
+removed from all the destination buffers by moving the following ones down. Decoding then goes on
+into the space freed, so read() still fills the buffers unless it reaches the end of the
+CompressedVectorNode, and only returns 0 at the end. This avoids a second pass over the records,
+and buffers for all the records, when most are thrown away (e.g. the invalid points).
+@code
+e57::RecordFilter filter{ { "cartesianInvalidState", e57::FilterEqual, 0 },
+                          { "intensity", e57::FilterGreaterOrEqual, 0.1 } };
+
+reader.setFilter( filter );
+@endcode
+
+@pre The associated ImageFile must be open.
+@pre This CompressedVectorReader must be open (i.e isOpen())
+@pre Each field in @a filter must be one of the fields being read, and not a string.
+
+@throw ::ErrorImageFileNotOpen
+@throw ::ErrorReaderNotOpen
+@throw ::ErrorPathUndefined     A field in @a filter isn't being read.
+@throw ::ErrorExpectingNumeric  A field in @a filter is read into a string buffer.
+@throw ::ErrorInternal          All objects in undocumented state
+
+@see CompressedVectorReader::read(), e57::RecordCondition
+*/
+void CompressedVectorReader::setFilter( const RecordFilter &filter )
+{
+   impl_->setFilter( filter );
+}
+
+/*!
+@brief Gather statistics on some fields of the records read.
+
+@param [in] fields Fields to gather statistics on, with the range of their histogram. An empty
+vector stops gathering statistics.
+
+@details
+The count, minimum, maximum, sum and (optionally) histogram of each field are updated by every
+read(), over the records it returns, while they are still in the cache after decoding. This avoids
+a second pass over the records to compute bounds or check their distribution. The statistics are
+reset by each call to this function.
+
+Values outside the histogram range are counted in its first or last bin.
+@code
+reader.setStatistics( { { "cartesianX" }, { "intensity", 16, 0.0, 1.0 } } );
+
+while ( reader.read() > 0 )
+{
+   // use the points
+}
+
+const std::vector<e57::FieldStatistics> stats = reader.statistics();
+@endcode
+
+@pre The associated ImageFile must be open.
+@pre This CompressedVectorReader must be open (i.e isOpen())
+@pre Each field in @a fields must be one of the fields being read, and not a string.
+
+@throw ::ErrorImageFileNotOpen
+@throw ::ErrorReaderNotOpen
+@throw ::ErrorPathUndefined     A field in @a fields isn't being read.
+@throw ::ErrorExpectingNumeric  A field in @a fields is read into a string buffer.
+@throw ::ErrorBadAPIArgument    A histogram has bins but an empty range.
+@throw ::ErrorInternal          All objects in undocumented state
+
+@see CompressedVectorReader::statistics(), CompressedVectorReader::lastReadStatistics()
+*/
+void CompressedVectorReader::setStatistics( const std::vector<StatisticsField> &fields )
+{
+   impl_->setStatistics( fields );
+}
+
+/*!
+@brief Get the statistics of all the records read since setStatistics() was called.
+
+@details
+Records skipped by seek() or removed by a filter are not included.
+
+@return The statistics of each field given to setStatistics(), in the same order.
+
+@throw No E57Exceptions.
+
+@see CompressedVectorReader::setStatistics(), CompressedVectorReader::lastReadStatistics()
+*/
+std::vector<FieldStatistics> CompressedVectorReader::statistics() const
+{
+   return impl_->statistics();
+}
+
+/*!
+@brief Get the statistics of the records returned by the last call to read().
+
+@return The statistics of each field given to setStatistics(), in the same order.
+
+@throw No E57Exceptions.
+
+@see CompressedVectorReader::setStatistics(), CompressedVectorReader::statistics()
+*/
+std::vector<FieldStatistics> CompressedVectorReader::lastReadStatistics() const
+{
+   return impl_->lastReadStatistics();
+}
+
 /*!
 @brief End the read operation.
 
@@ -25,6 +25,8 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <algorithm>
+
 #include "CompressedVectorReaderImpl.h"
 #include "CheckedFile.h"
 #include "CompressedVectorNodeImpl.h"
@@ -97,6 +99,60 @@ namespace e57
 
       ImageFileImplSharedPtr imf( cVector_->destImageFile_ );
 
+      const uint64_t dataLogicalOffset = readSectionHeader();
+
+      //??? what if fault in this constructor?
+      cache_ = new PacketReadCache( imf->file_, imf->packetCacheSize(), imf->memoryResource() );
+
+      // Only read the bytestreams of the fields we are reading from the data packets
+      std::vector<bool> bytestreamsNeeded;
+
+      for ( const auto &channel : channels_ )
+      {
+         if ( bytestreamsNeeded.size() <= channel.bytestreamNumber )
+         {
+            bytestreamsNeeded.resize( channel.bytestreamNumber + 1, false );
+         }
+
+         bytestreamsNeeded[channel.bytestreamNumber] = true;
+      }
+
+      cache_->setBytestreamsNeeded( bytestreamsNeeded );
+
+      initChannels( dataLogicalOffset );
+
+      // Just before return (and can't throw) increment reader count  ??? safer
+      // way to assure don't miss close?
+      imf->incrReaderCount();
+
+      // If get here, the reader is open
+      isOpen_ = true;
+   }
+
+   CompressedVectorReaderImpl::~CompressedVectorReaderImpl()
+   {
+#ifdef E57_VERBOSE
+      std::cout << "~CompressedVectorReaderImpl() called" << std::endl; //???
+                                                                        // dump(4);
+#endif
+
+      if ( isOpen_ )
+      {
+         try
+         {
+            close(); //??? what if already closed?
+         }
+         catch ( ... )
+         {
+            //??? report?
+         }
+      }
+   }
+
+   uint64_t CompressedVectorReaderImpl::readSectionHeader()
+   {
+      ImageFileImplSharedPtr imf( cVector_->destImageFile_ );
+
       // Check the file offset of this vector - it must be positive
       uint64_t sectionLogicalStart = cVector_->getBinarySectionLogicalStart();
       if ( sectionLogicalStart == 0 )
@@ -129,66 +185,108 @@ namespace e57
       sectionEndLogicalOffset_ = sectionLogicalStart + sectionHeader.sectionLogicalLength;
 
       // Convert physical offset to first data packet to logical
-      uint64_t dataLogicalOffset =
-         imf->file_->physicalToLogical( sectionHeader.dataPhysicalOffset );
+      return imf->file_->physicalToLogical( sectionHeader.dataPhysicalOffset );
+   }
 
-      //??? what if fault in this constructor?
-      cache_ = new PacketReadCache( imf->file_, 32 );
+   void CompressedVectorReaderImpl::initChannels( uint64_t dataLogicalOffset )
+   {
+      dataLogicalOffset_ = dataLogicalOffset;
+
+      packetOffsets_.clear();
+      packetBytestreamEnds_.clear();
+      directoryEndLogicalOffset_ = dataLogicalOffset;
+      directoryBytestreamCount_ = 0;
 
       // Verify that packet given by dataPhysicalOffset is actually a data packet,
       // init channels
-      {
-         char *anyPacket = nullptr;
-         std::unique_ptr<PacketLock> packetLock = cache_->lock( dataLogicalOffset, anyPacket );
+      char *anyPacket = nullptr;
+      std::unique_ptr<PacketLock> packetLock = cache_->lock( dataLogicalOffset, anyPacket );
 
-         auto dpkt = reinterpret_cast<DataPacket *>( anyPacket );
+      auto dpkt = reinterpret_cast<DataPacket *>( anyPacket );
 
-         // Double check that have a data packet
-         if ( dpkt->header.packetType != DATA_PACKET )
-         {
-            throw E57_EXCEPTION2( ErrorBadCVPacket,
-                                  "packetType=" + toString( dpkt->header.packetType ) );
-         }
+      // Double check that have a data packet
+      if ( dpkt->header.packetType != DATA_PACKET )
+      {
+         throw E57_EXCEPTION2( ErrorBadCVPacket,
+                               "packetType=" + toString( dpkt->header.packetType ) );
+      }
 
-         // Have good packet, initialize channels if we have records
-         if ( maxRecordCount_ > 0 )
+      // Have good packet, initialize channels if we have records
+      if ( maxRecordCount_ > 0 )
+      {
+         for ( auto &channel : channels_ )
          {
-            for ( auto &channel : channels_ )
-            {
-               channel.currentPacketLogicalOffset = dataLogicalOffset;
-               channel.currentBytestreamBufferIndex = 0;
-               channel.currentBytestreamBufferLength =
-                  dpkt->getBytestreamBufferLength( channel.bytestreamNumber );
-            }
+            channel.currentPacketLogicalOffset = dataLogicalOffset;
+            channel.currentBytestreamBufferIndex = 0;
+            channel.currentBytestreamBufferLength =
+               dpkt->getBytestreamBufferLength( channel.bytestreamNumber );
          }
       }
-
-      // Just before return (and can't throw) increment reader count  ??? safer
-      // way to assure don't miss close?
-      imf->incrReaderCount();
-
-      // If get here, the reader is open
-      isOpen_ = true;
    }
 
-   CompressedVectorReaderImpl::~CompressedVectorReaderImpl()
+   void CompressedVectorReaderImpl::rebind( std::shared_ptr<CompressedVectorNodeImpl> cvi )
    {
-#ifdef E57_VERBOSE
-      std::cout << "~CompressedVectorReaderImpl() called" << std::endl; //???
-                                                                        // dump(4);
-#endif
+      checkImageFileOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+      checkReaderOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
 
-      if ( isOpen_ )
+      // The packet cache is for our file
+      ImageFileImplSharedPtr thisDest( cVector_->destImageFile() );
+      ImageFileImplSharedPtr cviDest( cvi->destImageFile() );
+      if ( thisDest != cviDest )
       {
-         try
-         {
-            close(); //??? what if already closed?
-         }
-         catch ( ... )
+         throw E57_EXCEPTION2( ErrorDifferentDestImageFile,
+                               "this->destImageFile" + thisDest->fileName() +
+                                  " cvi->destImageFile" + cviDest->fileName() );
+      }
+
+      // The decoders and the bytestream numbers only depend on the prototype and the codecs, so
+      // they can be kept if these are the same.
+      NodeImplSharedPtr proto = cvi->getPrototype();
+      if ( !proto_->isTypeEquivalent( proto ) )
+      {
+         throw E57_EXCEPTION2( ErrorBadPrototype, "cvPathName=" + cVector_->pathName() +
+                                                     " newCvPathName=" + cvi->pathName() );
+      }
+
+      for ( const auto &channel : channels_ )
+      {
+         const ustring &pathName = channel.dbuf.pathName();
+
+         if ( cVector_->codecFor( pathName ) != cvi->codecFor( pathName ) )
          {
-            //??? report?
+            throw E57_EXCEPTION2( ErrorBadCodecs, "cvPathName=" + cVector_->pathName() +
+                                                     " newCvPathName=" + cvi->pathName() +
+                                                     " pathName=" + pathName );
          }
       }
+
+      cVector_ = cvi;
+      proto_ = proto;
+
+      recordCount_ = 0;
+      maxRecordCount_ = cvi->childCount();
+
+      for ( auto &channel : channels_ )
+      {
+         channel.decoder->stateReset( maxRecordCount_ );
+
+         channel.maxRecordCount = maxRecordCount_;
+         channel.currentPacketLogicalOffset = 0;
+         channel.currentBytestreamBufferIndex = 0;
+         channel.currentBytestreamBufferLength = 0;
+         channel.inputFinished = false;
+      }
+
+      // If the new vector is bad, close the reader rather than leave it half rebound
+      try
+      {
+         initChannels( readSectionHeader() );
+      }
+      catch ( ... )
+      {
+         close();
+         throw;
+      }
    }
 
    void CompressedVectorReaderImpl::setBuffers( std::vector<SourceDestBuffer> &dbufs )
@@ -249,6 +347,40 @@ namespace e57
          dbuf.impl()->rewind();
       }
 
+      unsigned outputCount = decodeRecords();
+
+      if ( !filter_.empty() )
+      {
+         // Drop the records which fail the filter, then decode more into the space freed until
+         // the buffers are full or there are no more records.
+         unsigned keptCount = 0;
+
+         while ( true )
+         {
+            keptCount = filterRecords( keptCount, outputCount );
+
+            if ( ( keptCount == outputCount ) ||
+                 ( channels_.front().decoder->totalRecordsCompleted() >= maxRecordCount_ ) )
+            {
+               break;
+            }
+
+            outputCount = decodeRecords();
+         }
+
+         outputCount = keptCount;
+      }
+
+      if ( !statistics_.empty() )
+      {
+         updateStatistics( outputCount );
+      }
+
+      return outputCount;
+   }
+
+   unsigned CompressedVectorReaderImpl::decodeRecords()
+   {
       // Allow decoders to use data they already have in their queue to fill newly
       // empty dbufs This helps to keep decoder input queues smaller, which
       // reduces backtracking in the packet cache.
@@ -300,6 +432,71 @@ namespace e57
       return outputCount;
    }
 
+   unsigned CompressedVectorReaderImpl::filterRecords( unsigned first, unsigned end )
+   {
+      if ( filterKeep_.size() < end )
+      {
+         filterKeep_.resize( channels_.front().dbuf.impl()->capacity() );
+      }
+
+      std::fill( filterKeep_.begin() + first, filterKeep_.begin() + end, uint8_t{ 1 } );
+
+      for ( size_t i = 0; i < filter_.size(); ++i )
+      {
+         channels_[filterBufferIndices_[i]].dbuf.impl()->matchRecords(
+            filter_[i].comparison, filter_[i].value, first, end, filterKeep_.data() );
+      }
+
+      for ( auto &channel : channels_ )
+      {
+         channel.dbuf.impl()->compactRecords( filterKeep_.data(), first, end );
+      }
+
+      return channels_.front().dbuf.impl()->nextIndex();
+   }
+
+   /// Gather the statistics of the records [0, end) just returned, while they are still in the
+   /// cache, and add them to the statistics since setStatistics().
+   void CompressedVectorReaderImpl::updateStatistics( unsigned end )
+   {
+      for ( size_t i = 0; i < lastReadStatistics_.size(); ++i )
+      {
+         FieldStatistics &last = lastReadStatistics_[i];
+
+         last.count = 0;
+         last.sum = 0.0;
+         std::fill( last.histogram.begin(), last.histogram.end(), uint64_t{ 0 } );
+
+         channels_[statisticsBufferIndices_[i]].dbuf.impl()->accumulateStatistics( 0, end, last );
+
+         if ( last.count == 0 )
+         {
+            continue;
+         }
+
+         FieldStatistics &total = statistics_[i];
+
+         if ( total.count == 0 )
+         {
+            total.minimum = last.minimum;
+            total.maximum = last.maximum;
+         }
+         else
+         {
+            total.minimum = std::min( total.minimum, last.minimum );
+            total.maximum = std::max( total.maximum, last.maximum );
+         }
+
+         total.count += last.count;
+         total.sum += last.sum;
+
+         for ( size_t bin = 0; bin < last.histogram.size(); ++bin )
+         {
+            total.histogram[bin] += last.histogram[bin];
+         }
+      }
+   }
+
    uint64_t CompressedVectorReaderImpl::earliestPacketNeededForInput() const
    {
       uint64_t earliestPacketLogicalOffset = UINT64_MAX;
@@ -542,12 +739,247 @@ namespace e57
       return UINT64_MAX;
    }
 
-   void CompressedVectorReaderImpl::seek( uint64_t /*recordNumber*/ )
+   void CompressedVectorReaderImpl::seek( uint64_t recordNumber )
+   {
+      checkImageFileOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+      checkReaderOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+
+      if ( recordNumber > maxRecordCount_ )
+      {
+         throw E57_EXCEPTION2( ErrorBadAPIArgument,
+                               "recordNumber=" + toString( recordNumber ) +
+                                  " maxRecordCount=" + toString( maxRecordCount_ ) );
+      }
+
+      // We can only find the position of a record in a bytestream if all the records have the
+      // same size.
+      std::vector<unsigned> bitsPerRecord( channels_.size() );
+      std::vector<unsigned> bytesPerWord( channels_.size() );
+
+      for ( size_t i = 0; i < channels_.size(); ++i )
+      {
+         if ( !channels_[i].decoder->fixedRecordSize( bitsPerRecord[i], bytesPerWord[i] ) )
+         {
+            throw E57_EXCEPTION2( ErrorNotImplemented,
+                                  "cvPathName=" + cVector_->pathName() +
+                                     " pathName=" + channels_[i].dbuf.pathName() );
+         }
+      }
+
+      for ( size_t i = 0; i < channels_.size(); ++i )
+      {
+         DecodeChannel &channel = channels_[i];
+
+         if ( ( bitsPerRecord[i] == 0 ) || ( recordNumber == maxRecordCount_ ) )
+         {
+            channel.decoder->seekRecord( recordNumber, 0 );
+            channel.inputFinished = true;
+            continue;
+         }
+
+         // Start at the word holding the first bit of the record
+         const uint64_t recordBit = recordNumber * bitsPerRecord[i];
+         const uint64_t wordBits = 8 * uint64_t{ bytesPerWord[i] };
+         const uint64_t wordByte = recordBit / wordBits * bytesPerWord[i];
+
+         const unsigned bytestream = channel.bytestreamNumber;
+         const size_t packetIndex = findPacketHolding( bytestream, wordByte );
+         const uint64_t *ends =
+            &packetBytestreamEnds_[packetIndex * directoryBytestreamCount_ + bytestream];
+         const uint64_t packetStart =
+            ( packetIndex == 0 ) ? 0 : *( ends - directoryBytestreamCount_ );
+
+         channel.currentPacketLogicalOffset = packetOffsets_[packetIndex];
+         channel.currentBytestreamBufferIndex = static_cast<size_t>( wordByte - packetStart );
+         channel.currentBytestreamBufferLength = static_cast<size_t>( *ends - packetStart );
+         channel.inputFinished = false;
+
+         channel.decoder->seekRecord( recordNumber,
+                                      static_cast<size_t>( recordBit - 8 * wordByte ) );
+      }
+
+      recordCount_ = recordNumber;
+   }
+
+   size_t CompressedVectorReaderImpl::findPacketHolding( unsigned bytestreamNumber,
+                                                         uint64_t byteOffset )
+   {
+      ImageFileImplSharedPtr imf( cVector_->destImageFile_ );
+
+      // Read the headers of the data packets until we get past byteOffset. Only the packet
+      // headers and the bytestream lengths are read, not the data.
+      while ( packetOffsets_.empty() ||
+              ( packetBytestreamEnds_[( packetOffsets_.size() - 1 ) * directoryBytestreamCount_ +
+                                      bytestreamNumber] <= byteOffset ) )
+      {
+         if ( directoryEndLogicalOffset_ >= sectionEndLogicalOffset_ )
+         {
+            throw E57_EXCEPTION2( ErrorBadCVPacket,
+                                  "cvPathName=" + cVector_->pathName() +
+                                     " bytestreamNumber=" + toString( bytestreamNumber ) +
+                                     " byteOffset=" + toString( byteOffset ) );
+         }
+
+         char headerBytes[sizeof( DataPacketHeader )];
+         imf->file_->seek( directoryEndLogicalOffset_, CheckedFile::Logical );
+         imf->file_->read( headerBytes, sizeof( headerBytes ) );
+
+         const auto header = reinterpret_cast<const DataPacketHeader *>( headerBytes );
+         const uint64_t packetLogicalOffset = directoryEndLogicalOffset_;
+
+         // All packets have their length in the same place
+         directoryEndLogicalOffset_ += header->packetLogicalLengthMinus1 + 1;
+
+         if ( header->packetType != DATA_PACKET )
+         {
+            continue;
+         }
+
+         if ( directoryBytestreamCount_ == 0 )
+         {
+            directoryBytestreamCount_ = header->bytestreamCount;
+         }
+
+         if ( ( header->bytestreamCount != directoryBytestreamCount_ ) ||
+              ( bytestreamNumber >= directoryBytestreamCount_ ) )
+         {
+            throw E57_EXCEPTION2( ErrorBadCVPacket,
+                                  "bytestreamCount=" + toString( header->bytestreamCount ) +
+                                     " expected=" + toString( directoryBytestreamCount_ ) );
+         }
+
+         std::vector<uint16_t> lengths( directoryBytestreamCount_ );
+         imf->file_->read( reinterpret_cast<char *>( lengths.data() ),
+                           lengths.size() * sizeof( uint16_t ) );
+
+         const size_t previous = packetBytestreamEnds_.size();
+
+         for ( unsigned i = 0; i < directoryBytestreamCount_; ++i )
+         {
+            const uint64_t start =
+               ( previous == 0 ) ? 0
+                                 : packetBytestreamEnds_[previous - directoryBytestreamCount_ + i];
+
+            packetBytestreamEnds_.push_back( start + lengths[i] );
+         }
+
+         packetOffsets_.push_back( packetLogicalOffset );
+      }
+
+      // Binary search for the first packet ending past byteOffset. Packets with no bytes for
+      // this bytestream are skipped since they end where the previous one does.
+      size_t low = 0;
+      size_t high = packetOffsets_.size() - 1;
+
+      while ( low < high )
+      {
+         const size_t middle = low + ( high - low ) / 2;
+
+         if ( packetBytestreamEnds_[middle * directoryBytestreamCount_ + bytestreamNumber] <=
+              byteOffset )
+         {
+            low = middle + 1;
+         }
+         else
+         {
+            high = middle;
+         }
+      }
+
+      return low;
+   }
+
+   void CompressedVectorReaderImpl::setFilter( const RecordFilter &filter )
+   {
+      checkImageFileOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+      checkReaderOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+
+      std::vector<size_t> bufferIndices;
+
+      for ( const auto &condition : filter )
+      {
+         const auto channelIter =
+            std::find_if( channels_.begin(), channels_.end(), [&]( const DecodeChannel &channel ) {
+               return channel.dbuf.pathName() == condition.pathName;
+            } );
+
+         if ( channelIter == channels_.end() )
+         {
+            throw E57_EXCEPTION2( ErrorPathUndefined, "cvPathName=" + cVector_->pathName() +
+                                                         " pathName=" + condition.pathName );
+         }
+
+         if ( channelIter->dbuf.impl()->memoryRepresentation() == UString )
+         {
+            throw E57_EXCEPTION2( ErrorExpectingNumeric, "pathName=" + condition.pathName );
+         }
+
+         bufferIndices.push_back( static_cast<size_t>( channelIter - channels_.begin() ) );
+      }
+
+      filter_ = filter;
+      filterBufferIndices_ = std::move( bufferIndices );
+   }
+
+   void CompressedVectorReaderImpl::setStatistics( const std::vector<StatisticsField> &fields )
    {
       checkImageFileOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+      checkReaderOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+
+      std::vector<FieldStatistics> statistics;
+      std::vector<size_t> bufferIndices;
+
+      for ( const auto &field : fields )
+      {
+         const auto channelIter =
+            std::find_if( channels_.begin(), channels_.end(), [&]( const DecodeChannel &channel ) {
+               return channel.dbuf.pathName() == field.pathName;
+            } );
+
+         if ( channelIter == channels_.end() )
+         {
+            throw E57_EXCEPTION2( ErrorPathUndefined, "cvPathName=" + cVector_->pathName() +
+                                                         " pathName=" + field.pathName );
+         }
 
-      // !!! implement
-      throw E57_EXCEPTION1( ErrorNotImplemented );
+         if ( channelIter->dbuf.impl()->memoryRepresentation() == UString )
+         {
+            throw E57_EXCEPTION2( ErrorExpectingNumeric, "pathName=" + field.pathName );
+         }
+
+         if ( ( field.histogramBinCount > 0 ) &&
+              !( field.histogramMinimum < field.histogramMaximum ) )
+         {
+            throw E57_EXCEPTION2( ErrorBadAPIArgument,
+                                  "pathName=" + field.pathName +
+                                     " histogramMinimum=" + toString( field.histogramMinimum ) +
+                                     " histogramMaximum=" + toString( field.histogramMaximum ) );
+         }
+
+         FieldStatistics fieldStatistics;
+
+         fieldStatistics.pathName = field.pathName;
+         fieldStatistics.histogramMinimum = field.histogramMinimum;
+         fieldStatistics.histogramMaximum = field.histogramMaximum;
+         fieldStatistics.histogram.resize( field.histogramBinCount, 0 );
+
+         statistics.push_back( std::move( fieldStatistics ) );
+         bufferIndices.push_back( static_cast<size_t>( channelIter - channels_.begin() ) );
+      }
+
+      lastReadStatistics_ = statistics;
+      statistics_ = std::move( statistics );
+      statisticsBufferIndices_ = std::move( bufferIndices );
+   }
+
+   std::vector<FieldStatistics> CompressedVectorReaderImpl::statistics() const
+   {
+      return statistics_;
+   }
+
+   std::vector<FieldStatistics> CompressedVectorReaderImpl::lastReadStatistics() const
+   {
+      return lastReadStatistics_;
    }
 
    bool CompressedVectorReaderImpl::isOpen() const
@@ -43,6 +43,11 @@ namespace e57
       unsigned read();
       unsigned read( std::vector<SourceDestBuffer> &dbufs );
       void seek( uint64_t recordNumber );
+      void rebind( std::shared_ptr<CompressedVectorNodeImpl> cvi );
+      void setFilter( const RecordFilter &filter );
+      void setStatistics( const std::vector<StatisticsField> &fields );
+      std::vector<FieldStatistics> statistics() const;
+      std::vector<FieldStatistics> lastReadStatistics() const;
       bool isOpen() const;
       std::shared_ptr<CompressedVectorNodeImpl> compressedVectorNode() const;
       void close();
@@ -58,10 +63,17 @@ namespace e57
                             const char *srcFunctionName ) const;
       void setBuffers( std::vector<SourceDestBuffer> &dbufs ); //???needed?
       uint64_t earliestPacketNeededForInput() const;
+      unsigned decodeRecords();
+      unsigned filterRecords( unsigned first, unsigned end );
+      void updateStatistics( unsigned end );
+
+      uint64_t readSectionHeader();
+      void initChannels( uint64_t dataLogicalOffset );
 
       DataPacket *dataPacket( uint64_t inLogicalOffset ) const;
       void feedPacketToDecoders( uint64_t currentPacketLogicalOffset );
       uint64_t findNextDataPacket( uint64_t nextPacketLogicalOffset );
+      size_t findPacketHolding( unsigned bytestreamNumber, uint64_t byteOffset );
 
       //??? no default ctor, copy, assignment?
 
@@ -75,5 +87,24 @@ namespace e57
       uint64_t recordCount_; /// number of records written so far
       uint64_t maxRecordCount_;
       uint64_t sectionEndLogicalOffset_;
+      uint64_t dataLogicalOffset_ = 0; /// first data packet
+
+      /// Directory of the data packets, built as far as needed by seek()
+      std::vector<uint64_t> packetOffsets_;
+      /// For each packet in packetOffsets_, the number of bytes of each bytestream up to its end
+      std::vector<uint64_t> packetBytestreamEnds_;
+      uint64_t directoryEndLogicalOffset_ = 0;
+      unsigned directoryBytestreamCount_ = 0;
+
+      /// Conditions the records read must meet, with the index of the buffer of each field
+      RecordFilter filter_;
+      std::vector<size_t> filterBufferIndices_;
+      std::vector<uint8_t> filterKeep_;
+
+      /// Statistics of the records returned by the last read() and since setStatistics(), with
+      /// the index of the buffer of each field
+      std::vector<FieldStatistics> lastReadStatistics_;
+      std::vector<FieldStatistics> statistics_;
+      std::vector<size_t> statisticsBufferIndices_;
    };
 }
@@ -315,6 +315,22 @@ CompressedVectorNode CompressedVectorWriter::compressedVectorNode() const
    return impl_->compressedVectorNode();
 }
 
+/*!
+@brief Return the codecs selected automatically for the fields of the CompressedVectorNode.
+
+@details The selection is enabled by WriterOptions::codecSelectionSampleSize. It happens once that
+many records have been written, or when the writer is closed if fewer records were written. Fields
+which already have a codec in the CompressedVectorNode codecs aren't included.
+
+@return The selection made for each field, empty if there was none (yet).
+
+@see WriterOptions::codecSelectionSampleSize, e57::CodecSelection
+*/
+std::vector<CodecSelection> CompressedVectorWriter::codecSelections() const
+{
+   return impl_->codecSelections();
+}
+
 /*!
 @brief Diagnostic function to print internal state of object to output stream in an indented format.
 @copydetails Node::dump()
@@ -25,13 +25,17 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <algorithm>
 #include <cmath>
+#include <map>
 #include <numeric>
 
 #include "CheckedFile.h"
 #include "CompressedVectorNodeImpl.h"
 #include "CompressedVectorWriterImpl.h"
+#include "FloatNodeImpl.h"
 #include "ImageFileImpl.h"
+#include "ScaledIntegerNodeImpl.h"
 #include "SectionHeaders.h"
 #include "SourceDestBufferImpl.h"
 #include "StringFunctions.h"
@@ -67,48 +71,22 @@ namespace e57
       // Check sbufs well formed (matches proto exactly)
       setBuffers( sbufs ); //??? copy code here?
 
-      // For each individual sbuf, create an appropriate Encoder based on the
-      // cVector_ attributes
-      for ( unsigned i = 0; i < sbufs_.size(); i++ )
-      {
-         // Create vector of single sbuf  ??? for now, may have groups later
-         std::vector<SourceDestBuffer> vTemp;
-         vTemp.push_back( sbufs_.at( i ) );
+      ImageFileImplSharedPtr imf( ni->destImageFile_ );
 
-         ustring codecPath = sbufs_.at( i ).pathName();
+      // With automatic codec selection, the encoders are created once the codecs are selected
+      sampleSize_ = imf->codecSelectionSampleSize();
+      sizeTolerance_ = imf->codecSelectionTolerance();
+      sampleCount_ = 0;
 
-         // Calc which stream the given path belongs to.  This depends on position
-         // of the node in the proto tree.
-         NodeImplSharedPtr readNode = proto_->get( sbufs.at( i ).pathName() );
-         uint64_t bytestreamNumber = 0;
-         if ( !proto_->findTerminalPosition( readNode, bytestreamNumber ) )
-         {
-            throw E57_EXCEPTION2( ErrorInternal, "sbufIndex=" + toString( i ) );
-         }
-
-         // EncoderFactory picks the appropriate encoder to match type declared in
-         // prototype
-         bytestreams_.push_back( Encoder::EncoderFactory( static_cast<unsigned>( bytestreamNumber ),
-                                                          cVector_, vTemp, codecPath ) );
+      if ( sampleSize_ > 0 )
+      {
+         startSample();
       }
 
-      // The bytestreams_ vector must be ordered by bytestreamNumber, not by order
-      // called specified sbufs, so sort it.
-      sort( bytestreams_.begin(), bytestreams_.end(), SortByBytestreamNumber() );
-#if ( E57_VALIDATION_LEVEL == VALIDATION_DEEP )
-      // Double check that all bytestreams are specified
-      for ( unsigned i = 0; i < bytestreams_.size(); i++ )
+      if ( sampleSize_ == 0 )
       {
-         if ( bytestreams_.at( i )->bytestreamNumber() != i )
-         {
-            throw E57_EXCEPTION2( ErrorInternal,
-                                  "bytestreamIndex=" + toString( i ) + " bytestreamNumber=" +
-                                     toString( bytestreams_.at( i )->bytestreamNumber() ) );
-         }
+         createEncoders( sbufs_ );
       }
-#endif
-
-      ImageFileImplSharedPtr imf( ni->destImageFile_ );
 
       // Reserve space for CompressedVector binary section header, record location
       // so can save to when writer closes. Request that file be extended with
@@ -122,6 +100,7 @@ namespace e57
       recordCount_ = 0;
       dataPacketsCount_ = 0;
       indexPacketsCount_ = 0;
+      columnGrouped_ = imf->columnGroupedPackets();
 
       // Just before return (and can't throw) increment writer count  ??? safer
       // way to assure don't miss close?
@@ -172,6 +151,12 @@ namespace e57
       // try to close again.
       isOpen_ = false;
 
+      // Fewer records than the sample size were written
+      if ( sampleSize_ > 0 )
+      {
+         finishSample();
+      }
+
       // If have any data, write packet
       // Write all remaining ioBuffers and internal encoder register cache into
       // file. Know we are done when totalOutputAvailable() returns 0 after a
@@ -179,7 +164,16 @@ namespace e57
       flush();
       while ( totalOutputAvailable() > 0 )
       {
-         packetWrite();
+         if ( columnGrouped_ )
+         {
+            // Keep the bytestreams in separate packets
+            packetWriteBytestream( fullestBytestream() );
+         }
+         else
+         {
+            packetWrite();
+         }
+
          flush();
       }
 
@@ -311,8 +305,36 @@ namespace e57
          sbuf.impl()->rewind();
       }
 
-      // Loop until all channels have completed requestedRecordCount transfers
-      uint64_t endRecordIndex = recordCount_ + requestedRecordCount;
+      // While selecting the codecs, the records go to the sample until it is full
+      if ( sampleSize_ > 0 )
+      {
+         sampleRecords( requestedRecordCount );
+
+         if ( sampleCount_ == sampleSize_ )
+         {
+            finishSample();
+         }
+      }
+
+      if ( sampleSize_ == 0 )
+      {
+         encodeRecords( recordCount_ + requestedRecordCount );
+      }
+
+      recordCount_ += requestedRecordCount;
+
+      if ( writeObserver_ )
+      {
+         writeObserver_( sbufs_, requestedRecordCount );
+      }
+
+      // When we leave this function, will likely still have data in channel
+      // ioBuffers as well as partial words in Encoder registers.
+   }
+
+   void CompressedVectorWriterImpl::encodeRecords( const uint64_t endRecordIndex )
+   {
+      // Loop until all channels have completed transfers up to endRecordIndex
       while ( true )
       {
          // Calc remaining record counts for all channels
@@ -350,8 +372,20 @@ namespace e57
 #else
          constexpr size_t E57_TARGET_PACKET_SIZE = ( DATA_PACKET_MAX * 3 / 4 );
 #endif
+         if ( columnGrouped_ )
+         {
+            // Send a packet holding only the bytestream with the most data, once it has more
+            // than the target fraction of a packet.
+            const size_t fullest = fullestBytestream();
+
+            if ( bytestreams_.at( fullest )->outputAvailable() >= E57_TARGET_PACKET_SIZE )
+            {
+               packetWriteBytestream( fullest );
+               continue;
+            }
+         }
          // If have more than target fraction of packet, send it now
-         if ( currentPacketSize() >= E57_TARGET_PACKET_SIZE )
+         else if ( currentPacketSize() >= E57_TARGET_PACKET_SIZE )
          { //???
             packetWrite();
             continue; // restart loop so recalc statistics (packet size may not be
@@ -391,11 +425,315 @@ namespace e57
             }
          }
       }
+   }
 
-      recordCount_ += requestedRecordCount;
+   void CompressedVectorWriterImpl::setWriteObserver( WriteObserver observer )
+   {
+      writeObserver_ = std::move( observer );
+   }
 
-      // When we leave this function, will likely still have data in channel
-      // ioBuffers as well as partial words in Encoder registers.
+   std::vector<CodecSelection> CompressedVectorWriterImpl::codecSelections() const
+   {
+      return codecSelections_;
+   }
+
+   unsigned CompressedVectorWriterImpl::bytestreamNumber( const SourceDestBuffer &sbuf ) const
+   {
+      // Calc which stream the given path belongs to.  This depends on position
+      // of the node in the proto tree.
+      NodeImplSharedPtr readNode = proto_->get( sbuf.pathName() );
+      uint64_t bytestreamNumber = 0;
+      if ( !proto_->findTerminalPosition( readNode, bytestreamNumber ) )
+      {
+         throw E57_EXCEPTION2( ErrorInternal, "pathName=" + sbuf.pathName() );
+      }
+
+      return static_cast<unsigned>( bytestreamNumber );
+   }
+
+   void CompressedVectorWriterImpl::createEncoders( std::vector<SourceDestBuffer> &sbufs )
+   {
+      // For each individual sbuf, create an appropriate Encoder based on the
+      // cVector_ attributes
+      for ( auto &sbuf : sbufs )
+      {
+         // Create vector of single sbuf  ??? for now, may have groups later
+         std::vector<SourceDestBuffer> vTemp;
+         vTemp.push_back( sbuf );
+
+         ustring codecPath = sbuf.pathName();
+
+         // EncoderFactory picks the appropriate encoder to match type declared in
+         // prototype
+         bytestreams_.push_back(
+            Encoder::EncoderFactory( bytestreamNumber( sbuf ), cVector_, vTemp, codecPath ) );
+      }
+
+      // The bytestreams_ vector must be ordered by bytestreamNumber, not by order
+      // called specified sbufs, so sort it.
+      sort( bytestreams_.begin(), bytestreams_.end(), SortByBytestreamNumber() );
+
+      // Packets hold the header & lengths, a buffer for each bytestream, and padding
+      packetByteCounts_.resize( bytestreams_.size() );
+      packetBuffers_.reserve( bytestreams_.size() + 2 );
+#if ( E57_VALIDATION_LEVEL == VALIDATION_DEEP )
+      // Double check that all bytestreams are specified
+      for ( unsigned i = 0; i < bytestreams_.size(); i++ )
+      {
+         if ( bytestreams_.at( i )->bytestreamNumber() != i )
+         {
+            throw E57_EXCEPTION2( ErrorInternal,
+                                  "bytestreamIndex=" + toString( i ) + " bytestreamNumber=" +
+                                     toString( bytestreams_.at( i )->bytestreamNumber() ) );
+         }
+      }
+#endif
+   }
+
+   void CompressedVectorWriterImpl::startSample()
+   {
+      ImageFile imf( ImageFileImplSharedPtr( cVector_->destImageFile_ ) );
+
+      samples_.resize( sbufs_.size() );
+
+      bool selecting = false;
+
+      for ( size_t i = 0; i < sbufs_.size(); ++i )
+      {
+         const ustring pathName = sbufs_[i].pathName();
+         NodeImplSharedPtr field = proto_->get( pathName );
+         Sample &sample = samples_[i];
+
+         // Keep the codecs given in the CompressedVector
+         sample.select = !cVector_->hasCodec( pathName );
+         selecting = selecting || sample.select;
+
+         switch ( field->type() )
+         {
+            case TypeFloat:
+               if ( std::static_pointer_cast<FloatNodeImpl>( field )->precision() ==
+                    PrecisionSingle )
+               {
+                  sample.floats.resize( sampleSize_ );
+                  sampleBufs_.emplace_back( imf, pathName, sample.floats.data(), sampleSize_ );
+               }
+               else
+               {
+                  sample.doubles.resize( sampleSize_ );
+                  sampleBufs_.emplace_back( imf, pathName, sample.doubles.data(), sampleSize_ );
+               }
+               break;
+
+            case TypeString:
+               sample.strings.resize( sampleSize_ );
+               sampleBufs_.emplace_back( imf, pathName, &sample.strings );
+               break;
+
+            default:
+               sample.integers.resize( sampleSize_ );
+               sampleBufs_.emplace_back( imf, pathName, sample.integers.data(), sampleSize_ );
+               break;
+         }
+      }
+
+      if ( !selecting )
+      {
+         samples_.clear();
+         sampleBufs_.clear();
+         sampleSize_ = 0;
+      }
+   }
+
+   void CompressedVectorWriterImpl::sampleRecords( const size_t recordCount )
+   {
+      const size_t count = std::min( recordCount, sampleSize_ - sampleCount_ );
+
+      // Copy the values the same way the encoders read them
+      for ( size_t i = 0; i < sbufs_.size(); ++i )
+      {
+         SourceDestBufferImpl &source = *sbufs_[i].impl();
+         SourceDestBufferImpl &sample = *sampleBufs_[i].impl();
+         NodeImplSharedPtr field = proto_->get( sbufs_[i].pathName() );
+
+         switch ( field->type() )
+         {
+            case TypeInteger:
+               for ( size_t j = 0; j < count; ++j )
+               {
+                  sample.setNextInt64( source.getNextInt64() );
+               }
+               break;
+
+            case TypeScaledInteger:
+            {
+               auto sini = std::static_pointer_cast<ScaledIntegerNodeImpl>( field );
+
+               for ( size_t j = 0; j < count; ++j )
+               {
+                  sample.setNextInt64( source.getNextInt64( sini->scale(), sini->offset() ) );
+               }
+               break;
+            }
+
+            case TypeFloat:
+               if ( samples_[i].floats.empty() )
+               {
+                  for ( size_t j = 0; j < count; ++j )
+                  {
+                     sample.setNextDouble( source.getNextDouble() );
+                  }
+               }
+               else
+               {
+                  for ( size_t j = 0; j < count; ++j )
+                  {
+                     sample.setNextFloat( source.getNextFloat() );
+                  }
+               }
+               break;
+
+            case TypeString:
+               for ( size_t j = 0; j < count; ++j )
+               {
+                  sample.setNextString( source.getNextString() );
+               }
+               break;
+
+            default:
+               throw E57_EXCEPTION2( ErrorInternal, "pathName=" + sbufs_[i].pathName() );
+         }
+      }
+
+      sampleCount_ += count;
+   }
+
+   void CompressedVectorWriterImpl::finishSample()
+   {
+      if ( sampleCount_ > 0 )
+      {
+         selectCodecs();
+      }
+
+      // Encode the sample, then carry on from the same position in the user's buffers
+      for ( auto &sampleBuf : sampleBufs_ )
+      {
+         sampleBuf.impl()->rewind();
+      }
+
+      createEncoders( sampleBufs_ );
+      encodeRecords( sampleCount_ );
+
+      for ( auto &sbuf : sbufs_ )
+      {
+         std::vector<SourceDestBuffer> vTemp{ sbuf };
+
+         bytestreams_.at( bytestreamNumber( sbuf ) )->sourceBufferSetNew( vTemp );
+      }
+
+      samples_.clear();
+      sampleBufs_.clear();
+      sampleSize_ = 0;
+   }
+
+   void CompressedVectorWriterImpl::selectCodecs()
+   {
+      // Fastest decoding first
+      const Codec cCodecs[] = { CodecBitPack, CodecRunLength, CodecFloatXor, CodecRans };
+
+      std::map<Codec, std::vector<ustring>> fieldsByCodec;
+
+      for ( size_t i = 0; i < sbufs_.size(); ++i )
+      {
+         if ( !samples_[i].select )
+         {
+            continue;
+         }
+
+         CodecSelection selection;
+         selection.pathName = sbufs_[i].pathName();
+         selection.sampleRecordCount = sampleCount_;
+
+         const NodeType type = proto_->get( selection.pathName )->type();
+
+         for ( const Codec codec : cCodecs )
+         {
+            if ( CompressedVectorNodeImpl::codecSupportsType( codec, type ) )
+            {
+               selection.trials.push_back( { codec, 0 } );
+            }
+         }
+
+         if ( selection.trials.size() == 1 )
+         {
+            selection.trials.clear();
+         }
+
+         uint64_t smallest = UINT64_MAX;
+
+         for ( auto &trial : selection.trials )
+         {
+            trial.byteCount = trialEncode( i, trial.codec );
+            smallest = std::min( smallest, trial.byteCount );
+         }
+
+         // The first (fastest decoding) codec within the tolerance of the smallest
+         const double limit = static_cast<double>( smallest ) * ( 1.0 + sizeTolerance_ );
+
+         for ( const auto &trial : selection.trials )
+         {
+            if ( static_cast<double>( trial.byteCount ) <= limit )
+            {
+               selection.codec = trial.codec;
+               break;
+            }
+         }
+
+         if ( selection.codec != CodecBitPack )
+         {
+            fieldsByCodec[selection.codec].push_back( selection.pathName );
+         }
+
+         codecSelections_.push_back( selection );
+      }
+
+      // Record the choices in the codecs of the CompressedVector
+      for ( const auto &entry : fieldsByCodec )
+      {
+         cVector_->appendCodec( entry.first, entry.second );
+      }
+   }
+
+   uint64_t CompressedVectorWriterImpl::trialEncode( size_t sbufIndex, Codec codec )
+   {
+      // Returns the size of the sample of sbufIndex encoded with codec
+      std::vector<SourceDestBuffer> vTemp{ sampleBufs_.at( sbufIndex ) };
+      ustring codecPath = vTemp.at( 0 ).pathName();
+
+      vTemp.at( 0 ).impl()->rewind();
+
+      std::shared_ptr<Encoder> encoder =
+         Encoder::EncoderFactory( 0, cVector_, vTemp, codecPath, codec );
+
+      uint64_t byteCount = 0;
+
+      while ( encoder->currentRecordIndex() < sampleCount_ )
+      {
+         encoder->processRecords(
+            static_cast<size_t>( sampleCount_ - encoder->currentRecordIndex() ) );
+
+         byteCount += encoder->outputAvailable();
+         encoder->outputClear();
+      }
+
+      while ( !encoder->registerFlushToOutput() )
+      {
+         byteCount += encoder->outputAvailable();
+         encoder->outputClear();
+      }
+
+      byteCount += encoder->outputAvailable();
+
+      return byteCount;
    }
 
    size_t CompressedVectorWriterImpl::totalOutputAvailable() const
@@ -410,6 +748,21 @@ namespace e57
       return total;
    }
 
+   size_t CompressedVectorWriterImpl::fullestBytestream() const
+   {
+      size_t fullest = 0;
+
+      for ( size_t i = 1; i < bytestreams_.size(); ++i )
+      {
+         if ( bytestreams_[i]->outputAvailable() > bytestreams_[fullest]->outputAvailable() )
+         {
+            fullest = i;
+         }
+      }
+
+      return fullest;
+   }
+
    size_t CompressedVectorWriterImpl::currentPacketSize() const
    {
       // Calc current packet size
@@ -444,8 +797,8 @@ namespace e57
       std::cout << "  packetMaxPayloadBytes=" << cPacketMaxPayloadBytes << std::endl;
 #endif
 
-      // Allocate vector for number of bytes that each bytestream will write to file.
-      std::vector<size_t> count( cNumByteStreams );
+      // Number of bytes that each bytestream will write to file.
+      std::vector<size_t> &count = packetByteCounts_;
 
       // See if we can fit into a single data packet
       if ( cTotalOutput < cPacketMaxPayloadBytes )
@@ -471,6 +824,38 @@ namespace e57
          }
       }
 
+      return packetWrite( count );
+   }
+
+   uint64_t CompressedVectorWriterImpl::packetWriteBytestream( size_t bytestreamIndex )
+   {
+      const auto cNumByteStreams = bytestreams_.size();
+
+      // Calc maximum number of bytestream values can put in data packet.
+      const size_t cPacketMaxPayloadBytes =
+         DATA_PACKET_MAX - sizeof( DataPacketHeader ) - cNumByteStreams * sizeof( uint16_t );
+
+      // All the other bytestream buffers in the packet are empty
+      std::vector<size_t> &count = packetByteCounts_;
+      std::fill( count.begin(), count.end(), 0 );
+
+      count.at( bytestreamIndex ) =
+         std::min( bytestreams_.at( bytestreamIndex )->outputAvailable(), cPacketMaxPayloadBytes );
+
+      if ( count.at( bytestreamIndex ) == 0 )
+      {
+         return 0;
+      }
+
+      return packetWrite( count );
+   }
+
+   uint64_t CompressedVectorWriterImpl::packetWrite( const std::vector<size_t> &count )
+   {
+      // const bytestreams_ so it's clear it isn't modified in this function
+      const auto &cStreams = bytestreams_;
+      const auto cNumByteStreams = cStreams.size();
+
 #ifdef E57_VERBOSE
       for ( unsigned i = 0; i < cNumByteStreams; ++i )
       {
@@ -479,6 +864,10 @@ namespace e57
 #endif
 
 #if VALIDATE_BASIC
+      // Calc maximum number of bytestream values can put in data packet.
+      const size_t cPacketMaxPayloadBytes =
+         DATA_PACKET_MAX - sizeof( DataPacketHeader ) - cNumByteStreams * sizeof( uint16_t );
+
       // Double check sum of count is <= packetMaxPayloadBytes
       const size_t cTotalByteCount =
          std::accumulate( count.begin(), count.end(), static_cast<size_t>( 0 ) );
@@ -494,7 +883,8 @@ namespace e57
       // Get smart pointer to ImageFileImpl from associated CompressedVector
       ImageFileImplSharedPtr imf( cVector_->destImageFile_ );
 
-      // Use temp buf in object (is 64KBytes long) instead of allocating each time here
+      // Only the header and bytestreamBufferLength[bytestreamCount] are assembled in
+      // dataPacket_. The bytestream buffers are written to the file straight from the encoders.
       char *packet = reinterpret_cast<char *>( &dataPacket_ );
 
       // To be safe, clear header part of packet
@@ -506,43 +896,36 @@ namespace e57
       std::cout << "  packet=" << static_cast<void *>( packet ) << std::endl; //???
       std::cout << "  bsbLength=" << bsbLength << std::endl;                  //???
 #endif
+      size_t packetLength = sizeof( DataPacketHeader ) + cNumByteStreams * sizeof( uint16_t );
+
+      packetBuffers_.clear();
+      packetBuffers_.push_back( { packet, packetLength } );
+
       for ( unsigned i = 0; i < cNumByteStreams; ++i )
       {
-         bsbLength[i] = static_cast<uint16_t>( count.at( i ) ); // %%% Truncation
+         const size_t n = count.at( i );
+
+         bsbLength[i] = static_cast<uint16_t>( n ); // %%% Truncation
 #ifdef E57_VERBOSE
          std::cout << "  Writing " << bsbLength[i] << " bytes into bytestream " << i
                    << std::endl; //???
 #endif
-      }
-
-      // Get pointer to end of data so far
-      auto *p = reinterpret_cast<char *>( &bsbLength[cNumByteStreams] );
-#ifdef E57_VERBOSE
-      std::cout << "  after bsbLength, p=" << static_cast<void *>( p ) << std::endl; //???
-#endif
-
-      // Write contents of each bytestream in dataPacket_
-      for ( size_t i = 0; i < cNumByteStreams; ++i )
-      {
-         size_t n = count.at( i );
 
 #if VALIDATE_BASIC
-         // Double check we aren't accidentally going to write off end of vector<char>
-         if ( &p[n] > &packet[DATA_PACKET_MAX] )
+         // Double check the encoder has that much output
+         if ( n > cStreams.at( i )->outputAvailable() )
          {
             throw E57_EXCEPTION2( ErrorInternal, "n=" + toString( n ) );
          }
 #endif
 
-         // Read from encoder output into packet
-         cStreams.at( i )->outputRead( p, n );
-
-         // Move pointer to end of current data
-         p += n;
+         if ( n > 0 )
+         {
+            packetBuffers_.push_back( { cStreams.at( i )->outputData(), n } );
+            packetLength += n;
+         }
       }
 
-      // Length of packet is difference in beginning pointer and ending pointer
-      auto packetLength = static_cast<unsigned>( p - packet ); //??? pointer diff portable?
 #ifdef E57_VERBOSE
       std::cout << "  packetLength=" << packetLength << std::endl; //???
 #endif
@@ -560,37 +943,47 @@ namespace e57
 #endif
 
       // packetLength must be multiple of 4, if not, add some zero padding
-      while ( packetLength % 4 )
+      static const char cZeroPadding[4] = { 0, 0, 0, 0 };
+
+      if ( packetLength % 4 )
       {
-         // Double check we aren't accidentally going to write off end of
-         // vector<char>
-         if ( p >= &packet[DATA_PACKET_MAX - 1] )
-         {
-            throw E57_EXCEPTION1( ErrorInternal );
-         }
-         *p++ = 0;
-         packetLength++;
+         const size_t cPadding = 4 - packetLength % 4;
+
+         packetBuffers_.push_back( { cZeroPadding, cPadding } );
+         packetLength += cPadding;
 #ifdef E57_VERBOSE
-         std::cout << "  padding with zero byte, new packetLength=" << packetLength
+         std::cout << "  padding with zero bytes, new packetLength=" << packetLength
                    << std::endl; //???
 #endif
       }
 
+      // Double check the packet fits
+      if ( packetLength > DATA_PACKET_MAX )
+      {
+         throw E57_EXCEPTION2( ErrorInternal, "packetLength=" + toString( packetLength ) );
+      }
+
       // Prepare header in dataPacket_, now that we are sure of packetLength
       dataPacket_.header.packetLogicalLengthMinus1 =
          static_cast<uint16_t>( packetLength - 1 ); // %%% Truncation
       dataPacket_.header.bytestreamCount =
          static_cast<uint16_t>( cNumByteStreams ); // %%% Truncation
 
-      // Double check that data packet is well formed
-      dataPacket_.verify( packetLength );
+      // Double check that data packet header is well formed
+      dataPacket_.header.verify( static_cast<unsigned>( packetLength ) );
 
       // Write whole data packet at beginning of free space in file
       uint64_t packetLogicalOffset = imf->allocateSpace( packetLength, false );
       uint64_t packetPhysicalOffset = imf->file_->logicalToPhysical( packetLogicalOffset );
       imf->file_->seek( packetLogicalOffset ); //??? have seekLogical and seekPhysical instead?
                                                // more explicit
-      imf->file_->write( packet, packetLength );
+      imf->file_->write( packetBuffers_.data(), packetBuffers_.size() );
+
+      // The bytestream buffers have been written, remove them from the encoders
+      for ( unsigned i = 0; i < cNumByteStreams; ++i )
+      {
+         cStreams.at( i )->outputSkip( count.at( i ) );
+      }
 
 #ifdef E57_VERBOSE
 //  std::cout << "data packet:" << std::endl;
@@ -733,6 +1126,7 @@ namespace e57
       os << space( indent ) << "recordCount:               " << recordCount_ << std::endl;
       os << space( indent ) << "dataPacketsCount:          " << dataPacketsCount_ << std::endl;
       os << space( indent ) << "indexPacketsCount:         " << indexPacketsCount_ << std::endl;
+      os << space( indent ) << "sampleCount:               " << sampleCount_ << std::endl;
    }
 #endif
 }
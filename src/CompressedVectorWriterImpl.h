@@ -26,11 +26,18 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <functional>
+
+#include "CheckedFile.h"
 #include "Encoder.h"
 #include "Packet.h"
 
 namespace e57
 {
+   /// Called after records have been written, with the buffers they were read from
+   using WriteObserver =
+      std::function<void( const std::vector<SourceDestBuffer> &sbufs, size_t recordCount )>;
+
    class CompressedVectorWriterImpl
    {
    public:
@@ -44,6 +51,10 @@ namespace e57
       std::shared_ptr<CompressedVectorNodeImpl> compressedVectorNode() const;
       void close();
 
+      void setWriteObserver( WriteObserver observer );
+
+      std::vector<CodecSelection> codecSelections() const;
+
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
       void dump( int indent = 0, std::ostream &os = std::cout );
 #endif
@@ -54,9 +65,20 @@ namespace e57
       void checkWriterOpen( const char *srcFileName, int srcLineNumber,
                             const char *srcFunctionName ) const;
       void setBuffers( std::vector<SourceDestBuffer> &sbufs ); //???needed?
+      unsigned bytestreamNumber( const SourceDestBuffer &sbuf ) const;
+      void createEncoders( std::vector<SourceDestBuffer> &sbufs );
+      void encodeRecords( uint64_t endRecordIndex );
+      void startSample();
+      void sampleRecords( size_t recordCount );
+      void finishSample();
+      void selectCodecs();
+      uint64_t trialEncode( size_t sbufIndex, Codec codec );
       size_t totalOutputAvailable() const;
       size_t currentPacketSize() const;
+      size_t fullestBytestream() const;
       uint64_t packetWrite();
+      uint64_t packetWrite( const std::vector<size_t> &count );
+      uint64_t packetWriteBytestream( size_t bytestreamIndex );
       void packetWriteZeroRecords();
 
       void flush();
@@ -68,6 +90,10 @@ namespace e57
       std::vector<std::shared_ptr<Encoder>> bytestreams_;
       DataPacket dataPacket_;
 
+      // Reused for each packet so writing packets doesn't allocate
+      std::vector<size_t> packetByteCounts_;                /// bytes of each bytestream
+      std::vector<CheckedFile::WriteBuffer> packetBuffers_; /// header, bytestreams, padding
+
       bool isOpen_;
       uint64_t sectionHeaderLogicalStart_; /// start of CompressedVector binary section
       uint64_t sectionLogicalLength_;      /// total length of CompressedVector binary section
@@ -76,5 +102,27 @@ namespace e57
       uint64_t recordCount_;               /// number of records written so far
       uint64_t dataPacketsCount_;          /// number of data packets written so far
       uint64_t indexPacketsCount_;         /// number of index packets written so far
+      bool columnGrouped_;                 /// write each packet with a single bytestream
+
+      WriteObserver writeObserver_;
+
+      // Automatic codec selection: the first records are copied to a sample, which is trial
+      // encoded to select the codecs. The encoders are only created once the sample is full.
+      struct Sample
+      {
+         bool select = false; /// select the codec of this field
+
+         std::vector<int64_t> integers; /// Integer and (unscaled) ScaledInteger values
+         std::vector<float> floats;
+         std::vector<double> doubles;
+         std::vector<ustring> strings;
+      };
+
+      size_t sampleSize_;    /// records in a full sample, 0 if not sampling
+      double sizeTolerance_; /// see ImageFileImpl::setCodecSelection()
+      size_t sampleCount_;   /// records in the sample so far
+      std::vector<Sample> samples_;
+      std::vector<SourceDestBuffer> sampleBufs_; /// same order as sbufs_
+      std::vector<CodecSelection> codecSelections_;
    };
 }
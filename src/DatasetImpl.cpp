@@ -0,0 +1,610 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#include "DatasetImpl.h"
+#include "ReaderImpl.h"
+#include "StringFunctions.h"
+
+namespace e57
+{
+   namespace
+   {
+      constexpr char CATALOG_SIGNATURE[] = "E57DatasetCatalog";
+      constexpr int CATALOG_VERSION = 1;
+
+      /// Size of the file in bytes, or 0 if it cannot be read.
+      uint64_t _fileSize( const ustring &filePath )
+      {
+         std::ifstream file( filePath, std::ios::binary | std::ios::ate );
+
+         if ( !file )
+         {
+            return 0;
+         }
+
+         const auto size = file.tellg();
+
+         return ( size < 0 ) ? 0 : static_cast<uint64_t>( size );
+      }
+
+      /// Reads the rest of the line after the single space separating it from the previous field.
+      ustring _readTrailingString( std::istringstream &stream )
+      {
+         ustring str;
+
+         stream.get();
+         std::getline( stream, str );
+
+         return str;
+      }
+   }
+
+   /// Threads running the reading task of DatasetImpl::ReadPoints() alongside the calling thread,
+   /// kept for all the calls so threads aren't started for every call.
+   class DatasetWorkers
+   {
+   public:
+      explicit DatasetWorkers( size_t workerCount )
+      {
+         for ( size_t i = 0; i < workerCount; ++i )
+         {
+            threads_.emplace_back( &DatasetWorkers::work, this );
+         }
+      }
+
+      ~DatasetWorkers()
+      {
+         {
+            std::lock_guard<std::mutex> lock( mutex_ );
+            stop_ = true;
+         }
+
+         start_.notify_all();
+
+         for ( auto &thread : threads_ )
+         {
+            thread.join();
+         }
+      }
+
+      DatasetWorkers( const DatasetWorkers & ) = delete;
+      DatasetWorkers &operator=( const DatasetWorkers & ) = delete;
+
+      /// Runs task on every worker and on the calling thread, and waits until they have all
+      /// returned. task must not throw.
+      void run( const std::function<void()> &task )
+      {
+         {
+            std::lock_guard<std::mutex> lock( mutex_ );
+
+            task_ = &task;
+            remaining_ = threads_.size();
+            ++generation_;
+         }
+
+         start_.notify_all();
+
+         task();
+
+         std::unique_lock<std::mutex> lock( mutex_ );
+         done_.wait( lock, [this] { return remaining_ == 0; } );
+
+         task_ = nullptr;
+      }
+
+   private:
+      void work()
+      {
+         uint64_t generation = 0;
+
+         while ( true )
+         {
+            std::unique_lock<std::mutex> lock( mutex_ );
+            start_.wait( lock, [&] { return stop_ || ( generation_ != generation ); } );
+
+            if ( stop_ )
+            {
+               return;
+            }
+
+            generation = generation_;
+
+            const std::function<void()> &task = *task_;
+
+            lock.unlock();
+
+            task();
+
+            lock.lock();
+
+            if ( --remaining_ == 0 )
+            {
+               done_.notify_one();
+            }
+         }
+      }
+
+      std::vector<std::thread> threads_;
+
+      std::mutex mutex_;
+      std::condition_variable start_;
+      std::condition_variable done_;
+
+      const std::function<void()> *task_ = nullptr;
+      size_t remaining_ = 0;
+      uint64_t generation_ = 0;
+      bool stop_ = false;
+   };
+
+   DatasetImpl::DatasetImpl( const std::vector<ustring> &filePaths,
+                             const DatasetOptions &options ) :
+      readerOptions_( options.readerOptions ),
+      maxOpenFiles_( std::max<size_t>( 1, options.maxOpenFiles ) )
+   {
+      unsigned threadCount = options.threadCount;
+
+      if ( threadCount == 0 )
+      {
+         threadCount = std::max( 1U, std::thread::hardware_concurrency() );
+      }
+
+      // Each thread holds at most one open file, so this guarantees a thread can always open the
+      // file it needs.
+      threadCount_ = static_cast<unsigned>( std::min<size_t>( threadCount, maxOpenFiles_ ) );
+
+      // The memory budget is shared by the files being read at the same time.
+      readerOptions_.memoryBudget = options.memoryBudget / threadCount_;
+
+      files_.reserve( filePaths.size() );
+
+      for ( const auto &path : filePaths )
+      {
+         std::unique_ptr<File> file( new File );
+
+         file->path = path;
+         file->size = _fileSize( path );
+
+         files_.push_back( std::move( file ) );
+      }
+
+      if ( !options.catalogCachePath.empty() && loadCatalog( options.catalogCachePath ) )
+      {
+         return;
+      }
+
+      buildCatalog();
+
+      if ( !options.catalogCachePath.empty() )
+      {
+         // The cache is an optimization, so failing to write it is not an error.
+         SaveCatalog( options.catalogCachePath );
+      }
+   }
+
+   DatasetImpl::~DatasetImpl() = default;
+
+   size_t DatasetImpl::GetFileCount() const
+   {
+      return files_.size();
+   }
+
+   int64_t DatasetImpl::GetScanCount() const
+   {
+      return static_cast<int64_t>( catalog_.size() );
+   }
+
+   bool DatasetImpl::GetScan( int64_t scanIndex, DatasetScan &scan ) const
+   {
+      if ( ( scanIndex < 0 ) || ( scanIndex >= GetScanCount() ) )
+      {
+         return false;
+      }
+
+      scan = catalog_[static_cast<size_t>( scanIndex )];
+
+      return true;
+   }
+
+   bool DatasetImpl::SaveCatalog( const ustring &catalogPath ) const
+   {
+      std::ofstream out( catalogPath, std::ios::trunc );
+
+      if ( !out )
+      {
+         return false;
+      }
+
+      out.imbue( std::locale::classic() );
+      out.precision( std::numeric_limits<double>::max_digits10 );
+
+      out << CATALOG_SIGNATURE << " " << CATALOG_VERSION << "\n";
+
+      out << "files " << files_.size() << "\n";
+
+      for ( const auto &file : files_ )
+      {
+         out << file->size << " " << file->path << "\n";
+      }
+
+      out << "scans " << catalog_.size() << "\n";
+
+      for ( const auto &scan : catalog_ )
+      {
+         const auto &rotation = scan.pose.rotation;
+         const auto &translation = scan.pose.translation;
+         const auto &bounds = scan.cartesianBounds;
+
+         out << scan.fileIndex << " " << scan.dataIndex << " " << scan.pointCount << " "
+             << rotation.w << " " << rotation.x << " " << rotation.y << " " << rotation.z << " "
+             << translation.x << " " << translation.y << " " << translation.z << " "
+             << bounds.xMinimum << " " << bounds.xMaximum << " " << bounds.yMinimum << " "
+             << bounds.yMaximum << " " << bounds.zMinimum << " " << bounds.zMaximum << " "
+             << scan.guid << "\n";
+      }
+
+      return static_cast<bool>( out );
+   }
+
+   void DatasetImpl::ReadPoints( const std::vector<int64_t> &scanIndices,
+                                 const DatasetPointsCallback &callback )
+   {
+      // Interleave the scans by file so that the threads work on different files.
+      std::map<size_t, std::vector<size_t>> scansByFile;
+
+      for ( const auto scanIndex : scanIndices )
+      {
+         if ( ( scanIndex < 0 ) || ( scanIndex >= GetScanCount() ) )
+         {
+            throw E57_EXCEPTION2( ErrorBadAPIArgument, "scanIndex=" + toString( scanIndex ) );
+         }
+
+         const auto index = static_cast<size_t>( scanIndex );
+
+         scansByFile[catalog_[index].fileIndex].push_back( index );
+      }
+
+      std::vector<size_t> work;
+      work.reserve( scanIndices.size() );
+
+      for ( size_t round = 0; work.size() < scanIndices.size(); ++round )
+      {
+         for ( const auto &fileScans : scansByFile )
+         {
+            if ( round < fileScans.second.size() )
+            {
+               work.push_back( fileScans.second[round] );
+            }
+         }
+      }
+
+      std::atomic<size_t> nextWork( 0 );
+      std::atomic<bool> failed( false );
+      std::exception_ptr error;
+      std::mutex errorMutex;
+
+      const std::function<void()> worker = [&]() {
+         while ( !failed )
+         {
+            const size_t workIndex = nextWork++;
+
+            if ( workIndex >= work.size() )
+            {
+               return;
+            }
+
+            try
+            {
+               readScan( catalog_[work[workIndex]], callback );
+            }
+            catch ( ... )
+            {
+               std::lock_guard<std::mutex> lock( errorMutex );
+
+               if ( !error )
+               {
+                  error = std::current_exception();
+               }
+
+               failed = true;
+            }
+         }
+      };
+
+      // The calling thread is one of the workers.
+      if ( ( threadCount_ > 1 ) && ( work.size() > 1 ) )
+      {
+         std::lock_guard<std::mutex> lock( readPointsMutex_ );
+
+         if ( workers_ == nullptr )
+         {
+            workers_.reset( new DatasetWorkers( threadCount_ - 1 ) );
+         }
+
+         workers_->run( worker );
+      }
+      else
+      {
+         worker();
+      }
+
+      if ( error )
+      {
+         std::rethrow_exception( error );
+      }
+   }
+
+   std::shared_ptr<ReaderImpl> DatasetImpl::acquireReader( size_t fileIndex )
+   {
+      std::unique_lock<std::mutex> lock( filesMutex_ );
+
+      File &file = *files_.at( fileIndex );
+
+      if ( file.reader == nullptr )
+      {
+         // Close the least recently used file which isn't in use if we are at the limit.
+         while ( openFileCount_ >= maxOpenFiles_ )
+         {
+            File *oldest = nullptr;
+
+            for ( auto &candidate : files_ )
+            {
+               if ( ( candidate->reader != nullptr ) && ( candidate->useCount == 0 ) &&
+                    ( ( oldest == nullptr ) || ( candidate->lastUsed < oldest->lastUsed ) ) )
+               {
+                  oldest = candidate.get();
+               }
+            }
+
+            if ( oldest == nullptr )
+            {
+               fileReleased_.wait( lock );
+               continue;
+            }
+
+            oldest->reader.reset();
+            --openFileCount_;
+         }
+
+         file.reader = std::make_shared<ReaderImpl>( file.path, readerOptions_ );
+         ++openFileCount_;
+      }
+
+      ++file.useCount;
+      file.lastUsed = ++useCounter_;
+
+      return file.reader;
+   }
+
+   void DatasetImpl::releaseReader( size_t fileIndex )
+   {
+      {
+         std::lock_guard<std::mutex> lock( filesMutex_ );
+
+         --files_.at( fileIndex )->useCount;
+      }
+
+      fileReleased_.notify_one();
+   }
+
+   void DatasetImpl::buildCatalog()
+   {
+      catalog_.clear();
+
+      for ( size_t fileIndex = 0; fileIndex < files_.size(); ++fileIndex )
+      {
+         const auto reader = acquireReader( fileIndex );
+
+         try
+         {
+            const int64_t data3DCount = reader->GetData3DCount();
+
+            for ( int64_t dataIndex = 0; dataIndex < data3DCount; ++dataIndex )
+            {
+               Data3D header;
+
+               if ( !reader->ReadData3D( dataIndex, header ) )
+               {
+                  throw E57_EXCEPTION2( ErrorInternal, "fileName=" + files_[fileIndex]->path +
+                                                          " dataIndex=" + toString( dataIndex ) );
+               }
+
+               DatasetScan scan;
+
+               scan.fileIndex = fileIndex;
+               scan.filePath = files_[fileIndex]->path;
+               scan.dataIndex = dataIndex;
+               scan.guid = header.guid;
+               scan.pose = header.pose;
+               scan.cartesianBounds = header.cartesianBounds;
+               scan.pointCount = static_cast<int64_t>( header.pointCount );
+
+               catalog_.push_back( scan );
+            }
+         }
+         catch ( ... )
+         {
+            releaseReader( fileIndex );
+            throw;
+         }
+
+         releaseReader( fileIndex );
+      }
+   }
+
+   bool DatasetImpl::loadCatalog( const ustring &catalogPath )
+   {
+      std::ifstream in( catalogPath );
+
+      if ( !in )
+      {
+         return false;
+      }
+
+      ustring line;
+      ustring signature;
+      int version = 0;
+
+      if ( !std::getline( in, line ) )
+      {
+         return false;
+      }
+
+      std::istringstream headerStream( line );
+      headerStream.imbue( std::locale::classic() );
+
+      headerStream >> signature >> version;
+
+      if ( ( signature != CATALOG_SIGNATURE ) || ( version != CATALOG_VERSION ) )
+      {
+         return false;
+      }
+
+      // Files must match what we were given, and must not have changed size.
+      ustring keyword;
+      size_t fileCount = 0;
+
+      if ( !std::getline( in, line ) )
+      {
+         return false;
+      }
+
+      std::istringstream filesStream( line );
+
+      if ( !( filesStream >> keyword >> fileCount ) || ( keyword != "files" ) ||
+           ( fileCount != files_.size() ) )
+      {
+         return false;
+      }
+
+      for ( const auto &file : files_ )
+      {
+         uint64_t size = 0;
+
+         if ( !std::getline( in, line ) )
+         {
+            return false;
+         }
+
+         std::istringstream fileStream( line );
+
+         if ( !( fileStream >> size ) || ( size != file->size ) ||
+              ( _readTrailingString( fileStream ) != file->path ) )
+         {
+            return false;
+         }
+      }
+
+      size_t scanCount = 0;
+
+      if ( !std::getline( in, line ) )
+      {
+         return false;
+      }
+
+      std::istringstream scansStream( line );
+
+      if ( !( scansStream >> keyword >> scanCount ) || ( keyword != "scans" ) )
+      {
+         return false;
+      }
+
+      std::vector<DatasetScan> catalog( scanCount );
+
+      for ( auto &scan : catalog )
+      {
+         if ( !std::getline( in, line ) )
+         {
+            return false;
+         }
+
+         std::istringstream scanStream( line );
+         scanStream.imbue( std::locale::classic() );
+
+         auto &rotation = scan.pose.rotation;
+         auto &translation = scan.pose.translation;
+         auto &bounds = scan.cartesianBounds;
+
+         scanStream >> scan.fileIndex >> scan.dataIndex >> scan.pointCount >> rotation.w >>
+            rotation.x >> rotation.y >> rotation.z >> translation.x >> translation.y >>
+            translation.z >> bounds.xMinimum >> bounds.xMaximum >> bounds.yMinimum >>
+            bounds.yMaximum >> bounds.zMinimum >> bounds.zMaximum;
+
+         if ( !scanStream || ( scan.fileIndex >= files_.size() ) || ( scan.dataIndex < 0 ) ||
+              ( scan.pointCount < 0 ) )
+         {
+            return false;
+         }
+
+         scan.guid = _readTrailingString( scanStream );
+         scan.filePath = files_[scan.fileIndex]->path;
+      }
+
+      catalog_ = std::move( catalog );
+
+      return true;
+   }
+
+   void DatasetImpl::readScan( const DatasetScan &scan, const DatasetPointsCallback &callback )
+   {
+      if ( scan.pointCount == 0 )
+      {
+         return;
+      }
+
+      File &file = *files_.at( scan.fileIndex );
+
+      std::lock_guard<std::mutex> fileLock( file.readMutex );
+
+      const auto reader = acquireReader( scan.fileIndex );
+
+      try
+      {
+         // The catalog may be out of date if it was loaded from the cache
+         if ( ( scan.dataIndex < 0 ) || ( scan.dataIndex >= reader->GetData3DCount() ) )
+         {
+            throw E57_EXCEPTION2( ErrorBadAPIArgument,
+                                  "fileName=" + file.path +
+                                     " dataIndex=" + toString( scan.dataIndex ) );
+         }
+
+         Data3D header;
+
+         if ( !reader->ReadData3D( scan.dataIndex, header ) )
+         {
+            throw E57_EXCEPTION2( ErrorInternal, "fileName=" + file.path +
+                                                    " dataIndex=" + toString( scan.dataIndex ) );
+         }
+
+         const auto estimate = reader->EstimateMemory( scan.dataIndex, {} );
+
+         Data3DPointsDouble buffers( header, estimate.chunkPointCount );
+
+         auto vectorReader =
+            reader->SetUpData3DPointsData( scan.dataIndex, estimate.chunkPointCount, buffers );
+
+         unsigned count = 0;
+
+         while ( ( count = vectorReader.read() ) > 0 )
+         {
+            callback( scan, buffers, count );
+         }
+
+         vectorReader.close();
+      }
+      catch ( ... )
+      {
+         releaseReader( scan.fileIndex );
+         throw;
+      }
+
+      releaseReader( scan.fileIndex );
+   }
+} // end namespace e57
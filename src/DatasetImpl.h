@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+
+#include "Common.h"
+#include "E57SimpleDataset.h"
+
+namespace e57
+{
+   class DatasetWorkers;
+   class ReaderImpl;
+
+   class DatasetImpl
+   {
+   public:
+      DatasetImpl( const std::vector<ustring> &filePaths, const DatasetOptions &options );
+      ~DatasetImpl();
+
+      // disallow copying a DatasetImpl
+      DatasetImpl( const DatasetImpl & ) = delete;
+      DatasetImpl &operator=( DatasetImpl const & ) = delete;
+      DatasetImpl( const DatasetImpl && ) = delete;
+      DatasetImpl &operator=( const DatasetImpl && ) = delete;
+
+      size_t GetFileCount() const;
+
+      int64_t GetScanCount() const;
+
+      bool GetScan( int64_t scanIndex, DatasetScan &scan ) const;
+
+      bool SaveCatalog( const ustring &catalogPath ) const;
+
+      void ReadPoints( const std::vector<int64_t> &scanIndices,
+                       const DatasetPointsCallback &callback );
+
+   private:
+      struct File
+      {
+         ustring path;
+         uint64_t size = 0;
+
+         // Open reader, or nullptr if the file is closed
+         std::shared_ptr<ReaderImpl> reader;
+
+         // Number of users of reader (the file can only be closed when this is 0)
+         int useCount = 0;
+
+         // Value of useCounter_ when last acquired (to find the least recently used file)
+         uint64_t lastUsed = 0;
+
+         // Only one thread reads a file at a time
+         std::mutex readMutex;
+      };
+
+      std::shared_ptr<ReaderImpl> acquireReader( size_t fileIndex );
+      void releaseReader( size_t fileIndex );
+
+      void buildCatalog();
+      bool loadCatalog( const ustring &catalogPath );
+
+      void readScan( const DatasetScan &scan, const DatasetPointsCallback &callback );
+
+      ReaderOptions readerOptions_;
+      size_t maxOpenFiles_;
+      unsigned threadCount_;
+
+      std::vector<std::unique_ptr<File>> files_;
+      std::vector<DatasetScan> catalog_;
+
+      // Protects opening & closing the files. Also serializes the XML parsing on open which isn't
+      // thread safe.
+      std::mutex filesMutex_;
+      std::condition_variable fileReleased_;
+      size_t openFileCount_ = 0;
+      uint64_t useCounter_ = 0;
+
+      // Threads reading alongside the calling thread in ReadPoints(), kept for all the calls. Only
+      // one ReadPoints() runs at a time.
+      std::mutex readPointsMutex_;
+      std::unique_ptr<DatasetWorkers> workers_;
+   };
+} // end namespace e57
@@ -28,6 +28,7 @@
 #include <algorithm>
 #include <cstring>
 
+#include "CodecFormat.h"
 #include "CompressedVectorNodeImpl.h"
 #include "Decoder.h"
 #include "FloatNodeImpl.h"
@@ -39,6 +40,47 @@
 
 using namespace e57;
 
+namespace
+{
+   // Get bitCount (at most 32) bits of inbuf starting at bit, packed least significant first.
+   // Only reads the bytes holding those bits.
+   inline uint64_t _getBits( const char *inbuf, size_t bit, unsigned bitCount )
+   {
+      const auto bytes = reinterpret_cast<const uint8_t *>( inbuf ) + bit / 8;
+      const unsigned shift = bit % 8;
+      const unsigned byteCount = ( shift + bitCount + 7 ) / 8;
+
+      uint64_t value = 0;
+      for ( unsigned i = 0; i < byteCount; ++i )
+      {
+         value |= static_cast<uint64_t>( bytes[i] ) << ( 8 * i );
+      }
+
+      return ( value >> shift ) & ( ( 1ULL << bitCount ) - 1 );
+   }
+
+   // Set the next value of the dest buffer from raw IEEE bits
+   inline void _setNextValueBits( SourceDestBufferImpl &dbuf, uint32_t bits )
+   {
+      float value = 0.0F;
+      memcpy( &value, &bits, sizeof( value ) );
+      dbuf.setNextFloat( value );
+   }
+
+   inline void _setNextValueBits( SourceDestBufferImpl &dbuf, uint64_t bits )
+   {
+      double value = 0.0;
+      memcpy( &value, &bits, sizeof( value ) );
+      dbuf.setNextDouble( value );
+   }
+
+   // Inverse of the zigzag mapping of differences used by RansEncoder
+   inline uint64_t _unzigzag( uint64_t value )
+   {
+      return ( value >> 1 ) ^ ( 0 - ( value & 1 ) );
+   }
+}
+
 std::shared_ptr<Decoder> Decoder::DecoderFactory( unsigned bytestreamNumber, //!!! name ok?
                                                   const CompressedVectorNodeImpl *cVector,
                                                   std::vector<SourceDestBuffer> &dbufs,
@@ -58,6 +100,9 @@ std::shared_ptr<Decoder> Decoder::DecoderFactory( unsigned bytestreamNumber, //!
 
    uint64_t maxRecordCount = cVector->childCount();
 
+   // Codec selected for this node in the codecs of the CompressedVector
+   const Codec codec = cVector->codecFor( path );
+
    switch ( decodeNode->type() )
    {
       case TypeInteger:
@@ -65,6 +110,22 @@ std::shared_ptr<Decoder> Decoder::DecoderFactory( unsigned bytestreamNumber, //!
          std::shared_ptr<IntegerNodeImpl> ini =
             std::static_pointer_cast<IntegerNodeImpl>( decodeNode ); // downcast to correct type
 
+         if ( codec == CodecRunLength )
+         {
+            std::shared_ptr<Decoder> decoder(
+               new RunLengthDecoder( false, bytestreamNumber, dbufs.at( 0 ), ini->minimum(),
+                                     ini->maximum(), 1.0, 0.0, maxRecordCount ) );
+            return decoder;
+         }
+
+         if ( codec == CodecRans )
+         {
+            std::shared_ptr<Decoder> decoder(
+               new RansDecoder( false, bytestreamNumber, dbufs.at( 0 ), ini->minimum(),
+                                ini->maximum(), 1.0, 0.0, maxRecordCount ) );
+            return decoder;
+         }
+
          // Get pointer to parent ImageFileImpl, to call bitsNeeded()
          ImageFileImplSharedPtr imf(
             decodeNode->destImageFile_ ); //??? should be function for this,
@@ -119,6 +180,22 @@ std::shared_ptr<Decoder> Decoder::DecoderFactory( unsigned bytestreamNumber, //!
             std::static_pointer_cast<ScaledIntegerNodeImpl>(
                decodeNode ); // downcast to correct type
 
+         if ( codec == CodecRunLength )
+         {
+            std::shared_ptr<Decoder> decoder( new RunLengthDecoder(
+               true, bytestreamNumber, dbufs.at( 0 ), sini->minimum(), sini->maximum(),
+               sini->scale(), sini->offset(), maxRecordCount ) );
+            return decoder;
+         }
+
+         if ( codec == CodecRans )
+         {
+            std::shared_ptr<Decoder> decoder( new RansDecoder(
+               true, bytestreamNumber, dbufs.at( 0 ), sini->minimum(), sini->maximum(),
+               sini->scale(), sini->offset(), maxRecordCount ) );
+            return decoder;
+         }
+
          // Get pointer to parent ImageFileImpl, to call bitsNeeded()
          ImageFileImplSharedPtr imf(
             decodeNode->destImageFile_ ); //??? should be function for this,
@@ -173,6 +250,13 @@ std::shared_ptr<Decoder> Decoder::DecoderFactory( unsigned bytestreamNumber, //!
          std::shared_ptr<FloatNodeImpl> fni =
             std::static_pointer_cast<FloatNodeImpl>( decodeNode ); // downcast to correct type
 
+         if ( codec == CodecFloatXor )
+         {
+            std::shared_ptr<Decoder> decoder( new FloatXorDecoder(
+               bytestreamNumber, dbufs.at( 0 ), fni->precision(), maxRecordCount ) );
+            return decoder;
+         }
+
          std::shared_ptr<Decoder> decoder( new BitpackFloatDecoder(
             bytestreamNumber, dbufs.at( 0 ), fni->precision(), maxRecordCount ) );
          return decoder;
@@ -197,10 +281,21 @@ Decoder::Decoder( unsigned bytestreamNumber ) : bytestreamNumber_( bytestreamNum
 {
 }
 
+bool Decoder::fixedRecordSize( unsigned & /*bitsPerRecord*/, unsigned & /*bytesPerWord*/ ) const
+{
+   return false;
+}
+
+void Decoder::seekRecord( uint64_t recordIndex, size_t firstBit )
+{
+   throw E57_EXCEPTION2( ErrorInternal, "recordIndex=" + toString( recordIndex ) +
+                                           " firstBit=" + toString( firstBit ) );
+}
+
 BitpackDecoder::BitpackDecoder( unsigned bytestreamNumber, SourceDestBuffer &dbuf,
                                 unsigned alignmentSize, uint64_t maxRecordCount ) :
    Decoder( bytestreamNumber ), maxRecordCount_( maxRecordCount ), destBuffer_( dbuf.impl() ),
-   inBuffer_( 1024 ), // !!! need to pick smarter channel buffer sizes
+   inBuffer_( DECODER_BUFFER_SIZE, ResourceAllocator<char>( bufferMemoryResource( dbuf ) ) ),
    inBufferAlignmentSize_( alignmentSize ), bitsPerWord_( 8 * alignmentSize ),
    bytesPerWord_( alignmentSize )
 {
@@ -272,9 +367,16 @@ size_t BitpackDecoder::inputProcess( const char *source, const size_t availableB
       std::cout << "  feeding aligned decoder " << endBit - inBufferFirstBit_ << " bits."
                 << std::endl;
 #endif
-      bitsEaten =
-         inputProcessAligned( &inBuffer_[firstWord * bytesPerWord_],
-                              inBufferFirstBit_ - firstNaturalBit, endBit - firstNaturalBit );
+
+      // After seekRecord(), the first bit may be past the few bytes we have so far
+      bitsEaten = 0;
+
+      if ( endBit >= inBufferFirstBit_ )
+      {
+         bitsEaten =
+            inputProcessAligned( &inBuffer_[firstWord * bytesPerWord_],
+                                 inBufferFirstBit_ - firstNaturalBit, endBit - firstNaturalBit );
+      }
 #ifdef E57_VERBOSE
       std::cout << "  bitsEaten=" << bitsEaten << " firstWord=" << firstWord
                 << " firstNaturalBit=" << firstNaturalBit << " endBit=" << endBit << std::endl;
@@ -302,12 +404,27 @@ size_t BitpackDecoder::inputProcess( const char *source, const size_t availableB
    return ( availableByteCount - bytesUnsaved );
 }
 
-void BitpackDecoder::stateReset()
+void BitpackDecoder::stateReset( uint64_t maxRecordCount )
 {
+   currentRecordIndex_ = 0;
+   maxRecordCount_ = maxRecordCount;
    inBufferFirstBit_ = 0;
    inBufferEndByte_ = 0;
 }
 
+void BitpackDecoder::seekRecord( uint64_t recordIndex, size_t firstBit )
+{
+   if ( firstBit >= bitsPerWord_ )
+   {
+      throw E57_EXCEPTION2( ErrorInternal, "firstBit=" + toString( firstBit ) );
+   }
+
+   // Drop whatever input we had, the next input starts with the word holding the record
+   currentRecordIndex_ = recordIndex;
+   inBufferFirstBit_ = firstBit;
+   inBufferEndByte_ = 0;
+}
+
 void BitpackDecoder::inBufferShiftDown()
 {
    // Move uneaten data down to beginning of inBuffer_.
@@ -374,6 +491,14 @@ BitpackFloatDecoder::BitpackFloatDecoder( unsigned bytestreamNumber, SourceDestB
 {
 }
 
+bool BitpackFloatDecoder::fixedRecordSize( unsigned &bitsPerRecord, unsigned &bytesPerWord ) const
+{
+   bytesPerWord = bytesPerWord_;
+   bitsPerRecord = bitsPerWord_;
+
+   return true;
+}
+
 size_t BitpackFloatDecoder::inputProcessAligned( const char *inbuf, const size_t firstBit,
                                                  const size_t endBit )
 {
@@ -484,6 +609,680 @@ void BitpackFloatDecoder::dump( int indent, std::ostream &os )
 
 //================================================================
 
+FloatXorDecoder::FloatXorDecoder( unsigned bytestreamNumber, SourceDestBuffer &dbuf,
+                                  FloatPrecision precision, uint64_t maxRecordCount ) :
+   BitpackDecoder( bytestreamNumber, dbuf, 1, maxRecordCount ), precision_( precision )
+{
+}
+
+size_t FloatXorDecoder::inputProcessAligned( const char *inbuf, const size_t firstBit,
+                                             const size_t endBit )
+{
+#ifdef E57_VERBOSE
+   std::cout << "FloatXorDecoder::inputProcessAligned() called, inbuf="
+             << reinterpret_cast<const void *>( inbuf ) << " firstBit=" << firstBit
+             << " endBit=" << endBit << std::endl;
+#endif
+   size_t n = destBuffer_->capacity() - destBuffer_->nextIndex();
+
+   // Can't process more than defined in input file
+   if ( n > maxRecordCount_ - currentRecordIndex_ )
+   {
+      n = static_cast<size_t>( maxRecordCount_ - currentRecordIndex_ );
+   }
+
+   if ( precision_ == PrecisionSingle )
+   {
+      return decodeRecords<uint32_t>( inbuf, firstBit, endBit, n );
+   }
+
+   return decodeRecords<uint64_t>( inbuf, firstBit, endBit, n );
+}
+
+template <typename WordT>
+size_t FloatXorDecoder::decodeRecords( const char *inbuf, const size_t firstBit,
+                                       const size_t endBit, const size_t n )
+{
+   constexpr unsigned WordBits = sizeof( WordT ) * 8;
+   constexpr unsigned CountBits = ( WordBits == 32 ) ? 5 : 6;
+   constexpr unsigned CountMask = ( 1U << CountBits ) - 1;
+   constexpr unsigned HeaderBits = 2 * CountBits + 1;
+
+   auto previous = static_cast<WordT>( previousValue_ );
+
+   size_t bit = firstBit;
+   size_t i = 0;
+
+   // Only decode whole records. A record split across packets is completed on the next call.
+   for ( ; ( i < n ) && ( bit < endBit ); ++i )
+   {
+      WordT x = 0;
+
+      if ( _getBits( inbuf, bit, 1 ) == 0 )
+      {
+         // Same value as the previous record
+         ++bit;
+      }
+      else
+      {
+         if ( endBit - bit < HeaderBits )
+         {
+            break;
+         }
+
+         const auto header = static_cast<unsigned>( _getBits( inbuf, bit, HeaderBits ) );
+         const unsigned leadingZeros = ( header >> 1 ) & CountMask;
+         const unsigned meaningfulBits = ( header >> ( CountBits + 1 ) ) + 1;
+
+         if ( leadingZeros + meaningfulBits > WordBits )
+         {
+            throw E57_EXCEPTION2( ErrorBadCVPacket,
+                                  "leadingZeros=" + toString( leadingZeros ) +
+                                     " meaningfulBits=" + toString( meaningfulBits ) );
+         }
+
+         if ( endBit - bit < HeaderBits + meaningfulBits )
+         {
+            break;
+         }
+
+         const size_t valueBit = bit + HeaderBits;
+
+         uint64_t meaningful = 0;
+         if ( meaningfulBits > 32 )
+         {
+            meaningful = _getBits( inbuf, valueBit, 32 ) |
+                         ( _getBits( inbuf, valueBit + 32, meaningfulBits - 32 ) << 32 );
+         }
+         else
+         {
+            meaningful = _getBits( inbuf, valueBit, meaningfulBits );
+         }
+
+         x = static_cast<WordT>( meaningful << ( WordBits - leadingZeros - meaningfulBits ) );
+
+         bit += HeaderBits + meaningfulBits;
+      }
+
+      previous ^= x;
+
+      _setNextValueBits( *destBuffer_, previous );
+   }
+
+   previousValue_ = previous;
+
+   // Update counts of records processed
+   currentRecordIndex_ += i;
+
+   return ( bit - firstBit );
+}
+
+void FloatXorDecoder::stateReset( uint64_t maxRecordCount )
+{
+   BitpackDecoder::stateReset( maxRecordCount );
+
+   previousValue_ = 0;
+}
+
+#ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
+void FloatXorDecoder::dump( int indent, std::ostream &os )
+{
+   BitpackDecoder::dump( indent, os );
+   if ( precision_ == PrecisionSingle )
+   {
+      os << space( indent ) << "precision:                Single" << std::endl;
+   }
+   else
+   {
+      os << space( indent ) << "precision:                Double" << std::endl;
+   }
+}
+#endif
+
+//================================================================
+
+RunLengthDecoder::RunLengthDecoder( bool isScaledInteger, unsigned bytestreamNumber,
+                                    SourceDestBuffer &dbuf, int64_t minimum, int64_t maximum,
+                                    double scale, double offset, uint64_t maxRecordCount ) :
+   BitpackDecoder( bytestreamNumber, dbuf, 1, maxRecordCount ), isScaledInteger_( isScaledInteger ),
+   minimum_( minimum ), maximum_( maximum ), scale_( scale ), offset_( offset ),
+   dictionary_( ResourceAllocator<int64_t>( bufferMemoryResource( dbuf ) ) )
+{
+}
+
+size_t RunLengthDecoder::inputProcessAligned( const char *inbuf, const size_t firstBit,
+                                              const size_t endBit )
+{
+#ifdef E57_VERBOSE
+   std::cout << "RunLengthDecoder::inputProcessAligned() called, inbuf="
+             << reinterpret_cast<const void *>( inbuf ) << " firstBit=" << firstBit
+             << " endBit=" << endBit << std::endl;
+#endif
+   // Runs are whole bytes, so we always start on a byte boundary
+   if ( firstBit % 8 != 0 )
+   {
+      throw E57_EXCEPTION2( ErrorInternal, "firstBit=" + toString( firstBit ) );
+   }
+
+   const size_t endByte = endBit / 8;
+   size_t byte = firstBit / 8;
+
+   while ( currentRecordIndex_ < maxRecordCount_ )
+   {
+      if ( runRemaining_ == 0 )
+      {
+         const size_t runBytes = getRun( &inbuf[byte], endByte - byte );
+
+         // Wait for the rest of the run
+         if ( runBytes == 0 )
+         {
+            break;
+         }
+
+         byte += runBytes;
+      }
+
+      size_t n = destBuffer_->capacity() - destBuffer_->nextIndex();
+
+      if ( n == 0 )
+      {
+         break;
+      }
+
+      if ( n > runRemaining_ )
+      {
+         n = static_cast<size_t>( runRemaining_ );
+      }
+
+      if ( n > maxRecordCount_ - currentRecordIndex_ )
+      {
+         n = static_cast<size_t>( maxRecordCount_ - currentRecordIndex_ );
+      }
+
+      // Convert the value once, then copy it for the rest of the run.
+      if ( isScaledInteger_ )
+      {
+         destBuffer_->setNextInt64( runValue_, scale_, offset_ );
+      }
+      else
+      {
+         destBuffer_->setNextInt64( runValue_ );
+      }
+
+      destBuffer_->setNextRepeated( n - 1 );
+
+      runRemaining_ -= n;
+      currentRecordIndex_ += n;
+   }
+
+   return ( byte * 8 - firstBit );
+}
+
+size_t RunLengthDecoder::getRun( const char *inbuf, size_t byteCount )
+{
+   // Returns the number of bytes of the run, or 0 if it isn't complete in inbuf.
+   if ( byteCount == 0 )
+   {
+      return 0;
+   }
+
+   const auto tag = static_cast<uint8_t>( inbuf[0] );
+   size_t used = 1;
+
+   int64_t value = 0;
+
+   if ( tag == RUN_LENGTH_LITERAL_TAG )
+   {
+      uint64_t literal = 0;
+
+      const size_t literalBytes = varintGet( &inbuf[used], byteCount - used, literal );
+
+      if ( literalBytes == 0 )
+      {
+         if ( byteCount - used >= VARINT_MAX_BYTES )
+         {
+            throw E57_EXCEPTION2( ErrorBadCVPacket, "bytestreamNumber=" +
+                                                       toString( bytestreamNumber_ ) );
+         }
+         return 0;
+      }
+
+      used += literalBytes;
+
+      if ( literal > static_cast<uint64_t>( maximum_ ) - static_cast<uint64_t>( minimum_ ) )
+      {
+         throw E57_EXCEPTION2( ErrorBadCVPacket, "literal=" + toString( literal ) +
+                                                    " minimum=" + toString( minimum_ ) +
+                                                    " maximum=" + toString( maximum_ ) );
+      }
+
+      value = static_cast<int64_t>( static_cast<uint64_t>( minimum_ ) + literal );
+   }
+   else
+   {
+      if ( tag >= dictionary_.size() )
+      {
+         throw E57_EXCEPTION2( ErrorBadCVPacket, "tag=" + toString( tag ) + " dictionarySize=" +
+                                                    toString( dictionary_.size() ) );
+      }
+
+      value = dictionary_[tag];
+   }
+
+   uint64_t lengthMinus1 = 0;
+
+   const size_t lengthBytes = varintGet( &inbuf[used], byteCount - used, lengthMinus1 );
+
+   if ( lengthBytes == 0 )
+   {
+      if ( byteCount - used >= VARINT_MAX_BYTES )
+      {
+         throw E57_EXCEPTION2( ErrorBadCVPacket,
+                               "bytestreamNumber=" + toString( bytestreamNumber_ ) );
+      }
+      return 0;
+   }
+
+   used += lengthBytes;
+
+   // Only add the literal to the dictionary once the whole run has been read
+   if ( ( tag == RUN_LENGTH_LITERAL_TAG ) && ( dictionary_.size() < RUN_LENGTH_DICTIONARY_SIZE ) )
+   {
+      dictionary_.push_back( value );
+   }
+
+   runValue_ = value;
+   runRemaining_ = lengthMinus1 + 1;
+
+   return used;
+}
+
+void RunLengthDecoder::stateReset( uint64_t maxRecordCount )
+{
+   BitpackDecoder::stateReset( maxRecordCount );
+
+   dictionary_.clear();
+   runValue_ = 0;
+   runRemaining_ = 0;
+}
+
+#ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
+void RunLengthDecoder::dump( int indent, std::ostream &os )
+{
+   BitpackDecoder::dump( indent, os );
+   os << space( indent ) << "isScaledInteger:          " << isScaledInteger_ << std::endl;
+   os << space( indent ) << "minimum:                  " << minimum_ << std::endl;
+   os << space( indent ) << "maximum:                  " << maximum_ << std::endl;
+   os << space( indent ) << "scale:                    " << scale_ << std::endl;
+   os << space( indent ) << "offset:                   " << offset_ << std::endl;
+   os << space( indent ) << "dictionarySize:           " << dictionary_.size() << std::endl;
+   os << space( indent ) << "runValue:                 " << runValue_ << std::endl;
+   os << space( indent ) << "runRemaining:             " << runRemaining_ << std::endl;
+}
+#endif
+
+//================================================================
+
+RansDecoder::RansDecoder( bool isScaledInteger, unsigned bytestreamNumber, SourceDestBuffer &dbuf,
+                          int64_t minimum, int64_t maximum, double scale, double offset,
+                          uint64_t maxRecordCount ) :
+   Decoder( bytestreamNumber ), maxRecordCount_( maxRecordCount ), destBuffer_( dbuf.impl() ),
+   isScaledInteger_( isScaledInteger ), minimum_( minimum ), maximum_( maximum ), scale_( scale ),
+   offset_( offset ), input_( ResourceAllocator<char>( bufferMemoryResource( dbuf ) ) ),
+   values_( input_.get_allocator() ), residuals_( input_.get_allocator() )
+{
+   values_.reserve( RANS_BLOCK_RECORDS );
+   residuals_.resize( RANS_BLOCK_RECORDS );
+}
+
+void RansDecoder::destBufferSetNew( std::vector<SourceDestBuffer> &dbufs )
+{
+   if ( dbufs.size() != 1 )
+   {
+      throw E57_EXCEPTION2( ErrorInternal, "dbufsSize=" + toString( dbufs.size() ) );
+   }
+
+   destBuffer_ = dbufs.at( 0 ).impl();
+}
+
+size_t RansDecoder::inputProcess( const char *source, const size_t availableByteCount )
+{
+#ifdef E57_VERBOSE
+   std::cout << "RansDecoder::inputProcess() called, source=" << (void *)( source )
+             << " availableByteCount=" << availableByteCount << std::endl;
+#endif
+
+   // Keep all the input, a block is decoded once all its bytes are here
+   if ( ( source != nullptr ) && ( availableByteCount > 0 ) )
+   {
+      input_.insert( input_.end(), source, source + availableByteCount );
+   }
+
+   size_t used = 0;
+
+   while ( true )
+   {
+      outputValues();
+
+      // Stop if the dest buffer is full or all the records are done
+      if ( ( valueIndex_ < values_.size() ) || ( currentRecordIndex_ >= maxRecordCount_ ) )
+      {
+         break;
+      }
+
+      const size_t blockBytes = getBlock( input_.data() + used, input_.size() - used );
+
+      // Wait for the rest of the block
+      if ( blockBytes == 0 )
+      {
+         break;
+      }
+
+      used += blockBytes;
+   }
+
+   input_.erase( input_.begin(), input_.begin() + static_cast<std::ptrdiff_t>( used ) );
+
+   return ( availableByteCount );
+}
+
+void RansDecoder::outputValues()
+{
+   size_t count = std::min( values_.size() - valueIndex_,
+                            destBuffer_->capacity() - destBuffer_->nextIndex() );
+
+   for ( size_t i = 0; i < count; ++i )
+   {
+      // The parameter isScaledInteger_ determines which version of setNextInt64 gets called
+      if ( isScaledInteger_ )
+      {
+         destBuffer_->setNextInt64( values_[valueIndex_ + i], scale_, offset_ );
+      }
+      else
+      {
+         destBuffer_->setNextInt64( values_[valueIndex_ + i] );
+      }
+   }
+
+   valueIndex_ += count;
+   currentRecordIndex_ += count;
+}
+
+size_t RansDecoder::getBlock( const char *inbuf, size_t byteCount )
+{
+   // Returns the number of bytes of the block, or 0 if it isn't complete in inbuf.
+   uint64_t blockSize = 0;
+
+   const size_t sizeBytes = varintGet( inbuf, byteCount, blockSize );
+
+   if ( sizeBytes == 0 )
+   {
+      if ( byteCount >= VARINT_MAX_BYTES )
+      {
+         throw E57_EXCEPTION2( ErrorBadCVPacket,
+                               "bytestreamNumber=" + toString( bytestreamNumber_ ) );
+      }
+      return 0;
+   }
+
+   if ( blockSize > RANS_BLOCK_MAX_BYTES )
+   {
+      throw E57_EXCEPTION2( ErrorBadCVPacket, "blockSize=" + toString( blockSize ) );
+   }
+
+   if ( byteCount - sizeBytes < blockSize )
+   {
+      return 0;
+   }
+
+   const char *block = &inbuf[sizeBytes];
+   const auto blockEnd = static_cast<size_t>( blockSize );
+
+   uint64_t recordCount = 0;
+   size_t used = varintGet( block, blockEnd, recordCount );
+
+   if ( ( used == 0 ) || ( recordCount == 0 ) || ( recordCount > RANS_BLOCK_RECORDS ) ||
+        ( recordCount > maxRecordCount_ - currentRecordIndex_ ) || ( blockEnd - used < 2 ) )
+   {
+      throw E57_EXCEPTION2( ErrorBadCVPacket, "recordCount=" + toString( recordCount ) +
+                                                 " blockSize=" + toString( blockSize ) );
+   }
+
+   const auto count = static_cast<size_t>( recordCount );
+   const auto mode = static_cast<uint8_t>( block[used++] );
+   const auto width = static_cast<uint8_t>( block[used++] );
+
+   if ( ( mode > RANS_MODE_DELTA ) || ( width > 8 ) )
+   {
+      throw E57_EXCEPTION2( ErrorBadCVPacket,
+                            "mode=" + toString( mode ) + " width=" + toString( width ) );
+   }
+
+   std::fill( residuals_.begin(), residuals_.begin() + static_cast<std::ptrdiff_t>( count ), 0 );
+
+   for ( unsigned plane = 0; plane < width; ++plane )
+   {
+      used += getPlane( &block[used], blockEnd - used, plane, count );
+   }
+
+   if ( used != blockEnd )
+   {
+      throw E57_EXCEPTION2( ErrorBadCVPacket,
+                            "used=" + toString( used ) + " blockSize=" + toString( blockSize ) );
+   }
+
+   // Unsigned arithmetic, as in the encoder
+   const auto minimum = static_cast<uint64_t>( minimum_ );
+   const uint64_t range = static_cast<uint64_t>( maximum_ ) - minimum;
+   uint64_t previous = minimum;
+
+   values_.resize( count );
+
+   for ( size_t i = 0; i < count; ++i )
+   {
+      const uint64_t value = ( mode == RANS_MODE_DELTA ) ? previous + _unzigzag( residuals_[i] )
+                                                         : minimum + residuals_[i];
+
+      if ( value - minimum > range )
+      {
+         throw E57_EXCEPTION2( ErrorBadCVPacket, "value=" + toString( value ) +
+                                                    " minimum=" + toString( minimum_ ) +
+                                                    " maximum=" + toString( maximum_ ) );
+      }
+
+      values_[i] = static_cast<int64_t>( value );
+      previous = value;
+   }
+
+   valueIndex_ = 0;
+
+   return sizeBytes + blockEnd;
+}
+
+size_t RansDecoder::getPlane( const char *inbuf, size_t byteCount, unsigned plane,
+                              size_t recordCount )
+{
+   const auto bytes = reinterpret_cast<const uint8_t *>( inbuf );
+   const unsigned shift = 8 * plane;
+
+   if ( byteCount < 2 )
+   {
+      throw E57_EXCEPTION2( ErrorBadCVPacket, "byteCount=" + toString( byteCount ) );
+   }
+
+   switch ( bytes[0] )
+   {
+      case RANS_PLANE_CONSTANT:
+      {
+         const uint64_t bits = static_cast<uint64_t>( bytes[1] ) << shift;
+
+         for ( size_t i = 0; i < recordCount; ++i )
+         {
+            residuals_[i] |= bits;
+         }
+
+         return 2;
+      }
+
+      case RANS_PLANE_RAW:
+      {
+         if ( byteCount - 1 < recordCount )
+         {
+            throw E57_EXCEPTION2( ErrorBadCVPacket, "byteCount=" + toString( byteCount ) +
+                                                       " recordCount=" + toString( recordCount ) );
+         }
+
+         for ( size_t i = 0; i < recordCount; ++i )
+         {
+            residuals_[i] |= static_cast<uint64_t>( bytes[1 + i] ) << shift;
+         }
+
+         return 1 + recordCount;
+      }
+
+      case RANS_PLANE_RANS:
+         break;
+
+      default:
+         throw E57_EXCEPTION2( ErrorBadCVPacket, "planeType=" + toString( bytes[0] ) );
+   }
+
+   size_t used = 1;
+
+   // Frequency table
+   uint64_t symbolCount = 0;
+   size_t varintBytes = varintGet( &inbuf[used], byteCount - used, symbolCount );
+
+   if ( ( varintBytes == 0 ) || ( symbolCount < 2 ) || ( symbolCount > 256 ) )
+   {
+      throw E57_EXCEPTION2( ErrorBadCVPacket, "symbolCount=" + toString( symbolCount ) );
+   }
+
+   used += varintBytes;
+
+   std::fill( std::begin( symbolFrequency_ ), std::end( symbolFrequency_ ), 0 );
+
+   uint32_t total = 0;
+
+   for ( uint64_t i = 0; i < symbolCount; ++i )
+   {
+      if ( used >= byteCount )
+      {
+         throw E57_EXCEPTION2( ErrorBadCVPacket, "byteCount=" + toString( byteCount ) );
+      }
+
+      const uint8_t symbol = bytes[used];
+
+      uint64_t frequency = 0;
+      varintBytes = varintGet( &inbuf[used + 1], byteCount - used - 1, frequency );
+
+      if ( ( varintBytes == 0 ) || ( frequency == 0 ) || ( frequency > RANS_PROB_SCALE - total ) ||
+           ( symbolFrequency_[symbol] != 0 ) )
+      {
+         throw E57_EXCEPTION2( ErrorBadCVPacket, "symbol=" + toString( symbol ) +
+                                                    " frequency=" + toString( frequency ) );
+      }
+
+      used += 1 + varintBytes;
+
+      symbolStart_[symbol] = total;
+      symbolFrequency_[symbol] = static_cast<uint32_t>( frequency );
+      std::fill( &slotSymbol_[total], &slotSymbol_[total + frequency], symbol );
+
+      total += static_cast<uint32_t>( frequency );
+   }
+
+   uint64_t payloadSize = 0;
+   varintBytes = varintGet( &inbuf[used], byteCount - used, payloadSize );
+
+   if ( ( total != RANS_PROB_SCALE ) || ( varintBytes == 0 ) ||
+        ( payloadSize > byteCount - used - varintBytes ) ||
+        ( payloadSize < 4 * RANS_STATE_COUNT ) )
+   {
+      throw E57_EXCEPTION2( ErrorBadCVPacket, "total=" + toString( total ) +
+                                                 " payloadSize=" + toString( payloadSize ) );
+   }
+
+   used += varintBytes;
+
+   const uint8_t *ptr = &bytes[used];
+   const uint8_t *const payloadEnd = ptr + payloadSize;
+
+   uint32_t state[RANS_STATE_COUNT];
+
+   for ( auto &x : state )
+   {
+      x = static_cast<uint32_t>( ptr[0] ) | ( static_cast<uint32_t>( ptr[1] ) << 8 ) |
+          ( static_cast<uint32_t>( ptr[2] ) << 16 ) | ( static_cast<uint32_t>( ptr[3] ) << 24 );
+      ptr += 4;
+   }
+
+   // Record i uses state i % RANS_STATE_COUNT. The states don't depend on each other, so the
+   // decoding of a group of records can overlap.
+   for ( size_t i = 0; i < recordCount; i += RANS_STATE_COUNT )
+   {
+      const size_t groupCount = std::min( RANS_STATE_COUNT, recordCount - i );
+
+      for ( size_t j = 0; j < groupCount; ++j )
+      {
+         uint32_t &x = state[j];
+
+         const uint32_t slot = x & ( RANS_PROB_SCALE - 1 );
+         const uint8_t symbol = slotSymbol_[slot];
+
+         x = symbolFrequency_[symbol] * ( x >> RANS_PROB_BITS ) + slot - symbolStart_[symbol];
+
+         residuals_[i + j] |= static_cast<uint64_t>( symbol ) << shift;
+
+         while ( x < RANS_STATE_LOWER )
+         {
+            if ( ptr == payloadEnd )
+            {
+               throw E57_EXCEPTION2( ErrorBadCVPacket, "payloadSize=" + toString( payloadSize ) );
+            }
+
+            x = ( x << 8 ) | *ptr++;
+         }
+      }
+   }
+
+   if ( ptr != payloadEnd )
+   {
+      throw E57_EXCEPTION2( ErrorBadCVPacket, "payloadSize=" + toString( payloadSize ) );
+   }
+
+   return used + static_cast<size_t>( payloadSize );
+}
+
+void RansDecoder::stateReset( uint64_t maxRecordCount )
+{
+   currentRecordIndex_ = 0;
+   maxRecordCount_ = maxRecordCount;
+   input_.clear();
+   values_.clear();
+   valueIndex_ = 0;
+}
+
+#ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
+void RansDecoder::dump( int indent, std::ostream &os )
+{
+   os << space( indent ) << "bytestreamNumber:   " << bytestreamNumber_ << std::endl;
+   os << space( indent ) << "currentRecordIndex: " << currentRecordIndex_ << std::endl;
+   os << space( indent ) << "maxRecordCount:     " << maxRecordCount_ << std::endl;
+   os << space( indent ) << "isScaledInteger:    " << isScaledInteger_ << std::endl;
+   os << space( indent ) << "minimum:            " << minimum_ << std::endl;
+   os << space( indent ) << "maximum:            " << maximum_ << std::endl;
+   os << space( indent ) << "scale:              " << scale_ << std::endl;
+   os << space( indent ) << "offset:             " << offset_ << std::endl;
+   os << space( indent ) << "inputSize:          " << input_.size() << std::endl;
+   os << space( indent ) << "valuesRemaining:    " << values_.size() - valueIndex_ << std::endl;
+   os << space( indent ) << "destBuffer:" << std::endl;
+   destBuffer_->dump( indent + 4, os );
+}
+#endif
+
+//================================================================
+
 BitpackStringDecoder::BitpackStringDecoder( unsigned bytestreamNumber, SourceDestBuffer &dbuf,
                                             uint64_t maxRecordCount ) :
    BitpackDecoder( bytestreamNumber, dbuf, sizeof( char ), maxRecordCount )
@@ -635,6 +1434,18 @@ size_t BitpackStringDecoder::inputProcessAligned( const char *inbuf, const size_
    return ( nBytesRead * 8 );
 }
 
+void BitpackStringDecoder::stateReset( uint64_t maxRecordCount )
+{
+   BitpackDecoder::stateReset( maxRecordCount );
+
+   readingPrefix_ = true;
+   prefixLength_ = 1;
+   nBytesPrefixRead_ = 0;
+   stringLength_ = 0;
+   currentString_.clear();
+   nBytesStringRead_ = 0;
+}
+
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
 void BitpackStringDecoder::dump( int indent, std::ostream &os )
 {
@@ -681,6 +1492,16 @@ BitpackIntegerDecoder<RegisterT>::BitpackIntegerDecoder( bool isScaledInteger,
       ( bitsPerRecord_ == 64 ) ? ~0 : static_cast<RegisterT>( 1ULL << bitsPerRecord_ ) - 1;
 }
 
+template <typename RegisterT>
+bool BitpackIntegerDecoder<RegisterT>::fixedRecordSize( unsigned &bitsPerRecord,
+                                                        unsigned &bytesPerWord ) const
+{
+   bitsPerRecord = bitsPerRecord_;
+   bytesPerWord = bytesPerWord_;
+
+   return true;
+}
+
 template <typename RegisterT>
 size_t BitpackIntegerDecoder<RegisterT>::inputProcessAligned( const char *inbuf,
                                                               const size_t firstBit,
@@ -909,8 +1730,25 @@ size_t ConstantIntegerDecoder::inputProcess( const char *source, const size_t av
    return ( count );
 }
 
-void ConstantIntegerDecoder::stateReset()
+void ConstantIntegerDecoder::stateReset( uint64_t maxRecordCount )
+{
+   currentRecordIndex_ = 0;
+   maxRecordCount_ = maxRecordCount;
+}
+
+bool ConstantIntegerDecoder::fixedRecordSize( unsigned &bitsPerRecord,
+                                              unsigned &bytesPerWord ) const
+{
+   // Nothing is stored in the bytestream
+   bitsPerRecord = 0;
+   bytesPerWord = 1;
+
+   return true;
+}
+
+void ConstantIntegerDecoder::seekRecord( uint64_t recordIndex, size_t /*firstBit*/ )
 {
+   currentRecordIndex_ = recordIndex;
 }
 
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
@@ -27,10 +27,15 @@
 
 #pragma once
 
+#include "CodecFormat.h"
 #include "Common.h"
+#include "MemoryResource.h"
 
 namespace e57
 {
+   // Size of the input buffer of each bitpack decoder
+   constexpr size_t DECODER_BUFFER_SIZE = 1024; // !!! need to pick smarter channel buffer sizes
+
    class Decoder
    {
    public:
@@ -44,7 +49,17 @@ namespace e57
       virtual void destBufferSetNew( std::vector<SourceDestBuffer> &dbufs ) = 0;
       virtual uint64_t totalRecordsCompleted() = 0;
       virtual size_t inputProcess( const char *source, size_t count ) = 0;
-      virtual void stateReset() = 0;
+
+      /// Reset to decode another bytestream of maxRecordCount records, keeping the buffers
+      virtual void stateReset( uint64_t maxRecordCount ) = 0;
+
+      /// Get the number of bits each record takes in the bytestream, and the size of the words
+      /// the bytestream is read in. Returns false if the records don't all have the same size.
+      virtual bool fixedRecordSize( unsigned &bitsPerRecord, unsigned &bytesPerWord ) const;
+
+      /// Continue decoding at record recordIndex. The next input starts at a word boundary and
+      /// the record starts at firstBit in it. Only valid if fixedRecordSize() returns true.
+      virtual void seekRecord( uint64_t recordIndex, size_t firstBit );
 
       unsigned bytestreamNumber() const
       {
@@ -74,7 +89,8 @@ namespace e57
       size_t inputProcess( const char *source, size_t availableByteCount ) override;
       virtual size_t inputProcessAligned( const char *inbuf, size_t firstBit, size_t endBit ) = 0;
 
-      void stateReset() override;
+      void stateReset( uint64_t maxRecordCount ) override;
+      void seekRecord( uint64_t recordIndex, size_t firstBit ) override;
 
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
       void dump( int indent = 0, std::ostream &os = std::cout ) override;
@@ -91,7 +107,7 @@ namespace e57
 
       std::shared_ptr<SourceDestBufferImpl> destBuffer_;
 
-      std::vector<char> inBuffer_;
+      ResourceBuffer inBuffer_;
       size_t inBufferFirstBit_ = 0;
       size_t inBufferEndByte_ = 0;
       unsigned int inBufferAlignmentSize_;
@@ -106,6 +122,7 @@ namespace e57
                            FloatPrecision precision, uint64_t maxRecordCount );
 
       size_t inputProcessAligned( const char *inbuf, size_t firstBit, size_t endBit ) override;
+      bool fixedRecordSize( unsigned &bitsPerRecord, unsigned &bytesPerWord ) const override;
 
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
       void dump( int indent = 0, std::ostream &os = std::cout ) override;
@@ -122,6 +139,7 @@ namespace e57
                             uint64_t maxRecordCount );
 
       size_t inputProcessAligned( const char *inbuf, size_t firstBit, size_t endBit ) override;
+      void stateReset( uint64_t maxRecordCount ) override;
 
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
       void dump( int indent = 0, std::ostream &os = std::cout ) override;
@@ -145,6 +163,7 @@ namespace e57
                              double offset, uint64_t maxRecordCount );
 
       size_t inputProcessAligned( const char *inbuf, size_t firstBit, size_t endBit ) override;
+      bool fixedRecordSize( unsigned &bitsPerRecord, unsigned &bytesPerWord ) const override;
 
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
       void dump( int indent = 0, std::ostream &os = std::cout ) override;
@@ -161,6 +180,113 @@ namespace e57
       static constexpr size_t RegisterBits = sizeof( RegisterT ) * 8;
    };
 
+   /// Decodes the values written by FloatXorEncoder
+   class FloatXorDecoder : public BitpackDecoder
+   {
+   public:
+      FloatXorDecoder( unsigned bytestreamNumber, SourceDestBuffer &dbuf, FloatPrecision precision,
+                       uint64_t maxRecordCount );
+
+      size_t inputProcessAligned( const char *inbuf, size_t firstBit, size_t endBit ) override;
+      void stateReset( uint64_t maxRecordCount ) override;
+
+#ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
+      void dump( int indent = 0, std::ostream &os = std::cout ) override;
+#endif
+
+   protected:
+      template <typename WordT>
+      size_t decodeRecords( const char *inbuf, size_t firstBit, size_t endBit, size_t n );
+
+      FloatPrecision precision_ = PrecisionSingle;
+      uint64_t previousValue_ = 0;
+   };
+
+   /// Decodes the runs written by RunLengthEncoder, expanding each run directly into the dest
+   /// buffer
+   class RunLengthDecoder : public BitpackDecoder
+   {
+   public:
+      RunLengthDecoder( bool isScaledInteger, unsigned bytestreamNumber, SourceDestBuffer &dbuf,
+                        int64_t minimum, int64_t maximum, double scale, double offset,
+                        uint64_t maxRecordCount );
+
+      size_t inputProcessAligned( const char *inbuf, size_t firstBit, size_t endBit ) override;
+      void stateReset( uint64_t maxRecordCount ) override;
+
+#ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
+      void dump( int indent = 0, std::ostream &os = std::cout ) override;
+#endif
+
+   protected:
+      size_t getRun( const char *inbuf, size_t byteCount );
+
+      bool isScaledInteger_;
+      int64_t minimum_;
+      int64_t maximum_;
+      double scale_;
+      double offset_;
+
+      ResourceVector<int64_t> dictionary_;
+
+      int64_t runValue_ = 0;
+      uint64_t runRemaining_ = 0;
+   };
+
+   /// Decodes the blocks written by RansEncoder. Each block is decoded as a whole once all its
+   /// bytes have been received, using RANS_STATE_COUNT interleaved rANS states.
+   class RansDecoder : public Decoder
+   {
+   public:
+      RansDecoder( bool isScaledInteger, unsigned bytestreamNumber, SourceDestBuffer &dbuf,
+                   int64_t minimum, int64_t maximum, double scale, double offset,
+                   uint64_t maxRecordCount );
+
+      void destBufferSetNew( std::vector<SourceDestBuffer> &dbufs ) override;
+
+      uint64_t totalRecordsCompleted() override
+      {
+         return currentRecordIndex_;
+      }
+
+      size_t inputProcess( const char *source, size_t availableByteCount ) override;
+      void stateReset( uint64_t maxRecordCount ) override;
+
+#ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
+      void dump( int indent = 0, std::ostream &os = std::cout ) override;
+#endif
+
+   protected:
+      size_t getBlock( const char *inbuf, size_t byteCount );
+      size_t getPlane( const char *inbuf, size_t byteCount, unsigned plane, size_t recordCount );
+      void outputValues();
+
+      uint64_t currentRecordIndex_ = 0;
+      uint64_t maxRecordCount_;
+
+      std::shared_ptr<SourceDestBufferImpl> destBuffer_;
+
+      bool isScaledInteger_;
+      int64_t minimum_;
+      int64_t maximum_;
+      double scale_;
+      double offset_;
+
+      // Bytes received which aren't part of a decoded block yet
+      ResourceBuffer input_;
+
+      // Values of the last decoded block, values_[valueIndex_] is the next one to output
+      ResourceVector<int64_t> values_;
+      size_t valueIndex_ = 0;
+
+      ResourceVector<uint64_t> residuals_;
+
+      // Decoding tables of the current plane
+      uint8_t slotSymbol_[RANS_PROB_SCALE];
+      uint32_t symbolStart_[256];
+      uint32_t symbolFrequency_[256];
+   };
+
    class ConstantIntegerDecoder : public Decoder
    {
    public:
@@ -175,7 +301,9 @@ namespace e57
       }
 
       size_t inputProcess( const char *source, size_t availableByteCount ) override;
-      void stateReset() override;
+      void stateReset( uint64_t maxRecordCount ) override;
+      bool fixedRecordSize( unsigned &bitsPerRecord, unsigned &bytesPerWord ) const override;
+      void seekRecord( uint64_t recordIndex, size_t firstBit ) override;
 
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
       void dump( int indent = 0, std::ostream &os = std::cout ) override;
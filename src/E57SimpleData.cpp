@@ -30,6 +30,83 @@ namespace e57
       }
    }
 
+   /// @private
+   /// Allocates a buffer of count elements from memory (or the heap if it is nullptr).
+   template <typename T> T *_allocateBuffer( MemoryResource *memory, size_t count )
+   {
+      if ( memory == nullptr )
+      {
+         return new T[count];
+      }
+
+      return static_cast<T *>( memory->allocate( count * sizeof( T ), alignof( T ) ) );
+   }
+
+   /// @private
+   /// Frees a buffer allocated by _allocateBuffer().
+   template <typename T> void _freeBuffer( MemoryResource *memory, T *buffer, size_t count )
+   {
+      if ( buffer == nullptr )
+      {
+         return;
+      }
+
+      if ( memory == nullptr )
+      {
+         delete[] buffer;
+         return;
+      }
+
+      memory->deallocate( buffer, count * sizeof( T ), alignof( T ) );
+   }
+
+   bool CartesianBounds::matches( const std::vector<FieldStatistics> &statistics,
+                                  double tolerance ) const
+   {
+      const auto withinTolerance = [tolerance]( double value, double bound ) {
+         return std::fabs( value - bound ) <= tolerance;
+      };
+
+      for ( const auto &fieldStatistics : statistics )
+      {
+         if ( fieldStatistics.count == 0 )
+         {
+            continue;
+         }
+
+         double minimum = 0.0;
+         double maximum = 0.0;
+
+         if ( fieldStatistics.pathName == "cartesianX" )
+         {
+            minimum = xMinimum;
+            maximum = xMaximum;
+         }
+         else if ( fieldStatistics.pathName == "cartesianY" )
+         {
+            minimum = yMinimum;
+            maximum = yMaximum;
+         }
+         else if ( fieldStatistics.pathName == "cartesianZ" )
+         {
+            minimum = zMinimum;
+            maximum = zMaximum;
+         }
+         else
+         {
+            continue;
+         }
+
+         if ( !withinTolerance( fieldStatistics.minimum, minimum ) ||
+              !withinTolerance( fieldStatistics.maximum, maximum ) )
+         {
+            return false;
+         }
+      }
+
+      return true;
+   }
+
    /// To avoid exposing M_PI, we define the constructor here.
    SphericalBounds::SphericalBounds()
    {
@@ -45,7 +122,21 @@ namespace e57
    }
 
    template <typename COORDTYPE>
-   Data3DPointsData_t<COORDTYPE>::Data3DPointsData_t( Data3D &data3D ) : _selfAllocated( true )
+   Data3DPointsData_t<COORDTYPE>::Data3DPointsData_t( Data3D &data3D ) :
+      Data3DPointsData_t( data3D, data3D.pointCount )
+   {
+   }
+
+   template <typename COORDTYPE>
+   Data3DPointsData_t<COORDTYPE>::Data3DPointsData_t( Data3D &data3D, size_t pointCount ) :
+      Data3DPointsData_t( data3D, pointCount, nullptr )
+   {
+   }
+
+   template <typename COORDTYPE>
+   Data3DPointsData_t<COORDTYPE>::Data3DPointsData_t( Data3D &data3D, size_t pointCount,
+                                                      MemoryResource *memory ) :
+      _selfAllocated( true ), _memory( memory ), _pointCount( pointCount )
    {
       static_assert( std::is_floating_point<COORDTYPE>::value, "Floating point type required." );
 
@@ -80,121 +171,121 @@ namespace e57
             ( cIsFloat ? NumericalNodeType::Float : NumericalNodeType::Double );
       }
 
-      const auto cPointCount = data3D.pointCount;
+      const auto cPointCount = pointCount;
 
       if ( data3D.pointFields.cartesianXField )
       {
-         cartesianX = new COORDTYPE[cPointCount];
+         cartesianX = _allocateBuffer<COORDTYPE>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.cartesianYField )
       {
-         cartesianY = new COORDTYPE[cPointCount];
+         cartesianY = _allocateBuffer<COORDTYPE>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.cartesianZField )
       {
-         cartesianZ = new COORDTYPE[cPointCount];
+         cartesianZ = _allocateBuffer<COORDTYPE>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.cartesianInvalidStateField )
       {
-         cartesianInvalidState = new int8_t[cPointCount];
+         cartesianInvalidState = _allocateBuffer<int8_t>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.intensityField )
       {
-         intensity = new double[cPointCount];
+         intensity = _allocateBuffer<double>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.isIntensityInvalidField )
       {
-         isIntensityInvalid = new int8_t[cPointCount];
+         isIntensityInvalid = _allocateBuffer<int8_t>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.colorRedField )
       {
-         colorRed = new uint16_t[cPointCount];
+         colorRed = _allocateBuffer<uint16_t>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.colorGreenField )
       {
-         colorGreen = new uint16_t[cPointCount];
+         colorGreen = _allocateBuffer<uint16_t>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.colorBlueField )
       {
-         colorBlue = new uint16_t[cPointCount];
+         colorBlue = _allocateBuffer<uint16_t>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.isColorInvalidField )
       {
-         isColorInvalid = new int8_t[cPointCount];
+         isColorInvalid = _allocateBuffer<int8_t>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.sphericalRangeField )
       {
-         sphericalRange = new COORDTYPE[cPointCount];
+         sphericalRange = _allocateBuffer<COORDTYPE>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.sphericalAzimuthField )
       {
-         sphericalAzimuth = new COORDTYPE[cPointCount];
+         sphericalAzimuth = _allocateBuffer<COORDTYPE>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.sphericalElevationField )
       {
-         sphericalElevation = new COORDTYPE[cPointCount];
+         sphericalElevation = _allocateBuffer<COORDTYPE>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.sphericalInvalidStateField )
       {
-         sphericalInvalidState = new int8_t[cPointCount];
+         sphericalInvalidState = _allocateBuffer<int8_t>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.rowIndexField )
       {
-         rowIndex = new int32_t[cPointCount];
+         rowIndex = _allocateBuffer<int32_t>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.columnIndexField )
       {
-         columnIndex = new int32_t[cPointCount];
+         columnIndex = _allocateBuffer<int32_t>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.returnIndexField )
       {
-         returnIndex = new int8_t[cPointCount];
+         returnIndex = _allocateBuffer<int8_t>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.returnCountField )
       {
-         returnCount = new int8_t[cPointCount];
+         returnCount = _allocateBuffer<int8_t>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.timeStampField )
       {
-         timeStamp = new double[cPointCount];
+         timeStamp = _allocateBuffer<double>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.isTimeStampInvalidField )
       {
-         isTimeStampInvalid = new int8_t[cPointCount];
+         isTimeStampInvalid = _allocateBuffer<int8_t>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.normalXField )
       {
-         normalX = new float[cPointCount];
+         normalX = _allocateBuffer<float>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.normalYField )
       {
-         normalY = new float[cPointCount];
+         normalY = _allocateBuffer<float>( memory, cPointCount );
       }
 
       if ( data3D.pointFields.normalZField )
       {
-         normalZ = new float[cPointCount];
+         normalZ = _allocateBuffer<float>( memory, cPointCount );
       }
    }
 
@@ -207,36 +298,36 @@ namespace e57
          return;
       }
 
-      delete[] cartesianX;
-      delete[] cartesianY;
-      delete[] cartesianZ;
-      delete[] cartesianInvalidState;
+      _freeBuffer( _memory, cartesianX, _pointCount );
+      _freeBuffer( _memory, cartesianY, _pointCount );
+      _freeBuffer( _memory, cartesianZ, _pointCount );
+      _freeBuffer( _memory, cartesianInvalidState, _pointCount );
 
-      delete[] intensity;
-      delete[] isIntensityInvalid;
+      _freeBuffer( _memory, intensity, _pointCount );
+      _freeBuffer( _memory, isIntensityInvalid, _pointCount );
 
-      delete[] colorRed;
-      delete[] colorGreen;
-      delete[] colorBlue;
-      delete[] isColorInvalid;
+      _freeBuffer( _memory, colorRed, _pointCount );
+      _freeBuffer( _memory, colorGreen, _pointCount );
+      _freeBuffer( _memory, colorBlue, _pointCount );
+      _freeBuffer( _memory, isColorInvalid, _pointCount );
 
-      delete[] sphericalRange;
-      delete[] sphericalAzimuth;
-      delete[] sphericalElevation;
-      delete[] sphericalInvalidState;
+      _freeBuffer( _memory, sphericalRange, _pointCount );
+      _freeBuffer( _memory, sphericalAzimuth, _pointCount );
+      _freeBuffer( _memory, sphericalElevation, _pointCount );
+      _freeBuffer( _memory, sphericalInvalidState, _pointCount );
 
-      delete[] rowIndex;
-      delete[] columnIndex;
+      _freeBuffer( _memory, rowIndex, _pointCount );
+      _freeBuffer( _memory, columnIndex, _pointCount );
 
-      delete[] returnIndex;
-      delete[] returnCount;
+      _freeBuffer( _memory, returnIndex, _pointCount );
+      _freeBuffer( _memory, returnCount, _pointCount );
 
-      delete[] timeStamp;
-      delete[] isTimeStampInvalid;
+      _freeBuffer( _memory, timeStamp, _pointCount );
+      _freeBuffer( _memory, isTimeStampInvalid, _pointCount );
 
-      delete[] normalX;
-      delete[] normalY;
-      delete[] normalZ;
+      _freeBuffer( _memory, normalX, _pointCount );
+      _freeBuffer( _memory, normalY, _pointCount );
+      _freeBuffer( _memory, normalZ, _pointCount );
 
       // Set them all to nullptr.
       *this = Data3DPointsData_t<COORDTYPE>();
@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "E57SimpleDataset.h"
+#include "DatasetImpl.h"
+
+namespace e57
+{
+   Dataset::Dataset( const std::vector<ustring> &filePaths, const DatasetOptions &options ) :
+      impl_( new DatasetImpl( filePaths, options ) )
+   {
+   }
+
+   size_t Dataset::GetFileCount() const
+   {
+      return impl_->GetFileCount();
+   }
+
+   int64_t Dataset::GetScanCount() const
+   {
+      return impl_->GetScanCount();
+   }
+
+   bool Dataset::GetScan( int64_t scanIndex, DatasetScan &scan ) const
+   {
+      return impl_->GetScan( scanIndex, scan );
+   }
+
+   bool Dataset::SaveCatalog( const ustring &catalogPath ) const
+   {
+      return impl_->SaveCatalog( catalogPath );
+   }
+
+   void Dataset::ReadPoints( const std::vector<int64_t> &scanIndices,
+                             const DatasetPointsCallback &callback ) const
+   {
+      impl_->ReadPoints( scanIndices, callback );
+   }
+} // end namespace e57
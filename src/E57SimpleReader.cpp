@@ -27,6 +27,7 @@
  */
 
 #include "E57SimpleReader.h"
+#include "ColumnCache.h"
 #include "ReaderImpl.h"
 
 namespace e57
@@ -36,6 +37,11 @@ namespace e57
    {
    }
 
+   Reader::Reader( const RangeSource &source, const ReaderOptions &options ) :
+      impl_( new ReaderImpl( source, options ) )
+   {
+   }
+
    // Note that this constructor is deprecated (see header).
    Reader::Reader( const ustring &filePath ) : Reader( filePath, {} )
    {
@@ -144,4 +150,70 @@ namespace e57
    {
       return impl_->SetUpData3DPointsData( dataIndex, pointCount, buffers );
    }
+
+   CompressedVectorReader Reader::SetUpData3DPointsData( int64_t dataIndex, size_t pointCount,
+                                                         const Data3DPointsFloat &buffers,
+                                                         const RecordFilter &filter ) const
+   {
+      CompressedVectorReader reader =
+         impl_->SetUpData3DPointsData( dataIndex, pointCount, buffers );
+
+      reader.setFilter( filter );
+
+      return reader;
+   }
+
+   CompressedVectorReader Reader::SetUpData3DPointsData( int64_t dataIndex, size_t pointCount,
+                                                         const Data3DPointsDouble &buffers,
+                                                         const RecordFilter &filter ) const
+   {
+      CompressedVectorReader reader =
+         impl_->SetUpData3DPointsData( dataIndex, pointCount, buffers );
+
+      reader.setFilter( filter );
+
+      return reader;
+   }
+
+   MemoryEstimate Reader::EstimateMemory( int64_t dataIndex,
+                                          const std::vector<ustring> &fields ) const
+   {
+      return impl_->EstimateMemory( dataIndex, fields );
+   }
+
+   int64_t Reader::ReadTimeWindow( int64_t dataIndex, double startTime, double endTime,
+                                   size_t pointCount, const Data3DPointsDouble &buffers,
+                                   const TimeWindowCallback &callback ) const
+   {
+      return impl_->ReadTimeWindow( dataIndex, startTime, endTime, pointCount, buffers,
+                                    callback );
+   }
+
+   int64_t Reader::ReadData3DDownsampled( int64_t dataIndex, const DownsampleOptions &options,
+                                          size_t pointCount, const Data3DPointsDouble &buffers,
+                                          const DownsampleCallback &callback ) const
+   {
+      return impl_->ReadData3DDownsampled( dataIndex, options, pointCount, buffers, callback );
+   }
+
+   MappedData3DPoints Reader::MapData3DPoints( int64_t dataIndex,
+                                               const std::vector<ustring> &fields ) const
+   {
+      return impl_->MapData3DPoints( dataIndex, fields );
+   }
+
+   MappedData3DPoints::MappedData3DPoints( std::shared_ptr<MappedData3DPointsImpl> impl ) :
+      impl_( std::move( impl ) )
+   {
+   }
+
+   int64_t MappedData3DPoints::GetPointCount() const
+   {
+      return impl_->pointCount;
+   }
+
+   const Data3DPointsDouble &MappedData3DPoints::GetPoints() const
+   {
+      return impl_->points;
+   }
 } // end namespace e57
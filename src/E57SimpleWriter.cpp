@@ -163,6 +163,15 @@ namespace
                                   const e57::Data3DPointsFloat &inBuffers );
    template void _fillMinMaxData( e57::Data3D &ioData3DHeader,
                                   const e57::Data3DPointsDouble &inBuffers );
+
+   // Options used by the deprecated constructor
+   e57::WriterOptions _optionsWithCoordinateMetadata( const e57::ustring &coordinateMetadata )
+   {
+      e57::WriterOptions options;
+      options.coordinateMetadata = coordinateMetadata;
+
+      return options;
+   }
 }
 
 namespace e57
@@ -174,7 +183,7 @@ namespace e57
 
    // Note that this constructor is deprecated (see header).
    Writer::Writer( const ustring &filePath, const ustring &coordinateMetadata ) :
-      Writer( filePath, WriterOptions{ {}, coordinateMetadata } )
+      Writer( filePath, _optionsWithCoordinateMetadata( coordinateMetadata ) )
    {
    }
 
@@ -227,11 +236,7 @@ namespace e57
 
       const int64_t scanIndex = impl_->NewData3D( data3DHeader );
 
-      e57::CompressedVectorWriter dataWriter =
-         impl_->SetUpData3DPointsData( scanIndex, data3DHeader.pointCount, buffers );
-
-      dataWriter.write( data3DHeader.pointCount );
-      dataWriter.close();
+      impl_->WriteData3DPoints( scanIndex, data3DHeader.pointCount, buffers );
 
       return scanIndex;
    }
@@ -242,11 +247,7 @@ namespace e57
 
       const int64_t scanIndex = impl_->NewData3D( data3DHeader );
 
-      e57::CompressedVectorWriter dataWriter =
-         impl_->SetUpData3DPointsData( scanIndex, data3DHeader.pointCount, buffers );
-
-      dataWriter.write( data3DHeader.pointCount );
-      dataWriter.close();
+      impl_->WriteData3DPoints( scanIndex, data3DHeader.pointCount, buffers );
 
       return scanIndex;
    }
@@ -588,7 +588,7 @@ void E57XmlParser::startElement( const XMLCh *const uri, const XMLCh *const loca
       }
 
       // Create container now, so can hold children
-      std::shared_ptr<StructureNodeImpl> s_ni( new StructureNodeImpl( imf_ ) );
+      std::shared_ptr<StructureNodeImpl> s_ni( makeNode<StructureNodeImpl>( imf_ ) );
       pi.container_ni = s_ni;
 
       // After have Structure, check again if E57Root, if so mark attached so all children will be
@@ -638,7 +638,7 @@ void E57XmlParser::startElement( const XMLCh *const uri, const XMLCh *const loca
 
       // Create container now, so can hold children
       std::shared_ptr<VectorNodeImpl> v_ni(
-         new VectorNodeImpl( imf_, pi.allowHeterogeneousChildren ) );
+         makeNode<VectorNodeImpl>( imf_, pi.allowHeterogeneousChildren ) );
       pi.container_ni = v_ni;
 
       stack_.push( pi );
@@ -661,7 +661,7 @@ void E57XmlParser::startElement( const XMLCh *const uri, const XMLCh *const loca
       pi.recordCount = convertStrToLL( recordCount_str );
 
       // Create container now, so can hold children
-      std::shared_ptr<CompressedVectorNodeImpl> cv_ni( new CompressedVectorNodeImpl( imf_ ) );
+      std::shared_ptr<CompressedVectorNodeImpl> cv_ni( makeNode<CompressedVectorNodeImpl>( imf_ ) );
       cv_ni->setRecordCount( pi.recordCount );
       cv_ni->setBinarySectionLogicalStart(
          imf_->file_->physicalToLogical( pi.fileOffset ) ); //??? what if file_ is NULL?
@@ -724,7 +724,7 @@ void E57XmlParser::endElement( const XMLCh *const uri, const XMLCh *const localN
          }
 
          std::shared_ptr<IntegerNodeImpl> i_ni(
-            new IntegerNodeImpl( imf_, intValue, pi.minimum, pi.maximum ) );
+            makeNode<IntegerNodeImpl>( imf_, intValue, pi.minimum, pi.maximum ) );
 
          if ( foundValue )
          {
@@ -746,7 +746,7 @@ void E57XmlParser::endElement( const XMLCh *const uri, const XMLCh *const localN
             foundValue = true;
          }
 
-         std::shared_ptr<ScaledIntegerNodeImpl> si_ni( new ScaledIntegerNodeImpl(
+         std::shared_ptr<ScaledIntegerNodeImpl> si_ni( makeNode<ScaledIntegerNodeImpl>(
             imf_, intValue, pi.minimum, pi.maximum, pi.scale, pi.offset ) );
 
          if ( foundValue )
@@ -769,8 +769,8 @@ void E57XmlParser::endElement( const XMLCh *const uri, const XMLCh *const localN
             foundValue = true;
          }
 
-         std::shared_ptr<FloatNodeImpl> f_ni(
-            new FloatNodeImpl( imf_, floatValue, pi.precision, pi.floatMinimum, pi.floatMaximum ) );
+         std::shared_ptr<FloatNodeImpl> f_ni( makeNode<FloatNodeImpl>(
+            imf_, floatValue, pi.precision, pi.floatMinimum, pi.floatMaximum ) );
 
          if ( foundValue )
          {
@@ -782,13 +782,14 @@ void E57XmlParser::endElement( const XMLCh *const uri, const XMLCh *const localN
       break;
       case TypeString:
       {
-         std::shared_ptr<StringNodeImpl> s_ni( new StringNodeImpl( imf_, pi.childText ) );
+         std::shared_ptr<StringNodeImpl> s_ni( makeNode<StringNodeImpl>( imf_, pi.childText ) );
          current_ni = s_ni;
       }
       break;
       case TypeBlob:
       {
-         std::shared_ptr<BlobNodeImpl> b_ni( new BlobNodeImpl( imf_, pi.fileOffset, pi.length ) );
+         std::shared_ptr<BlobNodeImpl> b_ni(
+            makeNode<BlobNodeImpl>( imf_, pi.fileOffset, pi.length ) );
          current_ni = b_ni;
       }
       break;
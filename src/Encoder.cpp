@@ -28,6 +28,11 @@
 #include <algorithm>
 #include <cstring>
 
+#if defined( _MSC_VER )
+#include <intrin.h>
+#endif
+
+#include "CodecFormat.h"
 #include "CompressedVectorNodeImpl.h"
 #include "Encoder.h"
 #include "FloatNodeImpl.h"
@@ -40,10 +45,137 @@
 
 using namespace e57;
 
+namespace
+{
+   // Number of zero bits at the top of a non-zero value
+   unsigned _countLeadingZeros( uint64_t value )
+   {
+#if defined( __GNUC__ ) || defined( __clang__ )
+      return static_cast<unsigned>( __builtin_clzll( value ) );
+#elif defined( _MSC_VER ) && defined( _M_X64 )
+      unsigned long index = 0;
+      _BitScanReverse64( &index, value );
+      return 63 - static_cast<unsigned>( index );
+#else
+      unsigned count = 0;
+      for ( ; ( value & ( 1ULL << 63 ) ) == 0; value <<= 1 )
+      {
+         ++count;
+      }
+      return count;
+#endif
+   }
+
+   // Number of zero bits at the bottom of a non-zero value
+   unsigned _countTrailingZeros( uint64_t value )
+   {
+#if defined( __GNUC__ ) || defined( __clang__ )
+      return static_cast<unsigned>( __builtin_ctzll( value ) );
+#elif defined( _MSC_VER ) && defined( _M_X64 )
+      unsigned long index = 0;
+      _BitScanForward64( &index, value );
+      return static_cast<unsigned>( index );
+#else
+      unsigned count = 0;
+      for ( ; ( value & 1 ) == 0; value >>= 1 )
+      {
+         ++count;
+      }
+      return count;
+#endif
+   }
+
+   // Get the next value of the source buffer as raw IEEE bits
+   template <typename WordT> WordT _nextValueBits( SourceDestBufferImpl &sbuf );
+
+   template <> uint32_t _nextValueBits<uint32_t>( SourceDestBufferImpl &sbuf )
+   {
+      const float value = sbuf.getNextFloat();
+
+      uint32_t bits = 0;
+      memcpy( &bits, &value, sizeof( bits ) );
+      return bits;
+   }
+
+   template <> uint64_t _nextValueBits<uint64_t>( SourceDestBufferImpl &sbuf )
+   {
+      const double value = sbuf.getNextDouble();
+
+      uint64_t bits = 0;
+      memcpy( &bits, &value, sizeof( bits ) );
+      return bits;
+   }
+
+   // Map a difference to an unsigned value so small negative differences stay small
+   uint64_t _zigzag( uint64_t difference )
+   {
+      return ( difference << 1 ) ^ ( 0 - ( difference >> 63 ) );
+   }
+
+   // Number of significant bits of value
+   unsigned _bitLength( uint64_t value )
+   {
+      return ( value == 0 ) ? 0 : 64 - _countLeadingZeros( value );
+   }
+
+   // Scale the symbol counts of recordCount records so they add up to RANS_PROB_SCALE, keeping
+   // every symbol which is used.
+   void _normalizeFrequencies( uint32_t ( &frequency )[256], size_t recordCount )
+   {
+      uint32_t total = 0;
+
+      for ( auto &f : frequency )
+      {
+         if ( f != 0 )
+         {
+            f = std::max<uint32_t>(
+               1, static_cast<uint32_t>( uint64_t{ f } * RANS_PROB_SCALE / recordCount ) );
+            total += f;
+         }
+      }
+
+      // Fix the rounding on the most frequent symbols, which costs the least
+      while ( total != RANS_PROB_SCALE )
+      {
+         uint32_t &largest = *std::max_element( std::begin( frequency ), std::end( frequency ) );
+
+         if ( total < RANS_PROB_SCALE )
+         {
+            largest += RANS_PROB_SCALE - total;
+            total = RANS_PROB_SCALE;
+         }
+         else
+         {
+            const uint32_t excess = std::min( total - RANS_PROB_SCALE, largest - 1 );
+
+            largest -= excess;
+            total -= excess;
+         }
+      }
+   }
+}
+
 std::shared_ptr<Encoder> Encoder::EncoderFactory( unsigned bytestreamNumber,
                                                   std::shared_ptr<CompressedVectorNodeImpl> cVector,
                                                   std::vector<SourceDestBuffer> &sbufs,
-                                                  ustring & /*codecPath*/ )
+                                                  ustring &codecPath )
+{
+   //??? For now, only handle one input
+   if ( sbufs.size() != 1 )
+   {
+      throw E57_EXCEPTION2( ErrorInternal, "sbufsSize=" + toString( sbufs.size() ) );
+   }
+
+   // Codec selected for this node in the codecs of the CompressedVector
+   const Codec codec = cVector->codecFor( sbufs.at( 0 ).pathName() );
+
+   return EncoderFactory( bytestreamNumber, cVector, sbufs, codecPath, codec );
+}
+
+std::shared_ptr<Encoder> Encoder::EncoderFactory( unsigned bytestreamNumber,
+                                                  std::shared_ptr<CompressedVectorNodeImpl> cVector,
+                                                  std::vector<SourceDestBuffer> &sbufs,
+                                                  ustring & /*codecPath*/, Codec codec )
 {
    //??? For now, only handle one input
    if ( sbufs.size() != 1 )
@@ -62,6 +194,7 @@ std::shared_ptr<Encoder> Encoder::EncoderFactory( unsigned bytestreamNumber,
    std::cout << "Node to encode:" << std::endl; //???
    encodeNode->dump( 2 );
 #endif
+
    switch ( encodeNode->type() )
    {
       case TypeInteger:
@@ -69,6 +202,23 @@ std::shared_ptr<Encoder> Encoder::EncoderFactory( unsigned bytestreamNumber,
          std::shared_ptr<IntegerNodeImpl> ini =
             std::static_pointer_cast<IntegerNodeImpl>( encodeNode ); // downcast to correct type
 
+         if ( codec == CodecRunLength )
+         {
+            std::shared_ptr<Encoder> encoder(
+               new RunLengthEncoder( false, bytestreamNumber, sbuf, DATA_PACKET_MAX,
+                                     ini->minimum(), ini->maximum(), 1.0, 0.0 ) );
+            return encoder;
+         }
+
+         // A rANS block is written all at once, so leave room for one next to a packet's worth
+         if ( codec == CodecRans )
+         {
+            std::shared_ptr<Encoder> encoder(
+               new RansEncoder( false, bytestreamNumber, sbuf, 2 * DATA_PACKET_MAX, ini->minimum(),
+                                ini->maximum(), 1.0, 0.0 ) );
+            return encoder;
+         }
+
          // Get pointer to parent ImageFileImpl, to call bitsNeeded()
          ImageFileImplSharedPtr imf(
             encodeNode->destImageFile_ ); //??? should be function for this,
@@ -124,6 +274,22 @@ std::shared_ptr<Encoder> Encoder::EncoderFactory( unsigned bytestreamNumber,
             std::static_pointer_cast<ScaledIntegerNodeImpl>(
                encodeNode ); // downcast to correct type
 
+         if ( codec == CodecRunLength )
+         {
+            std::shared_ptr<Encoder> encoder( new RunLengthEncoder(
+               true, bytestreamNumber, sbuf, DATA_PACKET_MAX, sini->minimum(), sini->maximum(),
+               sini->scale(), sini->offset() ) );
+            return encoder;
+         }
+
+         if ( codec == CodecRans )
+         {
+            std::shared_ptr<Encoder> encoder( new RansEncoder(
+               true, bytestreamNumber, sbuf, 2 * DATA_PACKET_MAX, sini->minimum(), sini->maximum(),
+               sini->scale(), sini->offset() ) );
+            return encoder;
+         }
+
          // Get pointer to parent ImageFileImpl, to call bitsNeeded()
          ImageFileImplSharedPtr imf(
             encodeNode->destImageFile_ ); //??? should be function for this,
@@ -178,6 +344,13 @@ std::shared_ptr<Encoder> Encoder::EncoderFactory( unsigned bytestreamNumber,
          std::shared_ptr<FloatNodeImpl> fni =
             std::static_pointer_cast<FloatNodeImpl>( encodeNode ); // downcast to correct type
 
+         if ( codec == CodecFloatXor )
+         {
+            std::shared_ptr<Encoder> encoder( new FloatXorEncoder(
+               bytestreamNumber, sbuf, DATA_PACKET_MAX, fni->precision() ) );
+            return encoder;
+         }
+
          // !!! need to pick smarter channel buffer sizes, here and elsewhere
          std::shared_ptr<Encoder> encoder( new BitpackFloatEncoder(
             bytestreamNumber, sbuf, DATA_PACKET_MAX /*!!!*/, fni->precision() ) );
@@ -214,7 +387,8 @@ void Encoder::dump( int indent, std::ostream &os ) const
 
 BitpackEncoder::BitpackEncoder( unsigned bytestreamNumber, SourceDestBuffer &sbuf,
                                 unsigned outputMaxSize, unsigned alignmentSize ) :
-   Encoder( bytestreamNumber ), sourceBuffer_( sbuf.impl() ), outBuffer_( outputMaxSize ),
+   Encoder( bytestreamNumber ), sourceBuffer_( sbuf.impl() ),
+   outBuffer_( outputMaxSize, ResourceAllocator<char>( bufferMemoryResource( sbuf ) ) ),
    outBufferFirst_( 0 ), outBufferEnd_( 0 ), outBufferAlignmentSize_( alignmentSize ),
    currentRecordIndex_( 0 )
 {
@@ -235,10 +409,15 @@ size_t BitpackEncoder::outputAvailable() const
    return outBufferEnd_ - outBufferFirst_;
 }
 
-void BitpackEncoder::outputRead( char *dest, const size_t byteCount )
+const char *BitpackEncoder::outputData() const
+{
+   return outBuffer_.data() + outBufferFirst_;
+}
+
+void BitpackEncoder::outputSkip( const size_t byteCount )
 {
 #ifdef E57_VERBOSE
-   std::cout << "BitpackEncoder::outputRead() called, dest=" << dest << " byteCount=" << byteCount
+   std::cout << "BitpackEncoder::outputSkip() called, byteCount=" << byteCount
              << std::endl; //???
 #endif
 
@@ -249,27 +428,6 @@ void BitpackEncoder::outputRead( char *dest, const size_t byteCount )
                                               " outputAvailable=" + toString( outputAvailable() ) );
    }
 
-   // Copy output bytes to caller
-   memcpy( dest, &outBuffer_[outBufferFirst_], byteCount );
-
-#ifdef E57_VERBOSE
-   {
-      unsigned i;
-      for ( i = 0; i < byteCount && i < 20; i++ )
-      {
-         std::cout << "  outBuffer[" << outBufferFirst_ + i << "]="
-                   << static_cast<unsigned>(
-                         static_cast<unsigned char>( outBuffer_[outBufferFirst_ + i] ) )
-                   << std::endl; //???
-      }
-
-      if ( i < byteCount )
-      {
-         std::cout << "  " << byteCount - 1 << " bytes unprinted..." << std::endl;
-      }
-   }
-#endif
-
    // Advance head pointer.
    outBufferFirst_ += byteCount;
 
@@ -494,6 +652,578 @@ void BitpackFloatEncoder::dump( int indent, std::ostream &os ) const
 
 //================
 
+FloatXorEncoder::FloatXorEncoder( unsigned bytestreamNumber, SourceDestBuffer &sbuf,
+                                  unsigned outputMaxSize, FloatPrecision precision ) :
+   BitpackEncoder( bytestreamNumber, sbuf, outputMaxSize, 1 ), precision_( precision )
+{
+}
+
+uint64_t FloatXorEncoder::processRecords( size_t recordCount )
+{
+#ifdef E57_VERBOSE
+   std::cout << "  FloatXorEncoder::processRecords() called, recordCount=" << recordCount
+             << std::endl;
+#endif
+
+   // Before we add any more, try to shift current contents of outBuffer_ down to beginning of
+   // buffer.
+   outBufferShiftDown();
+
+   // Worst case for a record is the control bit, the two zero counts, and all bits of the value.
+   const size_t maxRecordBits =
+      ( precision_ == PrecisionSingle ) ? ( 1 + 2 * 5 + 32 ) : ( 1 + 2 * 6 + 64 );
+
+   // Figure out how many records will fit in output (including the bits still in the register).
+   const size_t freeBits = ( outBuffer_.size() - outBufferEnd_ ) * 8;
+   const size_t maxOutputRecords =
+      ( freeBits > registerBitsUsed_ ) ? ( freeBits - registerBitsUsed_ ) / maxRecordBits : 0;
+
+   // Can't process more records than will safely fit in output stream
+   if ( recordCount > maxOutputRecords )
+   {
+      recordCount = maxOutputRecords;
+   }
+
+   if ( precision_ == PrecisionSingle )
+   {
+      encodeRecords<uint32_t>( recordCount );
+   }
+   else
+   {
+      encodeRecords<uint64_t>( recordCount );
+   }
+
+   // Update counts of records processed
+   currentRecordIndex_ += recordCount;
+
+   return ( currentRecordIndex_ );
+}
+
+template <typename WordT> void FloatXorEncoder::encodeRecords( size_t recordCount )
+{
+   constexpr unsigned WordBits = sizeof( WordT ) * 8;
+   constexpr unsigned CountBits = ( WordBits == 32 ) ? 5 : 6;
+   constexpr unsigned HeaderBits = 2 * CountBits + 1;
+
+   auto previous = static_cast<WordT>( previousValue_ );
+
+   for ( size_t i = 0; i < recordCount; ++i )
+   {
+      const WordT value = _nextValueBits<WordT>( *sourceBuffer_ );
+      const WordT x = value ^ previous;
+
+      previous = value;
+
+      if ( x == 0 )
+      {
+         // Same value as the previous record: a single 0 bit.
+         putBits( 0, 1 );
+         ++totalBitsEncoded_;
+         continue;
+      }
+
+      const unsigned leadingZeros = _countLeadingZeros( x ) - ( 64 - WordBits );
+      const unsigned trailingZeros = _countTrailingZeros( x );
+      const unsigned meaningfulBits = WordBits - leadingZeros - trailingZeros;
+
+      // A 1 bit, the leading zero count, the meaningful bit count minus one, then the meaningful
+      // bits of the XOR.
+      putBits( 1U | ( leadingZeros << 1 ) | ( ( meaningfulBits - 1 ) << ( CountBits + 1 ) ),
+               HeaderBits );
+      putBits( static_cast<uint64_t>( x ) >> trailingZeros, meaningfulBits );
+
+      totalBitsEncoded_ += HeaderBits + meaningfulBits;
+   }
+
+   previousValue_ = previous;
+}
+
+void FloatXorEncoder::putBits( uint64_t value, unsigned bitCount )
+{
+   // Bits are packed least significant first, like the bitPackCodec. The register never holds
+   // more than 7 bits between calls, so add at most 32 bits at a time.
+   if ( bitCount > 32 )
+   {
+      putBits( value & 0xFFFFFFFFULL, 32 );
+
+      value >>= 32;
+      bitCount -= 32;
+   }
+
+   register_ |= value << registerBitsUsed_;
+   registerBitsUsed_ += bitCount;
+
+   for ( ; registerBitsUsed_ >= 8; registerBitsUsed_ -= 8 )
+   {
+      outBuffer_[outBufferEnd_++] = static_cast<char>( register_ & 0xFF );
+      register_ >>= 8;
+   }
+}
+
+bool FloatXorEncoder::registerFlushToOutput()
+{
+   // Write the partial byte in the register, padded with zeros
+   if ( registerBitsUsed_ > 0 )
+   {
+      if ( outBufferEnd_ >= outBuffer_.size() )
+      {
+         return ( false );
+      }
+
+      outBuffer_[outBufferEnd_++] = static_cast<char>( register_ & 0xFF );
+      register_ = 0;
+      registerBitsUsed_ = 0;
+   }
+
+   return ( true );
+}
+
+float FloatXorEncoder::bitsPerRecord()
+{
+   if ( currentRecordIndex_ == 0 )
+   {
+      return ( ( precision_ == PrecisionSingle ) ? 32.0F : 64.0F );
+   }
+
+   return ( static_cast<float>( totalBitsEncoded_ ) / static_cast<float>( currentRecordIndex_ ) );
+}
+
+#ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
+void FloatXorEncoder::dump( int indent, std::ostream &os ) const
+{
+   BitpackEncoder::dump( indent, os );
+   if ( precision_ == PrecisionSingle )
+   {
+      os << space( indent ) << "precision:                Single" << std::endl;
+   }
+   else
+   {
+      os << space( indent ) << "precision:                Double" << std::endl;
+   }
+   os << space( indent ) << "registerBitsUsed:         " << registerBitsUsed_ << std::endl;
+   os << space( indent ) << "totalBitsEncoded:         " << totalBitsEncoded_ << std::endl;
+}
+#endif
+
+//================
+
+RunLengthEncoder::RunLengthEncoder( bool isScaledInteger, unsigned bytestreamNumber,
+                                    SourceDestBuffer &sbuf, unsigned outputMaxSize,
+                                    int64_t minimum, int64_t maximum, double scale,
+                                    double offset ) :
+   BitpackEncoder( bytestreamNumber, sbuf, outputMaxSize, 1 ), isScaledInteger_( isScaledInteger ),
+   minimum_( minimum ), maximum_( maximum ), scale_( scale ), offset_( offset ),
+   dictionary_( ResourceAllocator<int64_t>( bufferMemoryResource( sbuf ) ) )
+{
+}
+
+uint64_t RunLengthEncoder::processRecords( size_t recordCount )
+{
+#ifdef E57_VERBOSE
+   std::cout << "  RunLengthEncoder::processRecords() called, recordCount=" << recordCount
+             << std::endl;
+#endif
+
+   // Before we add any more, try to shift current contents of outBuffer_ down to beginning of
+   // buffer.
+   outBufferShiftDown();
+
+   // Each record ends at most one run, so this many records will safely fit in output.
+   const size_t maxOutputRecords = ( outBuffer_.size() - outBufferEnd_ ) / RUN_LENGTH_MAX_BYTES;
+
+   // Can't process more records than will safely fit in output stream
+   if ( recordCount > maxOutputRecords )
+   {
+      recordCount = maxOutputRecords;
+   }
+
+   for ( size_t i = 0; i < recordCount; ++i )
+   {
+      // The parameter isScaledInteger_ determines which version of getNextInt64 gets called
+      const int64_t rawValue = isScaledInteger_ ? sourceBuffer_->getNextInt64( scale_, offset_ )
+                                                : sourceBuffer_->getNextInt64();
+
+      // Enforce min/max specification on value
+      if ( rawValue < minimum_ || maximum_ < rawValue )
+      {
+         throw E57_EXCEPTION2( ErrorValueOutOfBounds, "rawValue=" + toString( rawValue ) +
+                                                         " minimum=" + toString( minimum_ ) +
+                                                         " maximum=" + toString( maximum_ ) );
+      }
+
+      if ( ( runLength_ > 0 ) && ( rawValue == runValue_ ) )
+      {
+         ++runLength_;
+         continue;
+      }
+
+      putRun();
+
+      runValue_ = rawValue;
+      runLength_ = 1;
+   }
+
+   // Update counts of records processed
+   currentRecordIndex_ += recordCount;
+
+   return ( currentRecordIndex_ );
+}
+
+void RunLengthEncoder::putRun()
+{
+   if ( runLength_ == 0 )
+   {
+      return;
+   }
+
+   const size_t start = outBufferEnd_;
+
+   const auto entry = std::find( dictionary_.begin(), dictionary_.end(), runValue_ );
+
+   if ( entry != dictionary_.end() )
+   {
+      outBuffer_[outBufferEnd_++] = static_cast<char>( entry - dictionary_.begin() );
+   }
+   else
+   {
+      outBuffer_[outBufferEnd_++] = static_cast<char>( RUN_LENGTH_LITERAL_TAG );
+      const uint64_t literal =
+         static_cast<uint64_t>( runValue_ ) - static_cast<uint64_t>( minimum_ );
+
+      outBufferEnd_ += varintPut( &outBuffer_[outBufferEnd_], literal );
+
+      if ( dictionary_.size() < RUN_LENGTH_DICTIONARY_SIZE )
+      {
+         dictionary_.push_back( runValue_ );
+      }
+   }
+
+   outBufferEnd_ += varintPut( &outBuffer_[outBufferEnd_], runLength_ - 1 );
+
+   totalBytesEncoded_ += outBufferEnd_ - start;
+   runLength_ = 0;
+}
+
+bool RunLengthEncoder::registerFlushToOutput()
+{
+   // Write the pending run
+   if ( runLength_ > 0 )
+   {
+      if ( outBuffer_.size() - outBufferEnd_ < RUN_LENGTH_MAX_BYTES )
+      {
+         return ( false );
+      }
+
+      putRun();
+   }
+
+   return ( true );
+}
+
+float RunLengthEncoder::bitsPerRecord()
+{
+   if ( currentRecordIndex_ == 0 )
+   {
+      return ( 8.0F );
+   }
+
+   return ( 8.0F * static_cast<float>( totalBytesEncoded_ ) /
+            static_cast<float>( currentRecordIndex_ ) );
+}
+
+#ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
+void RunLengthEncoder::dump( int indent, std::ostream &os ) const
+{
+   BitpackEncoder::dump( indent, os );
+   os << space( indent ) << "isScaledInteger:          " << isScaledInteger_ << std::endl;
+   os << space( indent ) << "minimum:                  " << minimum_ << std::endl;
+   os << space( indent ) << "maximum:                  " << maximum_ << std::endl;
+   os << space( indent ) << "scale:                    " << scale_ << std::endl;
+   os << space( indent ) << "offset:                   " << offset_ << std::endl;
+   os << space( indent ) << "dictionarySize:           " << dictionary_.size() << std::endl;
+   os << space( indent ) << "runValue:                 " << runValue_ << std::endl;
+   os << space( indent ) << "runLength:                " << runLength_ << std::endl;
+}
+#endif
+
+//================
+
+RansEncoder::RansEncoder( bool isScaledInteger, unsigned bytestreamNumber, SourceDestBuffer &sbuf,
+                          unsigned outputMaxSize, int64_t minimum, int64_t maximum, double scale,
+                          double offset ) :
+   BitpackEncoder( bytestreamNumber, sbuf, outputMaxSize, 1 ), isScaledInteger_( isScaledInteger ),
+   minimum_( minimum ), maximum_( maximum ), scale_( scale ), offset_( offset ),
+   block_( ResourceAllocator<int64_t>( bufferMemoryResource( sbuf ) ) ),
+   residuals_( block_.get_allocator() ), symbols_( block_.get_allocator() ),
+   payload_( block_.get_allocator() ), blockBytes_( block_.get_allocator() )
+{
+   block_.reserve( RANS_BLOCK_RECORDS );
+   residuals_.resize( RANS_BLOCK_RECORDS );
+   symbols_.resize( RANS_BLOCK_RECORDS );
+
+   // A symbol takes at most RANS_PROB_BITS bits of renormalization output
+   payload_.resize( 2 * RANS_BLOCK_RECORDS + 4 * RANS_STATE_COUNT );
+   blockBytes_.resize( RANS_BLOCK_MAX_BYTES );
+}
+
+uint64_t RansEncoder::processRecords( size_t recordCount )
+{
+#ifdef E57_VERBOSE
+   std::cout << "  RansEncoder::processRecords() called, recordCount=" << recordCount << std::endl;
+#endif
+
+   // Before we add any more, try to shift current contents of outBuffer_ down to beginning of
+   // buffer.
+   outBufferShiftDown();
+
+   size_t processed = 0;
+
+   while ( processed < recordCount )
+   {
+      // A full block must be coded before starting the next one. Stop if there is no room for it
+      // in the output.
+      if ( ( block_.size() == RANS_BLOCK_RECORDS ) && !putBlock() )
+      {
+         break;
+      }
+
+      const size_t count = std::min( recordCount - processed, RANS_BLOCK_RECORDS - block_.size() );
+
+      for ( size_t i = 0; i < count; ++i )
+      {
+         // The parameter isScaledInteger_ determines which version of getNextInt64 gets called
+         const int64_t rawValue = isScaledInteger_ ? sourceBuffer_->getNextInt64( scale_, offset_ )
+                                                   : sourceBuffer_->getNextInt64();
+
+         // Enforce min/max specification on value
+         if ( rawValue < minimum_ || maximum_ < rawValue )
+         {
+            throw E57_EXCEPTION2( ErrorValueOutOfBounds, "rawValue=" + toString( rawValue ) +
+                                                            " minimum=" + toString( minimum_ ) +
+                                                            " maximum=" + toString( maximum_ ) );
+         }
+
+         block_.push_back( rawValue );
+      }
+
+      processed += count;
+   }
+
+   if ( block_.size() == RANS_BLOCK_RECORDS )
+   {
+      putBlock();
+   }
+
+   // Update counts of records processed
+   currentRecordIndex_ += processed;
+
+   return ( currentRecordIndex_ );
+}
+
+bool RansEncoder::putBlock()
+{
+   if ( block_.empty() )
+   {
+      return ( true );
+   }
+
+   if ( outBuffer_.size() - outBufferEnd_ < RANS_BLOCK_MAX_BYTES )
+   {
+      return ( false );
+   }
+
+   const size_t recordCount = block_.size();
+   const auto minimum = static_cast<uint64_t>( minimum_ );
+
+   // Use the residuals with the fewest significant bits. Unsigned arithmetic, so the differences
+   // wrap around instead of overflowing.
+   uint64_t minimumBits = 0;
+   uint64_t deltaBits = 0;
+   uint64_t previous = minimum;
+
+   for ( const int64_t value : block_ )
+   {
+      minimumBits += _bitLength( static_cast<uint64_t>( value ) - minimum );
+      deltaBits += _bitLength( _zigzag( static_cast<uint64_t>( value ) - previous ) );
+      previous = static_cast<uint64_t>( value );
+   }
+
+   const uint8_t mode = ( deltaBits < minimumBits ) ? RANS_MODE_DELTA : RANS_MODE_MINIMUM;
+
+   uint64_t allBits = 0;
+   previous = minimum;
+
+   for ( size_t i = 0; i < recordCount; ++i )
+   {
+      const auto value = static_cast<uint64_t>( block_[i] );
+
+      residuals_[i] = ( mode == RANS_MODE_DELTA ) ? _zigzag( value - previous ) : value - minimum;
+      allBits |= residuals_[i];
+      previous = value;
+   }
+
+   const unsigned width = ( _bitLength( allBits ) + 7 ) / 8;
+
+   char *out = blockBytes_.data();
+
+   size_t size = varintPut( out, recordCount );
+   out[size++] = static_cast<char>( mode );
+   out[size++] = static_cast<char>( width );
+
+   for ( unsigned plane = 0; plane < width; ++plane )
+   {
+      size += putPlane( plane, recordCount, &out[size] );
+   }
+
+   const size_t start = outBufferEnd_;
+
+   outBufferEnd_ += varintPut( &outBuffer_[outBufferEnd_], size );
+   memcpy( &outBuffer_[outBufferEnd_], out, size );
+   outBufferEnd_ += size;
+
+   totalBytesEncoded_ += outBufferEnd_ - start;
+   block_.clear();
+
+   return ( true );
+}
+
+size_t RansEncoder::putPlane( unsigned plane, size_t recordCount, char *out )
+{
+   uint32_t frequency[256] = {};
+
+   for ( size_t i = 0; i < recordCount; ++i )
+   {
+      symbols_[i] = static_cast<uint8_t>( residuals_[i] >> ( 8 * plane ) );
+      ++frequency[symbols_[i]];
+   }
+
+   const auto symbolCount = static_cast<size_t>(
+      256 - std::count( std::begin( frequency ), std::end( frequency ), 0U ) );
+
+   if ( symbolCount == 1 )
+   {
+      out[0] = static_cast<char>( RANS_PLANE_CONSTANT );
+      out[1] = static_cast<char>( symbols_[0] );
+      return 2;
+   }
+
+   _normalizeFrequencies( frequency, recordCount );
+
+   uint32_t start[256];
+   uint32_t total = 0;
+
+   for ( unsigned symbol = 0; symbol < 256; ++symbol )
+   {
+      start[symbol] = total;
+      total += frequency[symbol];
+   }
+
+   // rANS codes in reverse, so the payload is written backwards from its end. The states are
+   // interleaved: record i uses state i % RANS_STATE_COUNT.
+   uint8_t *const payloadEnd = payload_.data() + payload_.size();
+   uint8_t *ptr = payloadEnd;
+
+   uint32_t state[RANS_STATE_COUNT];
+   std::fill( std::begin( state ), std::end( state ), RANS_STATE_LOWER );
+
+   for ( size_t i = recordCount; i-- > 0; )
+   {
+      uint32_t &x = state[i % RANS_STATE_COUNT];
+
+      const uint8_t symbol = symbols_[i];
+      const uint32_t freq = frequency[symbol];
+      const uint32_t xMax = ( ( RANS_STATE_LOWER >> RANS_PROB_BITS ) << 8 ) * freq;
+
+      while ( x >= xMax )
+      {
+         *--ptr = static_cast<uint8_t>( x );
+         x >>= 8;
+      }
+
+      x = ( ( x / freq ) << RANS_PROB_BITS ) + ( x % freq ) + start[symbol];
+   }
+
+   // The decoder reads state 0 first
+   for ( size_t j = RANS_STATE_COUNT; j-- > 0; )
+   {
+      ptr -= 4;
+
+      for ( unsigned b = 0; b < 4; ++b )
+      {
+         ptr[b] = static_cast<uint8_t>( state[j] >> ( 8 * b ) );
+      }
+   }
+
+   const auto payloadSize = static_cast<size_t>( payloadEnd - ptr );
+
+   size_t tableSize = 1 + varintSize( symbolCount ) + varintSize( payloadSize );
+
+   for ( const uint32_t f : frequency )
+   {
+      tableSize += ( f != 0 ) ? 1 + varintSize( f ) : 0;
+   }
+
+   // Store the bytes as they are if coding them doesn't help
+   if ( tableSize + payloadSize >= 1 + recordCount )
+   {
+      out[0] = static_cast<char>( RANS_PLANE_RAW );
+      memcpy( &out[1], symbols_.data(), recordCount );
+      return 1 + recordCount;
+   }
+
+   size_t size = 0;
+
+   out[size++] = static_cast<char>( RANS_PLANE_RANS );
+   size += varintPut( &out[size], symbolCount );
+
+   for ( unsigned symbol = 0; symbol < 256; ++symbol )
+   {
+      if ( frequency[symbol] != 0 )
+      {
+         out[size++] = static_cast<char>( symbol );
+         size += varintPut( &out[size], frequency[symbol] );
+      }
+   }
+
+   size += varintPut( &out[size], payloadSize );
+   memcpy( &out[size], ptr, payloadSize );
+
+   return size + payloadSize;
+}
+
+bool RansEncoder::registerFlushToOutput()
+{
+   // Write the partial block
+   return putBlock();
+}
+
+float RansEncoder::bitsPerRecord()
+{
+   if ( currentRecordIndex_ == 0 )
+   {
+      return ( 8.0F );
+   }
+
+   return ( 8.0F * static_cast<float>( totalBytesEncoded_ ) /
+            static_cast<float>( currentRecordIndex_ ) );
+}
+
+#ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
+void RansEncoder::dump( int indent, std::ostream &os ) const
+{
+   BitpackEncoder::dump( indent, os );
+   os << space( indent ) << "isScaledInteger:          " << isScaledInteger_ << std::endl;
+   os << space( indent ) << "minimum:                  " << minimum_ << std::endl;
+   os << space( indent ) << "maximum:                  " << maximum_ << std::endl;
+   os << space( indent ) << "scale:                    " << scale_ << std::endl;
+   os << space( indent ) << "offset:                   " << offset_ << std::endl;
+   os << space( indent ) << "blockSize:                " << block_.size() << std::endl;
+   os << space( indent ) << "totalBytesEncoded:        " << totalBytesEncoded_ << std::endl;
+}
+#endif
+
+//================
+
 BitpackStringEncoder::BitpackStringEncoder( unsigned bytestreamNumber, SourceDestBuffer &sbuf,
                                             unsigned outputMaxSize ) :
    BitpackEncoder( bytestreamNumber, sbuf, outputMaxSize, 1 ), totalBytesProcessed_( 0 ),
@@ -952,7 +1682,13 @@ size_t ConstantIntegerEncoder::outputAvailable() const
    return 0;
 }
 
-void ConstantIntegerEncoder::outputRead( char * /*dest*/, const size_t byteCount )
+const char *ConstantIntegerEncoder::outputData() const
+{
+   // We don't produce any output
+   return nullptr;
+}
+
+void ConstantIntegerEncoder::outputSkip( const size_t byteCount )
 {
    // Should never request any output data
    if ( byteCount > 0 )
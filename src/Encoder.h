@@ -28,6 +28,7 @@
 #pragma once
 
 #include "Common.h"
+#include "MemoryResource.h"
 
 namespace e57
 {
@@ -38,6 +39,11 @@ namespace e57
          unsigned bytestreamNumber, std::shared_ptr<CompressedVectorNodeImpl> cVector,
          std::vector<SourceDestBuffer> &sbuf, ustring &codecPath );
 
+      /// Create an encoder using codec instead of the one in the codecs of cVector
+      static std::shared_ptr<Encoder> EncoderFactory(
+         unsigned bytestreamNumber, std::shared_ptr<CompressedVectorNodeImpl> cVector,
+         std::vector<SourceDestBuffer> &sbuf, ustring &codecPath, Codec codec );
+
       virtual ~Encoder() = default;
 
       virtual uint64_t processRecords( size_t recordCount ) = 0;
@@ -46,8 +52,9 @@ namespace e57
       virtual float bitsPerRecord() = 0;
       virtual bool registerFlushToOutput() = 0;
 
-      virtual size_t outputAvailable() const = 0; /// number of bytes that can be read
-      virtual void outputRead( char *dest, size_t byteCount ) = 0; /// get data from encoder
+      virtual size_t outputAvailable() const = 0;      /// number of bytes that can be read
+      virtual const char *outputData() const = 0;      /// the bytes that can be read
+      virtual void outputSkip( size_t byteCount ) = 0; /// remove bytes which have been read
       virtual void outputClear() = 0;
 
       virtual void sourceBufferSetNew( std::vector<SourceDestBuffer> &sbufs ) = 0;
@@ -78,8 +85,9 @@ namespace e57
       float bitsPerRecord() override = 0;
       bool registerFlushToOutput() override = 0;
 
-      size_t outputAvailable() const override;                  /// number of bytes that can be read
-      void outputRead( char *dest, size_t byteCount ) override; /// get data from encoder
+      size_t outputAvailable() const override;      /// number of bytes that can be read
+      const char *outputData() const override;      /// the bytes that can be read
+      void outputSkip( size_t byteCount ) override; /// remove bytes which have been read
       void outputClear() override;
 
       void sourceBufferSetNew( std::vector<SourceDestBuffer> &sbufs ) override;
@@ -98,7 +106,7 @@ namespace e57
 
       std::shared_ptr<SourceDestBufferImpl> sourceBuffer_;
 
-      std::vector<char> outBuffer_;
+      ResourceBuffer outBuffer_;
       size_t outBufferFirst_;
       size_t outBufferEnd_;
       size_t outBufferAlignmentSize_;
@@ -173,6 +181,105 @@ namespace e57
       RegisterT register_;
    };
 
+   /// Lossless float codec: each value is XORed with the previous one and only the bits between
+   /// the leading and trailing zeros of the result are stored (with the two zero counts).
+   class FloatXorEncoder : public BitpackEncoder
+   {
+   public:
+      FloatXorEncoder( unsigned bytestreamNumber, SourceDestBuffer &sbuf, unsigned outputMaxSize,
+                       FloatPrecision precision );
+
+      uint64_t processRecords( size_t recordCount ) override;
+      bool registerFlushToOutput() override;
+      float bitsPerRecord() override;
+
+#ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
+      void dump( int indent = 0, std::ostream &os = std::cout ) const override;
+#endif
+
+   protected:
+      template <typename WordT> void encodeRecords( size_t recordCount );
+      void putBits( uint64_t value, unsigned bitCount );
+
+      FloatPrecision precision_;
+      uint64_t previousValue_ = 0;
+      uint64_t register_ = 0;
+      unsigned registerBitsUsed_ = 0;
+      uint64_t totalBitsEncoded_ = 0;
+   };
+
+   /// Integer codec storing runs of repeated values. Each run is a dictionary index (or a literal
+   /// value, which is added to the dictionary) and the run length. See CodecFormat.h.
+   class RunLengthEncoder : public BitpackEncoder
+   {
+   public:
+      RunLengthEncoder( bool isScaledInteger, unsigned bytestreamNumber, SourceDestBuffer &sbuf,
+                        unsigned outputMaxSize, int64_t minimum, int64_t maximum, double scale,
+                        double offset );
+
+      uint64_t processRecords( size_t recordCount ) override;
+      bool registerFlushToOutput() override;
+      float bitsPerRecord() override;
+
+#ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
+      void dump( int indent = 0, std::ostream &os = std::cout ) const override;
+#endif
+
+   protected:
+      void putRun();
+
+      bool isScaledInteger_;
+      int64_t minimum_;
+      int64_t maximum_;
+      double scale_;
+      double offset_;
+
+      ResourceVector<int64_t> dictionary_;
+
+      int64_t runValue_ = 0;
+      uint64_t runLength_ = 0;
+      uint64_t totalBytesEncoded_ = 0;
+   };
+
+   /// Entropy codes the residuals of integer records with rANS, a block of records at a time.
+   /// The residuals are the values minus the minimum or the differences between consecutive
+   /// values, whichever is smaller for the block. See CodecFormat.h for the format.
+   class RansEncoder : public BitpackEncoder
+   {
+   public:
+      RansEncoder( bool isScaledInteger, unsigned bytestreamNumber, SourceDestBuffer &sbuf,
+                   unsigned outputMaxSize, int64_t minimum, int64_t maximum, double scale,
+                   double offset );
+
+      uint64_t processRecords( size_t recordCount ) override;
+      bool registerFlushToOutput() override;
+      float bitsPerRecord() override;
+
+#ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
+      void dump( int indent = 0, std::ostream &os = std::cout ) const override;
+#endif
+
+   protected:
+      bool putBlock();
+      size_t putPlane( unsigned plane, size_t recordCount, char *out );
+
+      bool isScaledInteger_;
+      int64_t minimum_;
+      int64_t maximum_;
+      double scale_;
+      double offset_;
+
+      // Records of the current block, and the working buffers used to code it (kept to avoid
+      // allocating for each block)
+      ResourceVector<int64_t> block_;
+      ResourceVector<uint64_t> residuals_;
+      ResourceVector<uint8_t> symbols_;
+      ResourceVector<uint8_t> payload_;
+      ResourceBuffer blockBytes_;
+
+      uint64_t totalBytesEncoded_ = 0;
+   };
+
    class ConstantIntegerEncoder : public Encoder
    {
    public:
@@ -183,8 +290,9 @@ namespace e57
       float bitsPerRecord() override;
       bool registerFlushToOutput() override;
 
-      size_t outputAvailable() const override;                  /// number of bytes that can be read
-      void outputRead( char *dest, size_t byteCount ) override; /// get data from encoder
+      size_t outputAvailable() const override;      /// number of bytes that can be read
+      const char *outputData() const override;      /// the bytes that can be read
+      void outputSkip( size_t byteCount ) override; /// remove bytes which have been read
       void outputClear() override;
 
       void sourceBufferSetNew( std::vector<SourceDestBuffer> &sbufs ) override;
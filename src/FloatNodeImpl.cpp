@@ -156,7 +156,7 @@ namespace e57
       }
       else
       {
-         fieldName = elementName_;
+         fieldName = toUstring( elementName_ );
       }
 
       cf << space( indent ) << "<" << fieldName << " type=\"Float\"";
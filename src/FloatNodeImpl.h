@@ -62,6 +62,8 @@ namespace e57
 #endif
 
    private:
+      friend class NodeView;
+
       double value_;
       FloatPrecision precision_;
       double minimum_;
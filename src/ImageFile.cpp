@@ -297,6 +297,38 @@ ImageFile::ImageFile( const char *input, const uint64_t size, ReadChecksumPolicy
    impl_->construct2( input, size );
 }
 
+/*!
+@brief Open an ASTM E57 imaging data file for reading through a ReadRangeFunction.
+
+@details The file is opened in read mode. Instead of being read from a local file, its bytes are
+read by @a source.read in blocks which are cached (see RangeSource). This allows reading files
+from storage which is only accessible by byte ranges without copying them to a local disk first.
+
+@param [in] source Describes the file, how to read it and how to cache it.
+@param [in] checksumPolicy The percentage of checksums we compute and verify as an int. Clamped
+to 0-100.
+
+@post Resulting ImageFile is in @c open state if constructor succeeds (no exception thrown).
+
+@throw ::ErrorBadAPIArgument
+@throw ::ErrorReadFailed
+@throw ::ErrorBadChecksum
+@throw ::ErrorBadFileSignature
+@throw ::ErrorUnknownFileVersion
+@throw ::ErrorBadFileLength
+@throw ::ErrorXMLParserInit
+@throw ::ErrorXMLParser
+@throw ::ErrorBadXMLFormat
+@throw ::ErrorInternal All objects in undocumented state
+
+@see RangeSource
+*/
+ImageFile::ImageFile( const RangeSource &source, ReadChecksumPolicy checksumPolicy ) :
+   impl_( new ImageFileImpl( checksumPolicy ) )
+{
+   impl_->construct2( source );
+}
+
 /*!
 @brief Get the pre-established root StructureNode of the E57 ImageFile.
 
@@ -464,6 +496,40 @@ int ImageFile::readerCount() const
    return impl_->readerCount();
 }
 
+/*!
+@brief Set the MemoryResource used for the nodes and the large buffers of the readers and writers
+of the ImageFile.
+
+@details
+Nodes (with their element names, string values and lists of children), the packet caches of
+CompressedVectorReader objects and the buffers of the encoders and decoders of each field are
+allocated from @a memory. This only applies to the nodes, CompressedVectorReader and
+CompressedVectorWriter objects created after the call: the root and the nodes read from the file
+were already allocated when it was opened. e57::Reader and e57::Writer set their
+ReaderOptions::memoryResource and WriterOptions::memoryResource before the file is opened, so it is
+used for the whole tree.
+
+@param [in] memory The MemoryResource to use, or nullptr to use the heap (the default). It must
+outlive the readers and writers using it, and all the nodes allocated from it (including the
+handles on them kept after the ImageFile is closed).
+
+@pre This ImageFile must be open (i.e. isOpen()).
+
+@throw ::ErrorImageFileNotOpen
+@throw ::ErrorInternal All objects in undocumented state
+
+@see MemoryResource, MonotonicMemoryResource
+*/
+void ImageFile::setMemoryResource( MemoryResource *memory )
+{
+   if ( !impl_->isOpen() )
+   {
+      throw E57_EXCEPTION2( ErrorImageFileNotOpen, "fileName=" + impl_->fileName() );
+   }
+
+   impl_->setMemoryResource( memory );
+}
+
 /*!
 @brief Declare the use of an E57 extension in an ImageFile being written.
 
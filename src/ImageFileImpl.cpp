@@ -27,8 +27,12 @@
 
 #include "ImageFileImpl.h"
 #include "ASTMVersion.h"
+#include "BlobNodeImpl.h"
 #include "CheckedFile.h"
+#include "CompressedVectorNodeImpl.h"
 #include "E57XmlParser.h"
+#include "Packet.h"
+#include "SectionHeaders.h"
 #include "StringFunctions.h"
 #include "StructureNodeImpl.h"
 
@@ -74,10 +78,71 @@ namespace e57
    }
 #endif
 
+   namespace
+   {
+      // Collect the nodes in the tree which own a binary section (compressed vectors & blobs)
+      void _collectBinarySections( const NodeImplSharedPtr &node,
+                                   std::vector<NodeImplSharedPtr> &sections )
+      {
+         switch ( node->type() )
+         {
+            case TypeCompressedVector:
+            case TypeBlob:
+               sections.push_back( node );
+               break;
+
+            case TypeStructure:
+            case TypeVector:
+            {
+               auto parent = std::static_pointer_cast<StructureNodeImpl>( node );
+
+               for ( int64_t i = 0; i < parent->childCount(); ++i )
+               {
+                  _collectBinarySections( parent->get( i ), sections );
+               }
+            }
+            break;
+
+            default:
+               break;
+         }
+      }
+
+      // Move the recorded start of the binary sections by logicalShift bytes
+      void _moveBinarySections( const std::vector<NodeImplSharedPtr> &sections,
+                                uint64_t logicalShift )
+      {
+         for ( const auto &node : sections )
+         {
+            if ( node->type() == TypeCompressedVector )
+            {
+               auto cv = std::static_pointer_cast<CompressedVectorNodeImpl>( node );
+
+               // Empty compressed vectors have no binary section
+               if ( cv->getBinarySectionLogicalStart() != 0 )
+               {
+                  cv->setBinarySectionLogicalStart( cv->getBinarySectionLogicalStart() +
+                                                    logicalShift );
+               }
+            }
+            else
+            {
+               auto blob = std::static_pointer_cast<BlobNodeImpl>( node );
+
+               blob->setBinarySectionLogicalStart( blob->getBinarySectionLogicalStart() +
+                                                   logicalShift );
+            }
+         }
+      }
+   }
+
    ImageFileImpl::ImageFileImpl( ReadChecksumPolicy policy ) :
       isWriter_( false ), writerCount_( 0 ), readerCount_( 0 ),
       checksumPolicy( std::max( 0, std::min( policy, 100 ) ) ), file_( nullptr ),
-      xmlLogicalOffset_( 0 ), xmlLogicalLength_( 0 ), unusedLogicalStart_( 0 )
+      packetCacheSize_( PACKET_CACHE_DEFAULT_SIZE ), columnGroupedPackets_( false ),
+      codecSelectionSampleSize_( 0 ), codecSelectionTolerance_( 0.0 ), memoryResource_( nullptr ),
+      xmlAtFront_( false ), progressiveReadTimeout_( 0 ), xmlLogicalOffset_( 0 ),
+      xmlLogicalLength_( 0 ), unusedLogicalStart_( 0 )
    {
       // First phase of construction, can't do much until have the ImageFile object. See
       // ImageFileImpl::construct2() for second phase.
@@ -114,7 +179,7 @@ namespace e57
             // Open file for writing, truncate if already exists.
             file_ = new CheckedFile( fileName_, CheckedFile::Write, checksumPolicy );
 
-            std::shared_ptr<StructureNodeImpl> root( new StructureNodeImpl( imf ) );
+            std::shared_ptr<StructureNodeImpl> root( makeNode<StructureNodeImpl>( imf ) );
             root_ = root;
             root_->setAttachedRecursive();
 
@@ -138,8 +203,9 @@ namespace e57
       {
          // Open file for reading.
          file_ = new CheckedFile( fileName_, CheckedFile::Read, checksumPolicy );
+         file_->setWaitForData( progressiveReadTimeout_ );
 
-         std::shared_ptr<StructureNodeImpl> root( new StructureNodeImpl( imf ) );
+         std::shared_ptr<StructureNodeImpl> root( makeNode<StructureNodeImpl>( imf ) );
          root_ = root;
          root_->setAttachedRecursive();
 
@@ -188,21 +254,36 @@ namespace e57
 #ifdef E57_VERBOSE
       std::cout << "ImageFileImpl() called, fileName=<StreamBuffer> mode=r" << std::endl;
 #endif
-      unusedLogicalStart_ = sizeof( E57FileHeader );
       fileName_ = "<StreamBuffer>";
 
+      openReadOnly( new CheckedFile( input, size, checksumPolicy ) );
+   }
+
+   void ImageFileImpl::construct2( const RangeSource &source )
+   {
+      // Second phase of construction, now we have a well-formed ImageFile object.
+
+#ifdef E57_VERBOSE
+      std::cout << "ImageFileImpl() called, fileName=" << source.name << " mode=r" << std::endl;
+#endif
+      fileName_ = source.name;
+
+      openReadOnly( new CheckedFile( source, checksumPolicy ) );
+   }
+
+   void ImageFileImpl::openReadOnly( CheckedFile *file )
+   {
+      unusedLogicalStart_ = sizeof( E57FileHeader );
+
       // Get shared_ptr to this object
       ImageFileImplSharedPtr imf = shared_from_this();
 
       isWriter_ = false;
-      file_ = nullptr;
+      file_ = file;
 
       try
       {
-         // Open file for reading.
-         file_ = new CheckedFile( input, size, checksumPolicy );
-
-         std::shared_ptr<StructureNodeImpl> root( new StructureNodeImpl( imf ) );
+         std::shared_ptr<StructureNodeImpl> root( makeNode<StructureNodeImpl>( imf ) );
          root_ = root;
          root_->setAttachedRecursive();
 
@@ -261,48 +342,173 @@ namespace e57
 
       if ( isWriter_ )
       {
-         // Go to end of file, note physical position
-         xmlLogicalOffset_ = unusedLogicalStart_;
-         file_->seek( xmlLogicalOffset_, CheckedFile::Logical );
-         uint64_t xmlPhysicalOffset = file_->position( CheckedFile::Physical );
-         *file_ << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+         uint64_t xmlPhysicalOffset = 0;
 
-         //??? need to add name space attributes to e57Root
-         root_->writeXml( shared_from_this(), *file_, 0, "e57Root" );
+         if ( xmlAtFront_ )
+         {
+            xmlPhysicalOffset = writeXmlAtFront();
+         }
+         else
+         {
+            xmlPhysicalOffset = writeXmlSection( unusedLogicalStart_ );
+         }
+
+         writeFileHeader( xmlPhysicalOffset );
+
+         file_->close();
+      }
+
+      delete file_;
+      file_ = nullptr;
+   }
+
+   uint64_t ImageFileImpl::writeXmlSection( uint64_t logicalOffset )
+   {
+      // Note physical position
+      xmlLogicalOffset_ = logicalOffset;
+      file_->seek( xmlLogicalOffset_, CheckedFile::Logical );
+      uint64_t xmlPhysicalOffset = file_->position( CheckedFile::Physical );
+      *file_ << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+
+      //??? need to add name space attributes to e57Root
+      root_->writeXml( shared_from_this(), *file_, 0, "e57Root" );
+
+      // Pad XML section so length is multiple of 4
+      while ( ( file_->position( CheckedFile::Logical ) - xmlLogicalOffset_ ) % 4 != 0 )
+      {
+         *file_ << " ";
+      }
+
+      // Note logical length
+      xmlLogicalLength_ = file_->position( CheckedFile::Logical ) - xmlLogicalOffset_;
+
+      return xmlPhysicalOffset;
+   }
 
-         // Pad XML section so length is multiple of 4
-         while ( ( file_->position( CheckedFile::Logical ) - xmlLogicalOffset_ ) % 4 != 0 )
+   uint64_t ImageFileImpl::writeXmlAtFront()
+   {
+      constexpr uint64_t logicalPageSize = CheckedFile::logicalPageSize;
+
+      // The XML is first written after the binary sections to find its length. Then the pages
+      // holding the binary sections are moved up by enough whole pages to fit it after the
+      // header. Whole pages keep their checksums, so only the offsets which refer to the moved
+      // data have to be changed.
+      const uint64_t binaryLogicalEnd = unusedLogicalStart_;
+
+      std::vector<NodeImplSharedPtr> sections;
+      _collectBinarySections( root_, sections );
+
+      uint64_t pageShift = 0;
+
+      for ( ;; )
+      {
+         writeXmlSection( binaryLogicalEnd );
+
+         const uint64_t pagesNeeded = ( xmlLogicalLength_ + logicalPageSize - 1 ) / logicalPageSize;
+
+         if ( pagesNeeded <= pageShift )
          {
-            *file_ << " ";
+            break;
          }
 
-         // Note logical length
-         xmlLogicalLength_ = file_->position( CheckedFile::Logical ) - xmlLogicalOffset_;
+         // The file offsets in the XML may get longer when they move, so measure it again
+         _moveBinarySections( sections, ( pagesNeeded - pageShift ) * logicalPageSize );
+         pageShift = pagesNeeded;
+      }
+
+      ustring xml( static_cast<size_t>( xmlLogicalLength_ ), ' ' );
 
-         // Init header contents
-         E57FileHeader header;
+      file_->seek( xmlLogicalOffset_ );
+      file_->read( &xml[0], xml.size() );
 
-         memcpy( &header.fileSignature, "ASTM-E57", 8 );
+      // Move everything up to the end of the binary sections, including the page of the header
+      const uint64_t binaryPageEnd = ( binaryLogicalEnd + logicalPageSize - 1 ) / logicalPageSize;
 
-         header.majorVersion = E57_FORMAT_MAJOR;
-         header.minorVersion = E57_FORMAT_MINOR;
-         header.filePhysicalLength = file_->length( CheckedFile::Physical );
-         header.xmlPhysicalOffset = xmlPhysicalOffset;
-         header.xmlLogicalLength = xmlLogicalLength_;
-         header.pageSize = CheckedFile::physicalPageSize;
-#ifdef E57_VERBOSE
-         header.dump();
-#endif
+      file_->movePages( 0, binaryPageEnd, pageShift );
+
+      // The section headers of the compressed vectors point to their packets
+      const uint64_t physicalShift = pageShift * CheckedFile::physicalPageSize;
+
+      for ( const auto &node : sections )
+      {
+         if ( node->type() != TypeCompressedVector )
+         {
+            continue;
+         }
+
+         const uint64_t sectionStart =
+            std::static_pointer_cast<CompressedVectorNodeImpl>( node )
+               ->getBinarySectionLogicalStart();
 
-         // Write header at beginning of file
-         file_->seek( 0 );
+         if ( sectionStart == 0 )
+         {
+            continue;
+         }
+
+         CompressedVectorSectionHeader header;
+
+         file_->seek( sectionStart );
+         file_->read( reinterpret_cast<char *>( &header ), sizeof( header ) );
+
+         if ( header.dataPhysicalOffset != 0 )
+         {
+            header.dataPhysicalOffset += physicalShift;
+         }
+
+         if ( header.indexPhysicalOffset != 0 )
+         {
+            header.indexPhysicalOffset += physicalShift;
+         }
+
+         file_->seek( sectionStart );
          file_->write( reinterpret_cast<char *>( &header ), sizeof( header ) );
+      }
 
-         file_->close();
+      // Write the XML after the header, padded with spaces up to the first moved byte
+      xmlLogicalOffset_ = sizeof( E57FileHeader );
+      xmlLogicalLength_ = pageShift * logicalPageSize;
+      xml.resize( static_cast<size_t>( xmlLogicalLength_ ), ' ' );
+
+      file_->seek( xmlLogicalOffset_ );
+      file_->write( xml.data(), xml.size() );
+
+      // Clear what is left of the old XML section in the last page
+      unusedLogicalStart_ = binaryLogicalEnd + pageShift * logicalPageSize;
+
+      const auto tailSize = static_cast<size_t>(
+         ( logicalPageSize - unusedLogicalStart_ % logicalPageSize ) % logicalPageSize );
+
+      if ( tailSize > 0 )
+      {
+         const std::vector<char> zeros( tailSize, 0 );
+
+         file_->seek( unusedLogicalStart_ );
+         file_->write( zeros.data(), zeros.size() );
       }
 
-      delete file_;
-      file_ = nullptr;
+      return CheckedFile::logicalToPhysical( xmlLogicalOffset_ );
+   }
+
+   void ImageFileImpl::writeFileHeader( uint64_t xmlPhysicalOffset )
+   {
+      // Init header contents
+      E57FileHeader header;
+
+      memcpy( &header.fileSignature, "ASTM-E57", 8 );
+
+      header.majorVersion = E57_FORMAT_MAJOR;
+      header.minorVersion = E57_FORMAT_MINOR;
+      header.filePhysicalLength = file_->length( CheckedFile::Physical );
+      header.xmlPhysicalOffset = xmlPhysicalOffset;
+      header.xmlLogicalLength = xmlLogicalLength_;
+      header.pageSize = CheckedFile::physicalPageSize;
+#ifdef E57_VERBOSE
+      header.dump();
+#endif
+
+      // Write header at beginning of file
+      file_->seek( 0 );
+      file_->write( reinterpret_cast<char *>( &header ), sizeof( header ) );
    }
 
    void ImageFileImpl::cancel()
@@ -394,6 +600,84 @@ namespace e57
       return fileName_;
    }
 
+   void ImageFileImpl::setPacketCacheSize( unsigned packetCount )
+   {
+      if ( packetCount == 0 )
+      {
+         throw E57_EXCEPTION2( ErrorBadAPIArgument, "packetCount=" + toString( packetCount ) );
+      }
+
+      packetCacheSize_ = packetCount;
+   }
+
+   unsigned ImageFileImpl::packetCacheSize() const
+   {
+      return packetCacheSize_;
+   }
+
+   void ImageFileImpl::setDirectIO( bool enable )
+   {
+      checkImageFileOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+
+      if ( !isWriter_ )
+      {
+         throw E57_EXCEPTION2( ErrorFileReadOnly, "fileName=" + fileName_ );
+      }
+
+      file_->setDirectIO( enable );
+   }
+
+   void ImageFileImpl::setColumnGroupedPackets( bool enable )
+   {
+      columnGroupedPackets_ = enable;
+   }
+
+   bool ImageFileImpl::columnGroupedPackets() const
+   {
+      return columnGroupedPackets_;
+   }
+
+   void ImageFileImpl::setXmlAtFront( bool enable )
+   {
+      xmlAtFront_ = enable;
+   }
+
+   bool ImageFileImpl::xmlAtFront() const
+   {
+      return xmlAtFront_;
+   }
+
+   void ImageFileImpl::setProgressiveReadTimeout( unsigned timeoutMs )
+   {
+      progressiveReadTimeout_ = timeoutMs;
+   }
+
+   void ImageFileImpl::setCodecSelection( size_t sampleSize, double sizeTolerance )
+   {
+      codecSelectionSampleSize_ = sampleSize;
+      codecSelectionTolerance_ = std::max( 0.0, sizeTolerance );
+   }
+
+   size_t ImageFileImpl::codecSelectionSampleSize() const
+   {
+      return codecSelectionSampleSize_;
+   }
+
+   double ImageFileImpl::codecSelectionTolerance() const
+   {
+      return codecSelectionTolerance_;
+   }
+
+   void ImageFileImpl::setMemoryResource( MemoryResource *memory )
+   {
+      memoryResource_ = memory;
+   }
+
+   MemoryResource *ImageFileImpl::memoryResource() const
+   {
+      return memoryResource_;
+   }
+
    void ImageFileImpl::extensionsAdd( const ustring &prefix, const ustring &uri )
    {
       checkImageFileOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
@@ -917,6 +1201,12 @@ namespace e57
                                   " header.minorVersion=" + toString( header.minorVersion ) );
       }
 
+      // If the file is still arriving, its length is the one it will have
+      if ( file->waitsForData() )
+      {
+         file->setExpectedLength( header.filePhysicalLength );
+      }
+
       // Check if file length matches actual physical length
       if ( header.filePhysicalLength != file->length( CheckedFile::Physical ) )
       {
@@ -45,6 +45,7 @@ namespace e57
 
       void construct2( const ustring &fileName, const ustring &mode );
       void construct2( const char *input, uint64_t size );
+      void construct2( const RangeSource &source );
 
       std::shared_ptr<StructureNodeImpl> root();
 
@@ -60,6 +61,36 @@ namespace e57
       CheckedFile *file() const;
       ustring fileName() const;
 
+      /// Number of packets cached by each CompressedVectorReader
+      void setPacketCacheSize( unsigned packetCount );
+      unsigned packetCacheSize() const;
+
+      /// Write large aligned runs of pages bypassing the OS cache (writers only)
+      void setDirectIO( bool enable );
+
+      /// Write each data packet of compressed vectors with the data of a single bytestream
+      void setColumnGroupedPackets( bool enable );
+      bool columnGroupedPackets() const;
+
+      /// Select the codecs of the fields of compressed vectors by trial encoding the first
+      /// sampleSize records (0 disables it)
+      void setCodecSelection( size_t sampleSize, double sizeTolerance );
+      size_t codecSelectionSampleSize() const;
+      double codecSelectionTolerance() const;
+
+      /// Put the XML section right after the file header when the file is closed (writers only)
+      void setXmlAtFront( bool enable );
+      bool xmlAtFront() const;
+
+      /// Wait up to timeoutMs for data which hasn't arrived yet when reading (0 disables it).
+      /// Must be set before construct2().
+      void setProgressiveReadTimeout( unsigned timeoutMs );
+
+      /// Memory for the nodes and the buffers of readers & writers (nullptr uses the heap). Must be
+      /// set before construct2() to also apply to the root and the nodes read from the file.
+      void setMemoryResource( MemoryResource *memory );
+      MemoryResource *memoryResource() const;
+
       /// Manipulate registered extensions in the file
       void extensionsAdd( const ustring &prefix, const ustring &uri );
       bool extensionsLookupPrefix( const ustring &prefix, ustring &uri ) const;
@@ -101,6 +132,12 @@ namespace e57
 
       static void readFileHeader( CheckedFile *file, E57FileHeader &header );
 
+      void openReadOnly( CheckedFile *file );
+
+      uint64_t writeXmlSection( uint64_t logicalOffset );
+      uint64_t writeXmlAtFront();
+      void writeFileHeader( uint64_t xmlPhysicalOffset );
+
       void checkImageFileOpen( const char *srcFileName, int srcLineNumber,
                                const char *srcFunctionName ) const;
 
@@ -113,6 +150,15 @@ namespace e57
 
       CheckedFile *file_;
 
+      // Number of packets in the read cache of each CompressedVectorReader
+      unsigned packetCacheSize_;
+      bool columnGroupedPackets_;
+      size_t codecSelectionSampleSize_;
+      double codecSelectionTolerance_;
+      MemoryResource *memoryResource_;
+      bool xmlAtFront_;
+      unsigned progressiveReadTimeout_;
+
       // Read file attributes
       uint64_t xmlLogicalOffset_;
       uint64_t xmlLogicalLength_;
@@ -144,7 +144,7 @@ be true).
 */
 IntegerNode::IntegerNode( const ImageFile &destImageFile, int64_t value, int64_t minimum,
                           int64_t maximum ) :
-   impl_( new IntegerNodeImpl( destImageFile.impl(), value, minimum, maximum ) )
+   impl_( makeNode<IntegerNodeImpl>( destImageFile.impl(), value, minimum, maximum ) )
 {
    impl_->validateValue();
 }
@@ -129,7 +129,7 @@ namespace e57
       }
       else
       {
-         fieldName = elementName_;
+         fieldName = toUstring( elementName_ );
       }
 
       cf << space( indent ) << "<" << fieldName << " type=\"Integer\"";
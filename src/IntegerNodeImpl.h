@@ -61,6 +61,8 @@ namespace e57
 #endif
 
    private:
+      friend class NodeView;
+
       int64_t value_;
       int64_t minimum_;
       int64_t maximum_;
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <cstdint>
+
+#include "ImageFileImpl.h"
+#include "MemoryResource.h"
+#include "SourceDestBufferImpl.h"
+#include "StringFunctions.h"
+
+namespace e57
+{
+   MonotonicMemoryResource::MonotonicMemoryResource( size_t blockSize ) :
+      blockSize_( std::max( blockSize, static_cast<size_t>( 1024 ) ) )
+   {
+   }
+
+   MonotonicMemoryResource::~MonotonicMemoryResource() = default;
+
+   void *MonotonicMemoryResource::allocate( size_t bytes, size_t alignment )
+   {
+      if ( ( alignment == 0 ) || ( ( alignment & ( alignment - 1 ) ) != 0 ) )
+      {
+         throw E57_EXCEPTION2( ErrorInternal, "alignment=" + toString( alignment ) );
+      }
+
+      const auto padding = [this, alignment]() {
+         return ( alignment - reinterpret_cast<uintptr_t>( next_ ) % alignment ) % alignment;
+      };
+
+      if ( ( next_ == nullptr ) || ( padding() + bytes > available_ ) )
+      {
+         // Start a new block, large enough for the allocation and its alignment
+         const size_t cSize = std::max( blockSize_, bytes + alignment );
+
+         blocks_.emplace_back( new char[cSize] );
+         heapBytes_ += cSize;
+
+         next_ = blocks_.back().get();
+         available_ = cSize;
+      }
+
+      const size_t cPadding = padding();
+      char *p = next_ + cPadding;
+
+      next_ += cPadding + bytes;
+      available_ -= cPadding + bytes;
+
+      return p;
+   }
+
+   void MonotonicMemoryResource::deallocate( void * /*p*/, size_t /*bytes*/,
+                                             size_t /*alignment*/ )
+   {
+      // Only released all at once
+   }
+
+   void MonotonicMemoryResource::release()
+   {
+      blocks_.clear();
+      heapBytes_ = 0;
+      next_ = nullptr;
+      available_ = 0;
+   }
+
+   size_t MonotonicMemoryResource::heapBytes() const
+   {
+      return heapBytes_;
+   }
+
+   MemoryResource *bufferMemoryResource( const SourceDestBuffer &buf )
+   {
+      return imageFileMemoryResource( buf.impl()->destImageFile() );
+   }
+
+   MemoryResource *imageFileMemoryResource( const ImageFileImplWeakPtr &imf )
+   {
+      ImageFileImplSharedPtr imfi = imf.lock();
+
+      return ( imfi != nullptr ) ? imfi->memoryResource() : nullptr;
+   }
+}
@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#include "Common.h"
+
+namespace e57
+{
+   /// Allocator for standard containers which allocates from a MemoryResource, or the heap if
+   /// there is none. Memory is always aligned at least like operator new does, since the buffers
+   /// are accessed as words.
+   template <typename T> class ResourceAllocator
+   {
+   public:
+      using value_type = T;
+
+      ResourceAllocator() noexcept = default;
+
+      explicit ResourceAllocator( MemoryResource *memory ) noexcept : memory_( memory )
+      {
+      }
+
+      template <typename U>
+      ResourceAllocator( const ResourceAllocator<U> &other ) noexcept : memory_( other.memory() )
+      {
+      }
+
+      T *allocate( size_t count )
+      {
+         if ( memory_ == nullptr )
+         {
+            return std::allocator<T>().allocate( count );
+         }
+
+         return static_cast<T *>( memory_->allocate( count * sizeof( T ), alignment() ) );
+      }
+
+      void deallocate( T *p, size_t count ) noexcept
+      {
+         if ( memory_ == nullptr )
+         {
+            std::allocator<T>().deallocate( p, count );
+            return;
+         }
+
+         memory_->deallocate( p, count * sizeof( T ), alignment() );
+      }
+
+      MemoryResource *memory() const noexcept
+      {
+         return memory_;
+      }
+
+      static constexpr size_t alignment() noexcept
+      {
+         return std::max( alignof( T ), alignof( std::max_align_t ) );
+      }
+
+   private:
+      MemoryResource *memory_ = nullptr;
+   };
+
+   template <typename T, typename U>
+   bool operator==( const ResourceAllocator<T> &lhs, const ResourceAllocator<U> &rhs ) noexcept
+   {
+      return lhs.memory() == rhs.memory();
+   }
+
+   template <typename T, typename U>
+   bool operator!=( const ResourceAllocator<T> &lhs, const ResourceAllocator<U> &rhs ) noexcept
+   {
+      return lhs.memory() != rhs.memory();
+   }
+
+   /// Vector allocated from a MemoryResource
+   template <typename T> using ResourceVector = std::vector<T, ResourceAllocator<T>>;
+
+   /// Buffer of bytes allocated from a MemoryResource
+   using ResourceBuffer = ResourceVector<char>;
+
+   /// String allocated from a MemoryResource (the names and values stored in nodes)
+   using ResourceString = std::basic_string<char, std::char_traits<char>, ResourceAllocator<char>>;
+
+   /// Copy of str allocated from the heap, for the API
+   inline ustring toUstring( const ResourceString &str )
+   {
+      return { str.data(), str.size() };
+   }
+
+   /// MemoryResource of the ImageFile of buf (nullptr if it uses the heap)
+   MemoryResource *bufferMemoryResource( const SourceDestBuffer &buf );
+
+   /// MemoryResource of imf (nullptr if it uses the heap or imf is gone)
+   MemoryResource *imageFileMemoryResource( const ImageFileImplWeakPtr &imf );
+}
@@ -534,6 +534,58 @@ bool Node::isAttached() const
    return impl_->isAttached();
 }
 
+/*!
+@brief Walk the tree below the node, giving a view of each node to a visitor.
+
+@param [in] visitor Receives the nodes, depth first and in the order of the children.
+
+@details
+Walking a tree with StructureNode::get and VectorNode::get makes a handle for each node, and each
+must be checked with Node::type and downcast before its value can be read. This walks the tree
+directly: the NodeView given to the visitor reads the node without making handles or changing
+reference counts (only the names and string values it returns are copied), so large trees of
+metadata are cheap to walk. Use NodeView::node to get a handle
+on a node.
+
+The prototype and codecs of a CompressedVectorNode are visited as its children, but not its
+records.
+@code
+struct CountFloats : e57::NodeVisitor
+{
+   int64_t count = 0;
+
+   bool enter( const e57::NodeView &node ) override
+   {
+      count += ( node.type() == e57::TypeFloat ) ? 1 : 0;
+
+      // Don't go into the prototypes
+      return node.type() != e57::TypeCompressedVector;
+   }
+};
+
+CountFloats visitor;
+
+imf.root().visit( visitor );
+@endcode
+
+@pre The destination ImageFile must be open (i.e. destImageFile().isOpen()).
+@pre The tree must not be modified during the walk.
+@post No visible object state is modified.
+
+@throw ::ErrorImageFileNotOpen
+@throw ::ErrorInternal All objects in undocumented state
+
+Exceptions thrown by the visitor end the walk and are passed on.
+
+@see NodeVisitor, NodeView
+*/
+void Node::visit( NodeVisitor &visitor ) const
+{
+   impl_->checkImageFileOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+
+   NodeView::visit( impl_.get(), nullptr, 0, visitor );
+}
+
 /*!
 @brief Diagnostic function to print internal state of object to output stream in an indented format.
 
@@ -34,7 +34,9 @@
 using namespace e57;
 
 NodeImpl::NodeImpl( ImageFileImplWeakPtr destImageFile ) :
-   destImageFile_( destImageFile ), isAttached_( false )
+   destImageFile_( destImageFile ),
+   elementName_( ResourceAllocator<char>( imageFileMemoryResource( destImageFile ) ) ),
+   isAttached_( false ), isTypeConstrained_( false )
 {
    checkImageFileOpen(
       __FILE__, __LINE__,
@@ -88,10 +90,10 @@ ustring NodeImpl::pathName() const
 
    if ( p->isRoot() )
    {
-      return ( "/" + elementName_ );
+      return ( "/" + toUstring( elementName_ ) );
    }
 
-   return ( p->pathName() + "/" + elementName_ );
+   return ( p->pathName() + "/" + toUstring( elementName_ ) );
 }
 
 ustring NodeImpl::relativePathName( const NodeImplSharedPtr &origin, ustring childPathName ) const
@@ -114,17 +116,17 @@ ustring NodeImpl::relativePathName( const NodeImplSharedPtr &origin, ustring chi
 
    if ( childPathName.empty() )
    {
-      return p->relativePathName( origin, elementName_ );
+      return p->relativePathName( origin, toUstring( elementName_ ) );
    }
 
-   return p->relativePathName( origin, elementName_ + "/" + childPathName );
+   return p->relativePathName( origin, toUstring( elementName_ ) + "/" + childPathName );
 }
 
 ustring NodeImpl::elementName() const
 {
    checkImageFileOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
 
-   return elementName_;
+   return toUstring( elementName_ );
 }
 
 ImageFileImplSharedPtr NodeImpl::destImageFile()
@@ -176,7 +178,7 @@ void NodeImpl::setParent( NodeImplSharedPtr parent, const ustring &elementName )
    }
 
    parent_ = parent;
-   elementName_ = elementName;
+   elementName_.assign( elementName.data(), elementName.size() );
 
    // If parent is attached then we are attached (and all of our children)
    if ( parent->isAttached() )
@@ -203,6 +205,11 @@ bool NodeImpl::isTypeConstrained()
    // don't checkImageFileOpen
    // A node is type constrained if any of its parents is an homo VECTOR or COMPRESSED_VECTOR with
    // more than one child
+   if ( isTypeConstrained_ )
+   {
+      return ( true );
+   }
+
    NodeImplSharedPtr p( shared_from_this() );
 
    while ( !p->isRoot() )
@@ -210,6 +217,13 @@ bool NodeImpl::isTypeConstrained()
       // We have a parent since we are not root
       p = NodeImplSharedPtr( p->parent_ ); //??? check if bad ptr?
 
+      // If our parent is constrained, so are we
+      if ( p->isTypeConstrained_ )
+      {
+         isTypeConstrained_ = true;
+         return ( true );
+      }
+
       switch ( p->type() )
       {
          case TypeVector:
@@ -220,6 +234,7 @@ bool NodeImpl::isTypeConstrained()
             // If homogeneous vector and have more than one child, then can't change them
             if ( !ai->allowHeteroChildren() && ai->childCount() > 1 )
             {
+               isTypeConstrained_ = true;
                return ( true );
             }
          }
@@ -227,6 +242,7 @@ bool NodeImpl::isTypeConstrained()
          case TypeCompressedVector:
             // Can't make any type changes to CompressedVector prototype.  ???
             // what if hasn't been written to yet
+            isTypeConstrained_ = true;
             return ( true );
          default:
             break;
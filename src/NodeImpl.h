@@ -28,6 +28,7 @@
 #pragma once
 
 #include "Common.h"
+#include "MemoryResource.h"
 
 namespace e57
 {
@@ -88,6 +89,7 @@ namespace e57
       friend class CompressedVectorWriterImpl;
       friend class Decoder;
       friend class Encoder;
+      friend class NodeView;
 
       explicit NodeImpl( ImageFileImplWeakPtr destImageFile );
 
@@ -98,9 +100,29 @@ namespace e57
 
       NodeImplSharedPtr getRoot();
 
+      /// MemoryResource the node and its strings and children are allocated from
+      MemoryResource *memoryResource() const
+      {
+         return elementName_.get_allocator().memory();
+      }
+
       ImageFileImplWeakPtr destImageFile_;
       NodeImplWeakPtr parent_;
-      ustring elementName_;
+      ResourceString elementName_;
       bool isAttached_;
+
+      // Cached result of isTypeConstrained() once it is true. It can't become false again since
+      // parents are never changed and children are never removed.
+      bool isTypeConstrained_;
    };
+
+   /// Makes a node of the ImageFile imf, allocated from its MemoryResource. The resource must
+   /// outlive the node.
+   template <typename NodeT, typename... Args>
+   std::shared_ptr<NodeT> makeNode( const ImageFileImplWeakPtr &imf, Args &&...args )
+   {
+      const ResourceAllocator<NodeT> allocator( imageFileMemoryResource( imf ) );
+
+      return std::allocate_shared<NodeT>( allocator, imf, std::forward<Args>( args )... );
+   }
 }
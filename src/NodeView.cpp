@@ -0,0 +1,212 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "BlobNodeImpl.h"
+#include "CompressedVectorNodeImpl.h"
+#include "FloatNodeImpl.h"
+#include "IntegerNodeImpl.h"
+#include "ScaledIntegerNodeImpl.h"
+#include "StringFunctions.h"
+#include "StringNodeImpl.h"
+#include "VectorNodeImpl.h"
+
+namespace e57
+{
+   namespace
+   {
+      // Names of the children of a CompressedVectorNode, which aren't stored in the nodes
+      const char *const cPrototypeName = "prototype";
+      const char *const cCodecsName = "codecs";
+   }
+
+   NodeView::NodeView( const NodeImpl *impl, const char *elementName, unsigned depth ) :
+      impl_( impl ),
+      elementName_( ( elementName != nullptr ) ? elementName : impl->elementName_.c_str() ),
+      depth_( depth )
+   {
+   }
+
+   /// Walks the tree depth first. Nothing is allocated and the shared pointers of the children
+   /// are only read, so no reference counts change.
+   void NodeView::visit( const NodeImpl *impl, const char *elementName, unsigned depth,
+                         NodeVisitor &visitor )
+   {
+      const NodeView view( impl, elementName, depth );
+
+      if ( !visitor.enter( view ) )
+      {
+         return;
+      }
+
+      switch ( impl->type() )
+      {
+         case TypeStructure:
+         case TypeVector:
+            for ( const auto &child : static_cast<const StructureNodeImpl *>( impl )->children_ )
+            {
+               visit( child.get(), nullptr, depth + 1, visitor );
+            }
+            break;
+
+         case TypeCompressedVector:
+         {
+            const auto *cvImpl = static_cast<const CompressedVectorNodeImpl *>( impl );
+
+            if ( cvImpl->prototype_ )
+            {
+               visit( cvImpl->prototype_.get(), cPrototypeName, depth + 1, visitor );
+            }
+
+            if ( cvImpl->codecs_ )
+            {
+               visit( cvImpl->codecs_.get(), cCodecsName, depth + 1, visitor );
+            }
+            break;
+         }
+
+         default:
+            break;
+      }
+
+      visitor.leave( view );
+   }
+
+   template <typename ImplT> const ImplT *NodeView::implAs( NodeType type ) const
+   {
+      if ( impl_->type() != type )
+      {
+         throw E57_EXCEPTION2( ErrorBadNodeDowncast, "elementName=" + elementName() +
+                                                        " nodeType=" + toString( impl_->type() ) +
+                                                        " expectedType=" + toString( type ) );
+      }
+
+      return static_cast<const ImplT *>( impl_ );
+   }
+
+   NodeType NodeView::type() const
+   {
+      return impl_->type();
+   }
+
+   ustring NodeView::elementName() const
+   {
+      return elementName_;
+   }
+
+   unsigned NodeView::depth() const
+   {
+      return depth_;
+   }
+
+   int64_t NodeView::childCount() const
+   {
+      switch ( impl_->type() )
+      {
+         case TypeStructure:
+         case TypeVector:
+            return static_cast<int64_t>(
+               static_cast<const StructureNodeImpl *>( impl_ )->children_.size() );
+
+         case TypeCompressedVector:
+         {
+            const auto *cvImpl = static_cast<const CompressedVectorNodeImpl *>( impl_ );
+
+            return ( cvImpl->prototype_ ? 1 : 0 ) + ( cvImpl->codecs_ ? 1 : 0 );
+         }
+
+         default:
+            return 0;
+      }
+   }
+
+   int64_t NodeView::integerValue() const
+   {
+      if ( impl_->type() == TypeScaledInteger )
+      {
+         return static_cast<const ScaledIntegerNodeImpl *>( impl_ )->value_;
+      }
+
+      return implAs<IntegerNodeImpl>( TypeInteger )->value_;
+   }
+
+   int64_t NodeView::integerMinimum() const
+   {
+      if ( impl_->type() == TypeScaledInteger )
+      {
+         return static_cast<const ScaledIntegerNodeImpl *>( impl_ )->minimum_;
+      }
+
+      return implAs<IntegerNodeImpl>( TypeInteger )->minimum_;
+   }
+
+   int64_t NodeView::integerMaximum() const
+   {
+      if ( impl_->type() == TypeScaledInteger )
+      {
+         return static_cast<const ScaledIntegerNodeImpl *>( impl_ )->maximum_;
+      }
+
+      return implAs<IntegerNodeImpl>( TypeInteger )->maximum_;
+   }
+
+   double NodeView::scaledValue() const
+   {
+      const auto *scaledImpl = implAs<ScaledIntegerNodeImpl>( TypeScaledInteger );
+
+      return static_cast<double>( scaledImpl->value_ ) * scaledImpl->scale_ + scaledImpl->offset_;
+   }
+
+   double NodeView::scale() const
+   {
+      return implAs<ScaledIntegerNodeImpl>( TypeScaledInteger )->scale_;
+   }
+
+   double NodeView::offset() const
+   {
+      return implAs<ScaledIntegerNodeImpl>( TypeScaledInteger )->offset_;
+   }
+
+   double NodeView::floatValue() const
+   {
+      return implAs<FloatNodeImpl>( TypeFloat )->value_;
+   }
+
+   double NodeView::floatMinimum() const
+   {
+      return implAs<FloatNodeImpl>( TypeFloat )->minimum_;
+   }
+
+   double NodeView::floatMaximum() const
+   {
+      return implAs<FloatNodeImpl>( TypeFloat )->maximum_;
+   }
+
+   FloatPrecision NodeView::precision() const
+   {
+      return implAs<FloatNodeImpl>( TypeFloat )->precision_;
+   }
+
+   ustring NodeView::stringValue() const
+   {
+      return toUstring( implAs<StringNodeImpl>( TypeString )->value_ );
+   }
+
+   int64_t NodeView::blobLength() const
+   {
+      return static_cast<int64_t>( implAs<BlobNodeImpl>( TypeBlob )->blobLogicalLength_ );
+   }
+
+   int64_t NodeView::recordCount() const
+   {
+      return implAs<CompressedVectorNodeImpl>( TypeCompressedVector )->recordCount_;
+   }
+
+   bool NodeView::allowHeteroChildren() const
+   {
+      return implAs<VectorNodeImpl>( TypeVector )->allowHeteroChildren_;
+   }
+
+   Node NodeView::node() const
+   {
+      return Node( std::const_pointer_cast<NodeImpl>( impl_->shared_from_this() ) );
+   }
+}
@@ -81,8 +81,9 @@ struct EmptyPacketHeader
 //=============================================================================
 // PacketReadCache
 
-PacketReadCache::PacketReadCache( CheckedFile *cFile, unsigned packetCount ) :
-   cFile_( cFile ), entries_( packetCount )
+PacketReadCache::PacketReadCache( CheckedFile *cFile, unsigned packetCount,
+                                  MemoryResource *memory ) :
+   cFile_( cFile ), entries_( packetCount, ResourceAllocator<CacheEntry>( memory ) )
 {
    if ( packetCount == 0 )
    {
@@ -170,6 +171,88 @@ std::unique_ptr<PacketLock> PacketReadCache::lock( uint64_t packetLogicalOffset,
    return plock;
 }
 
+void PacketReadCache::setBytestreamsNeeded( const std::vector<bool> &needed )
+{
+   bytestreamsNeeded_ = needed;
+
+   // Cached packets may be missing bytestreams which are now needed
+   for ( auto &entry : entries_ )
+   {
+      entry.logicalOffset_ = 0;
+   }
+}
+
+void PacketReadCache::readDataPacketPartial( char *buffer, uint64_t packetLogicalOffset,
+                                             unsigned packetLength )
+{
+   // Read the header and the table of bytestream buffer lengths first
+   cFile_->seek( packetLogicalOffset, CheckedFile::Logical );
+   cFile_->read( buffer, sizeof( DataPacketHeader ) );
+
+   const unsigned bytestreamCount =
+      reinterpret_cast<const DataPacketHeader *>( buffer )->bytestreamCount;
+   const unsigned tableEnd = sizeof( DataPacketHeader ) + 2 * bytestreamCount;
+
+   if ( tableEnd > packetLength )
+   {
+      throw E57_EXCEPTION2( ErrorBadCVPacket, "bytestreamCount=" + toString( bytestreamCount ) +
+                                                 " packetLength=" + toString( packetLength ) );
+   }
+
+   cFile_->read( buffer + sizeof( DataPacketHeader ), 2 * bytestreamCount );
+
+   const auto bsbLength = reinterpret_cast<const uint16_t *>( buffer + sizeof( DataPacketHeader ) );
+
+   // Read a range of the packet (offsets relative to the start of the packet)
+   const auto readRange = [=]( unsigned start, unsigned end ) {
+      if ( end > start )
+      {
+         cFile_->seek( packetLogicalOffset + start, CheckedFile::Logical );
+         cFile_->read( buffer + start, end - start );
+      }
+   };
+
+   // Read the buffers of the needed bytestreams, merging adjacent ones into a single read.
+   unsigned rangeStart = tableEnd;
+   unsigned rangeEnd = tableEnd;
+   unsigned bufferStart = tableEnd;
+
+   for ( unsigned i = 0; i < bytestreamCount; ++i )
+   {
+      const unsigned bufferEnd = bufferStart + bsbLength[i];
+
+      if ( bufferEnd > packetLength )
+      {
+         throw E57_EXCEPTION2( ErrorBadCVPacket, "bytestream=" + toString( i ) +
+                                                    " packetLength=" + toString( packetLength ) );
+      }
+
+      const bool needed = ( i < bytestreamsNeeded_.size() ) && bytestreamsNeeded_[i];
+
+      if ( needed && ( bufferEnd > bufferStart ) )
+      {
+         if ( bufferStart != rangeEnd )
+         {
+            readRange( rangeStart, rangeEnd );
+            rangeStart = bufferStart;
+         }
+
+         rangeEnd = bufferEnd;
+      }
+
+      bufferStart = bufferEnd;
+   }
+
+   // Also read the padding at the end so it can be verified
+   if ( bufferStart != rangeEnd )
+   {
+      readRange( rangeStart, rangeEnd );
+      rangeStart = bufferStart;
+   }
+
+   readRange( rangeStart, packetLength );
+}
+
 void PacketReadCache::unlock( unsigned cacheIndex )
 {
    //??? why lockedEntry not used?
@@ -212,9 +295,17 @@ void PacketReadCache::readPacket( unsigned oldestEntry, uint64_t packetLogicalOf
 
    auto &entry = entries_.at( oldestEntry );
 
-   // Now read in whole packet into preallocated buffer_.  Note buffer is
-   cFile_->seek( packetLogicalOffset, CheckedFile::Logical );
-   cFile_->read( entry.buffer_, packetLength );
+   if ( ( header.packetType == DATA_PACKET ) && !bytestreamsNeeded_.empty() )
+   {
+      // Only read the parts of the data packet we need
+      readDataPacketPartial( entry.buffer_, packetLogicalOffset, packetLength );
+   }
+   else
+   {
+      // Now read in whole packet into preallocated buffer_.  Note buffer is
+      cFile_->seek( packetLogicalOffset, CheckedFile::Logical );
+      cFile_->read( entry.buffer_, packetLength );
+   }
 
    // Verify that packet is good.
    switch ( header.packetType )
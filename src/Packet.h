@@ -31,6 +31,7 @@
 #include <vector>
 
 #include "Common.h"
+#include "MemoryResource.h"
 
 namespace e57
 {
@@ -48,14 +49,21 @@ namespace e57
    // Maximum size of CompressedVector binary data packet
    constexpr int DATA_PACKET_MAX = ( 64 * 1024 );
 
+   // Default number of packets in the read cache of a CompressedVectorReader
+   constexpr unsigned PACKET_CACHE_DEFAULT_SIZE = 32;
+
    class PacketReadCache
    {
    public:
-      PacketReadCache( CheckedFile *cFile, unsigned packetCount );
+      PacketReadCache( CheckedFile *cFile, unsigned packetCount, MemoryResource *memory = nullptr );
 
       std::unique_ptr<PacketLock> lock( uint64_t packetLogicalOffset,
                                         char *&pkt ); //??? pkt could be const
 
+      /// Only read the buffers of these bytestreams from data packets (all of them if empty).
+      /// The buffers of the other bytestreams in the cached packets are not valid.
+      void setBytestreamsNeeded( const std::vector<bool> &needed );
+
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
       void dump( int indent = 0, std::ostream &os = std::cout );
 #endif
@@ -67,6 +75,8 @@ namespace e57
       void unlock( unsigned cacheIndex );
 
       void readPacket( unsigned oldestEntry, uint64_t packetLogicalOffset );
+      void readDataPacketPartial( char *buffer, uint64_t packetLogicalOffset,
+                                  unsigned packetLength );
 
       struct CacheEntry
       {
@@ -79,7 +89,8 @@ namespace e57
       unsigned useCount_ = 0;
       CheckedFile *cFile_ = nullptr;
 
-      std::vector<CacheEntry> entries_;
+      std::vector<CacheEntry, ResourceAllocator<CacheEntry>> entries_;
+      std::vector<bool> bytestreamsNeeded_;
    };
 
    class PacketLock
@@ -0,0 +1,217 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <cstdio>
+#include <cstring>
+
+#include "CheckedFile.h"
+#include "RangeFile.h"
+#include "StringFunctions.h"
+
+namespace e57
+{
+   RangeFile::RangeFile( const RangeSource &source ) :
+      read_( source.read ), name_( source.name ), size_( source.size ),
+      blockSize_( std::max<size_t>( 1, ( source.blockSize + CheckedFile::physicalPageSize - 1 ) /
+                                          CheckedFile::physicalPageSize ) *
+                  CheckedFile::physicalPageSize ),
+      cacheBlockCount_( std::max<size_t>( 1, source.cacheBlockCount ) ),
+      prefetchBlockCount_( source.prefetchBlockCount ),
+      blockCount_( ( size_ + blockSize_ - 1 ) / blockSize_ )
+   {
+      if ( !read_ )
+      {
+         throw E57_EXCEPTION2( ErrorBadAPIArgument, "fileName=" + name_ + " read=null" );
+      }
+
+      blocks_.reserve( cacheBlockCount_ );
+   }
+
+   uint64_t RangeFile::pos() const
+   {
+      return cursor_;
+   }
+
+   bool RangeFile::seek( uint64_t offset, int whence )
+   {
+      if ( whence == SEEK_CUR )
+      {
+         cursor_ += offset;
+      }
+      else if ( whence == SEEK_SET )
+      {
+         cursor_ = offset;
+      }
+      else if ( whence == SEEK_END )
+      {
+         cursor_ = size_ - offset;
+      }
+
+      if ( cursor_ > size_ )
+      {
+         cursor_ = size_;
+         return false;
+      }
+
+      return true;
+   }
+
+   void RangeFile::read( char *buffer, uint64_t count )
+   {
+      if ( count > size_ - cursor_ )
+      {
+         throw E57_EXCEPTION2( ErrorReadFailed, "fileName=" + name_ + " offset=" +
+                                                   toString( cursor_ ) + " count=" +
+                                                   toString( count ) + " size=" +
+                                                   toString( size_ ) );
+      }
+
+      while ( count > 0 )
+      {
+         const uint64_t index = cursor_ / blockSize_;
+         const auto offset = static_cast<size_t>( cursor_ - index * blockSize_ );
+         const auto n = static_cast<size_t>( std::min<uint64_t>( count, blockSize_ - offset ) );
+
+         memcpy( buffer, block( index ).data.data() + offset, n );
+
+         buffer += n;
+         cursor_ += n;
+         count -= n;
+      }
+   }
+
+   void RangeFile::willRead( uint64_t offset, uint64_t count )
+   {
+      if ( ( count == 0 ) || ( offset >= size_ ) )
+      {
+         return;
+      }
+
+      const uint64_t first = offset / blockSize_;
+      const uint64_t end =
+         std::min( ( std::min( offset + count, size_ ) + blockSize_ - 1 ) / blockSize_,
+                   first + cacheBlockCount_ );
+
+      // Mark the blocks already cached as used first, so fetching the others doesn't evict them
+      for ( uint64_t index = first; index < end; ++index )
+      {
+         const auto found = cached_.find( index );
+
+         if ( found != cached_.end() )
+         {
+            blocks_[found->second].lastUse = ++useCounter_;
+         }
+      }
+
+      // Fetch each run of missing blocks with one call
+      for ( uint64_t index = first; index < end; )
+      {
+         if ( cached_.count( index ) != 0 )
+         {
+            ++index;
+            continue;
+         }
+
+         uint64_t runEnd = index + 1;
+
+         while ( ( runEnd < end ) && ( cached_.count( runEnd ) == 0 ) )
+         {
+            ++runEnd;
+         }
+
+         fetch( index, runEnd );
+
+         index = runEnd;
+      }
+   }
+
+   const RangeFile::Block &RangeFile::block( uint64_t index )
+   {
+      const bool sequential = ( index == lastIndex_ + 1 );
+
+      lastIndex_ = index;
+
+      const auto found = cached_.find( index );
+
+      if ( found != cached_.end() )
+      {
+         Block &cachedBlock = blocks_[found->second];
+
+         cachedBlock.lastUse = ++useCounter_;
+
+         return cachedBlock;
+      }
+
+      // Read ahead the following blocks too when reading in order
+      uint64_t end = index + 1;
+
+      if ( sequential )
+      {
+         const uint64_t maxEnd =
+            std::min<uint64_t>( { blockCount_, index + 1 + prefetchBlockCount_,
+                                  index + cacheBlockCount_ } );
+
+         while ( ( end < maxEnd ) && ( cached_.count( end ) == 0 ) )
+         {
+            ++end;
+         }
+      }
+
+      fetch( index, end );
+
+      return blocks_[cached_.at( index )];
+   }
+
+   void RangeFile::fetch( uint64_t firstIndex, uint64_t endIndex )
+   {
+      const uint64_t offset = firstIndex * blockSize_;
+      const auto count = static_cast<size_t>( std::min( endIndex * blockSize_, size_ ) - offset );
+
+      if ( fetchBuffer_.size() < count )
+      {
+         fetchBuffer_.resize( count );
+      }
+
+      if ( !read_( offset, count, fetchBuffer_.data() ) )
+      {
+         throw E57_EXCEPTION2( ErrorReadFailed, "fileName=" + name_ + " offset=" +
+                                                   toString( offset ) + " count=" +
+                                                   toString( count ) );
+      }
+
+      for ( uint64_t index = firstIndex; index < endIndex; ++index )
+      {
+         Block &newBlock = unusedBlock();
+
+         const auto blockOffset = static_cast<size_t>( ( index - firstIndex ) * blockSize_ );
+
+         newBlock.index = index;
+         newBlock.lastUse = ++useCounter_;
+         newBlock.data.resize( blockSize_ );
+
+         memcpy( newBlock.data.data(), fetchBuffer_.data() + blockOffset,
+                 std::min( blockSize_, count - blockOffset ) );
+
+         cached_[index] = static_cast<size_t>( &newBlock - blocks_.data() );
+      }
+   }
+
+   RangeFile::Block &RangeFile::unusedBlock()
+   {
+      if ( blocks_.size() < cacheBlockCount_ )
+      {
+         blocks_.emplace_back();
+
+         return blocks_.back();
+      }
+
+      // Evict the least recently used block
+      auto oldest = std::min_element( blocks_.begin(), blocks_.end(),
+                                      []( const Block &lhs, const Block &rhs ) {
+                                         return lhs.lastUse < rhs.lastUse;
+                                      } );
+
+      cached_.erase( oldest->index );
+
+      return *oldest;
+   }
+}
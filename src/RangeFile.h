@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+
+#include <unordered_map>
+
+#include "Common.h"
+
+namespace e57
+{
+   /// Reads a RangeSource through an LRU cache of blocks made of whole physical pages. Missing
+   /// blocks which are needed together are read with a single call, and blocks are read ahead
+   /// when they are read in order.
+   class RangeFile
+   {
+   public:
+      explicit RangeFile( const RangeSource &source );
+
+      uint64_t pos() const;
+      bool seek( uint64_t offset, int whence );
+
+      /// Read count bytes at the cursor and leave the cursor just past them
+      void read( char *buffer, uint64_t count );
+
+      /// Hint that the bytes [offset, offset + count) are about to be read, so the missing blocks
+      /// can be fetched together
+      void willRead( uint64_t offset, uint64_t count );
+
+   private:
+      struct Block
+      {
+         uint64_t index = 0;
+         uint64_t lastUse = 0;
+         std::vector<char> data;
+      };
+
+      const Block &block( uint64_t index );
+      void fetch( uint64_t firstIndex, uint64_t endIndex );
+      Block &unusedBlock();
+
+      ReadRangeFunction read_;
+      ustring name_;
+      uint64_t size_;
+      size_t blockSize_;
+      size_t cacheBlockCount_;
+      size_t prefetchBlockCount_;
+      uint64_t blockCount_;
+
+      uint64_t cursor_ = 0;
+
+      // Cached blocks, and where each block index is in blocks_
+      std::vector<Block> blocks_;
+      std::unordered_map<uint64_t, size_t> cached_;
+
+      uint64_t useCounter_ = 0;
+      uint64_t lastIndex_ = 0;
+
+      std::vector<char> fetchBuffer_;
+   };
+}
@@ -26,8 +26,19 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+
 #include "ReaderImpl.h"
+#include "ColumnCache.h"
 #include "Common.h"
+#include "Decoder.h"
+#include "ImageFileImpl.h"
+#include "Packet.h"
 #include "StringFunctions.h"
 
 namespace e57
@@ -188,11 +199,111 @@ namespace e57
       }
    }
 
+   /// Number of packets to cache so the cache uses at most a quarter of the memory budget.
+   unsigned _packetCacheSizeForBudget( size_t memoryBudget )
+   {
+      const size_t packetCount = ( memoryBudget / 4 ) / DATA_PACKET_MAX;
+
+      return static_cast<unsigned>(
+         std::max<size_t>( 1, std::min<size_t>( packetCount, PACKET_CACHE_DEFAULT_SIZE ) ) );
+   }
+
+   /// Size of one element of the Data3DPointsData_t buffer used for the named field. Fields which
+   /// the Simple API doesn't know about are sized using the prototype node.
+   size_t _bytesPerPoint( const ustring &name, const Node &protoNode )
+   {
+      if ( ( name == "cartesianInvalidState" ) || ( name == "sphericalInvalidState" ) ||
+           ( name == "isIntensityInvalid" ) || ( name == "isColorInvalid" ) ||
+           ( name == "isTimeStampInvalid" ) || ( name == "returnIndex" ) ||
+           ( name == "returnCount" ) )
+      {
+         return sizeof( int8_t );
+      }
+
+      if ( ( name == "colorRed" ) || ( name == "colorGreen" ) || ( name == "colorBlue" ) )
+      {
+         return sizeof( uint16_t );
+      }
+
+      if ( ( name == "rowIndex" ) || ( name == "columnIndex" ) )
+      {
+         return sizeof( int32_t );
+      }
+
+      if ( ( name == "intensity" ) || ( name == "timeStamp" ) )
+      {
+         return sizeof( double );
+      }
+
+      if ( ( name == "nor:normalX" ) || ( name == "nor:normalY" ) || ( name == "nor:normalZ" ) )
+      {
+         return sizeof( float );
+      }
+
+      // Coordinates (and unknown fields) use the precision stored in the file.
+      switch ( protoNode.type() )
+      {
+         case TypeFloat:
+            return ( FloatNode( protoNode ).precision() == PrecisionSingle ) ? sizeof( float )
+                                                                              : sizeof( double );
+
+         case TypeInteger:
+         {
+            const IntegerNode integer( protoNode );
+            const unsigned bits = ImageFileImpl::bitsNeeded( integer.minimum(), integer.maximum() );
+
+            return std::max<size_t>( 1, ( bits + 7 ) / 8 );
+         }
+
+         default:
+            return sizeof( double );
+      }
+   }
+
    ReaderImpl::ReaderImpl( const ustring &filePath, const ReaderOptions &options ) :
-      imf_( filePath, "r", options.checksumPolicy ), root_( imf_.root() ),
+      ReaderImpl( openImageFile( filePath, options ), options )
+   {
+   }
+
+   ReaderImpl::ReaderImpl( const RangeSource &source, const ReaderOptions &options ) :
+      ReaderImpl( openImageFile( source, options ), options )
+   {
+   }
+
+   ReaderImpl::ReaderImpl( const ImageFile &imf, const ReaderOptions &options ) :
+      memoryBudget_( options.memoryBudget ), columnCachePath_( options.columnCachePath ),
+      imf_( imf ), root_( imf_.root() ),
       data3D_( root_.isDefined( "/data3D" ) ? root_.get( "/data3D" ) : VectorNode( imf_ ) ),
       images2D_( root_.isDefined( "/images2D" ) ? root_.get( "/images2D" ) : VectorNode( imf_ ) )
    {
+      if ( memoryBudget_ > 0 )
+      {
+         imf_.impl()->setPacketCacheSize( _packetCacheSizeForBudget( memoryBudget_ ) );
+      }
+
+      imf_.impl()->setMemoryResource( options.memoryResource );
+   }
+
+   ImageFile ReaderImpl::openImageFile( const ustring &filePath, const ReaderOptions &options )
+   {
+      // The timeout and memory resource have to be set before the file header and XML are read
+      std::shared_ptr<ImageFileImpl> imfi( new ImageFileImpl( options.checksumPolicy ) );
+
+      imfi->setProgressiveReadTimeout( options.progressiveReadTimeout );
+      imfi->setMemoryResource( options.memoryResource );
+      imfi->construct2( filePath, "r" );
+
+      return ImageFile( imfi );
+   }
+
+   ImageFile ReaderImpl::openImageFile( const RangeSource &source, const ReaderOptions &options )
+   {
+      std::shared_ptr<ImageFileImpl> imfi( new ImageFileImpl( options.checksumPolicy ) );
+
+      imfi->setMemoryResource( options.memoryResource );
+      imfi->construct2( source );
+
+      return ImageFile( imfi );
    }
 
    ReaderImpl::~ReaderImpl()
@@ -1711,6 +1822,883 @@ namespace e57
       return reader;
    }
 
+   MemoryEstimate ReaderImpl::EstimateMemory( int64_t dataIndex,
+                                              const std::vector<ustring> &fields ) const
+   {
+      MemoryEstimate estimate;
+
+      if ( !IsOpen() || ( dataIndex < 0 ) || ( dataIndex >= data3D_.childCount() ) )
+      {
+         return estimate;
+      }
+
+      const StructureNode scan( data3D_.get( dataIndex ) );
+      const CompressedVectorNode points( scan.get( "points" ) );
+      const StructureNode proto( points.prototype() );
+
+      std::vector<ustring> names = fields;
+
+      if ( names.empty() )
+      {
+         for ( int64_t i = 0; i < proto.childCount(); ++i )
+         {
+            names.push_back( proto.get( i ).elementName() );
+         }
+      }
+
+      for ( const auto &name : names )
+      {
+         if ( !proto.isDefined( name ) )
+         {
+            throw E57_EXCEPTION2( ErrorPathUndefined, "fieldName=" + name );
+         }
+
+         estimate.bytesPerPoint += _bytesPerPoint( name, proto.get( name ) );
+      }
+
+      estimate.packetCacheBytes =
+         static_cast<size_t>( imf_.impl()->packetCacheSize() ) * DATA_PACKET_MAX;
+      estimate.decoderBytes = names.size() * DECODER_BUFFER_SIZE;
+
+      const auto pointCount = static_cast<size_t>( points.childCount() );
+      const size_t fixedBytes = estimate.packetCacheBytes + estimate.decoderBytes;
+
+      estimate.chunkPointCount = pointCount;
+
+      if ( ( memoryBudget_ > 0 ) && ( estimate.bytesPerPoint > 0 ) && ( pointCount > 0 ) )
+      {
+         const size_t available = ( memoryBudget_ > fixedBytes ) ? memoryBudget_ - fixedBytes : 0;
+
+         estimate.chunkPointCount =
+            std::max<size_t>( 1, std::min( available / estimate.bytesPerPoint, pointCount ) );
+      }
+
+      estimate.totalBytes = fixedBytes + ( estimate.bytesPerPoint * estimate.chunkPointCount );
+
+      return estimate;
+   }
+
+   /// Number of points in each chunk of the time index built when the file doesn't have one
+   constexpr size_t TIME_INDEX_BUILD_CHUNK_SIZE = 8 * 1024;
+
+   const std::vector<ReaderImpl::TimeChunk> &ReaderImpl::timeIndex( int64_t dataIndex ) const
+   {
+      const auto cached = timeIndexes_.find( dataIndex );
+
+      if ( cached != timeIndexes_.end() )
+      {
+         return cached->second;
+      }
+
+      std::vector<TimeChunk> chunks;
+
+      const StructureNode scan( data3D_.get( dataIndex ) );
+      ustring prefix;
+
+      if ( imf_.extensionsLookupUri( TIME_INDEX_EXTENSION_URI, prefix ) &&
+           scan.isDefined( prefix + ":chunks" ) )
+      {
+         // Use the index written with the file
+         CompressedVectorNode index( scan.get( prefix + ":chunks" ) );
+         const auto chunkCount = static_cast<size_t>( index.childCount() );
+
+         std::vector<int64_t> startPointIndex( chunkCount );
+         std::vector<int64_t> pointCount( chunkCount );
+         std::vector<double> timeMinimum( chunkCount );
+         std::vector<double> timeMaximum( chunkCount );
+
+         if ( chunkCount > 0 )
+         {
+            std::vector<SourceDestBuffer> indexBuffers;
+            indexBuffers.emplace_back( imf_, "startPointIndex", startPointIndex.data(), chunkCount,
+                                       true );
+            indexBuffers.emplace_back( imf_, "pointCount", pointCount.data(), chunkCount, true );
+            indexBuffers.emplace_back( imf_, "timeMinimum", timeMinimum.data(), chunkCount, true );
+            indexBuffers.emplace_back( imf_, "timeMaximum", timeMaximum.data(), chunkCount, true );
+
+            CompressedVectorReader reader = index.reader( indexBuffers );
+            reader.read();
+            reader.close();
+         }
+
+         for ( size_t i = 0; i < chunkCount; ++i )
+         {
+            TimeChunk chunk;
+
+            chunk.startPointIndex = startPointIndex[i];
+            chunk.pointCount = pointCount[i];
+            chunk.timeMinimum = timeMinimum[i];
+            chunk.timeMaximum = timeMaximum[i];
+
+            chunks.push_back( chunk );
+         }
+      }
+      else
+      {
+         // Build the index by reading only the time stamps
+         CompressedVectorNode points( scan.get( "points" ) );
+         const StructureNode proto( points.prototype() );
+
+         const bool scaled = ( proto.get( "timeStamp" ).type() == TypeScaledInteger );
+         const bool haveInvalid = proto.isDefined( "isTimeStampInvalid" );
+
+         std::vector<double> timeStamp( TIME_INDEX_BUILD_CHUNK_SIZE );
+         std::vector<int8_t> isTimeStampInvalid( TIME_INDEX_BUILD_CHUNK_SIZE );
+
+         std::vector<SourceDestBuffer> timeBuffers;
+         timeBuffers.emplace_back( imf_, "timeStamp", timeStamp.data(),
+                                   TIME_INDEX_BUILD_CHUNK_SIZE, true, scaled );
+
+         if ( haveInvalid )
+         {
+            timeBuffers.emplace_back( imf_, "isTimeStampInvalid", isTimeStampInvalid.data(),
+                                      TIME_INDEX_BUILD_CHUNK_SIZE, true );
+         }
+
+         CompressedVectorReader reader = points.reader( timeBuffers );
+         int64_t startPointIndex = 0;
+
+         while ( const unsigned count = reader.read() )
+         {
+            TimeChunk chunk;
+
+            chunk.startPointIndex = startPointIndex;
+            chunk.pointCount = count;
+            chunk.timeMinimum = std::numeric_limits<double>::infinity();
+            chunk.timeMaximum = -std::numeric_limits<double>::infinity();
+
+            for ( unsigned i = 0; i < count; ++i )
+            {
+               if ( !haveInvalid || ( isTimeStampInvalid[i] == 0 ) )
+               {
+                  chunk.timeMinimum = std::min( chunk.timeMinimum, timeStamp[i] );
+                  chunk.timeMaximum = std::max( chunk.timeMaximum, timeStamp[i] );
+               }
+            }
+
+            // Chunks without any valid time stamp can't be in a time window
+            if ( chunk.timeMinimum <= chunk.timeMaximum )
+            {
+               chunks.push_back( chunk );
+            }
+
+            startPointIndex += count;
+         }
+
+         reader.close();
+      }
+
+      std::sort( chunks.begin(), chunks.end(), []( const TimeChunk &lhs, const TimeChunk &rhs ) {
+         return lhs.startPointIndex < rhs.startPointIndex;
+      } );
+
+      return timeIndexes_[dataIndex] = std::move( chunks );
+   }
+
+   int64_t ReaderImpl::ReadTimeWindow( int64_t dataIndex, double startTime, double endTime,
+                                       size_t pointCount, const Data3DPointsDouble &buffers,
+                                       const TimeWindowCallback &callback ) const
+   {
+      if ( !IsOpen() || ( dataIndex < 0 ) || ( dataIndex >= data3D_.childCount() ) )
+      {
+         return 0;
+      }
+
+      const StructureNode scan( data3D_.get( dataIndex ) );
+      const CompressedVectorNode points( scan.get( "points" ) );
+
+      if ( !StructureNode( points.prototype() ).isDefined( "timeStamp" ) )
+      {
+         throw E57_EXCEPTION2( ErrorPathUndefined, "fieldName=timeStamp" );
+      }
+
+      // Merge the chunks overlapping the window into ranges [first, second) of points
+      std::vector<std::pair<int64_t, int64_t>> ranges;
+
+      for ( const auto &chunk : timeIndex( dataIndex ) )
+      {
+         if ( ( chunk.timeMaximum < startTime ) || ( chunk.timeMinimum > endTime ) )
+         {
+            continue;
+         }
+
+         const int64_t chunkEnd = chunk.startPointIndex + chunk.pointCount;
+
+         if ( !ranges.empty() && ( ranges.back().second >= chunk.startPointIndex ) )
+         {
+            ranges.back().second = std::max( ranges.back().second, chunkEnd );
+         }
+         else
+         {
+            ranges.emplace_back( chunk.startPointIndex, chunkEnd );
+         }
+      }
+
+      if ( ranges.empty() )
+      {
+         return 0;
+      }
+
+      CompressedVectorReader reader = SetUpData3DPointsData( dataIndex, pointCount, buffers );
+
+      bool canSeek = true;
+
+      try
+      {
+         reader.seek( ranges.front().first );
+      }
+      catch ( const E57Exception &e )
+      {
+         if ( e.errorCode() != ErrorNotImplemented )
+         {
+            throw;
+         }
+
+         canSeek = false;
+      }
+
+      int64_t readCount = 0;
+
+      if ( canSeek )
+      {
+         for ( const auto &range : ranges )
+         {
+            reader.seek( range.first );
+
+            int64_t position = range.first;
+
+            while ( position < range.second )
+            {
+               const unsigned count = reader.read();
+
+               if ( count == 0 )
+               {
+                  break;
+               }
+
+               const auto usedCount =
+                  static_cast<size_t>( std::min<int64_t>( count, range.second - position ) );
+
+               callback( position, usedCount );
+
+               position += count;
+               readCount += static_cast<int64_t>( usedCount );
+            }
+         }
+      }
+      else
+      {
+         // Decode from the start, only passing on the buffers which overlap a range
+         int64_t position = 0;
+         size_t rangeIndex = 0;
+
+         while ( rangeIndex < ranges.size() )
+         {
+            const unsigned count = reader.read();
+
+            if ( count == 0 )
+            {
+               break;
+            }
+
+            const int64_t end = position + count;
+
+            while ( ( rangeIndex < ranges.size() ) && ( ranges[rangeIndex].second <= position ) )
+            {
+               ++rangeIndex;
+            }
+
+            if ( ( rangeIndex < ranges.size() ) && ( ranges[rangeIndex].first < end ) )
+            {
+               // Clip at the end of the last range in the buffer, as when seeking
+               size_t lastIndex = rangeIndex;
+
+               while ( ( lastIndex + 1 < ranges.size() ) && ( ranges[lastIndex + 1].first < end ) )
+               {
+                  ++lastIndex;
+               }
+
+               const auto usedCount = static_cast<size_t>(
+                  std::min<int64_t>( count, ranges[lastIndex].second - position ) );
+
+               callback( position, usedCount );
+
+               readCount += static_cast<int64_t>( usedCount );
+            }
+
+            position = end;
+         }
+      }
+
+      reader.close();
+
+      return readCount;
+   }
+
+   namespace
+   {
+      /// One field of the points kept by ReadData3DDownsampled(), stored as doubles
+      struct VoxelColumn
+      {
+         void *buffer = nullptr;
+         bool average = false;
+         double ( *get )( const void *buffer, size_t index ) = nullptr;
+         void ( *set )( void *buffer, size_t index, double value ) = nullptr;
+      };
+
+      template <typename T> double _getVoxelValue( const void *buffer, size_t index )
+      {
+         return static_cast<double>( static_cast<const T *>( buffer )[index] );
+      }
+
+      template <typename T> void _setVoxelValue( void *buffer, size_t index, double value )
+      {
+         // Averaged integers (i.e. colors) are rounded
+         static_cast<T *>( buffer )[index] = static_cast<T>(
+            std::is_integral<T>::value ? std::floor( value + 0.5 ) : value );
+      }
+
+      template <typename T>
+      void _addVoxelColumn( std::vector<VoxelColumn> &columns, T *buffer, bool average )
+      {
+         if ( buffer != nullptr )
+         {
+            columns.push_back( { buffer, average, &_getVoxelValue<T>, &_setVoxelValue<T> } );
+         }
+      }
+
+      /// Integer coordinates of a voxel
+      struct VoxelKey
+      {
+         int64_t x;
+         int64_t y;
+         int64_t z;
+
+         bool operator==( const VoxelKey &other ) const
+         {
+            return ( x == other.x ) && ( y == other.y ) && ( z == other.z );
+         }
+      };
+
+      struct VoxelKeyHash
+      {
+         size_t operator()( const VoxelKey &key ) const
+         {
+            // Large primes spread neighbouring voxels over the buckets
+            return static_cast<size_t>( ( static_cast<uint64_t>( key.x ) * 73856093ULL ) ^
+                                        ( static_cast<uint64_t>( key.y ) * 19349669ULL ) ^
+                                        ( static_cast<uint64_t>( key.z ) * 83492791ULL ) );
+         }
+      };
+   }
+
+   int64_t ReaderImpl::ReadData3DDownsampled( int64_t dataIndex, const DownsampleOptions &options,
+                                              size_t pointCount, const Data3DPointsDouble &buffers,
+                                              const DownsampleCallback &callback ) const
+   {
+      if ( !IsOpen() || ( dataIndex < 0 ) || ( dataIndex >= data3D_.childCount() ) )
+      {
+         return 0;
+      }
+
+      if ( !( options.voxelSize > 0.0 ) || ( pointCount == 0 ) )
+      {
+         throw E57_EXCEPTION2( ErrorBadAPIArgument,
+                               "voxelSize=" + toString( options.voxelSize ) +
+                                  " pointCount=" + toString( pointCount ) );
+      }
+
+      const StructureNode scan( data3D_.get( dataIndex ) );
+      const CompressedVectorNode points( scan.get( "points" ) );
+      const StructureNode proto( points.prototype() );
+
+      for ( const char *name : { "cartesianX", "cartesianY", "cartesianZ" } )
+      {
+         if ( !proto.isDefined( name ) )
+         {
+            throw E57_EXCEPTION2( ErrorPathUndefined, "fieldName=" + ustring( name ) );
+         }
+      }
+
+      if ( ( buffers.cartesianX == nullptr ) || ( buffers.cartesianY == nullptr ) ||
+           ( buffers.cartesianZ == nullptr ) )
+      {
+         throw E57_EXCEPTION2( ErrorPathUndefined, "fieldName=cartesianX" );
+      }
+
+      const bool centroid = ( options.voxelPoint == VoxelPoint::Centroid );
+
+      // The coordinates are the first three columns
+      std::vector<VoxelColumn> columns;
+
+      _addVoxelColumn( columns, buffers.cartesianX, centroid );
+      _addVoxelColumn( columns, buffers.cartesianY, centroid );
+      _addVoxelColumn( columns, buffers.cartesianZ, centroid );
+      _addVoxelColumn( columns, buffers.cartesianInvalidState, false );
+      _addVoxelColumn( columns, buffers.intensity, centroid );
+      _addVoxelColumn( columns, buffers.isIntensityInvalid, false );
+      _addVoxelColumn( columns, buffers.colorRed, centroid );
+      _addVoxelColumn( columns, buffers.colorGreen, centroid );
+      _addVoxelColumn( columns, buffers.colorBlue, centroid );
+      _addVoxelColumn( columns, buffers.isColorInvalid, false );
+      _addVoxelColumn( columns, buffers.sphericalRange, false );
+      _addVoxelColumn( columns, buffers.sphericalAzimuth, false );
+      _addVoxelColumn( columns, buffers.sphericalElevation, false );
+      _addVoxelColumn( columns, buffers.sphericalInvalidState, false );
+      _addVoxelColumn( columns, buffers.rowIndex, false );
+      _addVoxelColumn( columns, buffers.columnIndex, false );
+      _addVoxelColumn( columns, buffers.returnIndex, false );
+      _addVoxelColumn( columns, buffers.returnCount, false );
+      _addVoxelColumn( columns, buffers.timeStamp, false );
+      _addVoxelColumn( columns, buffers.isTimeStampInvalid, false );
+
+      const size_t normalColumn = columns.size();
+
+      _addVoxelColumn( columns, buffers.normalX, centroid );
+      _addVoxelColumn( columns, buffers.normalY, centroid );
+      _addVoxelColumn( columns, buffers.normalZ, centroid );
+
+      const bool haveNormals = ( columns.size() == normalColumn + 3 );
+      const size_t columnCount = columns.size();
+
+      // Values of the point kept for each voxel (sums for the averaged columns), one row of
+      // columnCount values per voxel in the order the voxels were first hit.
+      std::unordered_map<VoxelKey, size_t, VoxelKeyHash> voxelIndices;
+      std::vector<double> voxelValues;
+      std::vector<uint64_t> voxelPointCounts;
+
+      const double inverseSize = 1.0 / options.voxelSize;
+
+      CompressedVectorReader reader = SetUpData3DPointsData( dataIndex, pointCount, buffers );
+
+      while ( const unsigned count = reader.read() )
+      {
+         for ( size_t i = 0; i < count; ++i )
+         {
+            if ( ( buffers.cartesianInvalidState != nullptr ) &&
+                 ( buffers.cartesianInvalidState[i] != 0 ) )
+            {
+               continue;
+            }
+
+            const double x = std::floor( buffers.cartesianX[i] * inverseSize );
+            const double y = std::floor( buffers.cartesianY[i] * inverseSize );
+            const double z = std::floor( buffers.cartesianZ[i] * inverseSize );
+
+            // Skips NaN and points too far away to have an integer voxel
+            constexpr double cMaxVoxel = 4.0e18;
+
+            if ( !( ( std::fabs( x ) < cMaxVoxel ) && ( std::fabs( y ) < cMaxVoxel ) &&
+                    ( std::fabs( z ) < cMaxVoxel ) ) )
+            {
+               continue;
+            }
+
+            const VoxelKey key{ static_cast<int64_t>( x ), static_cast<int64_t>( y ),
+                                static_cast<int64_t>( z ) };
+
+            const auto inserted = voxelIndices.emplace( key, voxelPointCounts.size() );
+
+            if ( inserted.second )
+            {
+               for ( const auto &column : columns )
+               {
+                  voxelValues.push_back( column.get( column.buffer, i ) );
+               }
+
+               voxelPointCounts.push_back( 1 );
+            }
+            else if ( centroid )
+            {
+               const size_t voxelIndex = inserted.first->second;
+               double *values = &voxelValues[voxelIndex * columnCount];
+
+               for ( size_t c = 0; c < columnCount; ++c )
+               {
+                  if ( columns[c].average )
+                  {
+                     values[c] += columns[c].get( columns[c].buffer, i );
+                  }
+               }
+
+               ++voxelPointCounts[voxelIndex];
+            }
+         }
+      }
+
+      reader.close();
+
+      // The hash map isn't needed to pass back the points
+      voxelIndices = {};
+
+      const auto voxelCount = static_cast<int64_t>( voxelPointCounts.size() );
+
+      for ( int64_t start = 0; start < voxelCount; start += static_cast<int64_t>( pointCount ) )
+      {
+         const auto count =
+            static_cast<size_t>( std::min<int64_t>( voxelCount - start, pointCount ) );
+
+         for ( size_t i = 0; i < count; ++i )
+         {
+            const auto voxelIndex = static_cast<size_t>( start ) + i;
+            double *values = &voxelValues[voxelIndex * columnCount];
+
+            if ( centroid )
+            {
+               const auto pointsInVoxel = static_cast<double>( voxelPointCounts[voxelIndex] );
+
+               for ( size_t c = 0; c < columnCount; ++c )
+               {
+                  if ( columns[c].average )
+                  {
+                     values[c] /= pointsInVoxel;
+                  }
+               }
+
+               if ( haveNormals )
+               {
+                  double *normal = &values[normalColumn];
+                  const double length = std::sqrt( ( normal[0] * normal[0] ) +
+                                                   ( normal[1] * normal[1] ) +
+                                                   ( normal[2] * normal[2] ) );
+
+                  if ( length > 0.0 )
+                  {
+                     normal[0] /= length;
+                     normal[1] /= length;
+                     normal[2] /= length;
+                  }
+               }
+            }
+
+            for ( size_t c = 0; c < columnCount; ++c )
+            {
+               columns[c].set( columns[c].buffer, i, values[c] );
+            }
+         }
+
+         callback( start, count );
+      }
+
+      return voxelCount;
+   }
+
+   namespace
+   {
+      /// A field which MapData3DPoints() can map, and how to point a Data3DPointsDouble to it
+      struct ColumnField
+      {
+         const char *name;
+         size_t elementSize;
+         void ( *assign )( Data3DPointsDouble &points, char *values );
+      };
+
+      const ColumnField cColumnFields[] = {
+         { "cartesianX", sizeof( double ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.cartesianX = reinterpret_cast<double *>( values );
+           } },
+         { "cartesianY", sizeof( double ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.cartesianY = reinterpret_cast<double *>( values );
+           } },
+         { "cartesianZ", sizeof( double ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.cartesianZ = reinterpret_cast<double *>( values );
+           } },
+         { "cartesianInvalidState", sizeof( int8_t ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.cartesianInvalidState = reinterpret_cast<int8_t *>( values );
+           } },
+         { "intensity", sizeof( double ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.intensity = reinterpret_cast<double *>( values );
+           } },
+         { "isIntensityInvalid", sizeof( int8_t ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.isIntensityInvalid = reinterpret_cast<int8_t *>( values );
+           } },
+         { "colorRed", sizeof( uint16_t ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.colorRed = reinterpret_cast<uint16_t *>( values );
+           } },
+         { "colorGreen", sizeof( uint16_t ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.colorGreen = reinterpret_cast<uint16_t *>( values );
+           } },
+         { "colorBlue", sizeof( uint16_t ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.colorBlue = reinterpret_cast<uint16_t *>( values );
+           } },
+         { "isColorInvalid", sizeof( int8_t ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.isColorInvalid = reinterpret_cast<int8_t *>( values );
+           } },
+         { "sphericalRange", sizeof( double ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.sphericalRange = reinterpret_cast<double *>( values );
+           } },
+         { "sphericalAzimuth", sizeof( double ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.sphericalAzimuth = reinterpret_cast<double *>( values );
+           } },
+         { "sphericalElevation", sizeof( double ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.sphericalElevation = reinterpret_cast<double *>( values );
+           } },
+         { "sphericalInvalidState", sizeof( int8_t ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.sphericalInvalidState = reinterpret_cast<int8_t *>( values );
+           } },
+         { "rowIndex", sizeof( int32_t ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.rowIndex = reinterpret_cast<int32_t *>( values );
+           } },
+         { "columnIndex", sizeof( int32_t ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.columnIndex = reinterpret_cast<int32_t *>( values );
+           } },
+         { "returnIndex", sizeof( int8_t ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.returnIndex = reinterpret_cast<int8_t *>( values );
+           } },
+         { "returnCount", sizeof( int8_t ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.returnCount = reinterpret_cast<int8_t *>( values );
+           } },
+         { "timeStamp", sizeof( double ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.timeStamp = reinterpret_cast<double *>( values );
+           } },
+         { "isTimeStampInvalid", sizeof( int8_t ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.isTimeStampInvalid = reinterpret_cast<int8_t *>( values );
+           } },
+         { "nor:normalX", sizeof( float ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.normalX = reinterpret_cast<float *>( values );
+           } },
+         { "nor:normalY", sizeof( float ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.normalY = reinterpret_cast<float *>( values );
+           } },
+         { "nor:normalZ", sizeof( float ),
+           []( Data3DPointsDouble &points, char *values ) {
+              points.normalZ = reinterpret_cast<float *>( values );
+           } },
+      };
+
+      const ColumnField *_findColumnField( const ustring &name )
+      {
+         for ( const auto &field : cColumnFields )
+         {
+            if ( name == field.name )
+            {
+               return &field;
+            }
+         }
+
+         return nullptr;
+      }
+   }
+
+   /// Number of points decoded at a time to fill the column cache
+   constexpr size_t COLUMN_CACHE_CHUNK_SIZE = 64 * 1024;
+
+   MappedData3DPoints ReaderImpl::MapData3DPoints( int64_t dataIndex,
+                                                   const std::vector<ustring> &fields ) const
+   {
+      auto mapped = std::make_shared<MappedData3DPointsImpl>();
+
+      if ( !IsOpen() || ( dataIndex < 0 ) || ( dataIndex >= data3D_.childCount() ) )
+      {
+         return MappedData3DPoints( mapped );
+      }
+
+      const StructureNode scan( data3D_.get( dataIndex ) );
+      const CompressedVectorNode points( scan.get( "points" ) );
+      const StructureNode proto( points.prototype() );
+
+      std::vector<const ColumnField *> columnFields;
+
+      if ( fields.empty() )
+      {
+         for ( int64_t i = 0; i < proto.childCount(); ++i )
+         {
+            const ColumnField *field = _findColumnField( proto.get( i ).elementName() );
+
+            if ( field != nullptr )
+            {
+               columnFields.push_back( field );
+            }
+         }
+      }
+      else
+      {
+         for ( const auto &name : fields )
+         {
+            const ColumnField *field = _findColumnField( name );
+
+            if ( ( field == nullptr ) || !proto.isDefined( name ) )
+            {
+               throw E57_EXCEPTION2( ErrorPathUndefined, "fieldName=" + name );
+            }
+
+            columnFields.push_back( field );
+         }
+      }
+
+      const int64_t pointCount = points.childCount();
+
+      mapped->pointCount = pointCount;
+
+      if ( pointCount == 0 )
+      {
+         return MappedData3DPoints( mapped );
+      }
+
+      const ustring fileGuid =
+         root_.isDefined( "guid" ) ? StringNode( root_.get( "guid" ) ).value() : ustring();
+      const ustring scanGuid =
+         scan.isDefined( "guid" ) ? StringNode( scan.get( "guid" ) ).value() : ustring();
+
+      const bool useCache = !columnCachePath_.empty() && !fileGuid.empty() && !scanGuid.empty();
+
+      // Map the fields already in the cache
+      std::vector<const ColumnField *> missingFields;
+
+      for ( const ColumnField *field : columnFields )
+      {
+         if ( useCache )
+         {
+            const ustring key = ColumnCache::columnKey( fileGuid, scanGuid, field->name );
+            const ustring path = ColumnCache::columnPath( columnCachePath_, key, field->name );
+
+            char *values = nullptr;
+            auto file = ColumnCache::mapColumn( path, key, field->elementSize,
+                                                static_cast<uint64_t>( pointCount ), values );
+
+            if ( file != nullptr )
+            {
+               field->assign( mapped->points, values );
+               mapped->mappedColumns.push_back( file );
+               continue;
+            }
+         }
+
+         missingFields.push_back( field );
+      }
+
+      if ( missingFields.empty() )
+      {
+         return MappedData3DPoints( mapped );
+      }
+
+      // Decode the other fields in chunks, appending each chunk to the cache files (or to the
+      // columns in memory if they can't be cached)
+      const auto chunkSize =
+         static_cast<size_t>( std::min<int64_t>( pointCount, COLUMN_CACHE_CHUNK_SIZE ) );
+
+      Data3DPointsDouble chunk;
+      std::vector<std::vector<char>> chunkColumns;
+      std::vector<std::unique_ptr<ColumnCacheWriter>> writers;
+      std::vector<std::vector<char>> memoryColumns;
+
+      for ( const ColumnField *field : missingFields )
+      {
+         chunkColumns.emplace_back( chunkSize * field->elementSize );
+         field->assign( chunk, chunkColumns.back().data() );
+
+         std::unique_ptr<ColumnCacheWriter> writer;
+
+         if ( useCache )
+         {
+            const ustring key = ColumnCache::columnKey( fileGuid, scanGuid, field->name );
+
+            writer.reset( new ColumnCacheWriter(
+               ColumnCache::columnPath( columnCachePath_, key, field->name ), key,
+               field->elementSize, static_cast<uint64_t>( pointCount ) ) );
+
+            if ( !writer->isOpen() )
+            {
+               writer.reset();
+            }
+         }
+
+         writers.push_back( std::move( writer ) );
+         memoryColumns.emplace_back( ( writers.back() == nullptr )
+                                        ? static_cast<size_t>( pointCount ) * field->elementSize
+                                        : 0 );
+      }
+
+      CompressedVectorReader reader = SetUpData3DPointsData( dataIndex, chunkSize, chunk );
+
+      size_t position = 0;
+
+      while ( const unsigned count = reader.read() )
+      {
+         for ( size_t i = 0; i < missingFields.size(); ++i )
+         {
+            if ( writers[i] != nullptr )
+            {
+               writers[i]->append( chunkColumns[i].data(), count );
+            }
+            else
+            {
+               std::memcpy( &memoryColumns[i][position * missingFields[i]->elementSize],
+                            chunkColumns[i].data(), count * missingFields[i]->elementSize );
+            }
+         }
+
+         position += count;
+      }
+
+      reader.close();
+
+      for ( size_t i = 0; i < missingFields.size(); ++i )
+      {
+         const ColumnField *field = missingFields[i];
+
+         if ( writers[i] != nullptr )
+         {
+            const ustring key = ColumnCache::columnKey( fileGuid, scanGuid, field->name );
+            const ustring path = ColumnCache::columnPath( columnCachePath_, key, field->name );
+
+            char *values = nullptr;
+            std::shared_ptr<MappedFile> file;
+
+            if ( writers[i]->commit() )
+            {
+               file = ColumnCache::mapColumn( path, key, field->elementSize,
+                                              static_cast<uint64_t>( pointCount ), values );
+            }
+
+            if ( file != nullptr )
+            {
+               field->assign( mapped->points, values );
+               mapped->mappedColumns.push_back( file );
+               continue;
+            }
+
+            // The cache couldn't be written, so decode this field again into memory
+            memoryColumns[i].resize( static_cast<size_t>( pointCount ) * field->elementSize );
+
+            Data3DPointsDouble column;
+            field->assign( column, memoryColumns[i].data() );
+
+            CompressedVectorReader columnReader =
+               SetUpData3DPointsData( dataIndex, static_cast<size_t>( pointCount ), column );
+            columnReader.read();
+            columnReader.close();
+         }
+
+         mapped->memoryColumns.push_back( std::move( memoryColumns[i] ) );
+         field->assign( mapped->points, mapped->memoryColumns.back().data() );
+      }
+
+      return MappedData3DPoints( mapped );
+   }
+
    int64_t ReaderImpl::GetData3DCount() const
    {
       return data3D_.childCount();
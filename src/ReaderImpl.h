@@ -28,6 +28,9 @@
 
 #pragma once
 
+#include <map>
+
+#include "Common.h"
 #include "E57SimpleData.h"
 #include "E57SimpleReader.h"
 
@@ -37,6 +40,7 @@ namespace e57
    {
    public:
       ReaderImpl( const ustring &filePath, const ReaderOptions &options );
+      ReaderImpl( const RangeSource &source, const ReaderOptions &options );
       ~ReaderImpl();
 
       // disallow copying a ReaderImpl
@@ -79,6 +83,19 @@ namespace e57
       CompressedVectorReader SetUpData3DPointsData(
          int64_t dataIndex, size_t pointCount, const Data3DPointsData_t<COORDTYPE> &buffers ) const;
 
+      MemoryEstimate EstimateMemory( int64_t dataIndex, const std::vector<ustring> &fields ) const;
+
+      int64_t ReadTimeWindow( int64_t dataIndex, double startTime, double endTime,
+                              size_t pointCount, const Data3DPointsDouble &buffers,
+                              const TimeWindowCallback &callback ) const;
+
+      int64_t ReadData3DDownsampled( int64_t dataIndex, const DownsampleOptions &options,
+                                     size_t pointCount, const Data3DPointsDouble &buffers,
+                                     const DownsampleCallback &callback ) const;
+
+      MappedData3DPoints MapData3DPoints( int64_t dataIndex,
+                                          const std::vector<ustring> &fields ) const;
+
       StructureNode GetRawE57Root() const;
 
       VectorNode GetRawData3D() const;
@@ -88,11 +105,34 @@ namespace e57
       ImageFile GetRawIMF() const;
 
    private:
+      ReaderImpl( const ImageFile &imf, const ReaderOptions &options );
+
+      static ImageFile openImageFile( const ustring &filePath, const ReaderOptions &options );
+      static ImageFile openImageFile( const RangeSource &source, const ReaderOptions &options );
+
+      // Range of time stamps of a chunk of points
+      struct TimeChunk
+      {
+         int64_t startPointIndex = 0;
+         int64_t pointCount = 0;
+         double timeMinimum = 0.0;
+         double timeMaximum = 0.0;
+      };
+
+      const std::vector<TimeChunk> &timeIndex( int64_t dataIndex ) const;
+
+      size_t memoryBudget_;
+
+      ustring columnCachePath_;
+
       ImageFile imf_;
       StructureNode root_;
 
       VectorNode data3D_;
 
       VectorNode images2D_;
+
+      // Time indexes read or built by ReadTimeWindow(), by Data3D index
+      mutable std::map<int64_t, std::vector<TimeChunk>> timeIndexes_;
    }; // end Reader class
 } // end namespace e57
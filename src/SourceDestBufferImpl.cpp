@@ -26,6 +26,8 @@
  */
 
 #include <cmath>
+#include <cstring>
+#include <functional>
 
 #include "ImageFileImpl.h"
 #include "SourceDestBufferImpl.h"
@@ -939,6 +941,61 @@ void SourceDestBufferImpl::setNextInt64( int64_t value, double scale, double off
    nextIndex_++;
 }
 
+/// Copy the element most recently set to the next count elements. This is a fast way to fill a
+/// run of equal values: the value is only checked and converted once.
+void SourceDestBufferImpl::setNextRepeated( size_t count )
+{
+   /// don't checkImageFileOpen
+
+   if ( count == 0 )
+   {
+      return;
+   }
+
+   /// Verify have a previous element and room for the copies
+   if ( ( nextIndex_ == 0 ) || ( count > capacity_ - nextIndex_ ) )
+   {
+      throw E57_EXCEPTION2( ErrorInternal, "pathName=" + pathName_ +
+                                              " nextIndex=" + toString( nextIndex_ ) +
+                                              " count=" + toString( count ) );
+   }
+
+   size_t elementSize = 0;
+
+   switch ( memoryRepresentation_ )
+   {
+      case Int8:
+      case UInt8:
+      case Bool:
+         elementSize = 1;
+         break;
+      case Int16:
+      case UInt16:
+         elementSize = 2;
+         break;
+      case Int32:
+      case UInt32:
+      case Real32:
+         elementSize = 4;
+         break;
+      case Int64:
+      case Real64:
+         elementSize = 8;
+         break;
+      case UString:
+         throw E57_EXCEPTION2( ErrorExpectingNumeric, "pathName=" + pathName_ );
+   }
+
+   const char *last = &base_[( nextIndex_ - 1 ) * stride_];
+
+   for ( size_t i = 0; i < count; ++i )
+   {
+      memcpy( &base_[( nextIndex_ + i ) * stride_], last, elementSize );
+   }
+
+   nextIndex_ += count;
+}
+
 void SourceDestBufferImpl::setNextFloat( float value )
 {
    _setNextReal( value );
@@ -969,6 +1026,281 @@ void SourceDestBufferImpl::setNextString( const ustring &value )
    nextIndex_++;
 }
 
+namespace
+{
+   // Both kernels are branchless so the compiler can vectorize the loops over contiguous buffers.
+
+   template <typename T, typename CompareT>
+   void _matchRecords( const char *base, size_t stride, size_t first, size_t end, double value,
+                       uint8_t *keep, CompareT compare )
+   {
+      for ( size_t i = first; i < end; ++i )
+      {
+         const double recordValue =
+            static_cast<double>( *reinterpret_cast<const T *>( &base[i * stride] ) );
+
+         keep[i] &= static_cast<uint8_t>( compare( recordValue, value ) );
+      }
+   }
+
+   template <typename T>
+   void _matchRecords( const char *base, size_t stride, size_t first, size_t end,
+                       FilterComparison comparison, double value, uint8_t *keep )
+   {
+      switch ( comparison )
+      {
+         case FilterEqual:
+            _matchRecords<T>( base, stride, first, end, value, keep, std::equal_to<double>() );
+            break;
+         case FilterNotEqual:
+            _matchRecords<T>( base, stride, first, end, value, keep, std::not_equal_to<double>() );
+            break;
+         case FilterLess:
+            _matchRecords<T>( base, stride, first, end, value, keep, std::less<double>() );
+            break;
+         case FilterLessOrEqual:
+            _matchRecords<T>( base, stride, first, end, value, keep, std::less_equal<double>() );
+            break;
+         case FilterGreater:
+            _matchRecords<T>( base, stride, first, end, value, keep, std::greater<double>() );
+            break;
+         case FilterGreaterOrEqual:
+            _matchRecords<T>( base, stride, first, end, value, keep,
+                              std::greater_equal<double>() );
+            break;
+      }
+   }
+
+   /// Returns the index following the last record kept
+   template <typename T>
+   size_t _compactRecords( char *base, size_t stride, const uint8_t *keep, size_t first,
+                           size_t end )
+   {
+      size_t next = first;
+
+      for ( size_t i = first; i < end; ++i )
+      {
+         // Always copy, only move on when the record is kept. next <= i so this stays in the
+         // part of the buffer already decoded.
+         *reinterpret_cast<T *>( &base[next * stride] ) =
+            *reinterpret_cast<const T *>( &base[i * stride] );
+
+         next += keep[i];
+      }
+
+      return next;
+   }
+
+   template <typename T> bool _isNaN( T /*value*/ )
+   {
+      return false;
+   }
+
+   template <> bool _isNaN( float value )
+   {
+      return std::isnan( value );
+   }
+
+   template <> bool _isNaN( double value )
+   {
+      return std::isnan( value );
+   }
+
+   /// The minimum, maximum and sum are gathered in locals so the loop stays in registers.
+   template <typename T>
+   void _accumulateStatistics( const char *base, size_t stride, size_t first, size_t end,
+                               FieldStatistics &statistics )
+   {
+      uint64_t count = 0;
+      double minimum = ( statistics.count > 0 ) ? statistics.minimum : DOUBLE_MAX;
+      double maximum = ( statistics.count > 0 ) ? statistics.maximum : -DOUBLE_MAX;
+      double sum = 0.0;
+
+      uint64_t *histogram = statistics.histogram.data();
+      const size_t binCount = statistics.histogram.size();
+      const double lastBin = static_cast<double>( binCount ) - 1.0;
+      const double binScale =
+         ( binCount > 0 ) ? static_cast<double>( binCount ) /
+                               ( statistics.histogramMaximum - statistics.histogramMinimum )
+                          : 0.0;
+
+      for ( size_t i = first; i < end; ++i )
+      {
+         const T recordValue = *reinterpret_cast<const T *>( &base[i * stride] );
+
+         if ( _isNaN( recordValue ) )
+         {
+            continue;
+         }
+
+         const auto value = static_cast<double>( recordValue );
+
+         ++count;
+         minimum = std::min( minimum, value );
+         maximum = std::max( maximum, value );
+         sum += value;
+
+         if ( binCount > 0 )
+         {
+            // Clamp before converting so values far outside the range don't overflow
+            const double bin = std::min(
+               std::max( ( value - statistics.histogramMinimum ) * binScale, 0.0 ), lastBin );
+
+            ++histogram[static_cast<size_t>( bin )];
+         }
+      }
+
+      if ( count > 0 )
+      {
+         statistics.count += count;
+         statistics.minimum = minimum;
+         statistics.maximum = maximum;
+         statistics.sum += sum;
+      }
+   }
+}
+
+/// Clear keep[i] for the records in [first, end) whose value doesn't meet the condition. Values
+/// are compared as they are in the buffer (i.e. after any conversion or scaling).
+void SourceDestBufferImpl::matchRecords( FilterComparison comparison, double value, size_t first,
+                                         size_t end, uint8_t *keep ) const
+{
+   switch ( memoryRepresentation_ )
+   {
+      case Int8:
+         _matchRecords<int8_t>( base_, stride_, first, end, comparison, value, keep );
+         break;
+      case UInt8:
+         _matchRecords<uint8_t>( base_, stride_, first, end, comparison, value, keep );
+         break;
+      case Int16:
+         _matchRecords<int16_t>( base_, stride_, first, end, comparison, value, keep );
+         break;
+      case UInt16:
+         _matchRecords<uint16_t>( base_, stride_, first, end, comparison, value, keep );
+         break;
+      case Int32:
+         _matchRecords<int32_t>( base_, stride_, first, end, comparison, value, keep );
+         break;
+      case UInt32:
+         _matchRecords<uint32_t>( base_, stride_, first, end, comparison, value, keep );
+         break;
+      case Int64:
+         _matchRecords<int64_t>( base_, stride_, first, end, comparison, value, keep );
+         break;
+      case Bool:
+         _matchRecords<bool>( base_, stride_, first, end, comparison, value, keep );
+         break;
+      case Real32:
+         _matchRecords<float>( base_, stride_, first, end, comparison, value, keep );
+         break;
+      case Real64:
+         _matchRecords<double>( base_, stride_, first, end, comparison, value, keep );
+         break;
+      case UString:
+         throw E57_EXCEPTION2( ErrorExpectingNumeric, "pathName=" + pathName_ );
+   }
+}
+
+/// Move the records in [first, end) whose keep[i] is set down to first, keeping their order. The
+/// next element set follows the last record kept.
+void SourceDestBufferImpl::compactRecords( const uint8_t *keep, size_t first, size_t end )
+{
+   size_t next = first;
+
+   switch ( memoryRepresentation_ )
+   {
+      case Int8:
+         next = _compactRecords<int8_t>( base_, stride_, keep, first, end );
+         break;
+      case UInt8:
+         next = _compactRecords<uint8_t>( base_, stride_, keep, first, end );
+         break;
+      case Int16:
+         next = _compactRecords<int16_t>( base_, stride_, keep, first, end );
+         break;
+      case UInt16:
+         next = _compactRecords<uint16_t>( base_, stride_, keep, first, end );
+         break;
+      case Int32:
+         next = _compactRecords<int32_t>( base_, stride_, keep, first, end );
+         break;
+      case UInt32:
+         next = _compactRecords<uint32_t>( base_, stride_, keep, first, end );
+         break;
+      case Int64:
+         next = _compactRecords<int64_t>( base_, stride_, keep, first, end );
+         break;
+      case Bool:
+         next = _compactRecords<bool>( base_, stride_, keep, first, end );
+         break;
+      case Real32:
+         next = _compactRecords<float>( base_, stride_, keep, first, end );
+         break;
+      case Real64:
+         next = _compactRecords<double>( base_, stride_, keep, first, end );
+         break;
+      case UString:
+         for ( size_t i = first; i < end; ++i )
+         {
+            if ( keep[i] != 0 )
+            {
+               if ( next != i )
+               {
+                  ( *ustrings_ )[next] = std::move( ( *ustrings_ )[i] );
+               }
+
+               ++next;
+            }
+         }
+         break;
+   }
+
+   nextIndex_ = static_cast<unsigned>( next );
+}
+
+/// Add the values of the records in [first, end) to the statistics, as they are in the buffer
+/// (i.e. after any conversion or scaling).
+void SourceDestBufferImpl::accumulateStatistics( size_t first, size_t end,
+                                                 FieldStatistics &statistics ) const
+{
+   switch ( memoryRepresentation_ )
+   {
+      case Int8:
+         _accumulateStatistics<int8_t>( base_, stride_, first, end, statistics );
+         break;
+      case UInt8:
+         _accumulateStatistics<uint8_t>( base_, stride_, first, end, statistics );
+         break;
+      case Int16:
+         _accumulateStatistics<int16_t>( base_, stride_, first, end, statistics );
+         break;
+      case UInt16:
+         _accumulateStatistics<uint16_t>( base_, stride_, first, end, statistics );
+         break;
+      case Int32:
+         _accumulateStatistics<int32_t>( base_, stride_, first, end, statistics );
+         break;
+      case UInt32:
+         _accumulateStatistics<uint32_t>( base_, stride_, first, end, statistics );
+         break;
+      case Int64:
+         _accumulateStatistics<int64_t>( base_, stride_, first, end, statistics );
+         break;
+      case Bool:
+         _accumulateStatistics<bool>( base_, stride_, first, end, statistics );
+         break;
+      case Real32:
+         _accumulateStatistics<float>( base_, stride_, first, end, statistics );
+         break;
+      case Real64:
+         _accumulateStatistics<double>( base_, stride_, first, end, statistics );
+         break;
+      case UString:
+         throw E57_EXCEPTION2( ErrorExpectingNumeric, "pathName=" + pathName_ );
+   }
+}
+
 void SourceDestBufferImpl::checkCompatible(
    const std::shared_ptr<SourceDestBufferImpl> &newBuf ) const
 {
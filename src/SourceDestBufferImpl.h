@@ -109,6 +109,12 @@ namespace e57
       void setNextFloat( float value );
       void setNextDouble( double value );
       void setNextString( const ustring &value );
+      void setNextRepeated( size_t count );
+
+      void matchRecords( FilterComparison comparison, double value, size_t first, size_t end,
+                         uint8_t *keep ) const;
+      void compactRecords( const uint8_t *keep, size_t first, size_t end );
+      void accumulateStatistics( size_t first, size_t end, FieldStatistics &statistics ) const;
 
       void checkCompatible( const std::shared_ptr<SourceDestBufferImpl> &newBuf ) const;
 
@@ -110,7 +110,7 @@ be true).
 @see StringNode::value, Node, CompressedVectorNode, CompressedVectorNode::prototype
 */
 StringNode::StringNode( const ImageFile &destImageFile, const ustring &value ) :
-   impl_( new StringNodeImpl( destImageFile.impl(), value ) )
+   impl_( makeNode<StringNodeImpl>( destImageFile.impl(), value ) )
 {
 }
 
@@ -32,7 +32,8 @@
 namespace e57
 {
    StringNodeImpl::StringNodeImpl( ImageFileImplWeakPtr destImageFile, const ustring &value ) :
-      NodeImpl( destImageFile ), value_( value )
+      NodeImpl( destImageFile ),
+      value_( value.data(), value.size(), ResourceAllocator<char>( memoryResource() ) )
    {
       // don't checkImageFileOpen, NodeImpl() will do it
    }
@@ -64,7 +65,7 @@ namespace e57
    ustring StringNodeImpl::value()
    {
       checkImageFileOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
-      return ( value_ );
+      return toUstring( value_ );
    }
 
    void StringNodeImpl::checkLeavesInSet( const StringSet &pathNames, NodeImplSharedPtr origin )
@@ -90,7 +91,7 @@ namespace e57
       }
       else
       {
-         fieldName = elementName_;
+         fieldName = toUstring( elementName_ );
       }
 
       cf << space( indent ) << "<" << fieldName << " type=\"String\"";
@@ -104,25 +105,26 @@ namespace e57
       {
          cf << "><![CDATA[";
 
+         const ustring value = toUstring( value_ );
          size_t currentPosition = 0;
-         size_t len = value_.length();
+         size_t len = value.length();
 
          // Loop, searching for occurrences of "]]>", which will be split across two CDATA
          // directives
          while ( currentPosition < len )
          {
-            size_t found = value_.find( "]]>", currentPosition );
+            size_t found = value.find( "]]>", currentPosition );
 
             if ( found == std::string::npos )
             {
                // Didn't find any more "]]>", so can send the rest.
-               cf << value_.substr( currentPosition );
+               cf << value.substr( currentPosition );
                break;
             }
 
             // Must output in two pieces, first send up to end of "]]"  (don't send the following
             // ">").
-            cf << value_.substr( currentPosition, found - currentPosition + 2 );
+            cf << value.substr( currentPosition, found - currentPosition + 2 );
 
             // Then start a new CDATA
             cf << "]]><![CDATA[";
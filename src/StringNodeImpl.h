@@ -56,7 +56,9 @@ namespace e57
 #endif
 
    private:
-      ustring value_;
+      friend class NodeView;
+
+      ResourceString value_;
    };
 
 }
@@ -133,7 +133,7 @@ be true).
 @see Node
 */
 StructureNode::StructureNode( const ImageFile &destImageFile ) :
-   impl_( new StructureNodeImpl( destImageFile.impl() ) )
+   impl_( makeNode<StructureNodeImpl>( destImageFile.impl() ) )
 {
 }
 
@@ -191,6 +191,15 @@ bool StructureNode::isAttached() const
    return impl_->isAttached();
 }
 
+/*!
+@brief Walk the tree below the node, giving a view of each node to a visitor.
+@copydetails Node::visit()
+*/
+void StructureNode::visit( NodeVisitor &visitor ) const
+{
+   static_cast<Node>( *this ).visit( visitor );
+}
+
 /*!
 @brief Return number of child nodes contained by this StructureNode.
 
@@ -403,7 +412,7 @@ StructureNode::StructureNode( const Node &n )
 
 /// @cond documentNonPublic The following isn't part of the API, and isn't documented.
 StructureNode::StructureNode( std::weak_ptr<ImageFileImpl> fileParent ) :
-   impl_( new StructureNodeImpl( fileParent ) )
+   impl_( makeNode<StructureNodeImpl>( fileParent ) )
 {
 }
 
@@ -26,6 +26,7 @@
  */
 
 #include <climits>
+#include <cstring>
 
 #include "CheckedFile.h"
 #include "ImageFileImpl.h"
@@ -34,8 +35,57 @@
 
 using namespace e57;
 
+namespace
+{
+   // Parse an element name which is a child index (e.g. "14"). Returns false for anything else,
+   // including leading zeros which would be a different name for the same index.
+   bool _parseIndex( const ustring &elementName, size_t &index )
+   {
+      if ( elementName.empty() || elementName.size() > 18 ||
+           ( elementName[0] == '0' && elementName.size() > 1 ) )
+      {
+         return false;
+      }
+
+      index = 0;
+
+      for ( const char c : elementName )
+      {
+         if ( c < '0' || c > '9' )
+         {
+            return false;
+         }
+
+         index = index * 10 + static_cast<size_t>( c - '0' );
+      }
+
+      return true;
+   }
+}
+
+size_t StructureNodeImpl::NameKeyHash::operator()( const NameKey &key ) const noexcept
+{
+   // FNV-1a
+   uint64_t hash = 14695981039346656037ULL;
+
+   for ( size_t i = 0; i < key.size; ++i )
+   {
+      hash = ( hash ^ static_cast<uint8_t>( key.data[i] ) ) * 1099511628211ULL;
+   }
+
+   return static_cast<size_t>( hash );
+}
+
+bool StructureNodeImpl::NameKeyEqual::operator()( const NameKey &lhs,
+                                                  const NameKey &rhs ) const noexcept
+{
+   return ( lhs.size == rhs.size ) && ( std::memcmp( lhs.data, rhs.data, lhs.size ) == 0 );
+}
+
 StructureNodeImpl::StructureNodeImpl( ImageFileImplWeakPtr destImageFile ) :
-   NodeImpl( destImageFile )
+   NodeImpl( destImageFile ),
+   children_( ResourceAllocator<NodeImplSharedPtr>( memoryResource() ) ),
+   childIndex_( ResourceAllocator<std::pair<const NameKey, size_t>>( memoryResource() ) )
 {
    checkImageFileOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
 }
@@ -170,22 +220,15 @@ NodeImplSharedPtr StructureNodeImpl::lookup( const ustring &pathName )
       }
 
       // Find child with elementName that matches first field in path
-      unsigned i;
-      for ( i = 0; i < children_.size(); i++ )
-      {
-         if ( fields.at( 0 ) == children_.at( i )->elementName() )
-         {
-            break;
-         }
-      }
-      if ( i == children_.size() )
+      NodeImplSharedPtr child( findChild( fields.at( 0 ) ) );
+      if ( !child )
       {
          return {}; // empty pointer
       }
 
       if ( fields.size() == 1 )
       {
-         return ( children_.at( i ) );
+         return ( child );
       }
 
       //??? use level here rather than unparse
@@ -193,7 +236,7 @@ NodeImplSharedPtr StructureNodeImpl::lookup( const ustring &pathName )
       fields.erase( fields.begin() );
 
       // Call lookup on child object with remaining fields in path name
-      return children_.at( i )->lookup( imf->pathNameUnparse( true, fields ) );
+      return child->lookup( imf->pathNameUnparse( true, fields ) );
    }
 
    // Absolute pathname and we aren't at the root
@@ -235,18 +278,14 @@ void StructureNodeImpl::set( int64_t index64, NodeImplSharedPtr ni )
                                niDest->fileName() );
    }
 
-   // Field name is string version of index value, e.g. "14"
-   std::stringstream elementName;
-   elementName << index;
-
    // If this struct is type constrained, can't add new child
    if ( isTypeConstrained() )
    {
       throw E57_EXCEPTION2( ErrorHomogeneousViolation, "this->pathName=" + this->pathName() );
    }
 
-   ni->setParent( shared_from_this(), elementName.str() );
-   children_.push_back( ni );
+   // Field name is string version of index value, e.g. "14"
+   appendChild( ni, toString( index ) );
 }
 
 void StructureNodeImpl::set( const ustring &pathName, NodeImplSharedPtr ni, bool autoPathCreate )
@@ -302,23 +341,21 @@ void StructureNodeImpl::set( const std::vector<ustring> &fields, unsigned level,
       throw E57_EXCEPTION2( ErrorSetTwice, "this->pathName=" + this->pathName() + " element=/" );
    }
 
-   // Serial search for matching field name, if find match, have error since can't set twice
-   for ( auto &child : children_ )
+   // Search for matching field name, if find match, have error since can't set twice
+   NodeImplSharedPtr existing( findChild( fields.at( level ) ) );
+   if ( existing )
    {
-      if ( fields.at( level ) == child->elementName() )
+      if ( level == fields.size() - 1 )
       {
-         if ( level == fields.size() - 1 )
-         {
-            // Enforce "set once" policy, don't allow reset
-            throw E57_EXCEPTION2( ErrorSetTwice, "this->pathName=" + this->pathName() +
-                                                    " element=" + fields[level] );
-         }
+         // Enforce "set once" policy, don't allow reset
+         throw E57_EXCEPTION2( ErrorSetTwice, "this->pathName=" + this->pathName() +
+                                                 " element=" + fields[level] );
+      }
 
-         // Recurse on child
-         child->set( fields, level + 1, ni );
+      // Recurse on child
+      existing->set( fields, level + 1, ni );
 
-         return;
-      }
+      return;
    }
    // Didn't find matching field name, so have a new child.
 
@@ -332,8 +369,7 @@ void StructureNodeImpl::set( const std::vector<ustring> &fields, unsigned level,
    if ( level == fields.size() - 1 )
    {
       // At bottom, so append node at end of children
-      ni->setParent( shared_from_this(), fields.at( level ) );
-      children_.push_back( ni );
+      appendChild( ni, fields.at( level ) );
    }
    else
    {
@@ -349,7 +385,7 @@ void StructureNodeImpl::set( const std::vector<ustring> &fields, unsigned level,
       NodeImplSharedPtr parent( shared_from_this() );
       for ( ; level != fields.size() - 1; level++ )
       {
-         std::shared_ptr<StructureNodeImpl> child( new StructureNodeImpl( destImageFile_ ) );
+         std::shared_ptr<StructureNodeImpl> child = makeNode<StructureNodeImpl>( destImageFile_ );
          parent->set( fields.at( level ), child );
          parent = child;
       }
@@ -365,6 +401,46 @@ void StructureNodeImpl::append( NodeImplSharedPtr ni )
    set( childCount(), ni );
 }
 
+NodeImplSharedPtr StructureNodeImpl::findChild( const ustring &elementName ) const
+{
+   // don't checkImageFileOpen
+
+   // Children appended by index are named by their position
+   size_t index = 0;
+   if ( _parseIndex( elementName, index ) && ( index < children_.size() ) &&
+        ( children_[index]->elementName_ == elementName.c_str() ) )
+   {
+      return children_[index];
+   }
+
+   const auto found = childIndex_.find( NameKey{ elementName.data(), elementName.size() } );
+   if ( found == childIndex_.end() )
+   {
+      return {}; // empty pointer
+   }
+
+   return children_[found->second];
+}
+
+void StructureNodeImpl::appendChild( const NodeImplSharedPtr &ni, const ustring &elementName )
+{
+   // don't checkImageFileOpen
+
+   // setParent() throws if ni already has one, so do it before changing anything
+   ni->setParent( shared_from_this(), elementName );
+
+   const size_t position = children_.size();
+   size_t index = 0;
+   if ( !_parseIndex( elementName, index ) || ( index != position ) )
+   {
+      const ResourceString &name = ni->elementName_;
+
+      childIndex_.emplace( NameKey{ name.data(), name.size() }, position );
+   }
+
+   children_.push_back( ni );
+}
+
 //??? use visitor?
 void StructureNodeImpl::checkLeavesInSet( const StringSet &pathNames, NodeImplSharedPtr origin )
 {
@@ -390,7 +466,7 @@ void StructureNodeImpl::writeXml( ImageFileImplSharedPtr imf, CheckedFile &cf, i
    }
    else
    {
-      fieldName = elementName_;
+      fieldName = toUstring( elementName_ );
    }
 
    cf << space( indent ) << "<" << fieldName << " type=\"Structure\"";
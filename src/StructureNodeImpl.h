@@ -27,6 +27,8 @@
 
 #pragma once
 
+#include <unordered_map>
+
 #include "NodeImpl.h"
 
 namespace e57
@@ -65,10 +67,39 @@ namespace e57
 #endif
 
    protected:
+      friend class CompressedVectorNodeImpl;
       friend class CompressedVectorReaderImpl;
+      friend class NodeView;
 
       NodeImplSharedPtr lookup( const ustring &pathName ) override;
 
-      std::vector<NodeImplSharedPtr> children_;
+      NodeImplSharedPtr findChild( const ustring &elementName ) const;
+      void appendChild( const NodeImplSharedPtr &ni, const ustring &elementName );
+
+      // Element name of a child, pointing into the child's elementName_ (which doesn't change once
+      // it has a parent), so neither adding nor finding a child copies the name
+      struct NameKey
+      {
+         const char *data;
+         size_t size;
+      };
+
+      struct NameKeyHash
+      {
+         size_t operator()( const NameKey &key ) const noexcept;
+      };
+
+      struct NameKeyEqual
+      {
+         bool operator()( const NameKey &lhs, const NameKey &rhs ) const noexcept;
+      };
+
+      ResourceVector<NodeImplSharedPtr> children_;
+
+      // Position in children_ of the children whose element name isn't their position (e.g.
+      // "cartesianX"). Children appended by index ("0", "1", ...) are found without it.
+      std::unordered_map<NameKey, size_t, NameKeyHash, NameKeyEqual,
+                         ResourceAllocator<std::pair<const NameKey, size_t>>>
+         childIndex_;
    };
 }
@@ -152,7 +152,7 @@ be true).
 @see Node, VectorNode::allowHeteroChildren, ::ErrorHomogeneousViolation
 */
 VectorNode::VectorNode( const ImageFile &destImageFile, bool allowHeteroChildren ) :
-   impl_( new VectorNodeImpl( destImageFile.impl(), allowHeteroChildren ) )
+   impl_( makeNode<VectorNodeImpl>( destImageFile.impl(), allowHeteroChildren ) )
 {
 }
 
@@ -366,6 +366,70 @@ void VectorNode::append( const Node &n )
    impl_->append( n.impl() );
 }
 
+/*!
+@brief Append several child elements to end of VectorNode.
+
+@param [in] nodes The nodes to be added as children at end of the VectorNode, in order.
+
+@details
+This is the same as calling VectorNode::append for each node, but the space for the new children is
+reserved first. Each append takes constant time, so building a VectorNode with millions of children
+(e.g. one per scan or per image) takes linear time.
+
+If one of the nodes can't be appended, an exception is thrown and the nodes before it stay appended.
+
+@pre Each node in @a nodes must be a root node (not already having a parent).
+@pre The destination ImageFile must be open (i.e. destImageFile().isOpen()).
+@pre The associated destImageFile must have been opened in write mode (i.e.
+destImageFile().isWritable()).
+@post the childCount is incremented by the number of nodes.
+
+@throw ::ErrorImageFileNotOpen
+@throw ::ErrorHomogeneousViolation
+@throw ::ErrorFileReadOnly
+@throw ::ErrorAlreadyHasParent
+@throw ::ErrorDifferentDestImageFile
+@throw ::ErrorInternal All objects in undocumented state
+
+@see VectorNode::append, VectorNode::reserve
+*/
+void VectorNode::appendMany( const std::vector<Node> &nodes )
+{
+   std::vector<NodeImplSharedPtr> impls;
+   impls.reserve( nodes.size() );
+
+   for ( const auto &n : nodes )
+   {
+      impls.push_back( n.impl() );
+   }
+
+   impl_->appendMany( impls );
+}
+
+/*!
+@brief Reserve space for a number of children.
+
+@param [in] count The total number of children the VectorNode is expected to have.
+
+@details
+This doesn't change the childCount. It only avoids growing the list of children several times when
+many children are appended one by one.
+
+@pre The destination ImageFile must be open (i.e. destImageFile().isOpen()).
+@pre count >= 0
+@post No visible state is modified.
+
+@throw ::ErrorBadAPIArgument
+@throw ::ErrorImageFileNotOpen
+@throw ::ErrorInternal All objects in undocumented state
+
+@see VectorNode::append, VectorNode::appendMany
+*/
+void VectorNode::reserve( int64_t count )
+{
+   impl_->reserve( count );
+}
+
 /*!
 @brief Diagnostic function to print internal state of object to output stream in an indented format.
 @copydetails Node::dump()
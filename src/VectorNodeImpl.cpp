@@ -83,16 +83,14 @@ namespace e57
    void VectorNodeImpl::set( int64_t index64, NodeImplSharedPtr ni )
    {
       checkImageFileOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
-      if ( !allowHeteroChildren_ )
+      if ( !allowHeteroChildren_ && !children_.empty() )
       {
-         // New node type must match all existing children
-         for ( auto &child : children_ )
+         // New node type must match all existing children. They all match each other, so
+         // comparing with the first one is enough.
+         if ( !children_.front()->isTypeEquivalent( ni ) )
          {
-            if ( !child->isTypeEquivalent( ni ) )
-            {
-               throw E57_EXCEPTION2( ErrorHomogeneousViolation,
-                                     "this->pathName=" + this->pathName() );
-            }
+            throw E57_EXCEPTION2( ErrorHomogeneousViolation,
+                                  "this->pathName=" + this->pathName() );
          }
       }
 
@@ -100,6 +98,31 @@ namespace e57
       StructureNodeImpl::set( index64, ni );
    }
 
+   void VectorNodeImpl::reserve( int64_t count )
+   {
+      checkImageFileOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+
+      if ( count < 0 )
+      {
+         throw E57_EXCEPTION2( ErrorBadAPIArgument, "this->pathName=" + this->pathName() +
+                                                       " count=" + toString( count ) );
+      }
+
+      children_.reserve( static_cast<size_t>( count ) );
+   }
+
+   void VectorNodeImpl::appendMany( const std::vector<NodeImplSharedPtr> &nodes )
+   {
+      // don't checkImageFileOpen, set() will do it
+
+      children_.reserve( children_.size() + nodes.size() );
+
+      for ( const auto &ni : nodes )
+      {
+         append( ni );
+      }
+   }
+
    void VectorNodeImpl::writeXml( ImageFileImplSharedPtr imf, CheckedFile &cf, int indent,
                                   const char *forcedFieldName )
    {
@@ -112,7 +135,7 @@ namespace e57
       }
       else
       {
-         fieldName = elementName_;
+         fieldName = toUstring( elementName_ );
       }
 
       cf << space( indent ) << "<" << fieldName << " type=\"Vector\" allowHeterogeneousChildren=\""
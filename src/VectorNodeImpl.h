@@ -45,6 +45,8 @@ namespace e57
       bool allowHeteroChildren() const;
 
       void set( int64_t index, NodeImplSharedPtr ni ) override;
+      void reserve( int64_t count );
+      void appendMany( const std::vector<NodeImplSharedPtr> &nodes );
 
       void writeXml( ImageFileImplSharedPtr imf, CheckedFile &cf, int indent,
                      const char *forcedFieldName = nullptr ) override;
@@ -54,6 +56,8 @@ namespace e57
 #endif
 
    private:
+      friend class NodeView;
+
       // Because we are overriding set(), it is hiding the other overrides in StructureNodeImpl.
       // This will pull them in.
       // Fixes the "overloaded-virtual" warning in gcc.
@@ -26,12 +26,18 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <algorithm>
 #include <cmath>
+#include <functional>
+#include <limits>
 
 #include "WriterImpl.h"
 
 #include "Common.h"
+#include "CompressedVectorWriterImpl.h"
 #include "E57Version.h"
+#include "ImageFileImpl.h"
+#include "SourceDestBufferImpl.h"
 
 namespace
 {
@@ -71,6 +77,127 @@ namespace
                .append( std::to_string( static_cast<int>( inNodeType ) ) );
       }
    }
+
+   /*!
+   @brief Get the value of a record in a buffer without changing the buffer's read position.
+
+   @param sbuf buffer to read from
+   @param index index of the record
+   @param [out] value the value of the record
+
+   @return false if the buffer doesn't hold numbers.
+   */
+   bool _recordValue( const e57::SourceDestBufferImpl &sbuf, size_t index, int64_t &value )
+   {
+      const char *record = static_cast<const char *>( sbuf.base() ) + index * sbuf.stride();
+
+      switch ( sbuf.memoryRepresentation() )
+      {
+         case e57::Int8:
+            value = *reinterpret_cast<const int8_t *>( record );
+            break;
+         case e57::UInt8:
+            value = *reinterpret_cast<const uint8_t *>( record );
+            break;
+         case e57::Int16:
+            value = *reinterpret_cast<const int16_t *>( record );
+            break;
+         case e57::UInt16:
+            value = *reinterpret_cast<const uint16_t *>( record );
+            break;
+         case e57::Int32:
+            value = *reinterpret_cast<const int32_t *>( record );
+            break;
+         case e57::UInt32:
+            value = *reinterpret_cast<const uint32_t *>( record );
+            break;
+         case e57::Int64:
+            value = *reinterpret_cast<const int64_t *>( record );
+            break;
+         case e57::Bool:
+            value = *reinterpret_cast<const bool *>( record ) ? 1 : 0;
+            break;
+         case e57::Real32:
+            value = static_cast<int64_t>( *reinterpret_cast<const float *>( record ) );
+            break;
+         case e57::Real64:
+            value = static_cast<int64_t>( *reinterpret_cast<const double *>( record ) );
+            break;
+         default:
+            return false;
+      }
+
+      return true;
+   }
+
+   /// @overload
+   bool _recordValue( const e57::SourceDestBufferImpl &sbuf, size_t index, double &value )
+   {
+      const char *record = static_cast<const char *>( sbuf.base() ) + index * sbuf.stride();
+
+      switch ( sbuf.memoryRepresentation() )
+      {
+         case e57::Real32:
+            value = *reinterpret_cast<const float *>( record );
+            break;
+         case e57::Real64:
+            value = *reinterpret_cast<const double *>( record );
+            break;
+         default:
+         {
+            int64_t integerValue = 0;
+
+            if ( !_recordValue( sbuf, index, integerValue ) )
+            {
+               return false;
+            }
+
+            value = static_cast<double>( integerValue );
+         }
+      }
+
+      return true;
+   }
+
+   /// Copies one field of the user's points into a chunk buffer in the order of an index list
+   using GatherFunction = std::function<void( const std::vector<size_t> &pointIndices )>;
+
+   template <typename T>
+   void _addGatherField( std::vector<GatherFunction> &gathers, const T *source, T *&chunkField,
+                         size_t chunkSize )
+   {
+      if ( source == nullptr )
+      {
+         return;
+      }
+
+      auto chunk = std::make_shared<std::vector<T>>( chunkSize );
+
+      chunkField = chunk->data();
+
+      gathers.push_back( [source, chunk]( const std::vector<size_t> &pointIndices ) {
+         T *dest = chunk->data();
+
+         for ( size_t i = 0; i < pointIndices.size(); ++i )
+         {
+            dest[i] = source[pointIndices[i]];
+         }
+      } );
+   }
+
+   /// Reverses the order of the low bitCount bits of value
+   uint64_t _reverseBits( uint64_t value, unsigned bitCount )
+   {
+      uint64_t reversed = 0;
+
+      for ( unsigned i = 0; i < bitCount; ++i )
+      {
+         reversed = ( reversed << 1 ) | ( value & 1 );
+         value >>= 1;
+      }
+
+      return reversed;
+   }
 }
 
 namespace e57
@@ -126,7 +253,10 @@ namespace e57
    }
 
    WriterImpl::WriterImpl( const ustring &filePath, const WriterOptions &options ) :
-      imf_( filePath, "w" ), root_( imf_.root() ), data3D_( imf_, true ), images2D_( imf_, true )
+      imf_( openImageFile( filePath, options ) ), root_( imf_.root() ), data3D_( imf_, true ),
+      images2D_( imf_, true ), fieldCodecs_( options.fieldCodecs ),
+      timeIndexChunkSize_( options.timeIndexChunkSize ),
+      progressivePointOrder_( options.progressivePointOrder )
    {
       // We are using the E57 v1.0 data format standard fieldnames.
       // The standard fieldnames are used without an extension prefix (in the default namespace).
@@ -134,6 +264,16 @@ namespace e57
       // us, if we didn't).
       imf_.extensionsAdd( "", e57::VERSION_1_0_URI );
 
+      if ( options.directIO )
+      {
+         imf_.impl()->setDirectIO( true );
+      }
+
+      imf_.impl()->setColumnGroupedPackets( options.columnGroupedPackets );
+      imf_.impl()->setCodecSelection( options.codecSelectionSampleSize,
+                                      options.codecSelectionTolerance );
+      imf_.impl()->setXmlAtFront( options.xmlAtFront );
+
       // Set per-file properties.
       // Path names: "/formatName", "/majorVersion", "/minorVersion", "/coordinateMetadata"
       root_.set( "formatName", StringNode( imf_, "ASTM E57 3D Imaging Data File" ) );
@@ -173,6 +313,17 @@ namespace e57
       root_.set( "images2D", images2D_ );
    }
 
+   ImageFile WriterImpl::openImageFile( const ustring &filePath, const WriterOptions &options )
+   {
+      // The memory resource has to be set before the root is created
+      std::shared_ptr<ImageFileImpl> imfi( new ImageFileImpl( ChecksumAll ) );
+
+      imfi->setMemoryResource( options.memoryResource );
+      imfi->construct2( filePath, "w" );
+
+      return ImageFile( imfi );
+   }
+
    WriterImpl::~WriterImpl()
    {
       if ( IsOpen() )
@@ -193,6 +344,9 @@ namespace e57
          return false;
       }
 
+      writeLineGroups();
+      writeTimeIndexes();
+
       imf_.close();
       return true;
    }
@@ -797,8 +951,24 @@ namespace e57
          // This prototype will be used in creating the groups CompressedVector.
          // Will define path names like:
          //     "/data3D/0/pointGroupingSchemes/groupingByLine/groups/0/idElementValue"
-         const int64_t groupsSize = data3DHeader.pointGroupingSchemes.groupingByLine.groupsSize;
-         const int64_t countSize = data3DHeader.pointGroupingSchemes.groupingByLine.pointCountSize;
+         auto &groupsHeader = data3DHeader.pointGroupingSchemes.groupingByLine;
+
+         // If the sizes weren't set, use the largest sizes the header allows
+         if ( groupsHeader.groupsSize <= 0 )
+         {
+            groupsHeader.groupsSize =
+               ( byColumn ? int64_t{ data3DHeader.pointFields.columnIndexMaximum }
+                          : int64_t{ data3DHeader.pointFields.rowIndexMaximum } ) +
+               1;
+         }
+
+         if ( groupsHeader.pointCountSize <= 0 )
+         {
+            groupsHeader.pointCountSize = data3DHeader.pointCount;
+         }
+
+         const int64_t groupsSize = groupsHeader.groupsSize;
+         const int64_t countSize = groupsHeader.pointCountSize;
          const int64_t pointsCount = data3DHeader.pointCount;
 
          StructureNode lineGroupProto( imf_ );
@@ -820,6 +990,25 @@ namespace e57
          groupingByLine.set( "groups", groups );
          pointGroupingSchemes.set( "groupingByLine", groupingByLine );
          scan.set( "pointGroupingSchemes", pointGroupingSchemes );
+
+         // Collect the line groups as the points are written
+         auto lineGroups = std::make_shared<LineGroups>();
+
+         lineGroups->idElementName = byColumn ? "columnIndex" : "rowIndex";
+         lineGroups->maxIdElementValue = groupsSize - 1;
+         lineGroups->maxPointCount = countSize;
+
+         lineGroups_[pos] = lineGroups;
+      }
+
+      // Collect the time index as the points are written
+      if ( ( timeIndexChunkSize_ > 0 ) && data3DHeader.pointFields.timeStampField )
+      {
+         auto timeIndex = std::make_shared<TimeIndex>();
+
+         timeIndex->chunkSize = static_cast<int64_t>( timeIndexChunkSize_ );
+
+         timeIndexes_[pos] = timeIndex;
       }
 
       // Make a prototype of datatypes that will be stored in points record.
@@ -1141,12 +1330,27 @@ namespace e57
          proto.set( "nor:normalZ", FloatNode( imf_, 0.0, PrecisionSingle, -1.0, 1.0 ) );
       }
 
-      // Make empty codecs vector for use in creating points CompressedVector.
-      // If this vector is empty, it is assumed that all fields will use the BitPack codec.
-      const VectorNode codecs( imf_, true );
+      // Make codecs vector for use in creating points CompressedVector.
+      // Fields which aren't in this vector use the BitPack codec.
+      VectorNode codecs( imf_, true );
+
+      std::map<Codec, std::vector<ustring>> codecFields;
+
+      for ( const auto &fieldCodec : fieldCodecs_ )
+      {
+         if ( ( fieldCodec.second != CodecBitPack ) && proto.isDefined( fieldCodec.first ) )
+         {
+            codecFields[fieldCodec.second].push_back( fieldCodec.first );
+         }
+      }
+
+      for ( const auto &codecField : codecFields )
+      {
+         CompressedVectorNode::appendCodec( codecs, codecField.first, codecField.second );
+      }
 
       // Create CompressedVector for storing points.  Path Name: "/data3D/0/points".
-      // We use the prototype and empty codecs tree from above.
+      // We use the prototype and codecs tree from above.
       // The CompressedVector will be filled by code below.
       const CompressedVectorNode points( imf_, proto, codecs );
 
@@ -1297,6 +1501,32 @@ namespace e57
       // create the writer, all buffers must be setup before this call
       CompressedVectorWriter writer = points.writer( sourceBuffers );
 
+      // Derive the line groups and the time index from the points as they are written
+      const auto lineGroupsIter = lineGroups_.find( dataIndex );
+      const auto timeIndexIter = timeIndexes_.find( dataIndex );
+
+      std::shared_ptr<LineGroups> lineGroups =
+         ( lineGroupsIter != lineGroups_.end() ) ? lineGroupsIter->second : nullptr;
+      std::shared_ptr<TimeIndex> timeIndex =
+         ( timeIndexIter != timeIndexes_.end() ) ? timeIndexIter->second : nullptr;
+
+      if ( ( lineGroups != nullptr ) || ( timeIndex != nullptr ) )
+      {
+         writer.impl()->setWriteObserver( [lineGroups, timeIndex](
+                                             const std::vector<SourceDestBuffer> &sbufs,
+                                             size_t recordCount ) {
+            if ( lineGroups != nullptr )
+            {
+               lineGroups->add( sbufs, recordCount );
+            }
+
+            if ( timeIndex != nullptr )
+            {
+               timeIndex->add( sbufs, recordCount );
+            }
+         } );
+      }
+
       return writer;
    }
 
@@ -1307,6 +1537,123 @@ namespace e57
    template CompressedVectorWriter WriterImpl::SetUpData3DPointsData(
       int64_t dataIndex, size_t pointCount, const Data3DPointsData_t<double> &buffers );
 
+   /// Number of points reordered at a time by WriteData3DPoints()
+   constexpr size_t PROGRESSIVE_ORDER_CHUNK_SIZE = 64 * 1024;
+
+   template <typename COORDTYPE>
+   void WriterImpl::WriteData3DPoints( int64_t dataIndex, size_t pointCount,
+                                       const Data3DPointsData_t<COORDTYPE> &buffers )
+   {
+      if ( !progressivePointOrder_ || ( pointCount < 2 ) )
+      {
+         CompressedVectorWriter writer = SetUpData3DPointsData( dataIndex, pointCount, buffers );
+
+         writer.write( pointCount );
+         writer.close();
+
+         return;
+      }
+
+      // Record the order using the point order extension
+      ustring prefix;
+
+      if ( !imf_.extensionsLookupUri( POINT_ORDER_EXTENSION_URI, prefix ) )
+      {
+         prefix = "pointOrder";
+         imf_.extensionsAdd( prefix, POINT_ORDER_EXTENSION_URI );
+      }
+
+      StructureNode scan( data3D_.get( dataIndex ) );
+      scan.set( prefix + ":order", StringNode( imf_, "bitReversedIndex" ) );
+
+      // Runs of points with the same row or column aren't lines any more
+      const auto lineGroupsIter = lineGroups_.find( dataIndex );
+
+      if ( lineGroupsIter != lineGroups_.end() )
+      {
+         lineGroupsIter->second->valid = false;
+      }
+
+      // Chunk buffers for the fields provided by the user
+      const size_t chunkSize = std::min( pointCount, PROGRESSIVE_ORDER_CHUNK_SIZE );
+
+      Data3DPointsData_t<COORDTYPE> chunk;
+      std::vector<GatherFunction> gathers;
+
+      _addGatherField( gathers, buffers.cartesianX, chunk.cartesianX, chunkSize );
+      _addGatherField( gathers, buffers.cartesianY, chunk.cartesianY, chunkSize );
+      _addGatherField( gathers, buffers.cartesianZ, chunk.cartesianZ, chunkSize );
+      _addGatherField( gathers, buffers.cartesianInvalidState, chunk.cartesianInvalidState,
+                       chunkSize );
+      _addGatherField( gathers, buffers.intensity, chunk.intensity, chunkSize );
+      _addGatherField( gathers, buffers.isIntensityInvalid, chunk.isIntensityInvalid, chunkSize );
+      _addGatherField( gathers, buffers.colorRed, chunk.colorRed, chunkSize );
+      _addGatherField( gathers, buffers.colorGreen, chunk.colorGreen, chunkSize );
+      _addGatherField( gathers, buffers.colorBlue, chunk.colorBlue, chunkSize );
+      _addGatherField( gathers, buffers.isColorInvalid, chunk.isColorInvalid, chunkSize );
+      _addGatherField( gathers, buffers.sphericalRange, chunk.sphericalRange, chunkSize );
+      _addGatherField( gathers, buffers.sphericalAzimuth, chunk.sphericalAzimuth, chunkSize );
+      _addGatherField( gathers, buffers.sphericalElevation, chunk.sphericalElevation, chunkSize );
+      _addGatherField( gathers, buffers.sphericalInvalidState, chunk.sphericalInvalidState,
+                       chunkSize );
+      _addGatherField( gathers, buffers.rowIndex, chunk.rowIndex, chunkSize );
+      _addGatherField( gathers, buffers.columnIndex, chunk.columnIndex, chunkSize );
+      _addGatherField( gathers, buffers.returnIndex, chunk.returnIndex, chunkSize );
+      _addGatherField( gathers, buffers.returnCount, chunk.returnCount, chunkSize );
+      _addGatherField( gathers, buffers.timeStamp, chunk.timeStamp, chunkSize );
+      _addGatherField( gathers, buffers.isTimeStampInvalid, chunk.isTimeStampInvalid, chunkSize );
+      _addGatherField( gathers, buffers.normalX, chunk.normalX, chunkSize );
+      _addGatherField( gathers, buffers.normalY, chunk.normalY, chunkSize );
+      _addGatherField( gathers, buffers.normalZ, chunk.normalZ, chunkSize );
+
+      CompressedVectorWriter writer = SetUpData3DPointsData( dataIndex, chunkSize, chunk );
+
+      // Number of bits needed for the point indices
+      unsigned bitCount = 0;
+
+      while ( ( uint64_t{ 1 } << bitCount ) < pointCount )
+      {
+         ++bitCount;
+      }
+
+      std::vector<size_t> pointIndices;
+      pointIndices.reserve( chunkSize );
+
+      const uint64_t end = uint64_t{ 1 } << bitCount;
+
+      for ( uint64_t k = 0; k < end; ++k )
+      {
+         const uint64_t pointIndex = _reverseBits( k, bitCount );
+
+         if ( pointIndex < pointCount )
+         {
+            pointIndices.push_back( static_cast<size_t>( pointIndex ) );
+         }
+
+         if ( ( pointIndices.size() == chunkSize ) ||
+              ( ( k == end - 1 ) && !pointIndices.empty() ) )
+         {
+            for ( const auto &gather : gathers )
+            {
+               gather( pointIndices );
+            }
+
+            writer.write( pointIndices.size() );
+
+            pointIndices.clear();
+         }
+      }
+
+      writer.close();
+   }
+
+   // Explicit template instantiation
+   template void WriterImpl::WriteData3DPoints( int64_t dataIndex, size_t pointCount,
+                                                const Data3DPointsData_t<float> &buffers );
+
+   template void WriterImpl::WriteData3DPoints( int64_t dataIndex, size_t pointCount,
+                                                const Data3DPointsData_t<double> &buffers );
+
    // This function writes out the group data
    bool WriterImpl::WriteData3DGroupsData( int64_t dataIndex, size_t groupCount,
                                            int64_t *idElementValue, int64_t *startPointIndex,
@@ -1340,6 +1687,14 @@ namespace e57
 
       CompressedVectorNode groups( groupingByLine.get( "groups" ) );
 
+      // Groups written explicitly replace the ones derived from the points
+      const auto lineGroupsIter = lineGroups_.find( dataIndex );
+
+      if ( lineGroupsIter != lineGroups_.end() )
+      {
+         lineGroupsIter->second->written = true;
+      }
+
       std::vector<SourceDestBuffer> groupSDBuffers;
       groupSDBuffers.emplace_back( imf_, "idElementValue", idElementValue, groupCount, true );
       groupSDBuffers.emplace_back( imf_, "startPointIndex", startPointIndex, groupCount, true );
@@ -1352,6 +1707,219 @@ namespace e57
       return true;
    }
 
+   void WriterImpl::LineGroups::add( const std::vector<SourceDestBuffer> &sbufs,
+                                     size_t recordCount )
+   {
+      if ( !valid )
+      {
+         return;
+      }
+
+      const auto sbufIter =
+         std::find_if( sbufs.begin(), sbufs.end(), [this]( const SourceDestBuffer &sbuf ) {
+            return sbuf.pathName() == idElementName;
+         } );
+
+      if ( sbufIter == sbufs.end() )
+      {
+         valid = false;
+         return;
+      }
+
+      const SourceDestBufferImpl &sbuf = *sbufIter->impl();
+
+      for ( size_t i = 0; i < recordCount; ++i )
+      {
+         int64_t value = 0;
+
+         if ( !_recordValue( sbuf, i, value ) || ( value < 0 ) || ( value > maxIdElementValue ) )
+         {
+            valid = false;
+            return;
+         }
+
+         // A line is a run of consecutive points with the same id element value
+         if ( !idElementValue.empty() && ( idElementValue.back() == value ) )
+         {
+            if ( ++pointCount.back() > maxPointCount )
+            {
+               valid = false;
+               return;
+            }
+         }
+         else
+         {
+            idElementValue.push_back( value );
+            startPointIndex.push_back( nextPointIndex );
+            pointCount.push_back( 1 );
+         }
+
+         ++nextPointIndex;
+      }
+   }
+
+   void WriterImpl::writeLineGroups()
+   {
+      // Points writers still open means the groups are incomplete (and can't be written anyway)
+      if ( imf_.writerCount() > 0 )
+      {
+         lineGroups_.clear();
+         return;
+      }
+
+      for ( auto &entry : lineGroups_ )
+      {
+         LineGroups &lineGroups = *entry.second;
+
+         if ( !lineGroups.valid || lineGroups.written || lineGroups.idElementValue.empty() )
+         {
+            continue;
+         }
+
+         WriteData3DGroupsData( entry.first, lineGroups.idElementValue.size(),
+                                lineGroups.idElementValue.data(),
+                                lineGroups.startPointIndex.data(), lineGroups.pointCount.data() );
+      }
+
+      lineGroups_.clear();
+   }
+
+   void WriterImpl::TimeIndex::add( const std::vector<SourceDestBuffer> &sbufs,
+                                    size_t recordCount )
+   {
+      if ( !valid )
+      {
+         return;
+      }
+
+      const auto findBuffer = [&sbufs]( const ustring &pathName ) -> const SourceDestBufferImpl * {
+         const auto sbufIter =
+            std::find_if( sbufs.begin(), sbufs.end(), [&pathName]( const SourceDestBuffer &sbuf ) {
+               return sbuf.pathName() == pathName;
+            } );
+
+         return ( sbufIter != sbufs.end() ) ? sbufIter->impl().get() : nullptr;
+      };
+
+      const SourceDestBufferImpl *timeStamp = findBuffer( "timeStamp" );
+      const SourceDestBufferImpl *isTimeStampInvalid = findBuffer( "isTimeStampInvalid" );
+
+      if ( timeStamp == nullptr )
+      {
+         valid = false;
+         return;
+      }
+
+      for ( size_t i = 0; i < recordCount; ++i )
+      {
+         if ( ( nextPointIndex % chunkSize ) == 0 )
+         {
+            startPointIndex.push_back( nextPointIndex );
+            pointCount.push_back( 0 );
+            timeMinimum.push_back( std::numeric_limits<double>::infinity() );
+            timeMaximum.push_back( -std::numeric_limits<double>::infinity() );
+         }
+
+         ++pointCount.back();
+         ++nextPointIndex;
+
+         // Invalid time stamps don't widen the range
+         int64_t invalid = 0;
+
+         if ( ( isTimeStampInvalid != nullptr ) &&
+              _recordValue( *isTimeStampInvalid, i, invalid ) && ( invalid != 0 ) )
+         {
+            continue;
+         }
+
+         double value = 0.0;
+
+         if ( !_recordValue( *timeStamp, i, value ) )
+         {
+            valid = false;
+            return;
+         }
+
+         timeMinimum.back() = std::min( timeMinimum.back(), value );
+         timeMaximum.back() = std::max( timeMaximum.back(), value );
+      }
+   }
+
+   void WriterImpl::writeTimeIndexes()
+   {
+      // Points writers still open means the indexes are incomplete
+      if ( imf_.writerCount() > 0 )
+      {
+         timeIndexes_.clear();
+         return;
+      }
+
+      for ( auto &entry : timeIndexes_ )
+      {
+         TimeIndex &timeIndex = *entry.second;
+
+         // Chunks without any valid time stamp can't be in a time window, so leave them out
+         std::vector<int64_t> startPointIndex;
+         std::vector<int64_t> pointCount;
+         std::vector<double> timeMinimum;
+         std::vector<double> timeMaximum;
+
+         for ( size_t i = 0; i < timeIndex.startPointIndex.size(); ++i )
+         {
+            if ( timeIndex.timeMinimum[i] <= timeIndex.timeMaximum[i] )
+            {
+               startPointIndex.push_back( timeIndex.startPointIndex[i] );
+               pointCount.push_back( timeIndex.pointCount[i] );
+               timeMinimum.push_back( timeIndex.timeMinimum[i] );
+               timeMaximum.push_back( timeIndex.timeMaximum[i] );
+            }
+         }
+
+         if ( !timeIndex.valid || startPointIndex.empty() )
+         {
+            continue;
+         }
+
+         ustring prefix;
+
+         if ( !imf_.extensionsLookupUri( TIME_INDEX_EXTENSION_URI, prefix ) )
+         {
+            prefix = "timeIndex";
+            imf_.extensionsAdd( prefix, TIME_INDEX_EXTENSION_URI );
+         }
+
+         const int64_t maxPointIndex = std::max<int64_t>( 0, timeIndex.nextPointIndex - 1 );
+
+         StructureNode chunkProto( imf_ );
+
+         chunkProto.set( "startPointIndex", IntegerNode( imf_, 0, 0, maxPointIndex ) );
+         chunkProto.set( "pointCount", IntegerNode( imf_, 0, 0, timeIndex.chunkSize ) );
+         chunkProto.set( "timeMinimum", FloatNode( imf_, 0.0, PrecisionDouble ) );
+         chunkProto.set( "timeMaximum", FloatNode( imf_, 0.0, PrecisionDouble ) );
+
+         const VectorNode chunkCodecs( imf_, true );
+         CompressedVectorNode chunks( imf_, chunkProto, chunkCodecs );
+
+         StructureNode scan( data3D_.get( entry.first ) );
+         scan.set( prefix + ":chunks", chunks );
+
+         const size_t chunkCount = startPointIndex.size();
+
+         std::vector<SourceDestBuffer> chunkBuffers;
+         chunkBuffers.emplace_back( imf_, "startPointIndex", startPointIndex.data(), chunkCount,
+                                    true );
+         chunkBuffers.emplace_back( imf_, "pointCount", pointCount.data(), chunkCount, true );
+         chunkBuffers.emplace_back( imf_, "timeMinimum", timeMinimum.data(), chunkCount, true );
+         chunkBuffers.emplace_back( imf_, "timeMaximum", timeMaximum.data(), chunkCount, true );
+
+         CompressedVectorWriter writer = chunks.writer( chunkBuffers );
+         writer.write( chunkCount );
+         writer.close();
+      }
+
+      timeIndexes_.clear();
+   }
+
    StructureNode WriterImpl::GetRawE57Root()
    {
       return root_;
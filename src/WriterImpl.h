@@ -28,6 +28,9 @@
 
 #pragma once
 
+#include <map>
+
+#include "Common.h"
 #include "E57SimpleData.h"
 #include "E57SimpleWriter.h"
 
@@ -61,6 +64,10 @@ namespace e57
       CompressedVectorWriter SetUpData3DPointsData( int64_t dataIndex, size_t pointCount,
                                                     const Data3DPointsData_t<COORDTYPE> &buffers );
 
+      template <typename COORDTYPE>
+      void WriteData3DPoints( int64_t dataIndex, size_t pointCount,
+                              const Data3DPointsData_t<COORDTYPE> &buffers );
+
       bool WriteData3DGroupsData( int64_t dataIndex, size_t groupCount, int64_t *idElementValue,
                                   int64_t *startPointIndex, int64_t *pointCount );
 
@@ -73,11 +80,66 @@ namespace e57
       ImageFile GetRawIMF();
 
    private:
+      static ImageFile openImageFile( const ustring &filePath, const WriterOptions &options );
+
+      // Line groups (groupingByLine) derived from the rowIndex or columnIndex of the points as
+      // they are written. Unless the groups are written explicitly using WriteData3DGroupsData(),
+      // they are written when the file is closed.
+      struct LineGroups
+      {
+         ustring idElementName;
+         int64_t maxIdElementValue = 0;
+         int64_t maxPointCount = 0;
+
+         std::vector<int64_t> idElementValue;
+         std::vector<int64_t> startPointIndex;
+         std::vector<int64_t> pointCount;
+
+         int64_t nextPointIndex = 0;
+
+         // false if the groups can't be derived (e.g. points written without the id element)
+         bool valid = true;
+         bool written = false;
+
+         void add( const std::vector<SourceDestBuffer> &sbufs, size_t recordCount );
+      };
+
+      // Time index (the range of time stamps of each chunk of points) collected from the
+      // timeStamp of the points as they are written. It is written when the file is closed.
+      struct TimeIndex
+      {
+         int64_t chunkSize = 0;
+
+         std::vector<int64_t> startPointIndex;
+         std::vector<int64_t> pointCount;
+         std::vector<double> timeMinimum;
+         std::vector<double> timeMaximum;
+
+         int64_t nextPointIndex = 0;
+
+         // false if the index can't be built (e.g. points written without the timeStamp)
+         bool valid = true;
+
+         void add( const std::vector<SourceDestBuffer> &sbufs, size_t recordCount );
+      };
+
+      void writeLineGroups();
+      void writeTimeIndexes();
+
       ImageFile imf_;
       StructureNode root_;
 
       VectorNode data3D_;
 
       VectorNode images2D_;
+
+      std::map<ustring, Codec> fieldCodecs_;
+
+      std::map<int64_t, std::shared_ptr<LineGroups>> lineGroups_;
+
+      size_t timeIndexChunkSize_;
+      std::map<int64_t, std::shared_ptr<TimeIndex>> timeIndexes_;
+
+      bool progressivePointOrder_;
    }; // end Writer class
 } // end namespace e57
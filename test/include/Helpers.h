@@ -2,6 +2,8 @@
 // libE57Format testing Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
 // SPDX-License-Identifier: MIT
 
+#include "E57SimpleWriter.h"
+
 // GoogleTest's ASSERT_NO_THROW() doesn't let us show any info about the exceptions.
 // This wrapper macro will output the e57::E57Exception context on failure.
 #define E57_ASSERT_NO_THROW( code )                                                                \
@@ -23,3 +25,71 @@
 
 #define VALIDATE_BASIC ( E57_VALIDATION_LEVEL > VALIDATION_OFF )
 #define VALIDATE_DEEP ( E57_VALIDATION_LEVEL > VALIDATION_BASIC )
+
+// Set the header to indicate we are using coloured cartesian points.
+// Just used to avoid a bunch of repetition.
+inline void setUsingColouredCartesianPoints( e57::Data3D &ioHeader )
+{
+   ioHeader.pointFields.cartesianXField = true;
+   ioHeader.pointFields.cartesianYField = true;
+   ioHeader.pointFields.cartesianZField = true;
+
+   ioHeader.pointFields.colorRedField = true;
+   ioHeader.pointFields.colorGreenField = true;
+   ioHeader.pointFields.colorBlueField = true;
+
+   ioHeader.colorLimits.colorRedMaximum = 255;
+   ioHeader.colorLimits.colorGreenMaximum = 255;
+   ioHeader.colorLimits.colorBlueMaximum = 255;
+}
+
+// Write a file with one Data3D of pointCount points ( i, -i, 0.5 * i ) and the other fields enabled
+// in fields: cartesianInvalidState 2 for every third point, intensity ( i % 100 ) / 100, rowIndex i
+// and timeStamp 0.001 * i. Returns the header which was written.
+inline e57::Data3D writeLinearPoints( const e57::ustring &filePath,
+                                      const e57::WriterOptions &options, int64_t pointCount,
+                                      const e57::Data3D &fields = {} )
+{
+   e57::Data3D header = fields;
+   header.pointCount = pointCount;
+   header.pointFields.cartesianXField = true;
+   header.pointFields.cartesianYField = true;
+   header.pointFields.cartesianZField = true;
+
+   e57::Data3DPointsDouble pointsData( header );
+
+   for ( int64_t i = 0; i < pointCount; ++i )
+   {
+      auto doublei = static_cast<double>( i );
+      pointsData.cartesianX[i] = doublei;
+      pointsData.cartesianY[i] = -doublei;
+      pointsData.cartesianZ[i] = 0.5 * doublei;
+
+      if ( header.pointFields.cartesianInvalidStateField )
+      {
+         pointsData.cartesianInvalidState[i] = ( ( i % 3 ) == 0 ) ? 2 : 0;
+      }
+
+      if ( header.pointFields.intensityField )
+      {
+         pointsData.intensity[i] = static_cast<double>( i % 100 ) / 100.0;
+      }
+
+      if ( header.pointFields.rowIndexField )
+      {
+         pointsData.rowIndex[i] = static_cast<int32_t>( i );
+      }
+
+      if ( header.pointFields.timeStampField )
+      {
+         pointsData.timeStamp[i] = 0.001 * doublei;
+      }
+   }
+
+   e57::Writer writer( filePath, options );
+
+   writer.WriteData3DData( header, pointsData );
+   writer.Close();
+
+   return header;
+}
@@ -0,0 +1,241 @@
+// libE57Format testing Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// This file is compiled as C++20 when the compiler supports it (see CMakeLists.txt).
+
+#include "gtest/gtest.h"
+
+#include "E57Async.h"
+
+#include "Helpers.h"
+
+#if defined( E57_HAS_COROUTINES )
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+   // Runs the tasks one after the other on its own thread
+   class ThreadExecutor
+   {
+   public:
+      ThreadExecutor() : thread_( [this] { run(); } )
+      {
+      }
+
+      ~ThreadExecutor()
+      {
+         {
+            std::lock_guard<std::mutex> lock( mutex_ );
+            stop_ = true;
+         }
+
+         condition_.notify_one();
+         thread_.join();
+      }
+
+      e57::AsyncExecutor executor()
+      {
+         return [this]( std::function<void()> task ) {
+            {
+               std::lock_guard<std::mutex> lock( mutex_ );
+               tasks_.push_back( std::move( task ) );
+            }
+
+            condition_.notify_one();
+         };
+      }
+
+      std::thread::id threadId() const
+      {
+         return thread_.get_id();
+      }
+
+   private:
+      void run()
+      {
+         while ( true )
+         {
+            std::function<void()> task;
+
+            {
+               std::unique_lock<std::mutex> lock( mutex_ );
+               condition_.wait( lock, [this] { return stop_ || !tasks_.empty(); } );
+
+               if ( tasks_.empty() )
+               {
+                  return;
+               }
+
+               task = std::move( tasks_.front() );
+               tasks_.pop_front();
+            }
+
+            task();
+         }
+      }
+
+      std::mutex mutex_;
+      std::condition_variable condition_;
+      std::deque<std::function<void()>> tasks_;
+      bool stop_ = false;
+      std::thread thread_;
+   };
+
+   // Coroutine which starts immediately and signals a future when it is done
+   struct Task
+   {
+      struct promise_type
+      {
+         std::promise<void> done;
+
+         Task get_return_object()
+         {
+            return { done.get_future() };
+         }
+
+         std::suspend_never initial_suspend() noexcept
+         {
+            return {};
+         }
+
+         std::suspend_never final_suspend() noexcept
+         {
+            return {};
+         }
+
+         void return_void()
+         {
+            done.set_value();
+         }
+
+         void unhandled_exception()
+         {
+            done.set_exception( std::current_exception() );
+         }
+      };
+
+      std::future<void> finished;
+   };
+
+   constexpr size_t cNumRecords = 10'000;
+
+   Task WriteAndRead( e57::ImageFile &imf, e57::AsyncExecutor executor, std::thread::id workerId,
+                      size_t &readCount, size_t &chunkRecordCount )
+   {
+      e57::StructureNode proto( imf );
+      proto.set( "x", e57::FloatNode( imf ) );
+
+      e57::VectorNode codecs( imf, true );
+      e57::CompressedVectorNode cv( imf, proto, codecs );
+      imf.root().set( "points", cv );
+
+      std::vector<double> values( cNumRecords );
+
+      for ( size_t i = 0; i < cNumRecords; ++i )
+      {
+         values[i] = static_cast<double>( i ) * 0.5;
+      }
+
+      std::vector<e57::SourceDestBuffer> sbufs{ e57::SourceDestBuffer(
+         imf, "x", values.data(), cNumRecords, true ) };
+
+      e57::CompressedVectorWriter writer = cv.writer( sbufs );
+
+      co_await e57::writeAsync( writer, cNumRecords, executor );
+
+      // Resumed on the executor's thread
+      EXPECT_EQ( std::this_thread::get_id(), workerId );
+
+      writer.close();
+
+      std::vector<double> readValues( cNumRecords );
+
+      std::vector<e57::SourceDestBuffer> dbufs{ e57::SourceDestBuffer(
+         imf, "x", readValues.data(), cNumRecords, true ) };
+
+      e57::CompressedVectorReader reader = cv.reader( dbufs );
+
+      readCount = co_await e57::readAsync( reader, executor );
+
+      EXPECT_TRUE( readValues == values );
+
+      reader.close();
+
+      // Again in small chunks
+      constexpr size_t cChunkSize = 1'000;
+
+      dbufs = { e57::SourceDestBuffer( imf, "x", readValues.data(), cChunkSize, true ) };
+
+      e57::AsyncChunkReader chunks( cv.reader( dbufs ), executor );
+
+      while ( const unsigned count = co_await chunks.next() )
+      {
+         chunkRecordCount += count;
+      }
+   }
+}
+
+TEST( Async, WriteAndRead )
+{
+   ThreadExecutor threadExecutor;
+
+   e57::ImageFile imf( "./AsyncWriteAndRead.e57", "w" );
+
+   size_t readCount = 0;
+   size_t chunkRecordCount = 0;
+
+   Task task = WriteAndRead( imf, threadExecutor.executor(), threadExecutor.threadId(), readCount,
+                             chunkRecordCount );
+
+   E57_ASSERT_NO_THROW( task.finished.get() );
+
+   EXPECT_EQ( readCount, cNumRecords );
+   EXPECT_EQ( chunkRecordCount, cNumRecords );
+
+   imf.close();
+}
+
+TEST( Async, ReadErrorIsRethrown )
+{
+   ThreadExecutor threadExecutor;
+
+   e57::ImageFile imf( "./AsyncReadError.e57", "w" );
+
+   e57::StructureNode proto( imf );
+   proto.set( "x", e57::FloatNode( imf ) );
+
+   e57::VectorNode codecs( imf, true );
+   e57::CompressedVectorNode cv( imf, proto, codecs );
+   imf.root().set( "points", cv );
+
+   std::vector<double> values( 10 );
+
+   std::vector<e57::SourceDestBuffer> sbufs{ e57::SourceDestBuffer( imf, "x", values.data(),
+                                                                    values.size(), true ) };
+
+   e57::CompressedVectorWriter writer = cv.writer( sbufs );
+   writer.write( values.size() );
+   writer.close();
+
+   e57::CompressedVectorReader reader = cv.reader( sbufs );
+   reader.close();
+
+   // Reading a closed reader throws on the executor thread
+   auto readClosed = []( e57::CompressedVectorReader closedReader,
+                         e57::AsyncExecutor executor ) -> Task {
+      co_await e57::readAsync( closedReader, executor );
+   };
+
+   Task task = readClosed( reader, threadExecutor.executor() );
+
+   E57_ASSERT_THROW( task.finished.get() );
+
+   imf.close();
+}
+
+#endif
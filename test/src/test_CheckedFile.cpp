@@ -0,0 +1,147 @@
+// libE57Format testing Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include <fstream>
+#include <iterator>
+
+#if defined( __linux__ )
+#include <dirent.h>
+#endif
+
+#include "gtest/gtest.h"
+
+#include "CheckedFile.h"
+
+#include "Helpers.h"
+
+namespace
+{
+   std::vector<char> ReadFileBytes( const e57::ustring &filePath )
+   {
+      std::ifstream file( filePath, std::ios::binary );
+
+      return { std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() };
+   }
+}
+
+TEST( CheckedFile, NewPagePaddingIsZero )
+{
+   const e57::ustring cFilePath = "./NewPagePaddingIsZero.e57";
+
+   constexpr size_t cLogicalPageSize = e57::CheckedFile::logicalPageSize;
+   constexpr size_t cPhysicalPageSize = e57::CheckedFile::physicalPageSize;
+
+   {
+      e57::CheckedFile file( cFilePath, e57::CheckedFile::Write, e57::ChecksumAll );
+
+      // Fill two pages, then start a third one
+      const std::vector<char> fullPages( 2 * cLogicalPageSize, 'A' );
+      const std::vector<char> partialPage( 10, 'B' );
+
+      E57_ASSERT_NO_THROW( file.write( fullPages.data(), fullPages.size() ) );
+      E57_ASSERT_NO_THROW( file.write( partialPage.data(), partialPage.size() ) );
+
+      E57_ASSERT_NO_THROW( file.close() );
+   }
+
+   const std::vector<char> bytes = ReadFileBytes( cFilePath );
+
+   ASSERT_EQ( bytes.size(), 3 * cPhysicalPageSize );
+
+   const char *thirdPage = &bytes[2 * cPhysicalPageSize];
+
+   for ( size_t i = 0; i < 10; ++i )
+   {
+      ASSERT_EQ( thirdPage[i], 'B' );
+   }
+
+   // The rest of the page must not hold bytes of the previous pages
+   for ( size_t i = 10; i < cLogicalPageSize; ++i )
+   {
+      ASSERT_EQ( thirdPage[i], 0 ) << "offset " << i;
+   }
+}
+
+TEST( CheckedFile, ParallelChecksumsMatchSerial )
+{
+   // Enough pages for several threads, and a partial last page
+   constexpr size_t cByteCount = 3'000 * e57::CheckedFile::logicalPageSize + 123;
+
+   std::vector<char> data( cByteCount );
+
+   for ( size_t i = 0; i < cByteCount; ++i )
+   {
+      data[i] = static_cast<char>( ( i * 2'654'435'761u ) >> 13 );
+   }
+
+   const auto writeFile = [&data]( const e57::ustring &filePath, unsigned threadCount ) {
+      e57::CheckedFile file( filePath, e57::CheckedFile::Write, e57::ChecksumAll );
+
+      file.setChecksumThreadCount( threadCount );
+
+      // Write in pieces so some pages are written in two parts
+      for ( size_t offset = 0; offset < data.size(); offset += 100'000 )
+      {
+         file.write( &data[offset], std::min<size_t>( 100'000, data.size() - offset ) );
+      }
+
+      file.close();
+   };
+
+   E57_ASSERT_NO_THROW( writeFile( "./ChecksumsSerial.e57", 1 ) );
+   E57_ASSERT_NO_THROW( writeFile( "./ChecksumsParallel.e57", 4 ) );
+
+   const std::vector<char> serialBytes = ReadFileBytes( "./ChecksumsSerial.e57" );
+
+   ASSERT_EQ( serialBytes.size(), 3'001 * e57::CheckedFile::physicalPageSize );
+   ASSERT_TRUE( serialBytes == ReadFileBytes( "./ChecksumsParallel.e57" ) );
+
+   // Reading verifies every checksum
+   const e57::ustring cParallelPath = "./ChecksumsParallel.e57";
+
+   e57::CheckedFile file( cParallelPath, e57::CheckedFile::Read, e57::ChecksumAll );
+
+   std::vector<char> readData( cByteCount );
+
+   E57_ASSERT_NO_THROW( file.read( readData.data(), readData.size() ) );
+
+   ASSERT_TRUE( readData == data );
+}
+
+#if defined( __linux__ )
+TEST( CheckedFile, CloseReleasesFileWhenFlushFails )
+{
+   const auto openFileCount = []() {
+      size_t count = 0;
+
+      if ( DIR *dir = ::opendir( "/proc/self/fd" ) )
+      {
+         while ( ::readdir( dir ) != nullptr )
+         {
+            ++count;
+         }
+
+         ::closedir( dir );
+      }
+
+      return count;
+   };
+
+   const size_t countBefore = openFileCount();
+
+   {
+      // Every write to /dev/full fails
+      const e57::ustring cFullPath = "/dev/full";
+
+      e57::CheckedFile file( cFullPath, e57::CheckedFile::Write, e57::ChecksumAll );
+
+      const std::vector<char> data( 10'000, 'A' );
+
+      file.write( data.data(), data.size() );
+
+      E57_ASSERT_THROW( file.close() );
+   }
+
+   EXPECT_EQ( openFileCount(), countBefore );
+}
+#endif
@@ -0,0 +1,215 @@
+// libE57Format testing Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+
+#include "gtest/gtest.h"
+
+#include "E57SimpleDataset.h"
+
+#include "Helpers.h"
+#include "TestData.h"
+
+namespace
+{
+   std::vector<e57::ustring> BunnyFiles()
+   {
+      return { TestData::Path() + "/reference/bunnyDouble.e57",
+               TestData::Path() + "/reference/bunnyInt32.e57" };
+   }
+
+   int64_t ReadAllPoints( const e57::Dataset &dataset )
+   {
+      std::vector<int64_t> scanIndices;
+
+      for ( int64_t i = 0; i < dataset.GetScanCount(); ++i )
+      {
+         scanIndices.push_back( i );
+      }
+
+      std::atomic<int64_t> totalRead( 0 );
+
+      auto countPoints = [&]( const e57::DatasetScan &, const e57::Data3DPointsDouble &,
+                              size_t count ) { totalRead += count; };
+
+      dataset.ReadPoints( scanIndices, countPoints );
+
+      return totalRead;
+   }
+}
+
+TEST( SimpleDataset, PathError )
+{
+   E57_ASSERT_THROW( e57::Dataset( { "./no-path/empty.e57" }, {} ) );
+}
+
+TEST( SimpleDatasetData, Catalog )
+{
+   e57::Dataset *dataset = nullptr;
+
+   E57_ASSERT_NO_THROW( dataset = new e57::Dataset( BunnyFiles(), {} ) );
+
+   EXPECT_EQ( dataset->GetFileCount(), 2 );
+   ASSERT_EQ( dataset->GetScanCount(), 2 );
+
+   e57::DatasetScan scan;
+
+   ASSERT_TRUE( dataset->GetScan( 0, scan ) );
+   EXPECT_EQ( scan.fileIndex, 0 );
+   EXPECT_EQ( scan.dataIndex, 0 );
+   EXPECT_EQ( scan.guid, "{9CA24C38-C93E-40E8-A366-F49977C7E3EB}" );
+   EXPECT_EQ( scan.pointCount, 30'571 );
+
+   ASSERT_TRUE( dataset->GetScan( 1, scan ) );
+   EXPECT_EQ( scan.fileIndex, 1 );
+   EXPECT_EQ( scan.pointCount, 30'571 );
+
+   EXPECT_FALSE( dataset->GetScan( 2, scan ) );
+
+   delete dataset;
+}
+
+TEST( SimpleDatasetData, CatalogCache )
+{
+   const e57::ustring cCatalogPath = "./DatasetCatalog.txt";
+
+   std::remove( cCatalogPath.c_str() );
+
+   e57::DatasetOptions options;
+   options.catalogCachePath = cCatalogPath;
+
+   e57::Dataset *dataset = nullptr;
+
+   // First one builds & saves the catalog, second one loads it
+   E57_ASSERT_NO_THROW( dataset = new e57::Dataset( BunnyFiles(), options ) );
+
+   e57::DatasetScan built;
+   ASSERT_TRUE( dataset->GetScan( 1, built ) );
+
+   delete dataset;
+
+   E57_ASSERT_NO_THROW( dataset = new e57::Dataset( BunnyFiles(), options ) );
+
+   ASSERT_EQ( dataset->GetScanCount(), 2 );
+
+   e57::DatasetScan loaded;
+   ASSERT_TRUE( dataset->GetScan( 1, loaded ) );
+
+   EXPECT_EQ( loaded.filePath, built.filePath );
+   EXPECT_EQ( loaded.guid, built.guid );
+   EXPECT_EQ( loaded.pointCount, built.pointCount );
+   EXPECT_EQ( loaded.pose, built.pose );
+   EXPECT_EQ( loaded.cartesianBounds, built.cartesianBounds );
+
+   EXPECT_EQ( ReadAllPoints( *dataset ), 2 * 30'571 );
+
+   delete dataset;
+
+   std::remove( cCatalogPath.c_str() );
+}
+
+TEST( SimpleDatasetData, ReadPointsOneOpenFile )
+{
+   e57::DatasetOptions options;
+   options.maxOpenFiles = 1;
+   options.memoryBudget = 256 * 1024;
+
+   e57::Dataset *dataset = nullptr;
+
+   E57_ASSERT_NO_THROW( dataset = new e57::Dataset( BunnyFiles(), options ) );
+
+   EXPECT_EQ( ReadAllPoints( *dataset ), 2 * 30'571 );
+
+   delete dataset;
+}
+
+TEST( SimpleDatasetData, ReadPointsThreaded )
+{
+   e57::DatasetOptions options;
+   options.maxOpenFiles = 2;
+   options.threadCount = 2;
+
+   e57::Dataset *dataset = nullptr;
+
+   E57_ASSERT_NO_THROW( dataset = new e57::Dataset( BunnyFiles(), options ) );
+
+   EXPECT_EQ( ReadAllPoints( *dataset ), 2 * 30'571 );
+
+   // The threads are reused
+   EXPECT_EQ( ReadAllPoints( *dataset ), 2 * 30'571 );
+
+   auto ignorePoints = []( const e57::DatasetScan &, const e57::Data3DPointsDouble &, size_t ) {};
+
+   E57_ASSERT_THROW( dataset->ReadPoints( { 2 }, ignorePoints ) );
+
+   delete dataset;
+}
+
+TEST( SimpleDatasetData, CatalogCacheBadDataIndex )
+{
+   const e57::ustring cCatalogPath = "./DatasetCatalogBadDataIndex.txt";
+
+   std::remove( cCatalogPath.c_str() );
+
+   e57::DatasetOptions options;
+   options.catalogCachePath = cCatalogPath;
+
+   e57::Dataset *dataset = nullptr;
+
+   E57_ASSERT_NO_THROW( dataset = new e57::Dataset( BunnyFiles(), options ) );
+
+   delete dataset;
+
+   // Change the dataIndex of the last scan, leaving the files as they are
+   std::vector<e57::ustring> lines;
+
+   {
+      std::ifstream in( cCatalogPath );
+
+      for ( e57::ustring line; std::getline( in, line ); )
+      {
+         lines.push_back( line );
+      }
+   }
+
+   ASSERT_FALSE( lines.empty() );
+
+   e57::ustring &lastScan = lines.back();
+   const size_t dataIndexStart = lastScan.find( ' ' ) + 1;
+
+   lastScan.replace( dataIndexStart, lastScan.find( ' ', dataIndexStart ) - dataIndexStart, "5" );
+
+   {
+      std::ofstream out( cCatalogPath, std::ios::trunc );
+
+      for ( const auto &line : lines )
+      {
+         out << line << "\n";
+      }
+   }
+
+   E57_ASSERT_NO_THROW( dataset = new e57::Dataset( BunnyFiles(), options ) );
+
+   e57::DatasetScan scan;
+   ASSERT_TRUE( dataset->GetScan( 1, scan ) );
+   ASSERT_EQ( scan.dataIndex, 5 );
+
+   auto ignorePoints = []( const e57::DatasetScan &, const e57::Data3DPointsDouble &, size_t ) {};
+
+   try
+   {
+      dataset->ReadPoints( { 1 }, ignorePoints );
+
+      FAIL() << "ReadPoints() didn't throw";
+   }
+   catch ( const e57::E57Exception &err )
+   {
+      EXPECT_EQ( err.errorCode(), e57::ErrorBadAPIArgument );
+   }
+
+   delete dataset;
+
+   std::remove( cCatalogPath.c_str() );
+}
@@ -1,9 +1,23 @@
 // libE57Format testing Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
 // SPDX-License-Identifier: MIT
 
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+#if defined( _WIN32 )
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "gtest/gtest.h"
 
+#include "ColumnCache.h"
 #include "E57SimpleReader.h"
+#include "E57SimpleWriter.h"
 
 #include "Helpers.h"
 #include "TestData.h"
@@ -19,6 +33,87 @@ namespace
       EXPECT_EQ( fileHeader.versionMajor, 1 );
       EXPECT_EQ( fileHeader.versionMinor, 0 );
    }
+
+   // Stand-in for a remote file: reads a local file and adds latency to each read
+   struct SlowRangeFile
+   {
+      explicit SlowRangeFile( const e57::ustring &path ) :
+         file( path, std::ios::binary | std::ios::ate )
+      {
+         size = static_cast<uint64_t>( file.tellg() );
+      }
+
+      e57::RangeSource source()
+      {
+         e57::RangeSource rangeSource;
+
+         rangeSource.read = [this]( uint64_t offset, size_t byteCount, char *dest ) {
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+
+            ++readCount;
+
+            file.seekg( static_cast<std::streamoff>( offset ) );
+
+            return static_cast<bool>(
+               file.read( dest, static_cast<std::streamsize>( byteCount ) ) );
+         };
+
+         rangeSource.size = size;
+         rangeSource.blockSize = 16 * 1024;
+         rangeSource.cacheBlockCount = 16;
+
+         return rangeSource;
+      }
+
+      std::ifstream file;
+      uint64_t size = 0;
+      int readCount = 0;
+   };
+
+   // Creates a new directory in the current one, named after the prefix and the time
+   e57::ustring MakeFreshDirectory( const e57::ustring &prefix )
+   {
+      const auto ticks = std::chrono::steady_clock::now().time_since_epoch().count();
+
+      for ( int attempt = 0; attempt < 100; ++attempt )
+      {
+         const e57::ustring path =
+            "./" + prefix + "_" + std::to_string( ticks ) + "_" + std::to_string( attempt );
+
+#if defined( _WIN32 )
+         if ( _mkdir( path.c_str() ) == 0 )
+#else
+         if ( mkdir( path.c_str(), 0755 ) == 0 )
+#endif
+         {
+            return path;
+         }
+      }
+
+      return {};
+   }
+
+   bool FileExists( const e57::ustring &path )
+   {
+      return std::ifstream( path, std::ios::binary ).good();
+   }
+
+   // Removes the files, then the directory, which must then be empty
+   bool RemoveCacheDirectory( const e57::ustring &path, const std::vector<e57::ustring> &files )
+   {
+      bool removed = true;
+
+      for ( const auto &file : files )
+      {
+         removed = ( std::remove( file.c_str() ) == 0 ) && removed;
+      }
+
+#if defined( _WIN32 )
+      return ( _rmdir( path.c_str() ) == 0 ) && removed;
+#else
+      return ( rmdir( path.c_str() ) == 0 ) && removed;
+#endif
+   }
 }
 
 TEST( SimpleReader, PathError )
@@ -368,3 +463,1033 @@ TEST( SimpleReaderData, ColourRepresentation )
 
    delete reader;
 }
+
+TEST( SimpleReaderData, MemoryBudget )
+{
+   e57::ReaderOptions options;
+   options.memoryBudget = 256 * 1024;
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW(
+      reader = new e57::Reader( TestData::Path() + "/reference/bunnyDouble.e57", options ) );
+
+   ASSERT_TRUE( reader->IsOpen() );
+   ASSERT_EQ( reader->GetData3DCount(), 1 );
+
+   e57::Data3D data3DHeader;
+   ASSERT_TRUE( reader->ReadData3D( 0, data3DHeader ) );
+
+   ASSERT_EQ( data3DHeader.pointCount, 30'571 );
+
+   const auto cEstimate = reader->EstimateMemory( 0 );
+
+   EXPECT_GT( cEstimate.bytesPerPoint, 0 );
+   EXPECT_GT( cEstimate.chunkPointCount, 0 );
+   EXPECT_LT( cEstimate.chunkPointCount, data3DHeader.pointCount );
+   EXPECT_LE( cEstimate.totalBytes, options.memoryBudget );
+
+   // Fewer fields allow bigger chunks
+   const auto cEstimateX = reader->EstimateMemory( 0, { "cartesianX" } );
+
+   EXPECT_LT( cEstimateX.bytesPerPoint, cEstimate.bytesPerPoint );
+   EXPECT_GT( cEstimateX.chunkPointCount, cEstimate.chunkPointCount );
+
+   E57_ASSERT_THROW( reader->EstimateMemory( 0, { "notAField" } ) );
+
+   // Read the whole scan reusing chunk-sized buffers
+   e57::Data3DPointsDouble pointsData( data3DHeader, cEstimate.chunkPointCount );
+
+   auto vectorReader = reader->SetUpData3DPointsData( 0, cEstimate.chunkPointCount, pointsData );
+
+   uint64_t totalRead = 0;
+   unsigned numRead = 0;
+
+   do
+   {
+      E57_ASSERT_NO_THROW( numRead = vectorReader.read() );
+      EXPECT_LE( numRead, cEstimate.chunkPointCount );
+
+      totalRead += numRead;
+   } while ( numRead > 0 );
+
+   vectorReader.close();
+
+   EXPECT_EQ( totalRead, data3DHeader.pointCount );
+
+   delete reader;
+}
+
+TEST( SimpleReaderData, MemoryResource )
+{
+   // Declared first so it outlives everything using it
+   e57::MonotonicMemoryResource memory( 64 * 1024 );
+
+   e57::ReaderOptions options;
+   options.memoryResource = &memory;
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW(
+      reader = new e57::Reader( TestData::Path() + "/reference/bunnyDouble.e57", options ) );
+
+   // The nodes read from the XML section are allocated from the resource
+   EXPECT_GT( memory.heapBytes(), 0 );
+
+   e57::Data3D data3DHeader;
+   ASSERT_TRUE( reader->ReadData3D( 0, data3DHeader ) );
+
+   const int64_t cNumPoints = data3DHeader.pointCount;
+
+   e57::Data3DPointsDouble pointsData( data3DHeader, cNumPoints, &memory );
+
+   const size_t cBuffersBytes = memory.heapBytes();
+
+   EXPECT_GE( cBuffersBytes, 3 * cNumPoints * sizeof( double ) );
+
+   auto vectorReader = reader->SetUpData3DPointsData( 0, cNumPoints, pointsData );
+
+   // The packet cache and the decoders are allocated from the resource too
+   EXPECT_GT( memory.heapBytes(), cBuffersBytes );
+
+   uint64_t numRead = 0;
+   E57_ASSERT_NO_THROW( numRead = vectorReader.read() );
+
+   vectorReader.close();
+
+   EXPECT_EQ( numRead, cNumPoints );
+
+   delete reader;
+
+   // Compare with reading into heap buffers
+   E57_ASSERT_NO_THROW(
+      reader = new e57::Reader( TestData::Path() + "/reference/bunnyDouble.e57", {} ) );
+
+   e57::Data3DPointsDouble heapPointsData( data3DHeader );
+
+   vectorReader = reader->SetUpData3DPointsData( 0, cNumPoints, heapPointsData );
+
+   EXPECT_EQ( vectorReader.read(), cNumPoints );
+
+   vectorReader.close();
+
+   for ( int64_t i = 0; i < cNumPoints; ++i )
+   {
+      ASSERT_EQ( pointsData.cartesianX[i], heapPointsData.cartesianX[i] );
+      ASSERT_EQ( pointsData.cartesianY[i], heapPointsData.cartesianY[i] );
+      ASSERT_EQ( pointsData.cartesianZ[i], heapPointsData.cartesianZ[i] );
+   }
+
+   delete reader;
+}
+
+TEST( SimpleReaderData, RangeSource )
+{
+   const e57::ustring cFilePath = TestData::Path() + "/reference/bunnyDouble.e57";
+
+   SlowRangeFile rangeFile( cFilePath );
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( rangeFile.source(), {} ) );
+
+   ASSERT_TRUE( reader->IsOpen() );
+   ASSERT_EQ( reader->GetData3DCount(), 1 );
+
+   e57::Data3D data3DHeader;
+   ASSERT_TRUE( reader->ReadData3D( 0, data3DHeader ) );
+
+   EXPECT_EQ( data3DHeader.guid, "{9CA24C38-C93E-40E8-A366-F49977C7E3EB}" );
+
+   const int64_t cNumPoints = data3DHeader.pointCount;
+
+   e57::Data3DPointsDouble pointsData( data3DHeader );
+
+   auto vectorReader = reader->SetUpData3DPointsData( 0, cNumPoints, pointsData );
+
+   EXPECT_EQ( vectorReader.read(), cNumPoints );
+
+   vectorReader.close();
+
+   delete reader;
+
+   // Whole blocks are read, so there are far fewer reads than pages
+   EXPECT_LT( rangeFile.readCount, static_cast<int>( rangeFile.size / 16384 ) + 2 );
+
+   // Compare with reading the file
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, {} ) );
+
+   e57::Data3DPointsDouble filePointsData( data3DHeader );
+
+   vectorReader = reader->SetUpData3DPointsData( 0, cNumPoints, filePointsData );
+
+   EXPECT_EQ( vectorReader.read(), cNumPoints );
+
+   vectorReader.close();
+
+   for ( int64_t i = 0; i < cNumPoints; ++i )
+   {
+      ASSERT_EQ( pointsData.cartesianX[i], filePointsData.cartesianX[i] );
+      ASSERT_EQ( pointsData.cartesianY[i], filePointsData.cartesianY[i] );
+      ASSERT_EQ( pointsData.cartesianZ[i], filePointsData.cartesianZ[i] );
+   }
+
+   delete reader;
+}
+
+TEST( SimpleReaderData, RangeSourceReadFailed )
+{
+   SlowRangeFile rangeFile( TestData::Path() + "/reference/bunnyDouble.e57" );
+
+   e57::RangeSource source = rangeFile.source();
+   source.read = []( uint64_t, size_t, char * ) { return false; };
+
+   E57_ASSERT_THROW( e57::Reader( source, {} ) );
+}
+
+TEST( SimpleReaderData, MapData3DPointsColumnCache )
+{
+   const e57::ustring cFilePath = TestData::Path() + "/reference/bunnyDouble.e57";
+
+   const e57::ustring cCacheDirectory = MakeFreshDirectory( "MapData3DPointsColumnCache" );
+   ASSERT_FALSE( cCacheDirectory.empty() );
+
+   e57::ReaderOptions options;
+   options.columnCachePath = cCacheDirectory;
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, options ) );
+
+   e57::Data3D data3DHeader;
+   ASSERT_TRUE( reader->ReadData3D( 0, data3DHeader ) );
+
+   const int64_t cNumPoints = data3DHeader.pointCount;
+
+   e57::Data3DPointsDouble pointsData( data3DHeader );
+
+   auto vectorReader = reader->SetUpData3DPointsData( 0, cNumPoints, pointsData );
+
+   EXPECT_EQ( vectorReader.read(), cNumPoints );
+
+   vectorReader.close();
+
+   const std::vector<e57::ustring> cFields{ "cartesianX", "cartesianY", "cartesianZ" };
+
+   e57::E57Root fileHeader;
+   ASSERT_TRUE( reader->GetE57Root( fileHeader ) );
+
+   std::vector<e57::ustring> columnPaths;
+
+   for ( const auto &field : cFields )
+   {
+      const e57::ustring key =
+         e57::ColumnCache::columnKey( fileHeader.guid, data3DHeader.guid, field );
+
+      columnPaths.push_back( e57::ColumnCache::columnPath( cCacheDirectory, key, field ) );
+   }
+
+   // The first call fills the cache, the second one (from another reader) only maps it, and the
+   // last one decodes into memory
+   std::vector<e57::MappedData3DPoints> mapped;
+
+   E57_ASSERT_NO_THROW( mapped.push_back( reader->MapData3DPoints( 0, cFields ) ) );
+
+   delete reader;
+
+   for ( const auto &path : columnPaths )
+   {
+      EXPECT_TRUE( FileExists( path ) ) << path;
+   }
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, options ) );
+   E57_ASSERT_NO_THROW( mapped.push_back( reader->MapData3DPoints( 0, cFields ) ) );
+
+   delete reader;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, {} ) );
+   E57_ASSERT_NO_THROW( mapped.push_back( reader->MapData3DPoints( 0, cFields ) ) );
+
+   E57_ASSERT_THROW( reader->MapData3DPoints( 0, { "timeStamp" } ) );
+
+   delete reader;
+
+   for ( const auto &mappedPoints : mapped )
+   {
+      ASSERT_EQ( mappedPoints.GetPointCount(), cNumPoints );
+
+      const e57::Data3DPointsDouble &points = mappedPoints.GetPoints();
+
+      ASSERT_NE( points.cartesianX, nullptr );
+      EXPECT_EQ( points.intensity, nullptr );
+
+      for ( int64_t i = 0; i < cNumPoints; ++i )
+      {
+         ASSERT_EQ( points.cartesianX[i], pointsData.cartesianX[i] );
+         ASSERT_EQ( points.cartesianY[i], pointsData.cartesianY[i] );
+         ASSERT_EQ( points.cartesianZ[i], pointsData.cartesianZ[i] );
+      }
+   }
+
+   // Unmap the columns before removing their files
+   mapped.clear();
+
+   EXPECT_TRUE( RemoveCacheDirectory( cCacheDirectory, columnPaths ) );
+}
+
+TEST( SimpleReaderData, VisitNodes )
+{
+   e57::ImageFile imf( TestData::Path() + "/reference/bunnyDouble.e57", "r" );
+
+   const e57::StructureNode root = imf.root();
+
+   struct Visitor : e57::NodeVisitor
+   {
+      int64_t nodeCount = 0;
+      unsigned maxDepth = 0;
+      e57::ustring formatName;
+      int64_t recordCount = 0;
+      int64_t enterCount = 0;
+      int64_t leaveCount = 0;
+
+      // Handles held by the test: visiting must not add any reference to the nodes
+      std::shared_ptr<e57::StructureNodeImpl> rootImpl;
+      std::shared_ptr<e57::VectorNodeImpl> data3DImpl;
+      long rootUseCount = 0;
+      long data3DUseCount = 0;
+
+      bool enter( const e57::NodeView &node ) override
+      {
+         EXPECT_EQ( rootImpl.use_count(), rootUseCount );
+         EXPECT_EQ( data3DImpl.use_count(), data3DUseCount );
+
+         ++nodeCount;
+         ++enterCount;
+         maxDepth = std::max( maxDepth, node.depth() );
+
+         if ( ( node.depth() == 1 ) && ( node.elementName() == "formatName" ) )
+         {
+            formatName = node.stringValue();
+         }
+
+         if ( node.type() == e57::TypeCompressedVector )
+         {
+            recordCount += node.recordCount();
+
+            EXPECT_EQ( node.childCount(), 2 );
+         }
+
+         return true;
+      }
+
+      void leave( const e57::NodeView & /*node*/ ) override
+      {
+         ++leaveCount;
+      }
+   };
+
+   Visitor visitor;
+   visitor.rootImpl = root.impl();
+   visitor.data3DImpl = e57::VectorNode( root.get( "data3D" ) ).impl();
+   visitor.rootUseCount = visitor.rootImpl.use_count();
+   visitor.data3DUseCount = visitor.data3DImpl.use_count();
+
+   E57_ASSERT_NO_THROW( root.visit( visitor ) );
+
+   EXPECT_EQ( visitor.formatName, "ASTM E57 3D Imaging Data File" );
+   EXPECT_EQ( visitor.recordCount, 30'571 );
+   EXPECT_EQ( visitor.enterCount, visitor.leaveCount );
+   EXPECT_GT( visitor.maxDepth, 2 );
+
+   // Compare with a walk using the handles
+   std::function<int64_t( const e57::Node & )> countNodes = [&]( const e57::Node &node ) {
+      int64_t count = 1;
+
+      switch ( node.type() )
+      {
+         case e57::TypeStructure:
+         {
+            const e57::StructureNode structure( node );
+
+            for ( int64_t i = 0; i < structure.childCount(); ++i )
+            {
+               count += countNodes( structure.get( i ) );
+            }
+            break;
+         }
+
+         case e57::TypeVector:
+         {
+            const e57::VectorNode vector( node );
+
+            for ( int64_t i = 0; i < vector.childCount(); ++i )
+            {
+               count += countNodes( vector.get( i ) );
+            }
+            break;
+         }
+
+         case e57::TypeCompressedVector:
+         {
+            const e57::CompressedVectorNode compressedVector( node );
+
+            count += countNodes( compressedVector.prototype() );
+            count += countNodes( compressedVector.codecs() );
+            break;
+         }
+
+         default:
+            break;
+      }
+
+      return count;
+   };
+
+   EXPECT_EQ( visitor.nodeCount, countNodes( imf.root() ) );
+
+   // Accessors of another type of node throw
+   struct BadVisitor : e57::NodeVisitor
+   {
+      bool enter( const e57::NodeView &node ) override
+      {
+         if ( node.elementName() == "formatName" )
+         {
+            node.floatValue();
+         }
+
+         return true;
+      }
+   };
+
+   BadVisitor badVisitor;
+
+   E57_ASSERT_THROW( imf.root().visit( badVisitor ) );
+
+   imf.close();
+}
+
+TEST( SimpleReader, ReadSubsetOfFields )
+{
+   const e57::ustring cFilePath = "./ReadSubsetOfFields.e57";
+
+   e57::Writer *writer = nullptr;
+
+   E57_ASSERT_NO_THROW( writer = new e57::Writer( cFilePath, e57::WriterOptions() ) );
+
+   // Enough points for several data packets
+   constexpr int64_t cNumPoints = 100'000;
+
+   e57::Data3D header;
+   header.pointCount = cNumPoints;
+
+   setUsingColouredCartesianPoints( header );
+
+   e57::Data3DPointsFloat pointsData( header );
+
+   for ( int64_t i = 0; i < cNumPoints; ++i )
+   {
+      auto floati = static_cast<float>( i );
+      pointsData.cartesianX[i] = floati;
+      pointsData.cartesianY[i] = 2.0f * floati;
+      pointsData.cartesianZ[i] = 3.0f * floati;
+
+      pointsData.colorRed[i] = static_cast<uint16_t>( i % 256 );
+      pointsData.colorGreen[i] = 0;
+      pointsData.colorBlue[i] = 255;
+   }
+
+   E57_ASSERT_NO_THROW( writer->WriteData3DData( header, pointsData ) );
+
+   delete writer;
+
+   // Read back only some of the fields - the other bytestreams aren't read from the packets
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, {} ) );
+
+   e57::Data3D readHeader;
+   ASSERT_TRUE( reader->ReadData3D( 0, readHeader ) );
+
+   readHeader.pointFields.cartesianXField = false;
+   readHeader.pointFields.colorGreenField = false;
+   readHeader.pointFields.colorBlueField = false;
+
+   e57::Data3DPointsFloat readData( readHeader );
+
+   auto vectorReader = reader->SetUpData3DPointsData( 0, cNumPoints, readData );
+
+   const uint64_t cNumRead = vectorReader.read();
+
+   vectorReader.close();
+
+   ASSERT_EQ( cNumRead, static_cast<uint64_t>( cNumPoints ) );
+
+   for ( int64_t i = 0; i < cNumPoints; i += 997 )
+   {
+      EXPECT_EQ( readData.cartesianY[i], 2.0f * static_cast<float>( i ) );
+      EXPECT_EQ( readData.cartesianZ[i], 3.0f * static_cast<float>( i ) );
+      EXPECT_EQ( readData.colorRed[i], i % 256 );
+   }
+
+   delete reader;
+}
+
+TEST( SimpleReader, RebindReader )
+{
+   const e57::ustring cFilePath = "./RebindReader.e57";
+
+   constexpr int64_t cNumScans = 4;
+
+   // Scan s has 1000 + 10 * s points, and point i of it is at ( s, i, 0 )
+   const auto pointCount = []( int64_t scan ) { return 1'000 + 10 * scan; };
+
+   e57::Writer *writer = nullptr;
+
+   E57_ASSERT_NO_THROW( writer = new e57::Writer( cFilePath, e57::WriterOptions() ) );
+
+   for ( int64_t scan = 0; scan <= cNumScans; ++scan )
+   {
+      e57::Data3D header;
+      header.pointCount = pointCount( scan );
+
+      setUsingColouredCartesianPoints( header );
+
+      // The last scan has a different prototype
+      if ( scan == cNumScans )
+      {
+         header.colorLimits.colorRedMaximum = 1023;
+      }
+
+      e57::Data3DPointsDouble pointsData( header );
+
+      for ( int64_t i = 0; i < header.pointCount; ++i )
+      {
+         pointsData.cartesianX[i] = static_cast<double>( scan );
+         pointsData.cartesianY[i] = static_cast<double>( i );
+         pointsData.cartesianZ[i] = 0.0;
+
+         pointsData.colorRed[i] = static_cast<uint16_t>( i % 256 );
+         pointsData.colorGreen[i] = 0;
+         pointsData.colorBlue[i] = 0;
+      }
+
+      E57_ASSERT_NO_THROW( writer->WriteData3DData( header, pointsData ) );
+   }
+
+   delete writer;
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, {} ) );
+
+   e57::Data3D header;
+   ASSERT_TRUE( reader->ReadData3D( 0, header ) );
+
+   constexpr int64_t cChunkSize = 300;
+
+   e57::Data3DPointsDouble readData( header, cChunkSize );
+
+   auto vectorReader = reader->SetUpData3DPointsData( 0, cChunkSize, readData );
+
+   for ( int64_t scan = 0; scan < cNumScans; ++scan )
+   {
+      const e57::StructureNode scanNode( reader->GetRawData3D().get( scan ) );
+      const e57::CompressedVectorNode points( scanNode.get( "points" ) );
+
+      // Also stops reading scan 0 part way through
+      E57_ASSERT_NO_THROW( vectorReader.rebind( points ) );
+
+      int64_t index = 0;
+
+      while ( const unsigned cNumRead = vectorReader.read() )
+      {
+         for ( unsigned i = 0; i < cNumRead; ++i, ++index )
+         {
+            ASSERT_EQ( readData.cartesianX[i], static_cast<double>( scan ) );
+            ASSERT_EQ( readData.cartesianY[i], static_cast<double>( index ) );
+            ASSERT_EQ( readData.colorRed[i], index % 256 );
+         }
+
+         if ( scan == 0 )
+         {
+            break;
+         }
+      }
+
+      if ( scan > 0 )
+      {
+         EXPECT_EQ( index, pointCount( scan ) );
+      }
+   }
+
+   const e57::StructureNode lastScanNode( reader->GetRawData3D().get( cNumScans ) );
+   const e57::CompressedVectorNode lastPoints( lastScanNode.get( "points" ) );
+
+   // A different prototype leaves the reader as it was
+   E57_ASSERT_THROW( vectorReader.rebind( lastPoints ) );
+   EXPECT_TRUE( vectorReader.isOpen() );
+
+   vectorReader.close();
+
+   delete reader;
+}
+
+TEST( SimpleReader, TimeIndex )
+{
+   const e57::ustring cFilePath = "./TimeIndex.e57";
+
+   constexpr int64_t cNumPoints = 100'000;
+   constexpr double cStartTime = 20.0;
+   constexpr double cEndTime = 30.0;
+
+   // With an index written with the file, then with one built when reading
+   for ( const size_t timeIndexChunkSize : { 4096, 0 } )
+   {
+      e57::WriterOptions options;
+      options.timeIndexChunkSize = timeIndexChunkSize;
+
+      e57::Data3D fields;
+      fields.pointFields.timeStampField = true;
+      fields.pointFields.timeNodeType = e57::NumericalNodeType::Double;
+
+      e57::Data3D header;
+      E57_ASSERT_NO_THROW( header = writeLinearPoints( cFilePath, options, cNumPoints, fields ) );
+
+      e57::Reader *reader = nullptr;
+
+      E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, {} ) );
+
+      constexpr size_t cBufferSize = 1000;
+
+      e57::Data3DPointsDouble readData( header, cBufferSize );
+
+      int64_t inWindowCount = 0;
+
+      const auto checkPoints = [&]( int64_t startPointIndex, size_t count ) {
+         for ( size_t i = 0; i < count; ++i )
+         {
+            const auto pointIndex = static_cast<double>( startPointIndex + i );
+
+            ASSERT_EQ( readData.cartesianX[i], pointIndex );
+            ASSERT_EQ( readData.cartesianZ[i], 0.5 * pointIndex );
+
+            if ( ( readData.timeStamp[i] >= cStartTime ) && ( readData.timeStamp[i] <= cEndTime ) )
+            {
+               ++inWindowCount;
+            }
+         }
+      };
+
+      int64_t readCount = 0;
+
+      E57_ASSERT_NO_THROW( readCount = reader->ReadTimeWindow( 0, cStartTime, cEndTime,
+                                                               cBufferSize, readData,
+                                                               checkPoints ) );
+
+      // All the points in the window, and not many more
+      EXPECT_EQ( inWindowCount, 10'001 );
+      EXPECT_LT( readCount, 20'000 );
+
+      EXPECT_EQ( reader->ReadTimeWindow( 0, 200.0, 300.0, cBufferSize, readData, checkPoints ),
+                 0 );
+
+      delete reader;
+   }
+}
+
+TEST( SimpleReader, TimeIndexWithoutSeek )
+{
+   const e57::ustring cFilePath = "./TimeIndexWithoutSeek.e57";
+
+   constexpr int64_t cNumPoints = 100'000;
+   constexpr double cStartTime = 20.0;
+   constexpr double cEndTime = 30.0;
+
+   // The FloatXor codec can't seek, so the points are decoded from the start
+   e57::WriterOptions options;
+   options.timeIndexChunkSize = 4096;
+   options.fieldCodecs["cartesianX"] = e57::CodecFloatXor;
+   options.fieldCodecs["timeStamp"] = e57::CodecFloatXor;
+
+   e57::Data3D fields;
+   fields.pointFields.timeStampField = true;
+   fields.pointFields.timeNodeType = e57::NumericalNodeType::Double;
+
+   e57::Data3D header;
+   E57_ASSERT_NO_THROW( header = writeLinearPoints( cFilePath, options, cNumPoints, fields ) );
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, {} ) );
+
+   constexpr size_t cBufferSize = 1000;
+
+   e57::Data3DPointsDouble readData( header, cBufferSize );
+
+   int64_t inWindowCount = 0;
+   int64_t callbackCount = 0;
+
+   const auto checkPoints = [&]( int64_t startPointIndex, size_t count ) {
+      callbackCount += static_cast<int64_t>( count );
+
+      for ( size_t i = 0; i < count; ++i )
+      {
+         const auto pointIndex = static_cast<double>( startPointIndex + i );
+
+         ASSERT_EQ( readData.cartesianX[i], pointIndex );
+         ASSERT_EQ( readData.cartesianZ[i], 0.5 * pointIndex );
+         ASSERT_EQ( readData.timeStamp[i], 0.001 * pointIndex );
+
+         if ( ( readData.timeStamp[i] >= cStartTime ) && ( readData.timeStamp[i] <= cEndTime ) )
+         {
+            ++inWindowCount;
+         }
+      }
+   };
+
+   int64_t readCount = 0;
+
+   E57_ASSERT_NO_THROW( readCount = reader->ReadTimeWindow( 0, cStartTime, cEndTime, cBufferSize,
+                                                            readData, checkPoints ) );
+
+   // The window is in the index chunks of points [16384, 32768), so the buffers of points
+   // [16000, 32768) are passed on, the last one clipped at the end of the chunks
+   EXPECT_EQ( inWindowCount, 10'001 );
+   EXPECT_EQ( readCount, 16'768 );
+   EXPECT_EQ( callbackCount, readCount );
+
+   delete reader;
+}
+
+TEST( SimpleReader, SeekRecord )
+{
+   const e57::ustring cFilePath = "./SeekRecord.e57";
+
+   constexpr int64_t cNumPoints = 100'000;
+
+   // cartesianX uses the bitPackCodec, which can seek, and cartesianY one which can't
+   for ( const bool canSeek : { true, false } )
+   {
+      e57::WriterOptions options;
+
+      if ( !canSeek )
+      {
+         options.fieldCodecs["cartesianY"] = e57::CodecFloatXor;
+      }
+
+      e57::Data3D header;
+      E57_ASSERT_NO_THROW( header = writeLinearPoints( cFilePath, options, cNumPoints ) );
+
+      e57::Reader *reader = nullptr;
+
+      E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, {} ) );
+
+      constexpr size_t cBufferSize = 100;
+
+      e57::Data3DPointsDouble readData( header, cBufferSize );
+
+      auto vectorReader = reader->SetUpData3DPointsData( 0, cBufferSize, readData );
+
+      if ( !canSeek )
+      {
+         try
+         {
+            vectorReader.seek( 12'345 );
+
+            FAIL() << "seek() didn't throw";
+         }
+         catch ( const e57::E57Exception &err )
+         {
+            EXPECT_EQ( err.errorCode(), e57::ErrorNotImplemented );
+         }
+
+         vectorReader.close();
+
+         delete reader;
+
+         continue;
+      }
+
+      // Records in the middle of data packets, going backwards and forwards
+      for ( const int64_t recordNumber : { 12'345, 98'765, 54'321, 0 } )
+      {
+         E57_ASSERT_NO_THROW( vectorReader.seek( recordNumber ) );
+
+         ASSERT_EQ( vectorReader.read(), cBufferSize );
+
+         for ( size_t i = 0; i < cBufferSize; ++i )
+         {
+            const auto pointIndex = static_cast<double>( recordNumber + i );
+
+            ASSERT_EQ( readData.cartesianX[i], pointIndex );
+            ASSERT_EQ( readData.cartesianY[i], -pointIndex );
+            ASSERT_EQ( readData.cartesianZ[i], 0.5 * pointIndex );
+         }
+      }
+
+      // Seeking to the end leaves nothing to read
+      E57_ASSERT_NO_THROW( vectorReader.seek( cNumPoints ) );
+      EXPECT_EQ( vectorReader.read(), 0u );
+
+      // Past the end is an error
+      E57_ASSERT_THROW( vectorReader.seek( cNumPoints + 1 ) );
+
+      vectorReader.close();
+
+      delete reader;
+   }
+}
+
+TEST( SimpleReader, ReadFilter )
+{
+   const e57::ustring cFilePath = "./ReadFilter.e57";
+
+   constexpr int64_t cNumPoints = 10'000;
+
+   e57::WriterOptions options;
+   options.guid = "Read Filter File GUID";
+
+   e57::Data3D fields;
+   fields.pointFields.cartesianInvalidStateField = true;
+   fields.pointFields.intensityField = true;
+   fields.intensityLimits.intensityMinimum = 0.0;
+   fields.intensityLimits.intensityMaximum = 1.0;
+
+   e57::Data3D header;
+   E57_ASSERT_NO_THROW( header = writeLinearPoints( cFilePath, options, cNumPoints, fields ) );
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, {} ) );
+
+   constexpr size_t cBufferSize = 1000;
+
+   e57::Data3DPointsDouble readData( header, cBufferSize );
+
+   // Valid points with intensity of at least 0.5
+   const e57::RecordFilter filter{ { "cartesianInvalidState", e57::FilterEqual, 0 },
+                                   { "intensity", e57::FilterGreaterOrEqual, 0.5 } };
+
+   e57::CompressedVectorReader vectorReader =
+      reader->SetUpData3DPointsData( 0, cBufferSize, readData, filter );
+
+   int64_t expectedIndex = 0;
+   int64_t readCount = 0;
+
+   while ( const unsigned count = vectorReader.read() )
+   {
+      // Only the last read doesn't fill the buffers
+      if ( count < cBufferSize )
+      {
+         ASSERT_EQ( readCount + count, 3'333 );
+      }
+
+      for ( unsigned i = 0; i < count; ++i )
+      {
+         while ( ( ( expectedIndex % 3 ) == 0 ) || ( ( expectedIndex % 100 ) < 50 ) )
+         {
+            ++expectedIndex;
+         }
+
+         ASSERT_EQ( readData.cartesianX[i], static_cast<double>( expectedIndex ) );
+         ASSERT_EQ( readData.cartesianInvalidState[i], 0 );
+         ASSERT_GE( readData.intensity[i], 0.5 );
+
+         ++expectedIndex;
+      }
+
+      readCount += count;
+   }
+
+   vectorReader.close();
+
+   // Half the points have intensity >= 0.5, and a third of those are invalid
+   EXPECT_EQ( readCount, 3'333 );
+
+   // A field which isn't read
+   vectorReader = reader->SetUpData3DPointsData( 0, cBufferSize, readData );
+
+   E57_ASSERT_THROW( vectorReader.setFilter( { { "timeStamp", e57::FilterLess, 1.0 } } ) );
+
+   vectorReader.close();
+
+   delete reader;
+}
+
+TEST( SimpleReader, ReadDownsampled )
+{
+   const e57::ustring cFilePath = "./ReadDownsampled.e57";
+
+   // A 100 x 100 grid of points 0.25 apart, so 25 x 25 voxels of 1.0 with 16 points each
+   constexpr int64_t cNumPoints = 10'000;
+
+   e57::WriterOptions options;
+   options.guid = "Read Downsampled File GUID";
+
+   e57::Writer *writer = nullptr;
+
+   E57_ASSERT_NO_THROW( writer = new e57::Writer( cFilePath, options ) );
+
+   e57::Data3D header;
+   header.pointCount = cNumPoints;
+   header.pointFields.cartesianXField = true;
+   header.pointFields.cartesianYField = true;
+   header.pointFields.cartesianZField = true;
+   header.pointFields.rowIndexField = true;
+   header.pointFields.rowIndexMaximum = cNumPoints;
+
+   e57::Data3DPointsDouble pointsData( header );
+
+   for ( int64_t i = 0; i < cNumPoints; ++i )
+   {
+      pointsData.cartesianX[i] = 0.25 * static_cast<double>( i % 100 );
+      pointsData.cartesianY[i] = 0.25 * static_cast<double>( i / 100 );
+      pointsData.cartesianZ[i] = 0.0;
+      pointsData.rowIndex[i] = static_cast<int32_t>( i );
+   }
+
+   E57_ASSERT_NO_THROW( writer->WriteData3DData( header, pointsData ) );
+
+   delete writer;
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, {} ) );
+
+   e57::Data3D readHeader;
+   ASSERT_TRUE( reader->ReadData3D( 0, readHeader ) );
+
+   constexpr size_t cBufferSize = 256;
+
+   e57::Data3DPointsDouble readData( readHeader, cBufferSize );
+
+   e57::DownsampleOptions downsampleOptions;
+   downsampleOptions.voxelSize = 1.0;
+
+   for ( const auto voxelPoint : { e57::VoxelPoint::First, e57::VoxelPoint::Centroid } )
+   {
+      downsampleOptions.voxelPoint = voxelPoint;
+
+      // Offset of the point kept from the corner of its voxel
+      const double offset = ( voxelPoint == e57::VoxelPoint::Centroid ) ? 0.375 : 0.0;
+
+      int64_t readCount = 0;
+
+      const auto checkPoints = [&]( int64_t startPointIndex, size_t count ) {
+         ASSERT_EQ( startPointIndex, readCount );
+
+         for ( size_t i = 0; i < count; ++i )
+         {
+            // Voxels are in the order they are first hit, i.e. by the first point in each one
+            const int32_t firstPoint = readData.rowIndex[i];
+
+            ASSERT_EQ( firstPoint % 4, 0 );
+            ASSERT_EQ( ( firstPoint / 100 ) % 4, 0 );
+
+            EXPECT_EQ( readData.cartesianX[i], ( firstPoint % 100 ) / 4 + offset );
+            EXPECT_EQ( readData.cartesianY[i], firstPoint / 400 + offset );
+            EXPECT_EQ( readData.cartesianZ[i], 0.0 );
+         }
+
+         readCount += static_cast<int64_t>( count );
+      };
+
+      int64_t voxelCount = 0;
+
+      E57_ASSERT_NO_THROW( voxelCount = reader->ReadData3DDownsampled(
+                              0, downsampleOptions, cBufferSize, readData, checkPoints ) );
+
+      EXPECT_EQ( voxelCount, 25 * 25 );
+      EXPECT_EQ( readCount, voxelCount );
+   }
+
+   downsampleOptions.voxelSize = 0.0;
+
+   E57_ASSERT_THROW( reader->ReadData3DDownsampled( 0, downsampleOptions, cBufferSize, readData,
+                                                    []( int64_t, size_t ) {} ) );
+
+   delete reader;
+}
+
+TEST( SimpleReader, ReadStatistics )
+{
+   const e57::ustring cFilePath = "./ReadStatistics.e57";
+
+   constexpr int64_t cNumPoints = 10'000;
+
+   e57::WriterOptions options;
+   options.guid = "Read Statistics File GUID";
+
+   e57::Data3D fields;
+   fields.cartesianBounds.xMinimum = 0.0;
+   fields.cartesianBounds.xMaximum = 9'999.0;
+   fields.cartesianBounds.yMinimum = -9'999.0;
+   fields.cartesianBounds.yMaximum = 0.0;
+   fields.cartesianBounds.zMinimum = 0.0;
+   fields.cartesianBounds.zMaximum = 4'999.5;
+
+   e57::Data3D header;
+   E57_ASSERT_NO_THROW( header = writeLinearPoints( cFilePath, options, cNumPoints, fields ) );
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, {} ) );
+
+   // The bounds are compared with the ones read back from the file
+   e57::Data3D readHeader;
+   ASSERT_TRUE( reader->ReadData3D( 0, readHeader ) );
+
+   constexpr size_t cBufferSize = 1000;
+
+   e57::Data3DPointsDouble readData( header, cBufferSize );
+
+   e57::CompressedVectorReader vectorReader =
+      reader->SetUpData3DPointsData( 0, cBufferSize, readData );
+
+   E57_ASSERT_THROW( vectorReader.setStatistics( { { "intensity" } } ) );
+
+   vectorReader.setStatistics(
+      { { "cartesianX", 10, 0.0, 10'000.0 }, { "cartesianY" }, { "cartesianZ" } } );
+
+   while ( const unsigned count = vectorReader.read() )
+   {
+      const std::vector<e57::FieldStatistics> lastRead = vectorReader.lastReadStatistics();
+
+      ASSERT_EQ( lastRead.size(), 3 );
+      ASSERT_EQ( lastRead[0].count, count );
+      ASSERT_EQ( lastRead[0].minimum, readData.cartesianX[0] );
+      ASSERT_EQ( lastRead[0].maximum, readData.cartesianX[count - 1] );
+   }
+
+   vectorReader.close();
+
+   const std::vector<e57::FieldStatistics> statistics = vectorReader.statistics();
+
+   ASSERT_EQ( statistics.size(), 3 );
+
+   EXPECT_EQ( statistics[0].pathName, "cartesianX" );
+   EXPECT_EQ( statistics[0].count, cNumPoints );
+   EXPECT_EQ( statistics[0].minimum, 0.0 );
+   EXPECT_EQ( statistics[0].maximum, 9'999.0 );
+   EXPECT_DOUBLE_EQ( statistics[0].mean(), 4'999.5 );
+
+   ASSERT_EQ( statistics[0].histogram.size(), 10 );
+
+   for ( const uint64_t binCount : statistics[0].histogram )
+   {
+      EXPECT_EQ( binCount, 1'000 );
+   }
+
+   EXPECT_TRUE( statistics[1].histogram.empty() );
+   EXPECT_EQ( statistics[1].minimum, -9'999.0 );
+   EXPECT_EQ( statistics[2].maximum, 4'999.5 );
+
+   EXPECT_TRUE( readHeader.cartesianBounds.matches( statistics ) );
+
+   readHeader.cartesianBounds.zMaximum = 5'000.0;
+
+   EXPECT_FALSE( readHeader.cartesianBounds.matches( statistics ) );
+   EXPECT_TRUE( readHeader.cartesianBounds.matches( statistics, 0.5 ) );
+
+   delete reader;
+}
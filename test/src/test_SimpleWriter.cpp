@@ -1,11 +1,18 @@
 // libE57Format testing Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
 // SPDX-License-Identifier: MIT
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <fstream>
+#include <iterator>
+#include <thread>
 
 #include "gtest/gtest.h"
 
+#include "E57SimpleReader.h"
 #include "E57SimpleWriter.h"
 
 #include "Helpers.h"
@@ -74,23 +81,6 @@ namespace
       }
    }
 
-   // Set the header to indicate we are using coloured cartesian points.
-   // Just used to avoid a bunch of repetition.
-   inline void setUsingColouredCartesianPoints( e57::Data3D &ioHeader )
-   {
-      ioHeader.pointFields.cartesianXField = true;
-      ioHeader.pointFields.cartesianYField = true;
-      ioHeader.pointFields.cartesianZField = true;
-
-      ioHeader.pointFields.colorRedField = true;
-      ioHeader.pointFields.colorGreenField = true;
-      ioHeader.pointFields.colorBlueField = true;
-
-      ioHeader.colorLimits.colorRedMaximum = 255;
-      ioHeader.colorLimits.colorGreenMaximum = 255;
-      ioHeader.colorLimits.colorBlueMaximum = 255;
-   }
-
    // Fill in a point and its colour given an index, which face it is on, and the data.
    template <typename T>
    inline void fillColouredCartesianPoint( e57::Data3DPointsData_t<T> &ioPointsData,
@@ -541,6 +531,971 @@ TEST( SimpleWriter, ColouredCartesianPoints )
    delete writer;
 }
 
+TEST( SimpleWriter, DirectIO )
+{
+   const e57::ustring cFilePath = "./DirectIO.e57";
+   const e57::ustring cBufferedFilePath = "./DirectIOBuffered.e57";
+
+   // Enough points for several MB of aligned blocks plus an unaligned tail
+   constexpr int64_t cNumPoints = 1'000'003;
+
+   e57::Data3D header;
+   header.guid = "Direct IO Header GUID";
+   header.pointCount = cNumPoints;
+   header.pointFields.cartesianXField = true;
+   header.pointFields.cartesianYField = true;
+   header.pointFields.cartesianZField = true;
+
+   e57::Data3DPointsFloat pointsData( header );
+
+   for ( int64_t i = 0; i < cNumPoints; ++i )
+   {
+      auto floati = static_cast<float>( i );
+      pointsData.cartesianX[i] = floati;
+      pointsData.cartesianY[i] = -floati;
+      pointsData.cartesianZ[i] = 0.5f * floati;
+   }
+
+   // The same data written with and without direct I/O
+   for ( const bool directIO : { true, false } )
+   {
+      e57::WriterOptions options;
+      options.guid = "Direct IO File GUID";
+      options.directIO = directIO;
+
+      e57::Writer *writer = nullptr;
+
+      E57_ASSERT_NO_THROW( writer = new e57::Writer( directIO ? cFilePath : cBufferedFilePath,
+                                                     options ) );
+
+      e57::Data3D writeHeader = header;
+
+      E57_ASSERT_NO_THROW( writer->WriteData3DData( writeHeader, pointsData ) );
+
+      delete writer;
+   }
+
+   // Read it back
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, {} ) );
+
+   e57::Data3D readHeader;
+   ASSERT_TRUE( reader->ReadData3D( 0, readHeader ) );
+   ASSERT_EQ( readHeader.pointCount, cNumPoints );
+
+   e57::Data3DPointsFloat readData( readHeader );
+
+   auto vectorReader = reader->SetUpData3DPointsData( 0, cNumPoints, readData );
+
+   const uint64_t cNumRead = vectorReader.read();
+
+   EXPECT_EQ( cNumRead, static_cast<uint64_t>( cNumPoints ) );
+
+   vectorReader.close();
+
+   EXPECT_EQ( readData.cartesianX[cNumPoints - 1], static_cast<float>( cNumPoints - 1 ) );
+   EXPECT_EQ( readData.cartesianY[cNumPoints - 1], -static_cast<float>( cNumPoints - 1 ) );
+   EXPECT_EQ( readData.cartesianZ[12345], 0.5f * 12345.0f );
+
+   delete reader;
+
+   // The files are byte-identical
+   std::ifstream directFile( cFilePath, std::ios::binary );
+   std::ifstream bufferedFile( cBufferedFilePath, std::ios::binary );
+
+   const std::vector<char> directBytes( ( std::istreambuf_iterator<char>( directFile ) ),
+                                        std::istreambuf_iterator<char>() );
+   const std::vector<char> bufferedBytes( ( std::istreambuf_iterator<char>( bufferedFile ) ),
+                                          std::istreambuf_iterator<char>() );
+
+   ASSERT_EQ( directBytes.size(), bufferedBytes.size() );
+   EXPECT_TRUE( directBytes == bufferedBytes );
+}
+
+TEST( SimpleWriter, AutomaticLineGroups )
+{
+   const e57::ustring cFilePath = "./AutomaticLineGroups.e57";
+
+   constexpr int cNumColumns = 8;
+   constexpr int cNumRows = 5;
+   constexpr int64_t cNumPoints = cNumColumns * cNumRows;
+
+   e57::WriterOptions options;
+   options.guid = "Automatic Line Groups File GUID";
+
+   e57::Writer *writer = nullptr;
+
+   E57_ASSERT_NO_THROW( writer = new e57::Writer( cFilePath, options ) );
+
+   e57::Data3D header;
+   header.guid = "Automatic Line Groups Header GUID";
+   header.pointCount = cNumPoints;
+   header.pointFields.cartesianXField = true;
+   header.pointFields.cartesianYField = true;
+   header.pointFields.cartesianZField = true;
+   header.pointFields.rowIndexField = true;
+   header.pointFields.rowIndexMaximum = cNumRows - 1;
+   header.pointFields.columnIndexField = true;
+   header.pointFields.columnIndexMaximum = cNumColumns - 1;
+   header.pointGroupingSchemes.groupingByLine.idElementName = "columnIndex";
+
+   e57::Data3DPointsFloat pointsData( header );
+
+   // Points are ordered by column, so each column is one line
+   for ( int64_t i = 0; i < cNumPoints; ++i )
+   {
+      pointsData.cartesianX[i] = static_cast<float>( i );
+      pointsData.cartesianY[i] = 0.0f;
+      pointsData.cartesianZ[i] = 0.0f;
+      pointsData.columnIndex[i] = static_cast<int32_t>( i / cNumRows );
+      pointsData.rowIndex[i] = static_cast<int32_t>( i % cNumRows );
+   }
+
+   // No call to WriteData3DGroupsData() - the groups are written when the writer is closed
+   E57_ASSERT_NO_THROW( writer->WriteData3DData( header, pointsData ) );
+
+   delete writer;
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, {} ) );
+
+   int64_t rowMax = 0;
+   int64_t columnMax = 0;
+   int64_t pointsSize = 0;
+   int64_t groupsSize = 0;
+   int64_t countSize = 0;
+   bool columnIndex = false;
+
+   ASSERT_TRUE( reader->GetData3DSizes( 0, rowMax, columnMax, pointsSize, groupsSize, countSize,
+                                        columnIndex ) );
+
+   EXPECT_TRUE( columnIndex );
+   ASSERT_EQ( groupsSize, cNumColumns );
+
+   std::vector<int64_t> idElementValue( cNumColumns );
+   std::vector<int64_t> startPointIndex( cNumColumns );
+   std::vector<int64_t> pointCount( cNumColumns );
+
+   ASSERT_TRUE( reader->ReadData3DGroupsData( 0, cNumColumns, idElementValue.data(),
+                                              startPointIndex.data(), pointCount.data() ) );
+
+   for ( int64_t i = 0; i < cNumColumns; ++i )
+   {
+      EXPECT_EQ( idElementValue[i], i );
+      EXPECT_EQ( startPointIndex[i], i * cNumRows );
+      EXPECT_EQ( pointCount[i], cNumRows );
+   }
+
+   delete reader;
+}
+
+TEST( SimpleWriter, ColumnGroupedPackets )
+{
+   const e57::ustring cFilePath = "./ColumnGroupedPackets.e57";
+
+   e57::WriterOptions options;
+   options.columnGroupedPackets = true;
+
+   e57::Writer *writer = nullptr;
+
+   E57_ASSERT_NO_THROW( writer = new e57::Writer( cFilePath, options ) );
+
+   // Enough points for several packets per field
+   constexpr int64_t cNumPoints = 100'000;
+
+   e57::Data3D header;
+   header.pointCount = cNumPoints;
+
+   setUsingColouredCartesianPoints( header );
+
+   e57::Data3DPointsDouble pointsData( header );
+
+   for ( int64_t i = 0; i < cNumPoints; ++i )
+   {
+      auto doublei = static_cast<double>( i );
+      pointsData.cartesianX[i] = doublei;
+      pointsData.cartesianY[i] = -doublei;
+      pointsData.cartesianZ[i] = 0.25 * doublei;
+
+      pointsData.colorRed[i] = static_cast<uint16_t>( i % 256 );
+      pointsData.colorGreen[i] = static_cast<uint16_t>( ( i / 256 ) % 256 );
+      pointsData.colorBlue[i] = 255;
+   }
+
+   E57_ASSERT_NO_THROW( writer->WriteData3DData( header, pointsData ) );
+
+   delete writer;
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, {} ) );
+
+   e57::Data3D readHeader;
+   ASSERT_TRUE( reader->ReadData3D( 0, readHeader ) );
+
+   // Read in chunks so the fields are read from packets in different parts of the file
+   constexpr int64_t cChunkSize = 4096;
+
+   e57::Data3DPointsDouble readData( readHeader, cChunkSize );
+
+   auto vectorReader = reader->SetUpData3DPointsData( 0, cChunkSize, readData );
+
+   int64_t index = 0;
+
+   while ( const unsigned cNumRead = vectorReader.read() )
+   {
+      for ( unsigned i = 0; i < cNumRead; ++i, ++index )
+      {
+         ASSERT_EQ( readData.cartesianX[i], static_cast<double>( index ) );
+         ASSERT_EQ( readData.cartesianY[i], -static_cast<double>( index ) );
+         ASSERT_EQ( readData.cartesianZ[i], 0.25 * static_cast<double>( index ) );
+         ASSERT_EQ( readData.colorRed[i], index % 256 );
+         ASSERT_EQ( readData.colorGreen[i], ( index / 256 ) % 256 );
+         ASSERT_EQ( readData.colorBlue[i], 255 );
+      }
+   }
+
+   vectorReader.close();
+
+   EXPECT_EQ( index, cNumPoints );
+
+   delete reader;
+}
+
+TEST( SimpleWriter, FloatXorCodec )
+{
+   const e57::ustring cFilePath = "./FloatXorCodec.e57";
+
+   e57::WriterOptions options;
+   options.fieldCodecs["cartesianX"] = e57::CodecFloatXor;
+   options.fieldCodecs["cartesianY"] = e57::CodecFloatXor;
+   options.fieldCodecs["cartesianZ"] = e57::CodecFloatXor;
+   options.fieldCodecs["timeStamp"] = e57::CodecFloatXor;
+
+   e57::Writer *writer = nullptr;
+
+   E57_ASSERT_NO_THROW( writer = new e57::Writer( cFilePath, options ) );
+
+   constexpr int64_t cNumPoints = 100'000;
+
+   e57::Data3D header;
+   header.pointCount = cNumPoints;
+   header.pointFields.cartesianXField = true;
+   header.pointFields.cartesianYField = true;
+   header.pointFields.cartesianZField = true;
+   header.pointFields.timeStampField = true;
+   header.pointFields.pointRangeNodeType = e57::NumericalNodeType::Double;
+   header.pointFields.timeNodeType = e57::NumericalNodeType::Double;
+
+   e57::Data3DPointsDouble pointsData( header );
+
+   // Mix runs of equal values, slowly changing values, and special values
+   auto timeStamp = []( int64_t i ) { return 1.0e9 + static_cast<double>( i / 4 ) * 1.0e-5; };
+
+   for ( int64_t i = 0; i < cNumPoints; ++i )
+   {
+      auto doublei = static_cast<double>( i );
+      pointsData.cartesianX[i] = doublei * 0.001;
+      pointsData.cartesianY[i] = ( i % 3 == 0 ) ? -0.0 : 1.0 / ( doublei + 1.0 );
+      pointsData.cartesianZ[i] = ( i < cNumPoints / 2 ) ? 12.5 : -doublei;
+      pointsData.timeStamp[i] = timeStamp( i );
+   }
+
+   E57_ASSERT_NO_THROW( writer->WriteData3DData( header, pointsData ) );
+
+   delete writer;
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, {} ) );
+
+   e57::Data3D readHeader;
+   ASSERT_TRUE( reader->ReadData3D( 0, readHeader ) );
+
+   // Read in chunks which don't match the packet boundaries
+   constexpr int64_t cChunkSize = 3000;
+
+   e57::Data3DPointsDouble readData( readHeader, cChunkSize );
+
+   auto vectorReader = reader->SetUpData3DPointsData( 0, cChunkSize, readData );
+
+   int64_t index = 0;
+
+   while ( const unsigned cNumRead = vectorReader.read() )
+   {
+      for ( unsigned i = 0; i < cNumRead; ++i, ++index )
+      {
+         ASSERT_EQ( readData.cartesianX[i], pointsData.cartesianX[index] );
+         ASSERT_EQ( readData.cartesianY[i], pointsData.cartesianY[index] );
+         ASSERT_EQ( std::signbit( readData.cartesianY[i] ),
+                    std::signbit( pointsData.cartesianY[index] ) );
+         ASSERT_EQ( readData.cartesianZ[i], pointsData.cartesianZ[index] );
+         ASSERT_EQ( readData.timeStamp[i], timeStamp( index ) );
+      }
+   }
+
+   vectorReader.close();
+
+   EXPECT_EQ( index, cNumPoints );
+
+   delete reader;
+}
+
+TEST( SimpleWriter, RunLengthCodec )
+{
+   const e57::ustring cFilePath = "./RunLengthCodec.e57";
+
+   e57::WriterOptions options;
+   options.fieldCodecs["cartesianInvalidState"] = e57::CodecRunLength;
+   options.fieldCodecs["returnIndex"] = e57::CodecRunLength;
+   options.fieldCodecs["returnCount"] = e57::CodecRunLength;
+   options.fieldCodecs["colorRed"] = e57::CodecRunLength;
+
+   e57::Writer *writer = nullptr;
+
+   E57_ASSERT_NO_THROW( writer = new e57::Writer( cFilePath, options ) );
+
+   constexpr int64_t cNumPoints = 100'000;
+
+   e57::Data3D header;
+   header.pointCount = cNumPoints;
+   header.pointFields.cartesianInvalidStateField = true;
+   header.pointFields.returnIndexField = true;
+   header.pointFields.returnCountField = true;
+   header.pointFields.returnMaximum = 3;
+
+   setUsingColouredCartesianPoints( header );
+
+   e57::Data3DPointsDouble pointsData( header );
+
+   // Long runs, runs of one, and more distinct values than fit in the dictionary
+   for ( int64_t i = 0; i < cNumPoints; ++i )
+   {
+      pointsData.cartesianX[i] = static_cast<double>( i );
+      pointsData.cartesianY[i] = 0.0;
+      pointsData.cartesianZ[i] = 0.0;
+
+      pointsData.cartesianInvalidState[i] = static_cast<int8_t>( ( i / 5000 ) % 3 );
+      pointsData.returnIndex[i] = static_cast<int8_t>( i % 4 );
+      pointsData.returnCount[i] = 3;
+
+      pointsData.colorRed[i] = static_cast<uint16_t>( ( i / 10 ) % 256 );
+      pointsData.colorGreen[i] = 0;
+      pointsData.colorBlue[i] = 0;
+   }
+
+   E57_ASSERT_NO_THROW( writer->WriteData3DData( header, pointsData ) );
+
+   delete writer;
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, {} ) );
+
+   e57::Data3D readHeader;
+   ASSERT_TRUE( reader->ReadData3D( 0, readHeader ) );
+
+   // Read in chunks which split the runs
+   constexpr int64_t cChunkSize = 777;
+
+   e57::Data3DPointsDouble readData( readHeader, cChunkSize );
+
+   auto vectorReader = reader->SetUpData3DPointsData( 0, cChunkSize, readData );
+
+   int64_t index = 0;
+
+   while ( const unsigned cNumRead = vectorReader.read() )
+   {
+      for ( unsigned i = 0; i < cNumRead; ++i, ++index )
+      {
+         ASSERT_EQ( readData.cartesianX[i], static_cast<double>( index ) );
+         ASSERT_EQ( readData.cartesianInvalidState[i], ( index / 5000 ) % 3 );
+         ASSERT_EQ( readData.returnIndex[i], index % 4 );
+         ASSERT_EQ( readData.returnCount[i], 3 );
+         ASSERT_EQ( readData.colorRed[i], ( index / 10 ) % 256 );
+      }
+   }
+
+   vectorReader.close();
+
+   EXPECT_EQ( index, cNumPoints );
+
+   delete reader;
+}
+
+TEST( SimpleWriter, RansCodec )
+{
+   const e57::ustring cFilePath = "./RansCodec.e57";
+
+   e57::WriterOptions options;
+   options.fieldCodecs["cartesianX"] = e57::CodecRans;
+   options.fieldCodecs["cartesianY"] = e57::CodecRans;
+   options.fieldCodecs["intensity"] = e57::CodecRans;
+   options.fieldCodecs["colorRed"] = e57::CodecRans;
+
+   e57::Writer *writer = nullptr;
+
+   E57_ASSERT_NO_THROW( writer = new e57::Writer( cFilePath, options ) );
+
+   constexpr int64_t cNumPoints = 100'000;
+
+   e57::Data3D header;
+   header.pointCount = cNumPoints;
+   header.pointFields.pointRangeNodeType = e57::NumericalNodeType::ScaledInteger;
+   header.pointFields.pointRangeScale = 0.001;
+   header.pointFields.pointRangeMinimum = -1000.0;
+   header.pointFields.pointRangeMaximum = 1000.0;
+   header.pointFields.intensityField = true;
+   header.pointFields.intensityNodeType = e57::NumericalNodeType::Integer;
+   header.intensityLimits.intensityMinimum = 0.0;
+   header.intensityLimits.intensityMaximum = 4095.0;
+
+   setUsingColouredCartesianPoints( header );
+
+   e57::Data3DPointsDouble pointsData( header );
+
+   // A slowly varying coordinate (coded as differences), a coordinate jumping between the limits,
+   // a skewed intensity, and a value which is the same in all the records of a block
+   const auto x = []( int64_t i ) { return static_cast<double>( ( i * 7 ) % 1000 - 500 ) * 0.001; };
+   const auto y = []( int64_t i ) { return ( i % 3 == 0 ) ? -1000.0 : 1000.0; };
+   const auto intensity = []( int64_t i ) { return static_cast<double>( ( i * i ) % 97 % 13 ); };
+
+   for ( int64_t i = 0; i < cNumPoints; ++i )
+   {
+      pointsData.cartesianX[i] = x( i );
+      pointsData.cartesianY[i] = y( i );
+      pointsData.cartesianZ[i] = 0.0;
+      pointsData.intensity[i] = intensity( i );
+
+      pointsData.colorRed[i] = static_cast<uint16_t>( ( i / 5000 ) % 256 );
+      pointsData.colorGreen[i] = 0;
+      pointsData.colorBlue[i] = 0;
+   }
+
+   E57_ASSERT_NO_THROW( writer->WriteData3DData( header, pointsData ) );
+
+   delete writer;
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, {} ) );
+
+   e57::Data3D readHeader;
+   ASSERT_TRUE( reader->ReadData3D( 0, readHeader ) );
+
+   // Read in chunks which split the blocks
+   constexpr int64_t cChunkSize = 777;
+
+   e57::Data3DPointsDouble readData( readHeader, cChunkSize );
+
+   auto vectorReader = reader->SetUpData3DPointsData( 0, cChunkSize, readData );
+
+   int64_t index = 0;
+
+   while ( const unsigned cNumRead = vectorReader.read() )
+   {
+      for ( unsigned i = 0; i < cNumRead; ++i, ++index )
+      {
+         ASSERT_NEAR( readData.cartesianX[i], x( index ), 0.0005 );
+         ASSERT_NEAR( readData.cartesianY[i], y( index ), 0.0005 );
+         ASSERT_EQ( readData.intensity[i], intensity( index ) );
+         ASSERT_EQ( readData.colorRed[i], ( index / 5000 ) % 256 );
+      }
+   }
+
+   vectorReader.close();
+
+   EXPECT_EQ( index, cNumPoints );
+
+   delete reader;
+}
+
+TEST( SimpleWriter, CodecSelection )
+{
+   const e57::ustring cFilePath = "./CodecSelection.e57";
+
+   constexpr int64_t cNumPoints = 100'000;
+   constexpr size_t cSampleSize = 10'000;
+
+   e57::WriterOptions options;
+   options.codecSelectionSampleSize = cSampleSize;
+   options.codecSelectionTolerance = 0.05;
+
+   e57::Writer *writer = nullptr;
+
+   E57_ASSERT_NO_THROW( writer = new e57::Writer( cFilePath, options ) );
+
+   e57::Data3D header;
+   header.pointCount = cNumPoints;
+   header.pointFields.pointRangeNodeType = e57::NumericalNodeType::ScaledInteger;
+   header.pointFields.pointRangeScale = 0.001;
+   header.pointFields.pointRangeMinimum = -1000.0;
+   header.pointFields.pointRangeMaximum = 1000.0;
+
+   setUsingColouredCartesianPoints( header );
+
+   e57::Data3DPointsDouble pointsData( header );
+
+   // A slowly varying coordinate, a noisy one, a constant one, and a colour in long runs
+   const auto x = []( int64_t i ) { return static_cast<double>( i % 1000 ) * 0.001; };
+   const auto y = []( int64_t i ) { return static_cast<double>( ( i * i ) % 9973 ) * 0.001; };
+
+   for ( int64_t i = 0; i < cNumPoints; ++i )
+   {
+      pointsData.cartesianX[i] = x( i );
+      pointsData.cartesianY[i] = y( i );
+      pointsData.cartesianZ[i] = 1.0;
+
+      pointsData.colorRed[i] = static_cast<uint16_t>( ( i / 5000 ) % 256 );
+      pointsData.colorGreen[i] = 0;
+      pointsData.colorBlue[i] = 0;
+   }
+
+   const int64_t cScanIndex = writer->NewData3D( header );
+
+   e57::CompressedVectorWriter dataWriter =
+      writer->SetUpData3DPointsData( cScanIndex, cNumPoints, pointsData );
+
+   E57_ASSERT_NO_THROW( dataWriter.write( cNumPoints ) );
+
+   const auto selections = dataWriter.codecSelections();
+
+   dataWriter.close();
+
+   delete writer;
+
+   // One selection for each field, the codec being within the tolerance of the smallest trial
+   ASSERT_EQ( selections.size(), 6 );
+
+   for ( const auto &selection : selections )
+   {
+      EXPECT_EQ( selection.sampleRecordCount, cSampleSize );
+
+      uint64_t smallest = UINT64_MAX;
+      uint64_t selected = 0;
+
+      for ( const auto &trial : selection.trials )
+      {
+         smallest = std::min( smallest, trial.byteCount );
+
+         if ( trial.codec == selection.codec )
+         {
+            selected = trial.byteCount;
+         }
+      }
+
+      EXPECT_LE( selected, smallest * 1.05 ) << selection.pathName;
+
+      if ( selection.pathName == "colorRed" )
+      {
+         EXPECT_EQ( selection.codec, e57::CodecRunLength );
+      }
+   }
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, {} ) );
+
+   e57::Data3D readHeader;
+   ASSERT_TRUE( reader->ReadData3D( 0, readHeader ) );
+
+   constexpr int64_t cChunkSize = 777;
+
+   e57::Data3DPointsDouble readData( readHeader, cChunkSize );
+
+   auto vectorReader = reader->SetUpData3DPointsData( 0, cChunkSize, readData );
+
+   int64_t index = 0;
+
+   while ( const unsigned cNumRead = vectorReader.read() )
+   {
+      for ( unsigned i = 0; i < cNumRead; ++i, ++index )
+      {
+         ASSERT_NEAR( readData.cartesianX[i], x( index ), 0.0005 );
+         ASSERT_NEAR( readData.cartesianY[i], y( index ), 0.0005 );
+         ASSERT_NEAR( readData.cartesianZ[i], 1.0, 0.0005 );
+         ASSERT_EQ( readData.colorRed[i], ( index / 5000 ) % 256 );
+         ASSERT_EQ( readData.colorBlue[i], 0 );
+      }
+   }
+
+   vectorReader.close();
+
+   EXPECT_EQ( index, cNumPoints );
+
+   delete reader;
+}
+
+TEST( SimpleWriter, LargeVectorNode )
+{
+   const e57::ustring cFilePath = "./LargeVectorNode.e57";
+
+   constexpr int64_t cNumChildren = 50'000;
+
+   e57::Writer *writer = nullptr;
+
+   E57_ASSERT_NO_THROW( writer = new e57::Writer( cFilePath, e57::WriterOptions() ) );
+
+   e57::ImageFile imf = writer->GetRawIMF();
+   imf.extensionsAdd( "test", "http://www.example.com/LargeVectorNode" );
+
+   e57::VectorNode items( imf, false );
+   items.reserve( cNumChildren );
+
+   std::vector<e57::Node> nodes;
+
+   for ( int64_t i = 0; i < cNumChildren; ++i )
+   {
+      e57::StructureNode item( imf );
+      item.set( "index", e57::IntegerNode( imf, i, 0, cNumChildren ) );
+      item.set( "name", e57::StringNode( imf, "item" ) );
+
+      nodes.push_back( item );
+   }
+
+   E57_ASSERT_NO_THROW( items.appendMany( nodes ) );
+
+   // Children of a homogeneous vector must all have the same type
+   E57_ASSERT_THROW( items.append( e57::StructureNode( imf ) ) );
+
+   // ... and can't have new fields once there is more than one
+   E57_ASSERT_THROW( e57::StructureNode( items.get( 7 ) ).set( "extra", e57::StringNode( imf ) ) );
+
+   writer->GetRawE57Root().set( "test:items", items );
+
+   delete writer;
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, {} ) );
+
+   const e57::VectorNode readItems( reader->GetRawE57Root().get( "test:items" ) );
+
+   ASSERT_EQ( readItems.childCount(), cNumChildren );
+
+   const e57::IntegerNode last( readItems.get( "/test:items/49999/index" ) );
+   EXPECT_EQ( last.value(), cNumChildren - 1 );
+
+   const e57::StructureNode first( readItems.get( 0 ) );
+   EXPECT_TRUE( first.isDefined( "name" ) );
+   EXPECT_FALSE( first.isDefined( "00" ) );
+
+   delete reader;
+}
+
+TEST( SimpleWriter, XmlAtFront )
+{
+   const e57::ustring cFilePath = "./XmlAtFront.e57";
+
+   e57::WriterOptions options;
+   options.xmlAtFront = true;
+
+   e57::Writer *writer = nullptr;
+
+   E57_ASSERT_NO_THROW( writer = new e57::Writer( cFilePath, options ) );
+
+   // Enough points for the data to span many pages
+   constexpr int64_t cNumPoints = 100'000;
+
+   e57::Data3D header;
+   header.pointCount = cNumPoints;
+
+   setUsingColouredCartesianPoints( header );
+
+   e57::Data3DPointsDouble pointsData( header );
+
+   for ( int64_t i = 0; i < cNumPoints; ++i )
+   {
+      auto doublei = static_cast<double>( i );
+      pointsData.cartesianX[i] = doublei;
+      pointsData.cartesianY[i] = -doublei;
+      pointsData.cartesianZ[i] = 0.25 * doublei;
+
+      pointsData.colorRed[i] = static_cast<uint16_t>( i % 256 );
+      pointsData.colorGreen[i] = static_cast<uint16_t>( ( i / 256 ) % 256 );
+      pointsData.colorBlue[i] = 255;
+   }
+
+   E57_ASSERT_NO_THROW( writer->WriteData3DData( header, pointsData ) );
+
+   delete writer;
+
+   // The XML section starts right after the 48 byte file header
+   std::ifstream file( cFilePath, std::ios::binary );
+
+   std::array<char, 48> fileHeader{};
+   ASSERT_TRUE( file.read( fileHeader.data(), fileHeader.size() ) );
+
+   uint64_t xmlPhysicalOffset = 0;
+   memcpy( &xmlPhysicalOffset, fileHeader.data() + 24, sizeof( xmlPhysicalOffset ) );
+
+   EXPECT_EQ( xmlPhysicalOffset, 48 );
+
+   file.close();
+
+   // Read it back, waiting for data is harmless when the file is complete
+   e57::ReaderOptions readerOptions;
+   readerOptions.progressiveReadTimeout = 1000;
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, readerOptions ) );
+
+   e57::Data3D readHeader;
+   ASSERT_TRUE( reader->ReadData3D( 0, readHeader ) );
+   ASSERT_EQ( readHeader.pointCount, cNumPoints );
+
+   e57::Data3DPointsDouble readData( readHeader );
+
+   auto vectorReader = reader->SetUpData3DPointsData( 0, cNumPoints, readData );
+
+   EXPECT_EQ( vectorReader.read(), static_cast<unsigned>( cNumPoints ) );
+
+   vectorReader.close();
+
+   for ( int64_t i = 0; i < cNumPoints; ++i )
+   {
+      ASSERT_EQ( readData.cartesianX[i], static_cast<double>( i ) );
+      ASSERT_EQ( readData.cartesianZ[i], 0.25 * static_cast<double>( i ) );
+      ASSERT_EQ( readData.colorGreen[i], ( i / 256 ) % 256 );
+   }
+
+   delete reader;
+}
+
+namespace
+{
+   // Write a file with the XML section at the front, and return its bytes and the length of the
+   // start of the file holding the file header and the XML section (rounded up to whole pages).
+   std::vector<char> writeXmlAtFrontFile( const e57::ustring &filePath, int64_t pointCount,
+                                          size_t &xmlEnd )
+   {
+      e57::WriterOptions options;
+      options.xmlAtFront = true;
+
+      writeLinearPoints( filePath, options, pointCount );
+
+      std::ifstream file( filePath, std::ios::binary );
+
+      std::vector<char> bytes( ( std::istreambuf_iterator<char>( file ) ),
+                               std::istreambuf_iterator<char>() );
+
+      // Each page of 1024 bytes holds 1020 bytes of data and a checksum
+      uint64_t xmlPhysicalOffset = 0;
+      uint64_t xmlLogicalLength = 0;
+      memcpy( &xmlPhysicalOffset, bytes.data() + 24, sizeof( xmlPhysicalOffset ) );
+      memcpy( &xmlLogicalLength, bytes.data() + 32, sizeof( xmlLogicalLength ) );
+
+      const uint64_t cXmlPhysicalEnd = xmlPhysicalOffset + ( xmlLogicalLength / 1020 + 2 ) * 1024;
+
+      xmlEnd = static_cast<size_t>( ( cXmlPhysicalEnd / 1024 + 1 ) * 1024 );
+
+      return bytes;
+   }
+}
+
+// Read a file while it is copied: only the file header and the XML section are there when it is
+// opened, and the rest arrives while the points are read.
+TEST( SimpleWriter, XmlAtFrontGrowingFile )
+{
+   const e57::ustring cFilePath = "./XmlAtFrontGrowingFile.e57";
+   const e57::ustring cCopyPath = "./XmlAtFrontGrowingFileCopy.e57";
+
+   constexpr int64_t cNumPoints = 100'000;
+
+   size_t xmlEnd = 0;
+   const std::vector<char> cBytes = writeXmlAtFrontFile( cFilePath, cNumPoints, xmlEnd );
+
+   ASSERT_LT( xmlEnd, cBytes.size() );
+
+   std::ofstream copy( cCopyPath, std::ios::binary | std::ios::trunc );
+   copy.write( cBytes.data(), static_cast<std::streamsize>( xmlEnd ) );
+   copy.flush();
+
+   e57::ReaderOptions readerOptions;
+   readerOptions.progressiveReadTimeout = 5000;
+
+   // The header gives the length the file will have, which it doesn't have yet
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cCopyPath, readerOptions ) );
+
+   e57::Data3D readHeader;
+   ASSERT_TRUE( reader->ReadData3D( 0, readHeader ) );
+   ASSERT_EQ( readHeader.pointCount, cNumPoints );
+
+   e57::Data3DPointsDouble readData( readHeader );
+
+   // Append the rest of the file a bit at a time while the points are read
+   std::thread appender( [&]() {
+      constexpr size_t cChunkSize = 64 * 1024;
+
+      for ( size_t offset = xmlEnd; offset < cBytes.size(); offset += cChunkSize )
+      {
+         std::this_thread::sleep_for( std::chrono::milliseconds( 2 ) );
+
+         const size_t cSize = std::min( cChunkSize, cBytes.size() - offset );
+
+         copy.write( cBytes.data() + offset, static_cast<std::streamsize>( cSize ) );
+         copy.flush();
+      }
+   } );
+
+   unsigned readCount = 0;
+
+   try
+   {
+      auto vectorReader = reader->SetUpData3DPointsData( 0, cNumPoints, readData );
+
+      readCount = vectorReader.read();
+
+      vectorReader.close();
+   }
+   catch ( const e57::E57Exception &err )
+   {
+      ADD_FAILURE() << err.errorStr() << ": " << err.context();
+   }
+
+   appender.join();
+   copy.close();
+
+   EXPECT_EQ( readCount, static_cast<unsigned>( cNumPoints ) );
+
+   for ( int64_t i = 0; i < cNumPoints; ++i )
+   {
+      ASSERT_EQ( readData.cartesianX[i], static_cast<double>( i ) );
+      ASSERT_EQ( readData.cartesianZ[i], 0.5 * static_cast<double>( i ) );
+   }
+
+   delete reader;
+}
+
+// A file which stops growing fails to read once the timeout has passed
+TEST( SimpleWriter, XmlAtFrontGrowingFileTimeout )
+{
+   const e57::ustring cFilePath = "./XmlAtFrontGrowingFileTimeout.e57";
+   const e57::ustring cCopyPath = "./XmlAtFrontGrowingFileTimeoutCopy.e57";
+
+   constexpr int64_t cNumPoints = 100'000;
+   constexpr unsigned cTimeoutMs = 200;
+
+   size_t xmlEnd = 0;
+   const std::vector<char> cBytes = writeXmlAtFrontFile( cFilePath, cNumPoints, xmlEnd );
+
+   ASSERT_LT( xmlEnd, cBytes.size() );
+
+   {
+      std::ofstream copy( cCopyPath, std::ios::binary | std::ios::trunc );
+      copy.write( cBytes.data(), static_cast<std::streamsize>( xmlEnd ) );
+   }
+
+   e57::ReaderOptions readerOptions;
+   readerOptions.progressiveReadTimeout = cTimeoutMs;
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cCopyPath, readerOptions ) );
+
+   e57::Data3D readHeader;
+   ASSERT_TRUE( reader->ReadData3D( 0, readHeader ) );
+
+   e57::Data3DPointsDouble readData( readHeader );
+
+   const auto cStart = std::chrono::steady_clock::now();
+
+   try
+   {
+      auto vectorReader = reader->SetUpData3DPointsData( 0, cNumPoints, readData );
+
+      vectorReader.read();
+
+      FAIL() << "Reading past the end of the file didn't throw";
+   }
+   catch ( const e57::E57Exception &err )
+   {
+      EXPECT_EQ( err.errorCode(), e57::ErrorReadFailed );
+   }
+
+   EXPECT_GE( std::chrono::steady_clock::now() - cStart,
+              std::chrono::milliseconds( cTimeoutMs ) );
+
+   delete reader;
+}
+
+TEST( SimpleWriter, ProgressivePointOrder )
+{
+   const e57::ustring cFilePath = "./ProgressivePointOrder.e57";
+
+   constexpr int64_t cNumPoints = 100'000;
+
+   e57::WriterOptions options;
+   options.guid = "Progressive Point Order File GUID";
+   options.progressivePointOrder = true;
+
+   e57::Data3D fields;
+   fields.pointFields.rowIndexField = true;
+   fields.pointFields.rowIndexMaximum = cNumPoints;
+
+   e57::Data3D header;
+   E57_ASSERT_NO_THROW( header = writeLinearPoints( cFilePath, options, cNumPoints, fields ) );
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW( reader = new e57::Reader( cFilePath, {} ) );
+
+   const e57::StructureNode scan( reader->GetRawData3D().get( 0 ) );
+   e57::ustring prefix;
+
+   ASSERT_TRUE( reader->GetRawIMF().extensionsLookupUri( e57::POINT_ORDER_EXTENSION_URI, prefix ) );
+   EXPECT_EQ( e57::StringNode( scan.get( prefix + ":order" ) ).value(), "bitReversedIndex" );
+
+   e57::Data3DPointsDouble readData( header );
+
+   auto vectorReader = reader->SetUpData3DPointsData( 0, cNumPoints, readData );
+
+   ASSERT_EQ( vectorReader.read(), cNumPoints );
+
+   vectorReader.close();
+
+   // 17 bits are needed for the point indices, so the order starts with 0, 2^16, 2^15, 3 * 2^15
+   EXPECT_EQ( readData.rowIndex[0], 0 );
+   EXPECT_EQ( readData.rowIndex[1], 65'536 );
+   EXPECT_EQ( readData.rowIndex[2], 32'768 );
+   EXPECT_EQ( readData.rowIndex[3], 98'304 );
+
+   // Every point is written once, with all its fields
+   std::vector<bool> found( cNumPoints, false );
+
+   for ( int64_t i = 0; i < cNumPoints; ++i )
+   {
+      const int32_t pointIndex = readData.rowIndex[i];
+
+      ASSERT_GE( pointIndex, 0 );
+      ASSERT_LT( pointIndex, cNumPoints );
+      ASSERT_FALSE( found[pointIndex] );
+
+      found[pointIndex] = true;
+
+      EXPECT_EQ( readData.cartesianX[i], static_cast<double>( pointIndex ) );
+      EXPECT_EQ( readData.cartesianZ[i], 0.5 * static_cast<double>( pointIndex ) );
+   }
+
+   // The first 1% of the points is spread over the whole scan
+   std::vector<int32_t> prefixIndices( readData.rowIndex, readData.rowIndex + cNumPoints / 100 );
+   std::sort( prefixIndices.begin(), prefixIndices.end() );
+
+   for ( size_t i = 1; i < prefixIndices.size(); ++i )
+   {
+      EXPECT_LE( prefixIndices[i] - prefixIndices[i - 1], 128 );
+   }
+
+   EXPECT_GE( prefixIndices.back(), cNumPoints - 128 );
+
+   delete reader;
+}
+
 // https://github.com/asmaloney/libE57Format/issues/160
 TEST( SimpleWriter, MinMaxIssuesCartesianFloat )
 {